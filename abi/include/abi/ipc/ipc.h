@@ -36,6 +36,8 @@
 #define _ABI_IPC_IPC_H_
 
 #include <stdint.h>
+#include <_bits/native.h>
+#include <_bits/size_t.h>
 #include <abi/proc/task.h>
 #include <abi/cap.h>
 #include <_bits/errno.h>
@@ -57,6 +59,12 @@ enum {
 	 * IPC_M_DATA_READ requests.
 	 */
 	DATA_XFER_LIMIT = 64 * 1024,
+
+	/**
+	 * Maximum number of scatter/gather segments in one direction of
+	 * an IPC_M_DATA_XFER request.
+	 */
+	IPC_XFER_MAX_IOV = 8,
 };
 
 /* Flags for calls */
@@ -105,6 +113,29 @@ enum {
 	IPC_FIRST_USER_METHOD = 1024,
 };
 
+/** Scatter/gather segment of an IPC_M_DATA_XFER request */
+typedef struct {
+	/** Segment address in the sender's address space */
+	uspace_addr_t base;
+	/** Segment size */
+	size_t size;
+} ipc_iovec_t;
+
+/** Descriptor of an IPC_M_DATA_XFER request
+ *
+ * The first @c out_cnt segments of @c iov are gathered into the request
+ * payload, the following @c in_cnt segments receive the reply payload.
+ * The payload in each direction is limited to DATA_XFER_LIMIT bytes.
+ */
+typedef struct {
+	/** Number of segments sent to the recipient */
+	size_t out_cnt;
+	/** Number of segments receiving the reply */
+	size_t in_cnt;
+	/** Segments */
+	ipc_iovec_t iov[2 * IPC_XFER_MAX_IOV];
+} ipc_xfer_t;
+
 typedef struct {
 	sysarg_t args[IPC_CALL_LEN];
 	/**
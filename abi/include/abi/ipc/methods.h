@@ -214,6 +214,35 @@ enum {
 	 * - other arguments are specific to the debug method
 	 */
 	IPC_M_DEBUG,
+
+	/** Send a request together with data and receive data in the answer.
+	 *
+	 * Combines a protocol method with IPC_M_DATA_WRITE-like and
+	 * IPC_M_DATA_READ-like transfers so that the whole exchange takes
+	 * a single call and answer.
+	 *
+	 * Sender:
+	 *  - uspace: arg1 .. address of the ipc_xfer_t descriptor
+	 *            arg2 .. protocol method
+	 *            arg3 .. <unused>
+	 *            arg4 .. protocol defined data
+	 *            arg5 .. protocol defined data
+	 *
+	 * Recipient:
+	 *  - kernel: arg1 .. size of the gathered request payload
+	 *            arg3 .. capacity of the reply segments
+	 *
+	 *  - uspace: fetches the request payload with SYS_IPC_XFER_FETCH
+	 *            and answers with:
+	 *            arg1 .. recipient's reply buffer address
+	 *            arg2 .. recipient's reply buffer size
+	 *            arg3 .. protocol defined data
+	 *            arg4 .. protocol defined data
+	 *
+	 * The sender receives the reply size in arg2.
+	 *
+	 */
+	IPC_M_DATA_XFER,
 };
 
 /** Last system IPC method */
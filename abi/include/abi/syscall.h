@@ -80,6 +80,7 @@ typedef enum {
 	SYS_IPC_POKE,
 	SYS_IPC_HANGUP,
 	SYS_IPC_CONNECT_KBOX,
+	SYS_IPC_XFER_FETCH,
 
 	SYS_IPC_EVENT_SUBSCRIBE,
 	SYS_IPC_EVENT_UNSUBSCRIBE,
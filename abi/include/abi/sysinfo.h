@@ -70,6 +70,9 @@ typedef struct {
 	uint16_t frequency_mhz;  /**< Frequency in MHz */
 	uint64_t idle_cycles;    /**< Number of idle cycles */
 	uint64_t busy_cycles;    /**< Number of busy cycles */
+	uint64_t steals;         /**< Threads stolen from other CPUs */
+	uint64_t migrations;     /**< Threads migrated here on wakeup */
+	uint64_t handoffs;       /**< Threads switched to directly on wakeup */
 } stats_cpu_t;
 
 /** Physical memory statistics
@@ -40,6 +40,10 @@ void ipi_broadcast_arch(int ipi)
 {
 }
 
+void ipi_unicast_arch(struct cpu *cpu, int ipi)
+{
+}
+
 #endif /* CONFIG_SMP */
 
 /** @}
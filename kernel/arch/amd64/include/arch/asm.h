@@ -209,6 +209,35 @@ _NO_TRACE static inline void write_rflags(uint64_t rflags)
 	);
 }
 
+#define ARCH_HAS_MEMZERO_NT
+
+/** Clear memory using non-temporal stores.
+ *
+ * The stores bypass the caches so that clearing memory which is not
+ * going to be used soon does not evict useful cache lines.
+ *
+ * @param dst Destination address, aligned to 8 bytes.
+ * @param cnt Number of bytes to clear, a multiple of 8.
+ *
+ */
+_NO_TRACE static inline void memzero_nt(void *dst, size_t cnt)
+{
+	uint64_t *ptr = (uint64_t *) dst;
+
+	for (size_t i = 0; i < cnt / sizeof(uint64_t); i++) {
+		asm volatile (
+		    "movnti %[zero], %[mem]\n"
+		    : [mem] "=m" (ptr[i])
+		    : [zero] "r" (0UL)
+		);
+	}
+
+	asm volatile (
+	    "sfence\n"
+	    ::: "memory"
+	);
+}
+
 /** Return interrupt priority level.
  *
  * Return the current interrupt priority level.
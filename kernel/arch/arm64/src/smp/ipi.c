@@ -46,6 +46,11 @@ void ipi_broadcast_arch(int ipi)
 	panic("broadcast IPI not implemented.");
 }
 
+void ipi_unicast_arch(struct cpu *cpu, int ipi)
+{
+	panic("unicast IPI not implemented.");
+}
+
 #endif /* CONFIG_SMP */
 
 /** @}
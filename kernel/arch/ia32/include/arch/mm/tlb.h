@@ -35,6 +35,13 @@
 #ifndef KERN_ia32_TLB_H_
 #define KERN_ia32_TLB_H_
 
+/*
+ * Reloading CR3 on address space switch flushes all non-global TLB
+ * entries, so a processor does not keep translations of address spaces
+ * it switched away from.
+ */
+#define TLB_AS_SWITCH_FLUSHES
+
 #endif
 
 /** @}
@@ -41,6 +41,10 @@ void ipi_broadcast_arch(int ipi)
 {
 }
 
+void ipi_unicast_arch(struct cpu *cpu, int ipi)
+{
+}
+
 void smp_init(void)
 {
 }
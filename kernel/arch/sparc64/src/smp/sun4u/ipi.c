@@ -172,5 +172,25 @@ void ipi_broadcast_arch(int ipi)
 	}
 }
 
+/*
+ * Deliver IPI to one processor.
+ *
+ * We assume that interrupts are disabled.
+ *
+ * @param cpu Destination processor.
+ * @param ipi IPI number.
+ */
+void ipi_unicast_arch(cpu_t *cpu, int ipi)
+{
+	switch (ipi) {
+	case IPI_TLB_SHOOTDOWN:
+		cross_call(cpu->arch.mid, tlb_shootdown_ipi_recv);
+		break;
+	default:
+		panic("Unknown IPI (%d).\n", ipi);
+		break;
+	}
+}
+
 /** @}
  */
@@ -121,5 +121,23 @@ void ipi_broadcast_arch(int ipi)
 	ipi_brodcast_to(func, ipi_cpu_list[CPU->arch.id], idx);
 }
 
+/*
+ * Deliver IPI to one processor.
+ *
+ * @param cpu Destination processor.
+ * @param ipi IPI number.
+ */
+void ipi_unicast_arch(cpu_t *cpu, int ipi)
+{
+	switch (ipi) {
+	case IPI_TLB_SHOOTDOWN:
+		ipi_unicast_to(tlb_shootdown_ipi_recv, (uint16_t) cpu->id);
+		break;
+	default:
+		panic("Unknown IPI (%d).\n", ipi);
+		break;
+	}
+}
+
 /** @}
  */
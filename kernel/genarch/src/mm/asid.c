@@ -125,9 +125,14 @@ asid_t asid_get(void)
 		/*
 		 * Get the system rid of the stolen ASID.
 		 */
-		ipl_t ipl = tlb_shootdown_start(TLB_INVL_ASID, asid, 0, 0);
+		ipl_t ipl = tlb_shootdown_start(TLB_INVL_ASID, as, asid, 0, 0);
 		tlb_invalidate_asid(asid);
 		tlb_shootdown_finalize(ipl);
+
+		/*
+		 * No processor holds TLB entries of the address space now.
+		 */
+		tlb_as_reset(as);
 	} else {
 
 		/*
@@ -139,9 +144,10 @@ asid_t asid_get(void)
 		asids_allocated++;
 
 		/*
-		 * Purge the allocated ASID from TLBs.
+		 * Purge the allocated ASID from TLBs. The address space
+		 * which used it before is gone, so purge it everywhere.
 		 */
-		ipl_t ipl = tlb_shootdown_start(TLB_INVL_ASID, asid, 0, 0);
+		ipl_t ipl = tlb_shootdown_start(TLB_INVL_ASID, NULL, asid, 0, 0);
 		tlb_invalidate_asid(asid);
 		tlb_shootdown_finalize(ipl);
 	}
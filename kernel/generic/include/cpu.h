@@ -55,12 +55,45 @@ typedef struct cpu {
 	tlb_shootdown_msg_t tlb_messages[TLB_MESSAGE_QUEUE_LEN];
 	size_t tlb_messages_count;
 
+	/**
+	 * Sequence number of TLB shootdowns initiated by this CPU.
+	 * Odd while a shootdown is in progress.
+	 */
+	atomic_size_t tlb_seq;
+	/** Address space of the TLB shootdown in progress. */
+	struct as *tlb_as;
+
 	context_t saved_context;
 
 	atomic_size_t nrdy;
 	runq_t rq[RQ_COUNT];
+
+	/**
+	 * Bitmap of non-empty run queues. Bit i is only
+	 * modified while holding rq[i].lock.
+	 */
+	atomic_uint rq_map;
 	volatile size_t needs_relink;
 
+	/** Number of threads stolen from other CPUs' run queues. */
+	atomic_size_t steals;
+	/** Number of threads placed here away from their last CPU. */
+	atomic_size_t migrations;
+	/** Number of threads switched to directly, bypassing the run queues. */
+	atomic_size_t handoffs;
+
+	/**
+	 * Thread readied in this CPU's run queue handoff_rq by
+	 * thread_handoff(), to be switched to directly if handoff_waker
+	 * blocks waiting for IPC while handoff_armed is set. Only a hint,
+	 * the thread is looked up in the run queue before being used.
+	 * CPU-local, accessed only with interrupts disabled.
+	 */
+	struct thread *handoff;
+	int handoff_rq;
+	struct thread *handoff_waker;
+	bool handoff_armed;
+
 	IRQ_SPINLOCK_DECLARE(timeoutlock);
 	list_t timeout_active_list;
 
@@ -163,8 +163,11 @@ typedef struct call {
 	/** Method as it was sent in the request. */
 	sysarg_t request_method;
 
-	/** Buffer for IPC_M_DATA_WRITE and IPC_M_DATA_READ. */
+	/** Buffer for IPC_M_DATA_WRITE, IPC_M_DATA_READ and IPC_M_DATA_XFER. */
 	uint8_t *buffer;
+
+	/** Reply payload of IPC_M_DATA_XFER. */
+	uint8_t *reply_buffer;
 } call_t;
 
 extern slab_cache_t *phone_cache;
@@ -178,11 +181,11 @@ extern void ipc_init(void);
 extern call_t *ipc_call_alloc(void);
 
 extern errno_t ipc_call_sync(phone_t *, call_t *);
-extern errno_t ipc_call(phone_t *, call_t *);
+extern errno_t ipc_call(phone_t *, call_t *, bool);
 extern errno_t ipc_wait_for_call(answerbox_t *, uint32_t, unsigned int, call_t **);
 extern errno_t ipc_forward(call_t *, phone_t *, answerbox_t *, unsigned int);
-extern void ipc_answer(answerbox_t *, call_t *);
-extern void _ipc_answer_free_call(call_t *, bool);
+extern void ipc_answer(answerbox_t *, call_t *, bool);
+extern void _ipc_answer_free_call(call_t *, bool, bool);
 
 extern void ipc_phone_init(phone_t *, struct task *);
 extern bool ipc_phone_connect(phone_t *, answerbox_t *);
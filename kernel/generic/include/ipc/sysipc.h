@@ -61,6 +61,7 @@ extern sys_errno_t sys_ipc_irq_subscribe(inr_t, sysarg_t, uspace_ptr_irq_code_t,
 extern sys_errno_t sys_ipc_irq_unsubscribe(cap_irq_handle_t);
 
 extern sys_errno_t sys_ipc_connect_kbox(uspace_ptr_task_id_t, uspace_ptr_cap_phone_handle_t);
+extern sys_errno_t sys_ipc_xfer_fetch(cap_call_handle_t, uspace_addr_t, size_t);
 
 #endif
 
@@ -155,6 +155,8 @@ extern errno_t null_answer_cleanup(call_t *, ipc_data_t *);
 extern errno_t null_answer_preprocess(call_t *, ipc_data_t *);
 extern errno_t null_answer_process(call_t *);
 
+extern errno_t data_xfer_fetch(call_t *, uspace_addr_t, size_t);
+
 #endif
 
 /** @}
@@ -43,6 +43,7 @@
 #include <arch/istate.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
+#include <mm/tlb.h>
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <lib/elf.h>
@@ -107,6 +108,9 @@ typedef struct as {
 	 */
 	size_t cpu_refcount;
 
+	/** Processors which may hold TLB entries of this address space. */
+	tlb_cpus_t tlb_cpus;
+
 	/** Address space identifier.
 	 *
 	 * Constant on architectures that do not
@@ -274,6 +278,9 @@ typedef struct {
 	/** Map of used space. */
 	used_space_t used_space;
 
+	/** Page following the pages mapped by the last page fault. */
+	uintptr_t fault_next;
+
 	/**
 	 * If the address space area is shared. this is
 	 * a reference to the share info structure.
@@ -298,6 +305,7 @@ typedef struct mem_backend {
 	bool (*is_shareable)(as_area_t *);
 
 	int (*page_fault)(as_area_t *, uintptr_t, pf_access_t);
+	bool (*page_prefault)(as_area_t *, uintptr_t);
 	void (*frame_free)(as_area_t *, uintptr_t, uintptr_t);
 
 	bool (*create_shared_data)(as_area_t *);
@@ -37,6 +37,7 @@
 
 #include <arch/mm/asid.h>
 #include <typedefs.h>
+#include <atomic.h>
 
 /**
  * Number of TLB shootdown messages that can be queued in processor tlb_messages
@@ -44,6 +45,19 @@
  */
 #define TLB_MESSAGE_QUEUE_LEN	10
 
+/**
+ * Number of processors which are tracked individually in tlb_cpus_t.
+ * Processors with a higher ID are always considered to hold TLB entries
+ * of every address space.
+ */
+#define TLB_CPUS_MAX		64
+
+#define TLB_CPUS_WORD_BITS	(sizeof(unsigned int) * 8)
+#define TLB_CPUS_WORDS		(TLB_CPUS_MAX / TLB_CPUS_WORD_BITS)
+
+/** Initiator of TLB shootdown messages merged after queue overflow. */
+#define TLB_INITIATOR_ANY	((unsigned int) -1)
+
 /** Type of TLB shootdown message. */
 typedef enum {
 	/** Invalid type. */
@@ -62,25 +76,43 @@ typedef struct {
 	asid_t asid;			/**< Address space identifier. */
 	uintptr_t page;			/**< Page address. */
 	size_t count;			/**< Number of pages to invalidate. */
+	unsigned int initiator;		/**< ID of the sending processor. */
+	size_t seq;			/**< Sequence number of the shootdown. */
 } tlb_shootdown_msg_t;
 
+/** Set of processors which may hold TLB entries of an address space. */
+typedef struct {
+	/** Bitmap of processor IDs. */
+	atomic_uint mask[TLB_CPUS_WORDS];
+	/** Number of TLB shootdowns of the address space in progress. */
+	atomic_size_t shootdowns;
+} tlb_cpus_t;
+
+struct as;
+
 extern void tlb_init(void);
+extern void tlb_cpus_initialize(tlb_cpus_t *);
 
 #ifdef CONFIG_SMP
-extern ipl_t tlb_shootdown_start(tlb_invalidate_type_t, asid_t, uintptr_t,
-    size_t);
+extern ipl_t tlb_shootdown_start(tlb_invalidate_type_t, struct as *, asid_t,
+    uintptr_t, size_t);
 extern void tlb_shootdown_finalize(ipl_t);
 extern void tlb_shootdown_ipi_recv(void);
+extern void tlb_as_install(struct as *);
+extern void tlb_as_deinstall(struct as *);
+extern void tlb_as_reset(struct as *);
 #else
-#define tlb_shootdown_start(w, x, y, z)	interrupts_disable()
+#define tlb_shootdown_start(v, w, x, y, z)	interrupts_disable()
 #define tlb_shootdown_finalize(i)	(interrupts_restore(i));
 #define tlb_shootdown_ipi_recv()
+#define tlb_as_install(as)
+#define tlb_as_deinstall(as)
+#define tlb_as_reset(as)
 #endif /* CONFIG_SMP */
 
 /* Export TLB interface that each architecture must implement. */
 extern void tlb_arch_init(void);
 extern void tlb_print(void);
-extern void tlb_shootdown_ipi_send(void);
 
 extern void tlb_invalidate_all(void);
 extern void tlb_invalidate_asid(asid_t);
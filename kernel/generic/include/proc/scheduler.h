@@ -44,6 +44,9 @@
 #define RQ_COUNT          16
 #define NEEDS_RELINK_MAX  (HZ)
 
+/** Run queue bit in cpu_t.rq_map */
+#define RQ_MAP_BIT(i)  (1U << (i))
+
 /** Scheduler run queue structure. */
 typedef struct {
 	IRQ_SPINLOCK_DECLARE(lock);
@@ -51,8 +54,11 @@ typedef struct {
 	size_t n;			/**< Number of threads in rq_ready. */
 } runq_t;
 
+struct cpu;
+
 extern atomic_size_t nrdy;
 extern void scheduler_init(void);
+extern struct cpu *scheduler_select_cpu(struct cpu *);
 
 extern void scheduler_fpu_lazy_request(void);
 extern void scheduler(void);
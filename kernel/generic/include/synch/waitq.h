@@ -42,7 +42,12 @@
 
 typedef enum {
 	WAKEUP_FIRST = 0,
-	WAKEUP_ALL
+	WAKEUP_ALL,
+	/**
+	 * Like WAKEUP_FIRST, but let the woken thread run in place of the
+	 * current one if that goes on to wait for IPC.
+	 */
+	WAKEUP_HANDOFF
 } wakeup_mode_t;
 
 /** Wait queue structure.
@@ -86,6 +86,7 @@ static void _ipc_call_init(call_t *call)
 	call->sender = NULL;
 	call->callerbox = NULL;
 	call->buffer = NULL;
+	call->reply_buffer = NULL;
 }
 
 static void call_destroy(void *arg)
@@ -94,6 +95,8 @@ static void call_destroy(void *arg)
 
 	if (call->buffer)
 		free(call->buffer);
+	if (call->reply_buffer)
+		free(call->reply_buffer);
 	if (call->caller_phone)
 		kobject_put(call->caller_phone->kobject);
 	slab_free(call_cache, call);
@@ -222,7 +225,8 @@ errno_t ipc_call_sync(phone_t *phone, call_t *request)
 	/* We will receive data in a special box. */
 	request->callerbox = mybox;
 
-	errno_t rc = ipc_call(phone, request);
+	/* We are going to wait for the answer right away */
+	errno_t rc = ipc_call(phone, request, true);
 	if (rc != EOK) {
 		slab_free(answerbox_cache, mybox);
 		return rc;
@@ -280,9 +284,11 @@ errno_t ipc_call_sync(phone_t *phone, call_t *request)
  *
  * @param call       Call structure to be answered.
  * @param selflocked If true, then TASK->answebox is locked.
+ * @param handoff    If true, the current thread may go on to wait for IPC
+ *                   and hand the processor off to the woken up thread.
  *
  */
-void _ipc_answer_free_call(call_t *call, bool selflocked)
+void _ipc_answer_free_call(call_t *call, bool selflocked, bool handoff)
 {
 	/* Count sent answer */
 	irq_spinlock_lock(&TASK->lock, true);
@@ -325,16 +331,18 @@ void _ipc_answer_free_call(call_t *call, bool selflocked)
 	if (do_lock)
 		irq_spinlock_unlock(&callerbox->lock, true);
 
-	waitq_wakeup(&callerbox->wq, WAKEUP_FIRST);
+	waitq_wakeup(&callerbox->wq, handoff ? WAKEUP_HANDOFF : WAKEUP_FIRST);
 }
 
 /** Answer a message which is in a callee queue.
  *
- * @param box  Answerbox that is answering the message.
- * @param call Modified request that is being sent back.
+ * @param box     Answerbox that is answering the message.
+ * @param call    Modified request that is being sent back.
+ * @param handoff If true, the current thread may go on to wait for IPC
+ *                and hand the processor off to the woken up thread.
  *
  */
-void ipc_answer(answerbox_t *box, call_t *call)
+void ipc_answer(answerbox_t *box, call_t *call, bool handoff)
 {
 	/* Remove from active box */
 	irq_spinlock_lock(&box->lock, true);
@@ -342,7 +350,7 @@ void ipc_answer(answerbox_t *box, call_t *call)
 	irq_spinlock_unlock(&box->lock, true);
 
 	/* Send back answer */
-	_ipc_answer_free_call(call, false);
+	_ipc_answer_free_call(call, false, handoff);
 }
 
 static void _ipc_call_actions_internal(phone_t *phone, call_t *call,
@@ -387,7 +395,7 @@ void ipc_backsend_err(phone_t *phone, call_t *call, errno_t err)
 {
 	_ipc_call_actions_internal(phone, call, false);
 	ipc_set_retval(&call->data, err);
-	_ipc_answer_free_call(call, false);
+	_ipc_answer_free_call(call, false, false);
 }
 
 /** Unsafe unchecking version of ipc_call.
@@ -396,10 +404,12 @@ void ipc_backsend_err(phone_t *phone, call_t *call, errno_t err)
  * @param box       Destination answerbox structure.
  * @param call      Call structure with request.
  * @param preforget If true, the call will be delivered already forgotten.
+ * @param handoff   If true, the current thread may go on to wait for IPC
+ *                  and hand the processor off to the woken up thread.
  *
  */
 static void _ipc_call(phone_t *phone, answerbox_t *box, call_t *call,
-    bool preforget)
+    bool preforget, bool handoff)
 {
 	task_t *caller = phone->caller;
 
@@ -415,19 +425,25 @@ static void _ipc_call(phone_t *phone, answerbox_t *box, call_t *call,
 	list_append(&call->ab_link, &box->calls);
 	irq_spinlock_unlock(&box->lock, true);
 
-	waitq_wakeup(&box->wq, WAKEUP_FIRST);
+	/*
+	 * If the caller is about to wait for the answer, a thread of the
+	 * recipient waiting for the call can run in its place.
+	 */
+	waitq_wakeup(&box->wq, handoff ? WAKEUP_HANDOFF : WAKEUP_FIRST);
 }
 
 /** Send an asynchronous request using a phone to an answerbox.
  *
- * @param phone Phone structure the call comes from and which is
- *              connected to the destination answerbox.
- * @param call  Call structure with request.
+ * @param phone   Phone structure the call comes from and which is
+ *                connected to the destination answerbox.
+ * @param call    Call structure with request.
+ * @param handoff If true, the current thread may go on to wait for IPC
+ *                and hand the processor off to the woken up thread.
  *
  * @return Return 0 on success, ENOENT on error.
  *
  */
-errno_t ipc_call(phone_t *phone, call_t *call)
+errno_t ipc_call(phone_t *phone, call_t *call, bool handoff)
 {
 	mutex_lock(&phone->lock);
 	if (phone->state != IPC_PHONE_CONNECTED) {
@@ -443,7 +459,7 @@ errno_t ipc_call(phone_t *phone, call_t *call)
 	}
 
 	answerbox_t *box = phone->callee;
-	_ipc_call(phone, box, call, false);
+	_ipc_call(phone, box, call, false, handoff);
 
 	mutex_unlock(&phone->lock);
 	return 0;
@@ -487,7 +503,7 @@ errno_t ipc_phone_hangup(phone_t *phone)
 		ipc_set_imethod(&call->data, IPC_M_PHONE_HUNGUP);
 		call->request_method = IPC_M_PHONE_HUNGUP;
 		call->flags |= IPC_CALL_DISCARD_ANSWER;
-		_ipc_call(phone, box, call, false);
+		_ipc_call(phone, box, call, false, false);
 	}
 
 	phone->state = IPC_PHONE_HUNGUP;
@@ -525,7 +541,7 @@ errno_t ipc_forward(call_t *call, phone_t *newphone, answerbox_t *oldbox,
 		call->data.task_id = TASK->taskid;
 	}
 
-	return ipc_call(newphone, call);
+	return ipc_call(newphone, call, false);
 }
 
 /** Wait for a phone call.
@@ -554,7 +570,13 @@ errno_t ipc_wait_for_call(answerbox_t *box, uint32_t usec, unsigned int flags,
 	uint64_t call_cnt = 0;
 	errno_t rc;
 
+	/*
+	 * A thread we have just woken up with a call or an answer can run
+	 * in our place while we wait.
+	 */
+	thread_handoff_arm();
 	rc = waitq_sleep_timeout(&box->wq, usec, flags, NULL);
+	thread_handoff_disarm();
 	if (rc != EOK)
 		return rc;
 
@@ -635,7 +657,7 @@ void ipc_cleanup_call_list(answerbox_t *box, list_t *lst)
 		ipc_data_t old = call->data;
 		ipc_set_retval(&call->data, EHANGUP);
 		answer_preprocess(call, &old);
-		_ipc_answer_free_call(call, true);
+		_ipc_answer_free_call(call, true, false);
 
 		irq_spinlock_lock(&box->lock, true);
 	}
@@ -692,7 +714,7 @@ restart_phones:
 			ipc_set_imethod(&call->data, IPC_M_PHONE_HUNGUP);
 			call->request_method = IPC_M_PHONE_HUNGUP;
 			call->flags |= IPC_CALL_DISCARD_ANSWER;
-			_ipc_call(phone, box, call, true);
+			_ipc_call(phone, box, call, true, false);
 
 			task_release(phone->caller);
 
@@ -121,7 +121,7 @@ static void kbox_proc_phone_hungup(call_t *call, bool *last)
 
 	LOG("Continue with hangup message.");
 	ipc_set_retval(&call->data, 0);
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 
 	mutex_lock(&TASK->kb.cleanup_lock);
 
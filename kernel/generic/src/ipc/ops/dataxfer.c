@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ */
+
+#include <assert.h>
+#include <ipc/sysipc_ops.h>
+#include <ipc/ipc.h>
+#include <stdlib.h>
+#include <abi/errno.h>
+#include <abi/ipc/methods.h>
+#include <syscall/copy.h>
+#include <config.h>
+#include <macros.h>
+
+/** Kernel copy of an IPC_M_DATA_XFER request kept in call->buffer */
+typedef struct {
+	/** Number of the sender's reply segments */
+	size_t in_cnt;
+	/** Sender's reply segments */
+	ipc_iovec_t in_iov[IPC_XFER_MAX_IOV];
+	/** Size of the gathered request payload */
+	size_t size;
+	/** Request payload */
+	uint8_t data[];
+} data_xfer_t;
+
+static errno_t request_preprocess(call_t *call, phone_t *phone)
+{
+	ipc_xfer_t xfer;
+	size_t out_size = 0;
+	size_t in_size = 0;
+	size_t i;
+
+	errno_t rc = copy_from_uspace(&xfer, ipc_get_arg1(&call->data),
+	    sizeof(xfer));
+	if (rc != EOK)
+		return rc;
+
+	if (xfer.out_cnt > IPC_XFER_MAX_IOV || xfer.in_cnt > IPC_XFER_MAX_IOV)
+		return EINVAL;
+
+	for (i = 0; i < xfer.out_cnt + xfer.in_cnt; i++) {
+		size_t *total = (i < xfer.out_cnt) ? &out_size : &in_size;
+
+		if (xfer.iov[i].size > DATA_XFER_LIMIT - *total)
+			return ELIMIT;
+		*total += xfer.iov[i].size;
+	}
+
+	data_xfer_t *dx = malloc(sizeof(data_xfer_t) + out_size);
+	if (!dx)
+		return ENOMEM;
+
+	/* call->buffer will be cleaned up in ipc_call_free() at the latest. */
+	call->buffer = (uint8_t *) dx;
+
+	dx->in_cnt = xfer.in_cnt;
+	for (i = 0; i < xfer.in_cnt; i++)
+		dx->in_iov[i] = xfer.iov[xfer.out_cnt + i];
+	dx->size = out_size;
+
+	uint8_t *dst = dx->data;
+	for (i = 0; i < xfer.out_cnt; i++) {
+		rc = copy_from_uspace(dst, (uspace_addr_t) xfer.iov[i].base,
+		    xfer.iov[i].size);
+		if (rc != EOK)
+			return rc;
+		dst += xfer.iov[i].size;
+	}
+
+	/* Tell the recipient what it is getting and what it can send back. */
+	ipc_set_arg1(&call->data, out_size);
+	ipc_set_arg3(&call->data, in_size);
+
+	return EOK;
+}
+
+static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
+{
+	assert(answer->buffer);
+	assert(!answer->reply_buffer);
+
+	if (ipc_get_retval(&answer->data) == EOK) {
+		uspace_addr_t src = ipc_get_arg1(&answer->data);
+		size_t size = ipc_get_arg2(&answer->data);
+		size_t max_size = ipc_get_arg3(olddata);
+
+		/* The recipient's reply buffer address is of no use to the sender. */
+		ipc_set_arg1(&answer->data, 0);
+
+		if (size > max_size) {
+			ipc_set_retval(&answer->data, ELIMIT);
+			return EOK;
+		}
+
+		if (size == 0)
+			return EOK;
+
+		/*
+		 * The request payload in answer->buffer is left alone as the
+		 * recipient may still be fetching it from another thread.
+		 */
+		answer->reply_buffer = malloc(size);
+		if (!answer->reply_buffer) {
+			ipc_set_retval(&answer->data, ENOMEM);
+			return EOK;
+		}
+
+		errno_t rc = copy_from_uspace(answer->reply_buffer, src, size);
+		if (rc != EOK) {
+			/*
+			 * answer->reply_buffer will be cleaned up in
+			 * ipc_call_free().
+			 */
+			ipc_set_retval(&answer->data, rc);
+		}
+	}
+
+	return EOK;
+}
+
+static errno_t answer_process(call_t *answer)
+{
+	if (!answer->reply_buffer || ipc_get_retval(&answer->data) != EOK)
+		return EOK;
+
+	data_xfer_t *dx = (data_xfer_t *) answer->buffer;
+	size_t size = ipc_get_arg2(&answer->data);
+	uint8_t *src = answer->reply_buffer;
+
+	for (size_t i = 0; i < dx->in_cnt && size > 0; i++) {
+		size_t chunk = min(size, dx->in_iov[i].size);
+
+		errno_t rc = copy_to_uspace((uspace_addr_t) dx->in_iov[i].base,
+		    src, chunk);
+		if (rc != EOK) {
+			ipc_set_retval(&answer->data, rc);
+			break;
+		}
+
+		src += chunk;
+		size -= chunk;
+	}
+
+	return EOK;
+}
+
+/** Copy the request payload of an IPC_M_DATA_XFER call to the recipient.
+ *
+ * @param call Received call.
+ * @param dst  Destination address in the current address space.
+ * @param size Size of the destination buffer.
+ *
+ * @return EOK on success, EINVAL if @a call is not an IPC_M_DATA_XFER
+ *         request, ELIMIT if @a size is smaller than the payload or
+ *         an error code from copy_to_uspace().
+ *
+ */
+errno_t data_xfer_fetch(call_t *call, uspace_addr_t dst, size_t size)
+{
+	if (call->request_method != IPC_M_DATA_XFER || !call->buffer)
+		return EINVAL;
+
+	data_xfer_t *dx = (data_xfer_t *) call->buffer;
+	if (size < dx->size)
+		return ELIMIT;
+
+	return copy_to_uspace(dst, dx->data, dx->size);
+}
+
+sysipc_ops_t ipc_m_data_xfer_ops = {
+	.request_preprocess = request_preprocess,
+	.request_forget = null_request_forget,
+	.request_process = null_request_process,
+	.answer_cleanup = null_answer_cleanup,
+	.answer_preprocess = answer_preprocess,
+	.answer_process = answer_process,
+};
+
+/** @}
+ */
@@ -109,6 +109,7 @@ static inline bool method_is_immutable(sysarg_t imethod)
 	case IPC_M_SHARE_IN:
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
+	case IPC_M_DATA_XFER:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
 		return true;
 	default:
@@ -138,6 +139,7 @@ static inline bool answer_need_old(call_t *call)
 	case IPC_M_SHARE_IN:
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
+	case IPC_M_DATA_XFER:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
 		return true;
 	default:
@@ -401,7 +403,7 @@ sys_errno_t sys_ipc_call_async_fast(cap_phone_handle_t handle, sysarg_t imethod,
 	errno_t res = request_preprocess(call, kobj->phone);
 
 	if (!res)
-		ipc_call(kobj->phone, call);
+		ipc_call(kobj->phone, call, true);
 	else
 		ipc_backsend_err(kobj->phone, call, res);
 
@@ -450,7 +452,7 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 	errno_t res = request_preprocess(call, kobj->phone);
 
 	if (!res)
-		ipc_call(kobj->phone, call);
+		ipc_call(kobj->phone, call, true);
 	else
 		ipc_backsend_err(kobj->phone, call, res);
 
@@ -565,9 +567,9 @@ error:
 	ipc_set_retval(&call->data, EFORWARD);
 	(void) answer_preprocess(call, need_old ? &old : NULL);
 	if (after_forward)
-		_ipc_answer_free_call(call, false);
+		_ipc_answer_free_call(call, false, false);
 	else
-		ipc_answer(&TASK->answerbox, call);
+		ipc_answer(&TASK->answerbox, call, false);
 
 	cap_free(TASK, chandle);
 	kobject_put(ckobj);
@@ -683,7 +685,7 @@ sys_errno_t sys_ipc_answer_fast(cap_call_handle_t chandle, sysarg_t retval,
 	ipc_set_arg5(&call->data, 0);
 	errno_t rc = answer_preprocess(call, saved ? &saved_data : NULL);
 
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, true);
 
 	kobject_put(kobj);
 	cap_free(TASK, chandle);
@@ -729,7 +731,7 @@ sys_errno_t sys_ipc_answer_slow(cap_call_handle_t chandle, uspace_ptr_ipc_data_t
 
 	rc = answer_preprocess(call, saved ? &saved_data : NULL);
 
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, true);
 
 	kobject_put(kobj);
 	cap_free(TASK, chandle);
@@ -737,6 +739,30 @@ sys_errno_t sys_ipc_answer_slow(cap_call_handle_t chandle, uspace_ptr_ipc_data_t
 	return rc;
 }
 
+/** Fetch the request payload of a received IPC_M_DATA_XFER call.
+ *
+ * The call stays unanswered and can be fetched from more than once.
+ *
+ * @param chandle Call handle of the received IPC_M_DATA_XFER call.
+ * @param dst     Userspace address of the destination buffer.
+ * @param size    Size of the destination buffer.
+ *
+ * @return 0 on success, otherwise an error code.
+ *
+ */
+sys_errno_t sys_ipc_xfer_fetch(cap_call_handle_t chandle, uspace_addr_t dst,
+    size_t size)
+{
+	kobject_t *kobj = kobject_get(TASK, chandle, KOBJECT_TYPE_CALL);
+	if (!kobj)
+		return ENOENT;
+
+	errno_t rc = data_xfer_fetch(kobj->call, dst, size);
+
+	kobject_put(kobj);
+	return (sys_errno_t) rc;
+}
+
 /** Hang up a phone.
  *
  * @param handle  Phone capability handle of the phone to be hung up.
@@ -860,7 +886,7 @@ error:
 	ipc_set_retval(&call->data, EPARTY);
 	(void) answer_preprocess(call, saved ? &saved_data : NULL);
 	call->flags |= IPC_CALL_AUTO_REPLY;
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, false);
 
 	return rc;
 }
@@ -46,6 +46,7 @@ extern sysipc_ops_t ipc_m_data_write_ops;
 extern sysipc_ops_t ipc_m_data_read_ops;
 extern sysipc_ops_t ipc_m_state_change_authorize_ops;
 extern sysipc_ops_t ipc_m_debug_ops;
+extern sysipc_ops_t ipc_m_data_xfer_ops;
 
 static sysipc_ops_t *sysipc_ops[] = {
 	[IPC_M_CONNECT_TO_ME] = &ipc_m_connect_to_me_ops,
@@ -56,7 +57,8 @@ static sysipc_ops_t *sysipc_ops[] = {
 	[IPC_M_DATA_WRITE] = &ipc_m_data_write_ops,
 	[IPC_M_DATA_READ] = &ipc_m_data_read_ops,
 	[IPC_M_STATE_CHANGE_AUTHORIZE] = &ipc_m_state_change_authorize_ops,
-	[IPC_M_DEBUG] = &ipc_m_debug_ops
+	[IPC_M_DEBUG] = &ipc_m_debug_ops,
+	[IPC_M_DATA_XFER] = &ipc_m_data_xfer_ops
 };
 
 static sysipc_ops_t null_ops = {
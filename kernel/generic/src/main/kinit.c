@@ -58,6 +58,7 @@
 #include <mm/as.h>
 #include <mm/frame.h>
 #include <mm/km.h>
+#include <mm/zero_pool.h>
 #include <stdio.h>
 #include <log.h>
 #include <mem.h>
@@ -151,6 +152,27 @@ void kinit(void *arg)
 	 */
 	ARCH_OP(post_smp_init);
 
+	/*
+	 * For each CPU, create the thread refilling its pool
+	 * of pre-zeroed frames. Without the pools, zeroed frames
+	 * are cleared on demand.
+	 */
+	if (zero_pool_init()) {
+		for (unsigned int cpu = 0; cpu < config.cpu_count; cpu++) {
+			thread = thread_create(kzpool, NULL, TASK,
+			    THREAD_FLAG_UNCOUNTED, "kzpool");
+			if (thread != NULL) {
+				thread_wire(thread, &cpus[cpu]);
+				thread_ready(thread);
+			} else
+				log(LF_OTHER, LVL_ERROR,
+				    "Unable to create kzpool thread for cpu%u",
+				    cpu);
+		}
+	} else
+		log(LF_OTHER, LVL_ERROR,
+		    "Unable to allocate zero pools, clearing frames on demand");
+
 	/* Start thread computing system load */
 	thread = thread_create(kload, NULL, TASK, THREAD_FLAG_NONE,
 	    "kload");
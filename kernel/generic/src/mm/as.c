@@ -81,6 +81,12 @@
 #include <interrupt.h>
 #include <stdlib.h>
 
+/**
+ * Number of pages in the naturally aligned window around a faulting page
+ * which the backend is asked to map ahead of access.
+ */
+#define AS_FAULT_AROUND_PAGES  16
+
 /**
  * Each architecture decides what functions will be used to carry out
  * address space operations such as creating or locking page tables.
@@ -183,6 +189,7 @@ as_t *as_create(unsigned int flags)
 
 	refcount_init(&as->refcount);
 	as->cpu_refcount = 0;
+	tlb_cpus_initialize(&as->tlb_cpus);
 
 #ifdef AS_PAGE_TABLE
 	as->genarch.page_table = page_table_create(flags);
@@ -721,12 +728,103 @@ _NO_TRACE static void sh_info_remove_reference(share_info_t *sh_info)
 	}
 }
 
+/** Map all pages of a newly created address space area.
+ *
+ * The pages are faulted in through the backend as if they were touched
+ * using the most permissive access the area allows. Populating the area
+ * is only a hint, so the first failure simply terminates it.
+ *
+ * Must not be used with backends which call out to user space to resolve
+ * page faults, as the address space and area locks are held.
+ *
+ * @param area Address space area.
+ *
+ */
+_NO_TRACE static void as_area_populate(as_area_t *area)
+{
+	assert(mutex_locked(&area->as->lock));
+
+	pf_access_t access;
+	if (area->flags & AS_AREA_WRITE)
+		access = PF_ACCESS_WRITE;
+	else if (area->flags & AS_AREA_READ)
+		access = PF_ACCESS_READ;
+	else if (area->flags & AS_AREA_EXEC)
+		access = PF_ACCESS_EXEC;
+	else
+		return;
+
+	mutex_lock(&area->lock);
+	page_table_lock(area->as, false);
+
+	for (size_t i = 0; i < area->pages; i++) {
+		uintptr_t page = area->base + P2SZ(i);
+
+		pte_t pte;
+		if (page_mapping_find(area->as, page, false, &pte))
+			continue;
+
+		if (area->backend->page_fault(area, page, access) != AS_PF_OK)
+			break;
+	}
+
+	page_table_unlock(area->as, false);
+	mutex_unlock(&area->lock);
+}
+
+/** Map pages surrounding a page which has just been faulted in.
+ *
+ * The backend maps only those pages of the window which it can provide
+ * cheaply so that sequential accesses do not trap on every page.
+ *
+ * Anonymous pages cost a fresh frame each, so they are only mapped
+ * ahead when the fault continues right where the previous one left
+ * off. Randomly accessed anonymous memory is thus not inflated.
+ *
+ * @param area Address space area containing the faulting page.
+ * @param page Faulting page.
+ *
+ */
+_NO_TRACE static void as_area_fault_around(as_area_t *area, uintptr_t page)
+{
+	assert(mutex_locked(&area->lock));
+	assert(page_table_locked(area->as));
+
+	bool sequential = (page == area->fault_next);
+	area->fault_next = page + PAGE_SIZE;
+
+	if (!area->backend->page_prefault)
+		return;
+
+	if ((area->backend == &anon_backend) && (!sequential))
+		return;
+
+	uintptr_t start = max(ALIGN_DOWN(page, P2SZ(AS_FAULT_AROUND_PAGES)),
+	    area->base);
+	uintptr_t end = min(start + P2SZ(AS_FAULT_AROUND_PAGES),
+	    area->base + P2SZ(area->pages));
+
+	area->fault_next = end;
+
+	for (uintptr_t cur = start; cur < end; cur += PAGE_SIZE) {
+		if (cur == page)
+			continue;
+
+		pte_t pte;
+		if (page_mapping_find(area->as, cur, false, &pte))
+			continue;
+
+		(void) area->backend->page_prefault(area, cur);
+	}
+}
+
 /** Create address space area of common attributes.
  *
  * The created address space area is added to the target address space.
  *
  * @param as           Target address space.
- * @param flags        Flags of the area memory.
+ * @param flags        Flags of the area memory. AS_AREA_POPULATE requests
+ *                     that all pages of the area are mapped right away.
  * @param size         Size of area.
  * @param attrs        Attributes of the area.
  * @param backend      Address space area backend. NULL if no backend is used.
@@ -788,10 +886,11 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 
 	area->as = as;
 	odlink_initialize(&area->las_areas);
-	area->flags = flags;
+	area->flags = flags & ~AS_AREA_POPULATE;
 	area->attributes = attrs;
 	area->pages = pages;
 	area->base = *base;
+	area->fault_next = *base;
 	area->backend = backend;
 	area->sh_info = NULL;
 
@@ -846,6 +945,15 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	used_space_initialize(&area->used_space);
 	odict_insert(&area->las_areas, &as->as_areas, NULL);
 
+	/*
+	 * Only backends which resolve faults in the kernel are populated.
+	 * The user backend would block the whole address space on an IPC
+	 * round trip to the pager for every page.
+	 */
+	if ((flags & AS_AREA_POPULATE) && (backend) && (backend->page_fault) &&
+	    (backend != &user_backend) && !(attrs & AS_AREA_ATTR_PARTIAL))
+		as_area_populate(area);
+
 	mutex_unlock(&as->lock);
 
 	return area;
@@ -955,7 +1063,7 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		 */
 
 		ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES,
-		    as->asid, area->base + P2SZ(pages),
+		    as, as->asid, area->base + P2SZ(pages),
 		    area->pages - pages);
 
 		/*
@@ -1104,8 +1212,8 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
-	    area->pages);
+	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as, as->asid,
+	    area->base, area->pages);
 
 	/*
 	 * Visit only the pages mapped by used_space.
@@ -1404,8 +1512,8 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
-	    area->pages);
+	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as, as->asid,
+	    area->base, area->pages);
 
 	/*
 	 * Remove used pages from page tables and remember their frame
@@ -1453,9 +1561,10 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	page_table_unlock(as, false);
 
 	/*
-	 * Set the new flags.
+	 * Set the new flags. AS_AREA_POPULATE only applies to creating
+	 * the area, it is not a property of the area.
 	 */
-	area->flags = flags;
+	area->flags = flags & ~AS_AREA_POPULATE;
 
 	/*
 	 * Map pages back in with new flags. This step is kept separate
@@ -1581,6 +1690,8 @@ int as_page_fault(uintptr_t address, pf_access_t access, istate_t *istate)
 		goto page_fault;
 	}
 
+	as_area_fault_around(area, page);
+
 	page_table_unlock(AS, false);
 	mutex_unlock(&area->lock);
 	mutex_unlock(&AS->lock);
@@ -1675,6 +1786,11 @@ retry:
 			new_as->asid = asid_get();
 	}
 
+	/*
+	 * Make the new address space visible to TLB shootdowns.
+	 */
+	tlb_as_install(new_as);
+
 #ifdef AS_PAGE_TABLE
 	SET_PTL0_ADDRESS(new_as->genarch.page_table);
 #endif
@@ -1685,6 +1801,9 @@ retry:
 	 */
 	as_install_arch(new_as);
 
+	if (old_as)
+		tlb_as_deinstall(old_as);
+
 	spinlock_unlock(&asidlock);
 
 	AS = new_as;
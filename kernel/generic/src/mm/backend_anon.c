@@ -45,6 +45,7 @@
 #include <mm/frame.h>
 #include <mm/slab.h>
 #include <mm/km.h>
+#include <mm/zero_pool.h>
 #include <synch/mutex.h>
 #include <adt/list.h>
 #include <errno.h>
@@ -62,6 +63,7 @@ static bool anon_is_resizable(as_area_t *);
 static bool anon_is_shareable(as_area_t *);
 
 static int anon_page_fault(as_area_t *, uintptr_t, pf_access_t);
+static bool anon_page_prefault(as_area_t *, uintptr_t);
 static void anon_frame_free(as_area_t *, uintptr_t, uintptr_t);
 
 mem_backend_t anon_backend = {
@@ -74,6 +76,7 @@ mem_backend_t anon_backend = {
 	.is_shareable = anon_is_shareable,
 
 	.page_fault = anon_page_fault,
+	.page_prefault = anon_page_prefault,
 	.frame_free = anon_frame_free,
 
 	.create_shared_data = NULL,
@@ -183,10 +186,9 @@ bool anon_is_shareable(as_area_t *area)
  */
 int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 {
-	uintptr_t kpage;
 	uintptr_t frame;
 
-	assert(page_table_locked(AS));
+	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 	assert(IS_ALIGNED(upage, PAGE_SIZE));
 
@@ -206,10 +208,7 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		    upage - area->base, &frame);
 		if (rc != EOK) {
 			/* Need to allocate the frame */
-			kpage = km_temporary_page_get(&frame,
-			    FRAME_NO_RESERVE);
-			memsetb((void *) kpage, PAGE_SIZE, 0);
-			km_temporary_page_put(kpage);
+			frame = zero_pool_frame_alloc(FRAME_NO_RESERVE);
 
 			/*
 			 * Insert the address of the newly allocated
@@ -246,9 +245,7 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 			}
 		}
 
-		kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
-		memsetb((void *) kpage, PAGE_SIZE, 0);
-		km_temporary_page_put(kpage);
+		frame = zero_pool_frame_alloc(FRAME_NO_RESERVE);
 	}
 	mutex_unlock(&area->sh_info->lock);
 
@@ -257,13 +254,69 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	 * Note that TLB shootdown is not attempted as only new information is
 	 * being inserted into page tables.
 	 */
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
 	return AS_PF_OK;
 }
 
+/** Map a page of the anonymous memory backend ahead of an access.
+ *
+ * The page is mapped only if doing so is cheap, i.e. if the frame is
+ * already present in the pagemap of a shared area or if a pre-zeroed
+ * frame is readily available for a private area whose memory has been
+ * reserved in advance.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Virtual page which is not mapped yet.
+ *
+ * @return True if the page was mapped, false otherwise.
+ */
+bool anon_page_prefault(as_area_t *area, uintptr_t upage)
+{
+	uintptr_t frame;
+
+	assert(page_table_locked(area->as));
+	assert(mutex_locked(&area->lock));
+	assert(IS_ALIGNED(upage, PAGE_SIZE));
+
+	mutex_lock(&area->sh_info->lock);
+	if (area->sh_info->shared) {
+		errno_t rc = as_pagemap_find(&area->sh_info->pagemap,
+		    upage - area->base, &frame);
+		if (rc != EOK) {
+			mutex_unlock(&area->sh_info->lock);
+			return false;
+		}
+		frame_reference_add(ADDR2PFN(frame));
+	} else {
+		/*
+		 * Late reservation areas would have to reserve the memory
+		 * for a page which may never be touched.
+		 */
+		if (area->flags & AS_AREA_LATE_RESERVE) {
+			mutex_unlock(&area->sh_info->lock);
+			return false;
+		}
+
+		frame = zero_pool_frame_get(FRAME_NO_RESERVE);
+		if (frame == 0) {
+			mutex_unlock(&area->sh_info->lock);
+			return false;
+		}
+	}
+	mutex_unlock(&area->sh_info->lock);
+
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
+	if (!used_space_insert(&area->used_space, upage, 1))
+		panic("Cannot insert used space.");
+
+	return true;
+}
+
 /** Free a frame that is backed by the anonymous memory backend.
  *
  * The address space area and page tables must be already locked.
@@ -61,6 +61,7 @@ static bool elf_is_resizable(as_area_t *);
 static bool elf_is_shareable(as_area_t *);
 
 static int elf_page_fault(as_area_t *, uintptr_t, pf_access_t);
+static bool elf_page_prefault(as_area_t *, uintptr_t);
 static void elf_frame_free(as_area_t *, uintptr_t, uintptr_t);
 
 mem_backend_t elf_backend = {
@@ -73,6 +74,7 @@ mem_backend_t elf_backend = {
 	.is_shareable = elf_is_shareable,
 
 	.page_fault = elf_page_fault,
+	.page_prefault = elf_page_prefault,
 	.frame_free = elf_frame_free,
 
 	.create_shared_data = NULL,
@@ -267,7 +269,7 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	size_t i;
 	bool dirty = false;
 
-	assert(page_table_locked(AS));
+	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 	assert(IS_ALIGNED(upage, PAGE_SIZE));
 
@@ -300,7 +302,7 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		    upage - area->base, &frame);
 		if (rc == EOK) {
 			frame_reference_add(ADDR2PFN(frame));
-			page_mapping_insert(AS, upage, frame,
+			page_mapping_insert(area->as, upage, frame,
 			    as_area_get_flags(area));
 			if (!used_space_insert(&area->used_space, upage, 1))
 				panic("Cannot insert used space.");
@@ -396,13 +398,84 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 
 	mutex_unlock(&area->sh_info->lock);
 
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
 	return AS_PF_OK;
 }
 
+/** Map a page of the ELF backend ahead of an access.
+ *
+ * The page is mapped only if no copying or clearing is needed, i.e. if
+ * the frame is already present in the pagemap of a shared area or if
+ * the page is a read-only page backed directly by the ELF image.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area		Pointer to the address space area.
+ * @param upage		Virtual page which is not mapped yet.
+ *
+ * @return		True if the page was mapped, false otherwise.
+ */
+bool elf_page_prefault(as_area_t *area, uintptr_t upage)
+{
+	elf_header_t *elf = area->backend_data.elf;
+	elf_segment_header_t *entry = area->backend_data.segment;
+	uintptr_t frame;
+	uintptr_t elfpage;
+
+	assert(page_table_locked(area->as));
+	assert(mutex_locked(&area->lock));
+	assert(IS_ALIGNED(upage, PAGE_SIZE));
+
+	elfpage = elf_orig_page(area, upage);
+
+	if (elfpage < ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE))
+		return false;
+
+	if (elfpage >= entry->p_vaddr + entry->p_memsz)
+		return false;
+
+	mutex_lock(&area->sh_info->lock);
+	if (area->sh_info->shared) {
+		errno_t rc = as_pagemap_find(&area->sh_info->pagemap,
+		    upage - area->base, &frame);
+		if (rc == EOK) {
+			frame_reference_add(ADDR2PFN(frame));
+			mutex_unlock(&area->sh_info->lock);
+			goto map;
+		}
+	}
+	mutex_unlock(&area->sh_info->lock);
+
+	if ((entry->p_flags & PF_W) || (elfpage < entry->p_vaddr) ||
+	    (elfpage + PAGE_SIZE > entry->p_vaddr + entry->p_filesz))
+		return false;
+
+	size_t i = (elfpage - ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE)) >>
+	    PAGE_WIDTH;
+	uintptr_t base = (uintptr_t)
+	    (((void *) elf) + ALIGN_DOWN(entry->p_offset, PAGE_SIZE));
+
+	pte_t pte;
+	bool found = page_mapping_find(AS_KERNEL, base + i * FRAME_SIZE,
+	    true, &pte);
+
+	(void) found;
+	assert(found);
+	assert(PTE_PRESENT(&pte));
+
+	frame = PTE_GET_FRAME(&pte);
+
+map:
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
+	if (!used_space_insert(&area->used_space, upage, 1))
+		panic("Cannot insert used space.");
+
+	return true;
+}
+
 /** Free a frame that is backed by the ELF backend.
  *
  * The address space area and page tables must be already locked.
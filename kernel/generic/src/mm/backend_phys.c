@@ -74,6 +74,7 @@ mem_backend_t phys_backend = {
 	.is_shareable = phys_is_shareable,
 
 	.page_fault = phys_page_fault,
+	.page_prefault = NULL,
 	.frame_free = NULL,
 
 	.create_shared_data = phys_create_shared_data,
@@ -135,7 +136,7 @@ int phys_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 {
 	uintptr_t base = area->backend_data.base;
 
-	assert(page_table_locked(AS));
+	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 	assert(IS_ALIGNED(upage, PAGE_SIZE));
 
@@ -143,7 +144,7 @@ int phys_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		return AS_PF_FAULT;
 
 	assert(upage - area->base < area->backend_data.frames * FRAME_SIZE);
-	page_mapping_insert(AS, upage, base + (upage - area->base),
+	page_mapping_insert(area->as, upage, base + (upage - area->base),
 	    as_area_get_flags(area));
 
 	if (!used_space_insert(&area->used_space, upage, 1))
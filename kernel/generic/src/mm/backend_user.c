@@ -39,6 +39,7 @@
 #include <mm/as.h>
 #include <mm/page.h>
 #include <mm/frame.h>
+#include <mm/km.h>
 #include <abi/mm/as.h>
 #include <abi/ipc/methods.h>
 #include <ipc/sysipc.h>
@@ -48,6 +49,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <log.h>
+#include <mem.h>
 #include <str.h>
 
 static bool user_create(as_area_t *);
@@ -69,6 +71,7 @@ mem_backend_t user_backend = {
 	.is_shareable = user_is_shareable,
 
 	.page_fault = user_page_fault,
+	.page_prefault = NULL,
 	.frame_free = user_frame_free,
 
 	.create_shared_data = NULL,
@@ -108,7 +111,7 @@ bool user_is_shareable(as_area_t *area)
  */
 int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 {
-	assert(page_table_locked(AS));
+	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 	assert(IS_ALIGNED(upage, PAGE_SIZE));
 
@@ -145,7 +148,26 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	 */
 
 	uintptr_t frame = ipc_get_arg1(&data);
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+
+	if (area->flags & AS_AREA_WRITE) {
+		/*
+		 * The pager may hand out the same frame to several areas
+		 * (e.g. from a page cache). Writable areas get a private
+		 * copy so that their modifications are not seen elsewhere.
+		 */
+		uintptr_t copy;
+		uintptr_t kpage = km_temporary_page_get(&copy, 0);
+		uintptr_t src = km_map(frame, PAGE_SIZE, PAGE_SIZE,
+		    PAGE_READ | PAGE_CACHEABLE);
+		memcpy((void *) kpage, (void *) src, PAGE_SIZE);
+		km_unmap(src, PAGE_SIZE);
+		km_temporary_page_put(kpage);
+
+		user_frame_free(area, upage, frame);
+		frame = copy;
+	}
+
+	page_mapping_insert(area->as, upage, frame, as_area_get_flags(area));
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
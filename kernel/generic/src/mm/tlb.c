@@ -35,12 +35,16 @@
  * @brief Generic TLB shootdown algorithm.
  *
  * The algorithm implemented here is based on the CMU TLB shootdown
- * algorithm and is further simplified (e.g. all CPUs receive all TLB
- * shootdown messages).
+ * algorithm. Only processors which may hold TLB entries of the affected
+ * address space receive the shootdown message and there is no global
+ * lock, so shootdowns in unrelated address spaces can proceed in
+ * parallel.
  */
 
 #include <mm/tlb.h>
 #include <mm/asid.h>
+#include <mm/as.h>
+#include <mm/page.h>
 #include <arch/mm/tlb.h>
 #include <assert.h>
 #include <smp/ipi.h>
@@ -51,78 +55,204 @@
 #include <arch.h>
 #include <panic.h>
 #include <cpu.h>
+#include <macros.h>
 
 void tlb_init(void)
 {
 	tlb_arch_init();
 }
 
+/** Initialize an empty set of processors holding TLB entries.
+ *
+ * @param tcpus Set of processors to initialize.
+ *
+ */
+void tlb_cpus_initialize(tlb_cpus_t *tcpus)
+{
+	for (size_t i = 0; i < TLB_CPUS_WORDS; i++)
+		atomic_store(&tcpus->mask[i], 0);
+
+	atomic_store(&tcpus->shootdowns, 0);
+}
+
 #ifdef CONFIG_SMP
 
-/**
- * This lock is used for synchronisation between sender and
- * recipients of TLB shootdown message. It must be acquired
- * before CPU structure lock.
+/** Test whether a processor may hold TLB entries of an address space.
+ *
+ * @param mask Snapshot of tlb_cpus_t.mask or NULL if all
+ *             processors may hold the entries.
+ * @param id   Processor ID.
+ *
+ * @return True if the processor needs to receive the shootdown.
+ *
+ */
+static bool tlb_cpus_contain(const unsigned int *mask, unsigned int id)
+{
+	if ((mask == NULL) || (id >= TLB_CPUS_MAX))
+		return true;
+
+	return ((mask[id / TLB_CPUS_WORD_BITS] &
+	    (1U << (id % TLB_CPUS_WORD_BITS))) != 0);
+}
+
+/** Try to merge TLB shootdown message with the last queued one.
+ *
+ * Only messages sent by the same processor are merged. Waiting for the
+ * newer shootdown to finish implies that the older one is finished too.
+ *
+ * @param last Last queued message.
+ * @param msg  Message to be queued.
+ *
+ * @return True if @a last now covers also @a msg.
+ *
+ */
+static bool tlb_message_merge(tlb_shootdown_msg_t *last,
+    tlb_shootdown_msg_t *msg)
+{
+	if (last->initiator != msg->initiator)
+		return false;
+
+	if (last->type == TLB_INVL_ALL)
+		goto merged;
+
+	if ((msg->type == TLB_INVL_ALL) || (last->asid != msg->asid))
+		return false;
+
+	if (last->type == TLB_INVL_ASID)
+		goto merged;
+
+	if (msg->type == TLB_INVL_ASID) {
+		last->type = TLB_INVL_ASID;
+		last->page = 0;
+		last->count = 0;
+		goto merged;
+	}
+
+	/* Both messages are page ranges, merge them if they touch */
+	uintptr_t last_end = last->page + P2SZ(last->count);
+	uintptr_t msg_end = msg->page + P2SZ(msg->count);
+
+	if ((msg->page > last_end) || (last->page > msg_end))
+		return false;
+
+	last->page = min(last->page, msg->page);
+	last->count = (max(last_end, msg_end) - last->page) >> PAGE_WIDTH;
+
+merged:
+	last->seq = msg->seq;
+	return true;
+}
+
+/** Queue TLB shootdown message to a processor.
+ *
+ * @param cpu Destination processor. Its lock must be held.
+ * @param msg Message to be queued.
  *
  */
-IRQ_SPINLOCK_STATIC_INITIALIZE(tlblock);
+static void tlb_message_enqueue(cpu_t *cpu, tlb_shootdown_msg_t *msg)
+{
+	assert(irq_spinlock_locked(&cpu->lock));
+
+	if ((cpu->tlb_messages_count > 0) &&
+	    (tlb_message_merge(&cpu->tlb_messages[cpu->tlb_messages_count - 1],
+	    msg)))
+		return;
+
+	if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
+		/*
+		 * The message queue is full.
+		 * Erase the queue and store one TLB_INVL_ALL message.
+		 * As the initiators of the erased messages are no longer
+		 * known, the recipient waits for all shootdowns in progress.
+		 */
+		cpu->tlb_messages_count = 1;
+		cpu->tlb_messages[0].type = TLB_INVL_ALL;
+		cpu->tlb_messages[0].asid = ASID_INVALID;
+		cpu->tlb_messages[0].page = 0;
+		cpu->tlb_messages[0].count = 0;
+		cpu->tlb_messages[0].initiator = TLB_INITIATOR_ANY;
+		cpu->tlb_messages[0].seq = 0;
+	} else {
+		/*
+		 * Enqueue the message.
+		 */
+		cpu->tlb_messages[cpu->tlb_messages_count++] = *msg;
+	}
+}
 
 /** Send TLB shootdown message.
  *
- * This function attempts to deliver TLB shootdown message
- * to all other processors.
+ * This function delivers TLB shootdown message to all other
+ * processors which may hold TLB entries of the address space and
+ * waits until they stop using their TLBs. If the set of such processors
+ * is not known, the message is delivered to all other processors.
  *
  * @param type  Type describing scope of shootdown.
- * @param asid  Address space, if required by type.
+ * @param as    Address space whose translations are being invalidated
+ *              or NULL if unknown.
+ * @param asid  Address space identifier, if required by type.
  * @param page  Virtual page address, if required by type.
  * @param count Number of pages, if required by type.
  *
  * @return The interrupt priority level as it existed prior to this call.
  *
  */
-ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
+ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, as_t *as, asid_t asid,
     uintptr_t page, size_t count)
 {
 	ipl_t ipl = interrupts_disable();
 	CPU->tlb_active = false;
-	irq_spinlock_lock(&tlblock, false);
+
+	tlb_shootdown_msg_t msg = {
+		.type = type,
+		.asid = asid,
+		.page = page,
+		.count = count,
+		.initiator = CPU->id,
+		.seq = atomic_preinc(&CPU->tlb_seq)
+	};
+
+	assert((msg.seq & 1) != 0);
+
+	unsigned int snapshot[TLB_CPUS_WORDS];
+	unsigned int *mask = NULL;
+
+	if ((type != TLB_INVL_ALL) && (as != NULL) && (as != AS_KERNEL)) {
+		/*
+		 * Prevent other processors from starting to use the address
+		 * space until the shootdown is finished. Those which already
+		 * use it are visible in the mask afterwards.
+		 */
+		atomic_inc(&as->tlb_cpus.shootdowns);
+		CPU->tlb_as = as;
+
+		for (size_t i = 0; i < TLB_CPUS_WORDS; i++)
+			snapshot[i] = atomic_load(&as->tlb_cpus.mask[i]);
+
+		mask = snapshot;
+	}
 
 	size_t i;
 	for (i = 0; i < config.cpu_count; i++) {
-		if (i == CPU->id)
+		if ((i == CPU->id) || (!tlb_cpus_contain(mask, i)))
 			continue;
 
 		cpu_t *cpu = &cpus[i];
 
 		irq_spinlock_lock(&cpu->lock, false);
-		if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
-			/*
-			 * The message queue is full.
-			 * Erase the queue and store one TLB_INVL_ALL message.
-			 */
-			cpu->tlb_messages_count = 1;
-			cpu->tlb_messages[0].type = TLB_INVL_ALL;
-			cpu->tlb_messages[0].asid = ASID_INVALID;
-			cpu->tlb_messages[0].page = 0;
-			cpu->tlb_messages[0].count = 0;
-		} else {
-			/*
-			 * Enqueue the message.
-			 */
-			size_t idx = cpu->tlb_messages_count++;
-			cpu->tlb_messages[idx].type = type;
-			cpu->tlb_messages[idx].asid = asid;
-			cpu->tlb_messages[idx].page = page;
-			cpu->tlb_messages[idx].count = count;
-		}
+		tlb_message_enqueue(cpu, &msg);
 		irq_spinlock_unlock(&cpu->lock, false);
+
+		if ((mask != NULL) && (cpu->active))
+			ipi_unicast(cpu, VECTOR_TLB_SHOOTDOWN_IPI);
 	}
 
-	tlb_shootdown_ipi_send();
+	if (mask == NULL)
+		ipi_broadcast(VECTOR_TLB_SHOOTDOWN_IPI);
 
 busy_wait:
 	for (i = 0; i < config.cpu_count; i++) {
-		if (cpus[i].tlb_active)
+		if ((tlb_cpus_contain(mask, i)) && (cpus[i].tlb_active))
 			goto busy_wait;
 	}
 
@@ -136,14 +266,42 @@ busy_wait:
  */
 void tlb_shootdown_finalize(ipl_t ipl)
 {
-	irq_spinlock_unlock(&tlblock, false);
+	if (CPU->tlb_as != NULL) {
+		atomic_dec(&CPU->tlb_as->tlb_cpus.shootdowns);
+		CPU->tlb_as = NULL;
+	}
+
+	/* Let the recipients proceed */
+	atomic_inc(&CPU->tlb_seq);
+
 	CPU->tlb_active = true;
 	interrupts_restore(ipl);
 }
 
-void tlb_shootdown_ipi_send(void)
+/** Wait until the sender of a TLB shootdown message finishes.
+ *
+ * @param msg TLB shootdown message.
+ *
+ */
+static void tlb_shootdown_wait(tlb_shootdown_msg_t *msg)
 {
-	ipi_broadcast(VECTOR_TLB_SHOOTDOWN_IPI);
+	if (msg->initiator != TLB_INITIATOR_ANY) {
+		while (atomic_load(&cpus[msg->initiator].tlb_seq) == msg->seq)
+			;
+		return;
+	}
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		if (i == CPU->id)
+			continue;
+
+		size_t seq = atomic_load(&cpus[i].tlb_seq);
+		if ((seq & 1) == 0)
+			continue;
+
+		while (atomic_load(&cpus[i].tlb_seq) == seq)
+			;
+	}
 }
 
 /** Receive TLB shootdown message.
@@ -151,21 +309,34 @@ void tlb_shootdown_ipi_send(void)
  */
 void tlb_shootdown_ipi_recv(void)
 {
+	tlb_shootdown_msg_t msgs[TLB_MESSAGE_QUEUE_LEN];
+
 	assert(CPU);
 
 	CPU->tlb_active = false;
-	irq_spinlock_lock(&tlblock, false);
-	irq_spinlock_unlock(&tlblock, false);
 
 	irq_spinlock_lock(&CPU->lock, false);
 	assert(CPU->tlb_messages_count <= TLB_MESSAGE_QUEUE_LEN);
 
+	size_t count = CPU->tlb_messages_count;
 	size_t i;
-	for (i = 0; i < CPU->tlb_messages_count; i++) {
-		tlb_invalidate_type_t type = CPU->tlb_messages[i].type;
-		asid_t asid = CPU->tlb_messages[i].asid;
-		uintptr_t page = CPU->tlb_messages[i].page;
-		size_t count = CPU->tlb_messages[i].count;
+	for (i = 0; i < count; i++)
+		msgs[i] = CPU->tlb_messages[i];
+
+	CPU->tlb_messages_count = 0;
+	irq_spinlock_unlock(&CPU->lock, false);
+
+	/*
+	 * The senders may still be modifying the page tables.
+	 */
+	for (i = 0; i < count; i++)
+		tlb_shootdown_wait(&msgs[i]);
+
+	for (i = 0; i < count; i++) {
+		tlb_invalidate_type_t type = msgs[i].type;
+		asid_t asid = msgs[i].asid;
+		uintptr_t page = msgs[i].page;
+		size_t pcount = msgs[i].count;
 
 		switch (type) {
 		case TLB_INVL_ALL:
@@ -175,8 +346,8 @@ void tlb_shootdown_ipi_recv(void)
 			tlb_invalidate_asid(asid);
 			break;
 		case TLB_INVL_PAGES:
-			assert(count);
-			tlb_invalidate_pages(asid, page, count);
+			assert(pcount);
+			tlb_invalidate_pages(asid, page, pcount);
 			break;
 		default:
 			panic("Unknown type (%d).", type);
@@ -187,11 +358,79 @@ void tlb_shootdown_ipi_recv(void)
 			break;
 	}
 
-	CPU->tlb_messages_count = 0;
-	irq_spinlock_unlock(&CPU->lock, false);
 	CPU->tlb_active = true;
 }
 
+/** Start using an address space on the current processor.
+ *
+ * Must be called with interrupts disabled before the address space
+ * is installed. If a TLB shootdown of the address space is in progress,
+ * wait until it finishes so that no stale translation can be loaded.
+ *
+ * @param as Address space being installed.
+ *
+ */
+void tlb_as_install(as_t *as)
+{
+	assert(interrupts_disabled());
+
+	if (as == AS_KERNEL)
+		return;
+
+	unsigned int id = CPU->id;
+	if (id < TLB_CPUS_MAX) {
+		atomic_fetch_or(&as->tlb_cpus.mask[id / TLB_CPUS_WORD_BITS],
+		    1U << (id % TLB_CPUS_WORD_BITS));
+	}
+
+	if (atomic_load(&as->tlb_cpus.shootdowns) > 0) {
+		/* Do not hold up shootdowns which target this processor */
+		CPU->tlb_active = false;
+		while (atomic_load(&as->tlb_cpus.shootdowns) > 0)
+			;
+		CPU->tlb_active = true;
+	}
+}
+
+/** Stop using an address space on the current processor.
+ *
+ * Must be called after the next address space is installed. On
+ * architectures which keep TLB entries of address spaces that are
+ * not installed, the processor stays in the set until tlb_as_reset().
+ *
+ * @param as Address space which was deinstalled.
+ *
+ */
+void tlb_as_deinstall(as_t *as)
+{
+#ifdef TLB_AS_SWITCH_FLUSHES
+	if (as == AS_KERNEL)
+		return;
+
+	unsigned int id = CPU->id;
+	if (id < TLB_CPUS_MAX) {
+		atomic_fetch_and(&as->tlb_cpus.mask[id / TLB_CPUS_WORD_BITS],
+		    ~(1U << (id % TLB_CPUS_WORD_BITS)));
+	}
+#endif
+}
+
+/** Forget processors holding TLB entries of an inactive address space.
+ *
+ * To be called once all TLB entries of the address space have been
+ * invalidated on all processors (e.g. when its ASID is stolen).
+ *
+ * @param as Address space which is not active on any processor.
+ *
+ */
+void tlb_as_reset(as_t *as)
+{
+	assert(as->cpu_refcount == 0);
+
+	for (size_t i = 0; i < TLB_CPUS_WORDS; i++)
+		atomic_store(&as->tlb_cpus.mask[i], 0);
+}
+
 #endif /* CONFIG_SMP */
 
 /** @}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Pools of pre-zeroed frames.
+ *
+ * Each CPU keeps a small pool of frames which have already been cleared.
+ * The pools are refilled by per-CPU kzpool threads which only work
+ * while their CPU has nothing else to run, so that anonymous page faults
+ * do not need to clear the frame on the fault path.
+ *
+ * Frames in the pools are backed by memory reservations which are
+ * handed over to the consumer or released, depending on whether the
+ * consumer asked for FRAME_NO_RESERVE.
+ */
+
+#include <assert.h>
+#include <mm/zero_pool.h>
+#include <mm/frame.h>
+#include <mm/page.h>
+#include <mm/km.h>
+#include <mm/reserve.h>
+#include <proc/thread.h>
+#include <synch/spinlock.h>
+#include <sysinfo/sysinfo.h>
+#include <arch/asm.h>
+#include <config.h>
+#include <stdlib.h>
+#include <mem.h>
+#include <cpu.h>
+#include <arch.h>
+
+/** Period of kzpool refill passes (in microseconds). */
+#define ZERO_POOL_PERIOD  100000
+
+/** Pool of pre-zeroed frames belonging to one CPU. */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+
+	/** Physical addresses of the zeroed frames. */
+	uintptr_t frames[ZERO_POOL_SIZE];
+	/** Number of frames in the pool. */
+	size_t count;
+
+	/** Number of frames taken from the pool. */
+	uint64_t hits;
+	/** Number of frames which had to be cleared on demand. */
+	uint64_t misses;
+} zero_pool_t;
+
+static zero_pool_t *zero_pools = NULL;
+
+/** Clear a frame mapped at the given kernel address.
+ *
+ * Use non-temporal stores if the architecture provides them as the
+ * frame is unlikely to be touched again by this CPU soon.
+ *
+ */
+static void zero_pool_clear(uintptr_t page)
+{
+#ifdef ARCH_HAS_MEMZERO_NT
+	memzero_nt((void *) page, PAGE_SIZE);
+#else
+	memsetb((void *) page, PAGE_SIZE, 0);
+#endif
+}
+
+static sysarg_t get_zero_pool_stat(struct sysinfo_item *item, void *data)
+{
+	bool hits = (bool) data;
+	uint64_t sum = 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		irq_spinlock_lock(&zero_pools[i].lock, true);
+		sum += hits ? zero_pools[i].hits : zero_pools[i].misses;
+		irq_spinlock_unlock(&zero_pools[i].lock, true);
+	}
+
+	return (sysarg_t) sum;
+}
+
+/** Initialize the pools of pre-zeroed frames.
+ *
+ * Must be called after all CPUs were detected. If the pools cannot
+ * be allocated, zeroed frames are always cleared on demand.
+ *
+ * @return True if the pools were created and the kzpool threads
+ *         can be started.
+ *
+ */
+bool zero_pool_init(void)
+{
+	zero_pool_t *pools = malloc(sizeof(zero_pool_t) * config.cpu_count);
+	if (pools == NULL)
+		return false;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		irq_spinlock_initialize(&pools[i].lock, "zero_pool.lock");
+		pools[i].count = 0;
+		pools[i].hits = 0;
+		pools[i].misses = 0;
+	}
+
+	zero_pools = pools;
+
+	sysinfo_set_item_gen_val("system.zero_pool.hits", NULL,
+	    get_zero_pool_stat, (void *) true);
+	sysinfo_set_item_gen_val("system.zero_pool.misses", NULL,
+	    get_zero_pool_stat, (void *) false);
+
+	return true;
+}
+
+/** Take a zeroed frame from the pool of the current CPU.
+ *
+ * @param flags FRAME_NONE or FRAME_NO_RESERVE.
+ * @param miss  Account an empty pool as a miss.
+ *
+ * @return Physical address of the zeroed frame or 0 if the pool is empty.
+ *
+ */
+static uintptr_t zero_pool_take(frame_flags_t flags, bool miss)
+{
+	assert(!(flags & ~FRAME_NO_RESERVE));
+
+	if (zero_pools == NULL)
+		return 0;
+
+	zero_pool_t *pool = &zero_pools[CPU->id];
+	uintptr_t frame = 0;
+
+	irq_spinlock_lock(&pool->lock, true);
+	if (pool->count > 0) {
+		frame = pool->frames[--pool->count];
+		pool->hits++;
+	} else if (miss) {
+		pool->misses++;
+	}
+	irq_spinlock_unlock(&pool->lock, true);
+
+	/* The caller already holds a reservation */
+	if ((frame != 0) && (flags & FRAME_NO_RESERVE))
+		reserve_free(1);
+
+	return frame;
+}
+
+/** Allocate a zeroed frame.
+ *
+ * Take a frame from the pool of the current CPU or allocate and clear
+ * a new one if the pool is empty.
+ *
+ * @param flags FRAME_NONE or FRAME_NO_RESERVE.
+ *
+ * @return Physical address of the zeroed frame.
+ *
+ */
+uintptr_t zero_pool_frame_alloc(frame_flags_t flags)
+{
+	uintptr_t frame = zero_pool_take(flags, true);
+	if (frame != 0)
+		return frame;
+
+	uintptr_t kpage = km_temporary_page_get(&frame, flags);
+	memsetb((void *) kpage, PAGE_SIZE, 0);
+	km_temporary_page_put(kpage);
+
+	return frame;
+}
+
+/** Get a zeroed frame only if one is readily available.
+ *
+ * Unlike zero_pool_frame_alloc(), this never clears a frame on demand
+ * and is meant for speculative users such as page fault-around.
+ *
+ * @param flags FRAME_NONE or FRAME_NO_RESERVE.
+ *
+ * @return Physical address of the zeroed frame or 0 if the pool of the
+ *         current CPU is empty.
+ *
+ */
+uintptr_t zero_pool_frame_get(frame_flags_t flags)
+{
+	return zero_pool_take(flags, false);
+}
+
+/** Refill the pool of pre-zeroed frames of one CPU
+ *
+ * The thread is wired to the CPU and clears frames only while
+ * the CPU has no other ready threads.
+ *
+ * @param arg Generic thread argument (unused).
+ *
+ */
+void kzpool(void *arg)
+{
+	thread_detach(THREAD);
+
+	assert(zero_pools != NULL);
+	zero_pool_t *pool = &zero_pools[CPU->id];
+
+	while (true) {
+		while (atomic_load(&CPU->nrdy) == 0) {
+			irq_spinlock_lock(&pool->lock, true);
+			bool full = (pool->count == ZERO_POOL_SIZE);
+			irq_spinlock_unlock(&pool->lock, true);
+
+			if (full)
+				break;
+
+			if (!reserve_try_alloc(1))
+				break;
+
+			uintptr_t frame;
+			uintptr_t kpage = km_temporary_page_get(&frame,
+			    FRAME_NO_RESERVE);
+			zero_pool_clear(kpage);
+			km_temporary_page_put(kpage);
+
+			/* Only this thread adds frames to the pool */
+			irq_spinlock_lock(&pool->lock, true);
+			assert(pool->count < ZERO_POOL_SIZE);
+			pool->frames[pool->count++] = frame;
+			irq_spinlock_unlock(&pool->lock, true);
+		}
+
+		thread_usleep(ZERO_POOL_PERIOD);
+	}
+}
+
+/** @}
+ */
@@ -35,11 +35,14 @@
  * @brief Scheduler and load balancing.
  *
  * This file contains the scheduler and kcpulb kernel thread which
- * performs load-balancing of per-CPU run queues.
+ * performs load-balancing of per-CPU run queues. Idle CPUs steal work
+ * from the busiest CPU on their own, kcpulb serves only as a periodic
+ * fallback.
  */
 
 #include <assert.h>
 #include <atomic.h>
+#include <bitops.h>
 #include <proc/scheduler.h>
 #include <proc/thread.h>
 #include <proc/task.h>
@@ -67,6 +70,8 @@
 
 static void scheduler_separated_stack(void);
 
+static_assert(RQ_COUNT <= 32, "rq_map is a 32-bit bitmap");
+
 atomic_size_t nrdy;  /**< Number of ready threads in the system. */
 
 /** Carry out actions before new task runs. */
@@ -172,6 +177,158 @@ void scheduler_init(void)
 {
 }
 
+#ifdef CONFIG_SMP
+/** Steal a ready thread from a run queue of another CPU
+ *
+ * The run queue is searched from the back and the first thread which
+ * can be migrated is removed from it.
+ *
+ * Interrupts must be disabled.
+ *
+ * @param cpu CPU to steal from.
+ * @param i   Index of the run queue to search.
+ *
+ * @return Stolen thread with its lock held or NULL if there
+ *         was no thread suitable for migration.
+ *
+ */
+static thread_t *steal_thread(cpu_t *cpu, int i)
+{
+	assert(interrupts_disabled());
+
+	irq_spinlock_lock(&(cpu->rq[i].lock), false);
+	if (cpu->rq[i].n == 0) {
+		irq_spinlock_unlock(&(cpu->rq[i].lock), false);
+		return NULL;
+	}
+
+	link_t *link = list_last(&cpu->rq[i].rq);
+	while (link != NULL) {
+		thread_t *thread = list_get_instance(link, thread_t, rq_link);
+
+		/*
+		 * Do not steal CPU-wired threads, threads
+		 * already stolen, threads for which migration
+		 * was temporarily disabled or threads whose
+		 * FPU context is still in the CPU.
+		 */
+		irq_spinlock_lock(&thread->lock, false);
+
+		if ((!thread->wired) && (!thread->stolen) &&
+		    (!thread->nomigrate) &&
+		    (!thread->fpu_context_engaged)) {
+			irq_spinlock_unlock(&thread->lock, false);
+
+			/*
+			 * Remove thread from ready queue.
+			 */
+			atomic_dec(&cpu->nrdy);
+			atomic_dec(&nrdy);
+
+			if (--cpu->rq[i].n == 0)
+				atomic_fetch_and(&cpu->rq_map, ~RQ_MAP_BIT(i));
+			list_remove(&thread->rq_link);
+
+			irq_spinlock_pass(&(cpu->rq[i].lock), &thread->lock);
+			return thread;
+		}
+
+		irq_spinlock_unlock(&thread->lock, false);
+		link = list_prev(link, &cpu->rq[i].rq);
+	}
+
+	irq_spinlock_unlock(&(cpu->rq[i].lock), false);
+	return NULL;
+}
+
+/** Steal work for an idle CPU
+ *
+ * Find the CPU with the most ready threads and steal the highest
+ * priority thread which can be migrated from it. This lets an idle
+ * CPU pick up work immediately instead of waiting for kcpulb.
+ *
+ * Interrupts must be disabled.
+ *
+ * @param rq Place to store the index of the run queue the thread
+ *           was stolen from.
+ *
+ * @return Stolen thread with its lock held or NULL.
+ *
+ */
+static thread_t *steal_idle(int *rq)
+{
+	cpu_t *victim = NULL;
+	size_t victim_nrdy = 0;
+
+	for (size_t acpu = 1; acpu < config.cpu_active; acpu++) {
+		cpu_t *cpu = &cpus[(CPU->id + acpu) % config.cpu_active];
+		size_t n = atomic_load(&cpu->nrdy);
+
+		if (n > victim_nrdy) {
+			victim = cpu;
+			victim_nrdy = n;
+		}
+	}
+
+	if (victim == NULL)
+		return NULL;
+
+	unsigned int map = atomic_load(&victim->rq_map);
+	while (map != 0) {
+		int i = fnzb32_lsb(map);
+		map &= ~RQ_MAP_BIT(i);
+
+		thread_t *thread = steal_thread(victim, i);
+		if (thread != NULL) {
+			atomic_inc(&CPU->steals);
+			*rq = i;
+			return thread;
+		}
+	}
+
+	return NULL;
+}
+#endif /* CONFIG_SMP */
+
+/** Choose a CPU for a thread which is being readied
+ *
+ * The CPU on which the thread ran last is preferred in order to keep
+ * its caches warm, unless it already has ready threads queued while
+ * some other CPU has fewer. Threads which have not run yet are placed
+ * on the least loaded CPU.
+ *
+ * @param preferred CPU on which the thread ran last or NULL.
+ *
+ * @return CPU to whose run queue the thread should be appended.
+ *
+ */
+cpu_t *scheduler_select_cpu(cpu_t *preferred)
+{
+#ifdef CONFIG_SMP
+	if ((preferred != NULL) && (atomic_load(&preferred->nrdy) == 0))
+		return preferred;
+
+	cpu_t *best = (preferred != NULL) ? preferred : CPU;
+	size_t best_nrdy = atomic_load(&best->nrdy);
+
+	for (size_t acpu = 0; (acpu < config.cpu_active) && (best_nrdy > 0);
+	    acpu++) {
+		size_t n = atomic_load(&cpus[acpu].nrdy);
+		if (n < best_nrdy) {
+			best = &cpus[acpu];
+			best_nrdy = n;
+		}
+	}
+
+	if ((preferred != NULL) && (best != preferred))
+		atomic_inc(&best->migrations);
+
+	return best;
+#else
+	return (preferred != NULL) ? preferred : CPU;
+#endif
+}
+
 /** Get thread to be scheduled
  *
  * Get the optimal thread to be scheduled
@@ -183,11 +340,24 @@ void scheduler_init(void)
  */
 static thread_t *find_best_thread(void)
 {
+	thread_t *thread;
+	int i;
+
 	assert(CPU != NULL);
 
 loop:
 
 	if (atomic_load(&CPU->nrdy) == 0) {
+#ifdef CONFIG_SMP
+		/*
+		 * Before going to sleep, try to steal some work
+		 * from the busiest CPU.
+		 */
+		thread = steal_idle(&i);
+		if (thread != NULL)
+			goto found;
+#endif
+
 		/*
 		 * For there was nothing to run, the CPU goes to sleep
 		 * until a hardware interrupt or an IPI comes.
@@ -210,45 +380,116 @@ loop:
 
 	assert(!CPU->idle);
 
-	unsigned int i;
-	for (i = 0; i < RQ_COUNT; i++) {
+	/*
+	 * Pick the highest-priority non-empty queue. Its thread might
+	 * have been stolen in the meantime, in which case start over.
+	 */
+	unsigned int map = atomic_load(&CPU->rq_map);
+	if (map != 0) {
+		i = fnzb32_lsb(map);
+
 		irq_spinlock_lock(&(CPU->rq[i].lock), false);
-		if (CPU->rq[i].n == 0) {
+		if (CPU->rq[i].n > 0) {
+			atomic_dec(&CPU->nrdy);
+			atomic_dec(&nrdy);
+			if (--CPU->rq[i].n == 0)
+				atomic_fetch_and(&CPU->rq_map, ~RQ_MAP_BIT(i));
+
 			/*
-			 * If this queue is empty, try a lower-priority queue.
+			 * Take the first thread from the queue.
 			 */
-			irq_spinlock_unlock(&(CPU->rq[i].lock), false);
-			continue;
+			thread = list_get_instance(
+			    list_first(&CPU->rq[i].rq), thread_t, rq_link);
+			list_remove(&thread->rq_link);
+
+			irq_spinlock_pass(&(CPU->rq[i].lock), &thread->lock);
+			goto found;
 		}
 
-		atomic_dec(&CPU->nrdy);
-		atomic_dec(&nrdy);
-		CPU->rq[i].n--;
+		irq_spinlock_unlock(&(CPU->rq[i].lock), false);
+	}
 
-		/*
-		 * Take the first thread from the queue.
-		 */
-		thread_t *thread = list_get_instance(
-		    list_first(&CPU->rq[i].rq), thread_t, rq_link);
-		list_remove(&thread->rq_link);
+	goto loop;
 
-		irq_spinlock_pass(&(CPU->rq[i].lock), &thread->lock);
+found:
+	thread->cpu = CPU;
+	thread->ticks = us2ticks((i + 1) * 10000);
+	thread->priority = i;  /* Correct rq index */
 
-		thread->cpu = CPU;
-		thread->ticks = us2ticks((i + 1) * 10000);
-		thread->priority = i;  /* Correct rq index */
+	/*
+	 * Clear the stolen flag so that it can be migrated
+	 * when load balancing needs emerge.
+	 */
+	thread->stolen = false;
+	irq_spinlock_unlock(&thread->lock, false);
 
-		/*
-		 * Clear the stolen flag so that it can be migrated
-		 * when load balancing needs emerge.
-		 */
-		thread->stolen = false;
-		irq_spinlock_unlock(&thread->lock, false);
+	return thread;
+}
 
-		return thread;
+/** Take the thread the processor was handed off to
+ *
+ * The handoff candidate recorded by thread_handoff() is forgotten in any
+ * case. It is taken out of its run queue only if the previous thread
+ * blocked waiting for IPC, see thread_handoff_arm(), and the candidate
+ * is still queued on this CPU. It then inherits the rest of the timeslice
+ * of the previous thread. If there is nothing left to inherit, the run
+ * queues are used so that a pair of threads handing the processor off to
+ * each other cannot starve them.
+ *
+ * @param ticks Rest of the timeslice of the previous thread or zero if
+ *              the processor is not to be handed off.
+ *
+ * @return Thread to be scheduled or NULL if the run queues are to be used.
+ *
+ */
+static thread_t *take_handoff(uint64_t ticks)
+{
+	thread_t *candidate = CPU->handoff;
+	int i = CPU->handoff_rq;
+
+	CPU->handoff = NULL;
+	CPU->handoff_waker = NULL;
+	CPU->handoff_armed = false;
+
+	if (candidate == NULL || ticks == 0)
+		return NULL;
+
+	/*
+	 * The candidate may have been stolen, run or even destroyed in the
+	 * meantime, so do not touch it unless it is found in the run queue.
+	 */
+	thread_t *thread = NULL;
+
+	irq_spinlock_lock(&(CPU->rq[i].lock), false);
+	list_foreach(CPU->rq[i].rq, rq_link, thread_t, t) {
+		if (t == candidate) {
+			thread = t;
+			break;
+		}
 	}
 
-	goto loop;
+	if (thread == NULL) {
+		irq_spinlock_unlock(&(CPU->rq[i].lock), false);
+		return NULL;
+	}
+
+	list_remove(&thread->rq_link);
+	atomic_dec(&CPU->nrdy);
+	atomic_dec(&nrdy);
+	if (--CPU->rq[i].n == 0)
+		atomic_fetch_and(&CPU->rq_map, ~RQ_MAP_BIT(i));
+
+	irq_spinlock_pass(&(CPU->rq[i].lock), &thread->lock);
+
+	thread->cpu = CPU;
+	thread->ticks = ticks;
+	thread->priority = i;
+	thread->stolen = false;
+
+	irq_spinlock_unlock(&thread->lock, false);
+
+	atomic_inc(&CPU->handoffs);
+	return thread;
 }
 
 /** Prevent rq starvation
@@ -266,18 +507,27 @@ static void relink_rq(int start)
 {
 	list_t list;
 
+	/* Avoid taking the lock in the common case */
+	if (CPU->needs_relink <= NEEDS_RELINK_MAX)
+		return;
+
 	list_initialize(&list);
 	irq_spinlock_lock(&CPU->lock, false);
 
 	if (CPU->needs_relink > NEEDS_RELINK_MAX) {
 		int i;
 		for (i = start; i < RQ_COUNT - 1; i++) {
+			/* Skip if there is nothing to move */
+			if ((atomic_load(&CPU->rq_map) & RQ_MAP_BIT(i + 1)) == 0)
+				continue;
+
 			/* Remember and empty rq[i + 1] */
 
 			irq_spinlock_lock(&CPU->rq[i + 1].lock, false);
 			list_concat(&list, &CPU->rq[i + 1].rq);
 			size_t n = CPU->rq[i + 1].n;
 			CPU->rq[i + 1].n = 0;
+			atomic_fetch_and(&CPU->rq_map, ~RQ_MAP_BIT(i + 1));
 			irq_spinlock_unlock(&CPU->rq[i + 1].lock, false);
 
 			/* Append rq[i + 1] to rq[i] */
@@ -285,6 +535,8 @@ static void relink_rq(int start)
 			irq_spinlock_lock(&CPU->rq[i].lock, false);
 			list_concat(&CPU->rq[i].rq, &list);
 			CPU->rq[i].n += n;
+			if (CPU->rq[i].n > 0)
+				atomic_fetch_or(&CPU->rq_map, RQ_MAP_BIT(i));
 			irq_spinlock_unlock(&CPU->rq[i].lock, false);
 		}
 
@@ -401,10 +653,17 @@ void scheduler_separated_stack(void)
 	if (old_as)
 		as_hold(old_as);
 
+	/* Timeslice the thread can pass on if it blocks waiting for IPC. */
+	uint64_t donated = 0;
+
 	if (THREAD) {
 		/* Must be run after the switch to scheduler stack */
 		after_thread_ran();
 
+		if (THREAD->state == Sleeping && CPU->handoff_armed &&
+		    CPU->handoff_waker == THREAD)
+			donated = THREAD->ticks;
+
 		switch (THREAD->state) {
 		case Running:
 			irq_spinlock_unlock(&THREAD->lock, false);
@@ -468,7 +727,9 @@ void scheduler_separated_stack(void)
 		THREAD = NULL;
 	}
 
-	THREAD = find_best_thread();
+	THREAD = take_handoff(donated);
+	if (THREAD == NULL)
+		THREAD = find_best_thread();
 
 	irq_spinlock_lock(&THREAD->lock, false);
 	int priority = THREAD->priority;
@@ -600,89 +861,43 @@ not_satisfied:
 			if (atomic_load(&cpu->nrdy) <= average)
 				continue;
 
-			irq_spinlock_lock(&(cpu->rq[rq].lock), true);
-			if (cpu->rq[rq].n == 0) {
-				irq_spinlock_unlock(&(cpu->rq[rq].lock), true);
+			ipl_t ipl = interrupts_disable();
+			thread_t *thread = steal_thread(cpu, rq);
+			if (thread == NULL) {
+				interrupts_restore(ipl);
 				continue;
 			}
 
-			thread_t *thread = NULL;
-
-			/* Search rq from the back */
-			link_t *link = list_last(&cpu->rq[rq].rq);
-
-			while (link != NULL) {
-				thread = (thread_t *) list_get_instance(link,
-				    thread_t, rq_link);
-
-				/*
-				 * Do not steal CPU-wired threads, threads
-				 * already stolen, threads for which migration
-				 * was temporarily disabled or threads whose
-				 * FPU context is still in the CPU.
-				 */
-				irq_spinlock_lock(&thread->lock, false);
-
-				if ((!thread->wired) && (!thread->stolen) &&
-				    (!thread->nomigrate) &&
-				    (!thread->fpu_context_engaged)) {
-					/*
-					 * Remove thread from ready queue.
-					 */
-					irq_spinlock_unlock(&thread->lock,
-					    false);
-
-					atomic_dec(&cpu->nrdy);
-					atomic_dec(&nrdy);
-
-					cpu->rq[rq].n--;
-					list_remove(&thread->rq_link);
-
-					break;
-				}
-
-				irq_spinlock_unlock(&thread->lock, false);
-
-				link = list_prev(link, &cpu->rq[rq].rq);
-				thread = NULL;
-			}
-
-			if (thread) {
-				/*
-				 * Ready thread on local CPU
-				 */
-
-				irq_spinlock_pass(&(cpu->rq[rq].lock),
-				    &thread->lock);
+			/*
+			 * Ready thread on local CPU
+			 */
 
 #ifdef KCPULB_VERBOSE
-				log(LF_OTHER, LVL_DEBUG,
-				    "kcpulb%u: TID %" PRIu64 " -> cpu%u, "
-				    "nrdy=%ld, avg=%ld", CPU->id, thread->tid,
-				    CPU->id, atomic_load(&CPU->nrdy),
-				    atomic_load(&nrdy) / config.cpu_active);
+			log(LF_OTHER, LVL_DEBUG,
+			    "kcpulb%u: TID %" PRIu64 " -> cpu%u, "
+			    "nrdy=%ld, avg=%ld", CPU->id, thread->tid,
+			    CPU->id, atomic_load(&CPU->nrdy),
+			    atomic_load(&nrdy) / config.cpu_active);
 #endif
 
-				thread->stolen = true;
-				thread->state = Entering;
-
-				irq_spinlock_unlock(&thread->lock, true);
-				thread_ready(thread);
+			thread->stolen = true;
+			thread->state = Entering;
 
-				if (--count == 0)
-					goto satisfied;
+			irq_spinlock_unlock(&thread->lock, false);
+			interrupts_restore(ipl);
 
-				/*
-				 * We are not satisfied yet, focus on another
-				 * CPU next time.
-				 *
-				 */
-				acpu_bias++;
+			atomic_inc(&CPU->steals);
+			thread_ready(thread);
 
-				continue;
-			} else
-				irq_spinlock_unlock(&(cpu->rq[rq].lock), true);
+			if (--count == 0)
+				goto satisfied;
 
+			/*
+			 * We are not satisfied yet, focus on another
+			 * CPU next time.
+			 *
+			 */
+			acpu_bias++;
 		}
 	}
 
@@ -272,14 +272,15 @@ static void before_thread_is_ready(thread_t *thread)
 	assert(irq_spinlock_locked(&thread->lock));
 }
 
-/** Make thread ready
- *
- * Switch thread to the ready state.
+/** Append thread to a run queue
  *
  * @param thread Thread to make ready.
+ * @param rq     Place to store the index of the run queue.
+ *
+ * @return CPU whose run queue the thread was appended to.
  *
  */
-void thread_ready(thread_t *thread)
+static cpu_t *thread_enqueue(thread_t *thread, int *rq)
 {
 	irq_spinlock_lock(&thread->lock, true);
 
@@ -298,12 +299,12 @@ void thread_ready(thread_t *thread)
 	} else if (thread->stolen) {
 		/* Ready to the stealing CPU */
 		cpu = CPU;
-	} else if (thread->cpu) {
-		/* Prefer the CPU on which the thread ran last */
-		assert(thread->cpu != NULL);
-		cpu = thread->cpu;
 	} else {
-		cpu = CPU;
+		/*
+		 * Prefer the CPU on which the thread ran last
+		 * unless it is considerably busier than others.
+		 */
+		cpu = scheduler_select_cpu(thread->cpu);
 	}
 
 	thread->state = Ready;
@@ -316,11 +317,99 @@ void thread_ready(thread_t *thread)
 	 */
 
 	list_append(&thread->rq_link, &cpu->rq[i].rq);
-	cpu->rq[i].n++;
+	if (cpu->rq[i].n++ == 0)
+		atomic_fetch_or(&cpu->rq_map, RQ_MAP_BIT(i));
 	irq_spinlock_unlock(&(cpu->rq[i].lock), true);
 
 	atomic_inc(&nrdy);
 	atomic_inc(&cpu->nrdy);
+
+	*rq = i;
+	return cpu;
+}
+
+/** Make thread ready
+ *
+ * Switch thread to the ready state.
+ *
+ * @param thread Thread to make ready.
+ *
+ */
+void thread_ready(thread_t *thread)
+{
+	int rq;
+
+	(void) thread_enqueue(thread, &rq);
+}
+
+/** Make thread ready and offer it the current processor
+ *
+ * The thread is readied normally, so that it remains visible to other
+ * CPUs and can be stolen. If it was queued on this CPU, it is remembered
+ * as a handoff candidate. Should the current thread then block waiting
+ * for IPC, see thread_handoff_arm(), the scheduler takes the candidate
+ * out of the run queue and switches to it directly, passing it the rest
+ * of the current thread's timeslice. The candidate is forgotten on the
+ * next scheduler invocation or clock tick on this CPU.
+ *
+ * The candidate is only a hint. It is looked up in the run queue before
+ * being used, so it need not be valid any longer.
+ *
+ * Interrupts must be disabled.
+ *
+ * @param thread Thread to hand the processor off to.
+ *
+ */
+void thread_handoff(thread_t *thread)
+{
+	assert(interrupts_disabled());
+
+	int rq;
+	cpu_t *cpu = thread_enqueue(thread, &rq);
+
+	if (THREAD && cpu == CPU) {
+		CPU->handoff = thread;
+		CPU->handoff_rq = rq;
+		CPU->handoff_waker = THREAD;
+		CPU->handoff_armed = false;
+	}
+}
+
+/** Let the next block of the current thread hand the processor off
+ *
+ * Called right before the current thread blocks waiting for IPC. If
+ * it woke up a handoff candidate on this CPU, see thread_handoff(), the
+ * scheduler switches to the candidate instead of searching the run
+ * queues.
+ *
+ */
+void thread_handoff_arm(void)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if (CPU->handoff != NULL && CPU->handoff_waker == THREAD)
+		CPU->handoff_armed = true;
+
+	interrupts_restore(ipl);
+}
+
+/** Forget the handoff candidate of the current thread
+ *
+ * Called once the current thread is done waiting for IPC, whether
+ * it actually blocked or not.
+ *
+ */
+void thread_handoff_disarm(void)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if (CPU->handoff_waker == THREAD) {
+		CPU->handoff = NULL;
+		CPU->handoff_waker = NULL;
+		CPU->handoff_armed = false;
+	}
+
+	interrupts_restore(ipl);
 }
 
 /** Create new thread
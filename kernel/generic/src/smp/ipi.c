@@ -39,6 +39,7 @@
 
 #include <smp/ipi.h>
 #include <config.h>
+#include <cpu.h>
 
 /** Broadcast IPI message
  *
@@ -59,6 +60,18 @@ void ipi_broadcast(int ipi)
 		ipi_broadcast_arch(ipi);
 }
 
+/** Send IPI message to one CPU
+ *
+ * @param cpu Destination CPU. It must be different from the current CPU.
+ * @param ipi Message to send.
+ *
+ */
+void ipi_unicast(cpu_t *cpu, int ipi)
+{
+	if ((config.cpu_count > 1) && (cpu != CPU))
+		ipi_unicast_arch(cpu, ipi);
+}
+
 #endif /* CONFIG_SMP */
 
 /** @}
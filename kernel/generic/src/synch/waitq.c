@@ -495,7 +495,9 @@ static void waitq_complete_wakeup(waitq_t *wq)
  * @param wq   Pointer to wait queue.
  * @param mode If mode is WAKEUP_FIRST, then the longest waiting
  *             thread, if any, is woken up. If mode is WAKEUP_ALL, then
- *             all waiting threads, if any, are woken up. If there are
+ *             all waiting threads, if any, are woken up. WAKEUP_HANDOFF
+ *             wakes up the longest waiting thread like WAKEUP_FIRST and
+ *             makes it a handoff candidate, see thread_handoff(). If there are
  *             no waiting threads to be woken up, the missed wakeup is
  *             recorded in the wait queue.
  *
@@ -508,7 +510,7 @@ void _waitq_wakeup_unsafe(waitq_t *wq, wakeup_mode_t mode)
 	assert(irq_spinlock_locked(&wq->lock));
 
 	if (wq->ignore_wakeups > 0) {
-		if (mode == WAKEUP_FIRST) {
+		if (mode != WAKEUP_ALL) {
 			wq->ignore_wakeups--;
 			return;
 		}
@@ -555,7 +557,10 @@ loop:
 	thread->sleep_queue = NULL;
 	irq_spinlock_unlock(&thread->lock, false);
 
-	thread_ready(thread);
+	if (mode == WAKEUP_HANDOFF)
+		thread_handoff(thread);
+	else
+		thread_ready(thread);
 
 	if (mode == WAKEUP_ALL)
 		goto loop;
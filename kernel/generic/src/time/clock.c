@@ -196,6 +196,15 @@ void clock(void)
 	 *
 	 */
 
+	/*
+	 * A thread which keeps running after waking up a handoff candidate
+	 * is not going to block for it any more. The candidate waits in the
+	 * run queue like any other ready thread.
+	 */
+	CPU->handoff = NULL;
+	CPU->handoff_waker = NULL;
+	CPU->handoff_armed = false;
+
 	if (THREAD) {
 		uint64_t ticks;
 
@@ -141,7 +141,7 @@ void udebug_stoppable_begin(void)
 		TASK->udebug.begin_call = NULL;
 
 		ipc_set_retval(&db_call->data, 0);
-		ipc_answer(&TASK->answerbox, db_call);
+		ipc_answer(&TASK->answerbox, db_call, false);
 	} else if (TASK->udebug.dt_state == UDEBUG_TS_ACTIVE) {
 		/*
 		 * Active debugging session
@@ -163,7 +163,7 @@ void udebug_stoppable_begin(void)
 			ipc_set_arg1(&go_call->data, UDEBUG_EVENT_STOP);
 
 			THREAD->udebug.cur_event = UDEBUG_EVENT_STOP;
-			ipc_answer(&TASK->answerbox, go_call);
+			ipc_answer(&TASK->answerbox, go_call, false);
 		}
 	}
 
@@ -263,7 +263,7 @@ void udebug_syscall_event(sysarg_t a1, sysarg_t a2, sysarg_t a3,
 	THREAD->udebug.go = false;
 	THREAD->udebug.cur_event = etype;
 
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, false);
 
 	mutex_unlock(&THREAD->udebug.lock);
 	mutex_unlock(&TASK->udebug.lock);
@@ -326,7 +326,7 @@ void udebug_thread_b_event_attach(struct thread *thread, struct task *task)
 	THREAD->udebug.go = false;
 	THREAD->udebug.cur_event = UDEBUG_EVENT_THREAD_B;
 
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, false);
 
 	mutex_unlock(&THREAD->udebug.lock);
 	mutex_unlock(&TASK->udebug.lock);
@@ -372,7 +372,7 @@ void udebug_thread_e_event(void)
 	THREAD->udebug.cur_event = 0;   /* None */
 	THREAD->udebug.go = false;      /* Set to initial value */
 
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, false);
 
 	mutex_unlock(&THREAD->udebug.lock);
 	mutex_unlock(&TASK->udebug.lock);
@@ -431,7 +431,7 @@ errno_t udebug_task_cleanup(struct task *task)
 				ipc_set_arg1(&thread->udebug.go_call->data,
 				    UDEBUG_EVENT_FINISHED);
 
-				ipc_answer(&task->answerbox, thread->udebug.go_call);
+				ipc_answer(&task->answerbox, thread->udebug.go_call, false);
 				thread->udebug.go_call = NULL;
 			} else {
 				/*
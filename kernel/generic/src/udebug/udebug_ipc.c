@@ -76,7 +76,7 @@ static void udebug_receive_begin(call_t *call)
 	rc = udebug_begin(call, &active);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -86,7 +86,7 @@ static void udebug_receive_begin(call_t *call)
 	 */
 	if (active) {
 		ipc_set_retval(&call->data, EOK);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 	}
 }
 
@@ -102,7 +102,7 @@ static void udebug_receive_end(call_t *call)
 	rc = udebug_end();
 
 	ipc_set_retval(&call->data, rc);
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process a SET_EVMASK call.
@@ -119,7 +119,7 @@ static void udebug_receive_set_evmask(call_t *call)
 	rc = udebug_set_evmask(mask);
 
 	ipc_set_retval(&call->data, rc);
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process a GO call.
@@ -137,7 +137,7 @@ static void udebug_receive_go(call_t *call)
 	rc = udebug_go(t, call);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 }
@@ -156,7 +156,7 @@ static void udebug_receive_stop(call_t *call)
 
 	rc = udebug_stop(t, call);
 	ipc_set_retval(&call->data, rc);
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process a THREAD_READ call.
@@ -182,7 +182,7 @@ static void udebug_receive_thread_read(call_t *call)
 	rc = udebug_thread_read(&buffer, buf_size, &copied, &needed);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -201,7 +201,7 @@ static void udebug_receive_thread_read(call_t *call)
 	ipc_set_arg3(&call->data, needed);
 	call->buffer = buffer;
 
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process a NAME_READ call.
@@ -228,7 +228,7 @@ static void udebug_receive_name_read(call_t *call)
 	rc = udebug_name_read((char **) &data, &data_size);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -255,7 +255,7 @@ static void udebug_receive_name_read(call_t *call)
 	ipc_set_arg3(&call->data, data_size);
 	call->buffer = data;
 
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process an AREAS_READ call.
@@ -282,7 +282,7 @@ static void udebug_receive_areas_read(call_t *call)
 	data = as_get_area_info(AS, &data_size);
 	if (!data) {
 		ipc_set_retval(&call->data, ENOMEM);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -309,7 +309,7 @@ static void udebug_receive_areas_read(call_t *call)
 	ipc_set_arg3(&call->data, data_size);
 	call->buffer = (uint8_t *) data;
 
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process an ARGS_READ call.
@@ -329,7 +329,7 @@ static void udebug_receive_args_read(call_t *call)
 	rc = udebug_args_read(t, &buffer);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -349,7 +349,7 @@ static void udebug_receive_args_read(call_t *call)
 	ipc_set_arg2(&call->data, 6 * sizeof(sysarg_t));
 	call->buffer = buffer;
 
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Receive a REGS_READ call.
@@ -369,7 +369,7 @@ static void udebug_receive_regs_read(call_t *call)
 	rc = udebug_regs_read(t, &buffer);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -393,7 +393,7 @@ static void udebug_receive_regs_read(call_t *call)
 
 	call->buffer = buffer;
 
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Process an MEM_READ call.
@@ -416,7 +416,7 @@ static void udebug_receive_mem_read(call_t *call)
 	rc = udebug_mem_read(uspace_src, size, &buffer);
 	if (rc != EOK) {
 		ipc_set_retval(&call->data, rc);
-		ipc_answer(&TASK->kb.box, call);
+		ipc_answer(&TASK->kb.box, call, false);
 		return;
 	}
 
@@ -432,7 +432,7 @@ static void udebug_receive_mem_read(call_t *call)
 	ipc_set_arg2(&call->data, size);
 	call->buffer = buffer;
 
-	ipc_answer(&TASK->kb.box, call);
+	ipc_answer(&TASK->kb.box, call, false);
 }
 
 /** Handle a debug call received on the kernel answerbox.
@@ -456,7 +456,7 @@ void udebug_call_receive(call_t *call)
 		 */
 		if (TASK->udebug.debugger != call->sender) {
 			ipc_set_retval(&call->data, EINVAL);
-			ipc_answer(&TASK->kb.box, call);
+			ipc_answer(&TASK->kb.box, call, false);
 			return;
 		}
 	}
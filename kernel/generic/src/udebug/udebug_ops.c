@@ -335,7 +335,7 @@ errno_t udebug_stop(thread_t *thread, call_t *call)
 	_thread_op_end(thread);
 
 	mutex_lock(&TASK->udebug.lock);
-	ipc_answer(&TASK->answerbox, call);
+	ipc_answer(&TASK->answerbox, call, false);
 	mutex_unlock(&TASK->udebug.lock);
 
 	return EOK;
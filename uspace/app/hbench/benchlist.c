@@ -38,11 +38,19 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_crc32,
 	&benchmark_dir_read,
 	&benchmark_fibril_mutex,
 	&benchmark_file_read,
+	&benchmark_inet_checksum,
+	&benchmark_inet_checksum_copy,
 	&benchmark_malloc1,
+	&benchmark_malloc1_mt,
 	&benchmark_malloc2,
+	&benchmark_malloc2_mt,
+	&benchmark_memcpy,
+	&benchmark_memmove,
+	&benchmark_memset,
 	&benchmark_ns_ping,
 	&benchmark_ping_pong
 };
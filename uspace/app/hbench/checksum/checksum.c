@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/checksum.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/** Default size of the checksummed buffer (a full Ethernet frame) */
+#define DEFAULT_BUFFER_SIZE "1500"
+
+/** Sink for computed checksums, keeps the computation from being dropped */
+static volatile uint32_t checksum_sink;
+
+/** Allocate and fill the buffer to be checksummed.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run (for error reporting)
+ * @param rbuf Place to store pointer to the buffer
+ * @param rsize Place to store buffer size
+ * @return Whether the buffer was created
+ */
+static bool buffer_create(bench_env_t *env, bench_run_t *run, uint8_t **rbuf,
+    size_t *rsize)
+{
+	const char *size_str = bench_env_param_get(env, "buffer_size",
+	    DEFAULT_BUFFER_SIZE);
+	size_t size;
+	if ((str_size_t(size_str, NULL, 10, true, &size) != EOK) ||
+	    (size == 0)) {
+		return bench_run_fail(run, "invalid buffer size '%s'",
+		    size_str);
+	}
+
+	uint8_t *buf = malloc(size);
+	if (buf == NULL)
+		return bench_run_fail(run, "failed to allocate %zuB buffer", size);
+
+	for (size_t i = 0; i < size; i++)
+		buf[i] = i * 7;
+
+	*rbuf = buf;
+	*rsize = size;
+	return true;
+}
+
+static bool runner_crc32(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	uint8_t *buf;
+	size_t buffer_size;
+	if (!buffer_create(env, run, &buf, &buffer_size))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		checksum_sink = compute_crc32(buf, buffer_size);
+	bench_run_stop(run);
+
+	free(buf);
+	return true;
+}
+
+static bool runner_inet_checksum(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	uint8_t *buf;
+	size_t buffer_size;
+	if (!buffer_create(env, run, &buf, &buffer_size))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		checksum_sink = compute_inet_checksum(0xffff, buf, buffer_size);
+	bench_run_stop(run);
+
+	free(buf);
+	return true;
+}
+
+static bool runner_inet_checksum_copy(bench_env_t *env, bench_run_t *run,
+    uint64_t size)
+{
+	uint8_t *buf;
+	size_t buffer_size;
+	if (!buffer_create(env, run, &buf, &buffer_size))
+		return false;
+
+	uint8_t *dst = malloc(buffer_size);
+	if (dst == NULL) {
+		free(buf);
+		return bench_run_fail(run, "failed to allocate %zuB buffer",
+		    buffer_size);
+	}
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		checksum_sink = compute_inet_checksum_copy(0xffff, dst, buf,
+		    buffer_size);
+	}
+	bench_run_stop(run);
+
+	free(dst);
+	free(buf);
+	return true;
+}
+
+benchmark_t benchmark_crc32 = {
+	.name = "crc32",
+	.desc = "Compute CRC32 of a buffer (use 'buffer_size' param to alter the default).",
+	.entry = &runner_crc32,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_inet_checksum = {
+	.name = "inet_checksum",
+	.desc = "Compute Internet checksum of a buffer (use 'buffer_size' param to alter the default).",
+	.entry = &runner_inet_checksum,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_inet_checksum_copy = {
+	.name = "inet_checksum_copy",
+	.desc = "Copy a buffer and compute its Internet checksum (use 'buffer_size' param to alter the default).",
+	.entry = &runner_inet_checksum_copy,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
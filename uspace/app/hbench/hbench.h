@@ -97,8 +97,17 @@ typedef struct {
 	benchmark_helper_t teardown;
 } benchmark_t;
 
+/** Worker of a parallel benchmark.
+ *
+ * The argument is the number of iterations the worker shall execute.
+ * Returns false on failure.
+ */
+typedef bool (*bench_worker_t)(uint64_t);
+
 extern void bench_run_init(bench_run_t *, char *, size_t);
 extern bool bench_run_fail(bench_run_t *, const char *, ...);
+extern bool bench_run_parallel(bench_env_t *, bench_run_t *, uint64_t,
+    bench_worker_t);
 
 /*
  * We keep the following two functions inline to ensure that we start
@@ -131,11 +140,19 @@ extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_crc32;
 extern benchmark_t benchmark_dir_read;
 extern benchmark_t benchmark_fibril_mutex;
 extern benchmark_t benchmark_file_read;
+extern benchmark_t benchmark_inet_checksum;
+extern benchmark_t benchmark_inet_checksum_copy;
 extern benchmark_t benchmark_malloc1;
+extern benchmark_t benchmark_malloc1_mt;
 extern benchmark_t benchmark_malloc2;
+extern benchmark_t benchmark_malloc2_mt;
+extern benchmark_t benchmark_memcpy;
+extern benchmark_t benchmark_memmove;
+extern benchmark_t benchmark_memset;
 extern benchmark_t benchmark_ns_ping;
 extern benchmark_t benchmark_ping_pong;
 
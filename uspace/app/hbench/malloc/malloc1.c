@@ -52,6 +52,23 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
 	return true;
 }
 
+static bool worker(uint64_t size)
+{
+	for (uint64_t i = 0; i < size; i++) {
+		void *p = malloc(1);
+		if (p == NULL)
+			return false;
+		free(p);
+	}
+
+	return true;
+}
+
+static bool runner_mt(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return bench_run_parallel(env, run, size, worker);
+}
+
 benchmark_t benchmark_malloc1 = {
 	.name = "malloc1",
 	.desc = "User-space memory allocator benchmark, repeatedly allocate one block",
@@ -60,5 +77,13 @@ benchmark_t benchmark_malloc1 = {
 	.teardown = NULL
 };
 
+benchmark_t benchmark_malloc1_mt = {
+	.name = "malloc1_mt",
+	.desc = "Multi-threaded malloc1, repeatedly allocate one block in each worker",
+	.entry = &runner_mt,
+	.setup = NULL,
+	.teardown = NULL
+};
+
 /** @}
  */
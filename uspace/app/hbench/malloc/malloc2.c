@@ -67,6 +67,35 @@ static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
 	return true;
 }
 
+static bool worker(uint64_t niter)
+{
+	void **p = malloc(niter * sizeof(void *));
+	if (p == NULL)
+		return false;
+
+	for (uint64_t count = 0; count < niter; count++) {
+		p[count] = malloc(1);
+		if (p[count] == NULL) {
+			for (uint64_t j = 0; j < count; j++)
+				free(p[j]);
+			free(p);
+			return false;
+		}
+	}
+
+	for (uint64_t count = 0; count < niter; count++)
+		free(p[count]);
+
+	free(p);
+
+	return true;
+}
+
+static bool runner_mt(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return bench_run_parallel(env, run, niter, worker);
+}
+
 benchmark_t benchmark_malloc2 = {
 	.name = "malloc2",
 	.desc = "User-space memory allocator benchmark, allocate many small blocks",
@@ -75,5 +104,13 @@ benchmark_t benchmark_malloc2 = {
 	.teardown = NULL
 };
 
+benchmark_t benchmark_malloc2_mt = {
+	.name = "malloc2_mt",
+	.desc = "Multi-threaded malloc2, allocate many small blocks in each worker",
+	.entry = &runner_mt,
+	.setup = NULL,
+	.teardown = NULL
+};
+
 /** @}
  */
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <mem.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/** Default block size */
+#define DEFAULT_SIZE "4096"
+/** Default misalignment of the destination block */
+#define DEFAULT_OFFSET "0"
+
+/** Maximum misalignment of the destination block */
+#define MAX_OFFSET 64
+
+/** Benchmark buffers and their parameters */
+typedef struct {
+	uint8_t *src;
+	uint8_t *dst;
+	size_t size;
+	size_t offset;
+} mem_bufs_t;
+
+/** Allocate benchmark buffers.
+ *
+ * Block size is taken from the 'size' parameter. The 'offset' parameter
+ * shifts the destination block to measure copies between differently
+ * aligned buffers.
+ *
+ * @param env Benchmark environment
+ * @param run Benchmark run (for error reporting)
+ * @param bufs Buffers to initialize
+ * @return Whether the buffers were allocated
+ */
+static bool mem_bufs_init(bench_env_t *env, bench_run_t *run,
+    mem_bufs_t *bufs)
+{
+	const char *size_str = bench_env_param_get(env, "size", DEFAULT_SIZE);
+	const char *offset_str = bench_env_param_get(env, "offset",
+	    DEFAULT_OFFSET);
+
+	if (str_size_t(size_str, NULL, 10, true, &bufs->size) != EOK)
+		return bench_run_fail(run, "invalid size '%s'", size_str);
+
+	if ((str_size_t(offset_str, NULL, 10, true, &bufs->offset) != EOK) ||
+	    (bufs->offset >= MAX_OFFSET)) {
+		return bench_run_fail(run, "invalid offset '%s'", offset_str);
+	}
+
+	/* Room for moving the block by MAX_OFFSET bytes within one buffer */
+	bufs->src = malloc(bufs->size + MAX_OFFSET);
+	bufs->dst = malloc(bufs->size + MAX_OFFSET);
+	if (bufs->src == NULL || bufs->dst == NULL) {
+		free(bufs->src);
+		free(bufs->dst);
+		return bench_run_fail(run, "failed to allocate %zuB buffers",
+		    bufs->size);
+	}
+
+	memset(bufs->src, 0x5a, bufs->size + MAX_OFFSET);
+	memset(bufs->dst, 0, bufs->size + MAX_OFFSET);
+	return true;
+}
+
+static void mem_bufs_fini(mem_bufs_t *bufs)
+{
+	free(bufs->src);
+	free(bufs->dst);
+}
+
+static bool runner_memcpy(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	mem_bufs_t bufs;
+
+	if (!mem_bufs_init(env, run, &bufs))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		memcpy(bufs.dst + bufs.offset, bufs.src, bufs.size);
+	bench_run_stop(run);
+
+	mem_bufs_fini(&bufs);
+	return true;
+}
+
+static bool runner_memmove(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	mem_bufs_t bufs;
+	size_t shift;
+
+	if (!mem_bufs_init(env, run, &bufs))
+		return false;
+
+	/* Overlapping move, alternately forwards and backwards */
+	shift = bufs.offset != 0 ? bufs.offset : 1;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		if ((i & 1) == 0)
+			memmove(bufs.src + shift, bufs.src, bufs.size);
+		else
+			memmove(bufs.src, bufs.src + shift, bufs.size);
+	}
+	bench_run_stop(run);
+
+	mem_bufs_fini(&bufs);
+	return true;
+}
+
+static bool runner_memset(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	mem_bufs_t bufs;
+
+	if (!mem_bufs_init(env, run, &bufs))
+		return false;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++)
+		memset(bufs.dst + bufs.offset, (int) i, bufs.size);
+	bench_run_stop(run);
+
+	mem_bufs_fini(&bufs);
+	return true;
+}
+
+benchmark_t benchmark_memcpy = {
+	.name = "memcpy",
+	.desc = "Copy a memory block (use 'size' and 'offset' params to alter block size and destination alignment).",
+	.entry = &runner_memcpy,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memmove = {
+	.name = "memmove",
+	.desc = "Move an overlapping memory block back and forth (use 'size' and 'offset' params to alter block size and shift).",
+	.entry = &runner_memmove,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_memset = {
+	.name = "memset",
+	.desc = "Fill a memory block (use 'size' and 'offset' params to alter block size and alignment).",
+	.entry = &runner_memset,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -33,10 +33,25 @@
  * @file
  */
 
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
 #include "hbench.h"
 
+/** Default number of workers of parallel benchmarks. */
+#define DEFAULT_WORKER_COUNT "4"
+
+/** Single worker of a parallel benchmark run. */
+typedef struct {
+	bench_worker_t worker;
+	uint64_t niter;
+	bool ok;
+	fibril_semaphore_t *done;
+} bench_parallel_t;
+
 /** Initialize bench run structure.
  *
  * @param run Structure to intialize.
@@ -75,5 +90,86 @@ bool bench_run_fail(bench_run_t *run, const char *fmt, ...)
 	return false;
 }
 
+static errno_t bench_parallel_fibril(void *arg)
+{
+	bench_parallel_t *par = arg;
+
+	par->ok = par->worker(par->niter);
+	fibril_semaphore_up(par->done);
+
+	return EOK;
+}
+
+/** Execute a benchmark in multiple fibrils on multiple threads.
+ *
+ * The workload is split evenly among the workers. The number of
+ * workers is taken from the "workers" parameter of the environment.
+ *
+ * @param env Benchmark environment.
+ * @param run Current benchmark run.
+ * @param size Total number of iterations.
+ * @param worker Function executing a share of the iterations.
+ * @return Whether all workers succeeded.
+ */
+bool bench_run_parallel(bench_env_t *env, bench_run_t *run, uint64_t size,
+    bench_worker_t worker)
+{
+	const char *count_str = bench_env_param_get(env, "workers",
+	    DEFAULT_WORKER_COUNT);
+	size_t count;
+	if ((str_size_t(count_str, NULL, 10, true, &count) != EOK) ||
+	    (count == 0)) {
+		return bench_run_fail(run, "invalid number of workers '%s'",
+		    count_str);
+	}
+
+	bench_parallel_t *workers = calloc(count, sizeof(bench_parallel_t));
+	if (workers == NULL) {
+		return bench_run_fail(run, "failed to allocate %zu workers",
+		    count);
+	}
+
+	fibril_enable_multithreaded();
+
+	fibril_semaphore_t done;
+	fibril_semaphore_initialize(&done, 0);
+
+	size_t started = 0;
+
+	bench_run_start(run);
+	for (size_t i = 0; i < count; i++) {
+		workers[i].worker = worker;
+		workers[i].niter = size / count + ((i < size % count) ? 1 : 0);
+		workers[i].ok = false;
+		workers[i].done = &done;
+
+		fid_t fid = fibril_create(bench_parallel_fibril, &workers[i]);
+		if (fid == 0)
+			break;
+
+		fibril_add_ready(fid);
+		started++;
+	}
+
+	for (size_t i = 0; i < started; i++)
+		fibril_semaphore_down(&done);
+	bench_run_stop(run);
+
+	size_t failed = count - started;
+	for (size_t i = 0; i < started; i++) {
+		if (!workers[i].ok)
+			failed++;
+	}
+
+	free(workers);
+
+	if (failed > 0) {
+		return bench_run_fail(run, "%zu out of %zu workers failed",
+		    failed, count);
+	}
+
+	return true;
+}
+
 /** @}
  */
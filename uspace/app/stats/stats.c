@@ -54,6 +54,9 @@
 #define KERNEL_NAME  "kernel"
 #define INIT_PREFIX  "init:"
 
+/** Width of the per-CPU counter columns, header brackets included */
+#define CPU_COUNTER_WIDTH  12
+
 typedef enum {
 	LIST_TASKS,
 	LIST_THREADS,
@@ -172,7 +175,10 @@ static void list_cpus(void)
 		return;
 	}
 
-	printf("[id] [MHz     ] [busy cycles] [idle cycles]\n");
+	printf("[id] [MHz     ] [busy cycles] [idle cycles] [%-*s] [%-*s] "
+	    "[%-*s]\n", CPU_COUNTER_WIDTH - 2, "steals",
+	    CPU_COUNTER_WIDTH - 2, "migrations",
+	    CPU_COUNTER_WIDTH - 2, "handoffs");
 
 	for (size_t i = 0; i < count; i++) {
 		printf("%-4u ", cpus[i].id);
@@ -183,9 +189,13 @@ static void list_cpus(void)
 			order_suffix(cpus[i].busy_cycles, &bcycles, &bsuffix);
 			order_suffix(cpus[i].idle_cycles, &icycles, &isuffix);
 
-			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c\n",
+			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c "
+			    "%*" PRIu64 " %*" PRIu64 " %*" PRIu64 "\n",
 			    cpus[i].frequency_mhz, bcycles, bsuffix,
-			    icycles, isuffix);
+			    icycles, isuffix,
+			    CPU_COUNTER_WIDTH, cpus[i].steals,
+			    CPU_COUNTER_WIDTH, cpus[i].migrations,
+			    CPU_COUNTER_WIDTH, cpus[i].handoffs);
 		} else
 			printf("inactive\n");
 	}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <str_error.h>
+#include <ipc_test.h>
+#include "../tester.h"
+
+static const char out1[] = "Hello, ";
+static const char out2[] = "world!";
+
+#define OUT_SIZE  (sizeof(out1) - 1 + sizeof(out2) - 1)
+#define IN1_SIZE  10
+#define IN2_SIZE  16
+
+/** Send two request segments and check the reply in two reply segments.
+ *
+ * @param test       IPC test service
+ * @param forward    Have the service forward the request
+ * @param reply_size Number of bytes the service replies with
+ * @param rrc        Place to store the result of the request
+ * @return NULL on success or an error message
+ */
+static const char *xfer_check(ipc_test_t *test, bool forward,
+    size_t reply_size, errno_t *rrc)
+{
+	const char *gathered = "Hello, world!";
+	uint8_t in1[IN1_SIZE];
+	uint8_t in2[IN2_SIZE];
+	ipc_iovec_t iov[4];
+	size_t received;
+
+	memset(in1, 0, sizeof(in1));
+	memset(in2, 0, sizeof(in2));
+
+	iov[0].base = (void *) out1;
+	iov[0].size = sizeof(out1) - 1;
+	iov[1].base = (void *) out2;
+	iov[1].size = sizeof(out2) - 1;
+	iov[2].base = in1;
+	iov[2].size = sizeof(in1);
+	iov[3].base = in2;
+	iov[3].size = sizeof(in2);
+
+	*rrc = ipc_test_xfer(test, forward, iov, 2, 2, reply_size, &received);
+	if (*rrc != EOK)
+		return NULL;
+
+	if (received != reply_size)
+		return "Unexpected reply size.";
+
+	for (size_t i = 0; i < IN1_SIZE + IN2_SIZE; i++) {
+		uint8_t b = (i < IN1_SIZE) ? in1[i] : in2[i - IN1_SIZE];
+		uint8_t expected = (i < reply_size) ?
+		    (uint8_t) gathered[i % OUT_SIZE] : 0;
+
+		if (b != expected)
+			return "Reply data not scattered as expected.";
+	}
+
+	return NULL;
+}
+
+const char *test_xfer(void)
+{
+	ipc_test_t *test = NULL;
+	const char *err;
+	errno_t rc;
+
+	rc = ipc_test_create(&test);
+	if (rc != EOK)
+		return "Error contacting IPC test service.";
+
+	err = xfer_check(test, false, IN1_SIZE + IN2_SIZE, &rc);
+	if (err == NULL && rc != EOK)
+		err = "Request with data failed.";
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Reply filling all reply segments received.\n");
+
+	err = xfer_check(test, false, IN1_SIZE + 2, &rc);
+	if (err == NULL && rc != EOK)
+		err = "Request with data failed.";
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Reply filling part of the reply segments received.\n");
+
+	err = xfer_check(test, false, IN1_SIZE + IN2_SIZE + 1, &rc);
+	if (err == NULL && rc != ELIMIT) {
+		TPRINTF("Oversized reply: %s\n", str_error(rc));
+		err = "Oversized reply not refused with ELIMIT.";
+	}
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Oversized reply refused.\n");
+
+	err = xfer_check(test, true, IN1_SIZE + IN2_SIZE, &rc);
+	if (err == NULL && rc != EOK)
+		err = "Forwarded request with data failed.";
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Reply to a forwarded request received.\n");
+
+	err = xfer_check(test, true, IN1_SIZE + IN2_SIZE + 1, &rc);
+	if (err == NULL && rc != ELIMIT)
+		err = "Oversized reply to forwarded request not refused.";
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Oversized reply to a forwarded request refused.\n");
+
+out:
+	ipc_test_destroy(test);
+	return err;
+}
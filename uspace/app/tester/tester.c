@@ -69,6 +69,7 @@ test_t tests[] = {
 #include "vfs/vfs1.def"
 #include "ipc/sharein.def"
 #include "ipc/starve.def"
+#include "ipc/xfer.def"
 #include "loop/loop1.def"
 #include "mm/malloc1.def"
 #include "mm/malloc2.def"
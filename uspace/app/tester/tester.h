@@ -100,6 +100,7 @@ extern const char *test_vfs1(void);
 extern const char *test_ping_pong(void);
 extern const char *test_sharein(void);
 extern const char *test_starve_ipc(void);
+extern const char *test_xfer(void);
 extern const char *test_loop1(void);
 extern const char *test_malloc1(void);
 extern const char *test_malloc2(void);
@@ -260,6 +260,9 @@ static inline void print_cpu_info(data_t *data)
 			print_percent(data->cpus_perc[i].idle, 2);
 			fputs(", busy: ", stdout);
 			print_percent(data->cpus_perc[i].busy, 2);
+			printf(", steals: %" PRIu64 ", migrations: %" PRIu64
+			    ", handoffs: %" PRIu64, data->cpus[i].steals,
+			    data->cpus[i].migrations, data->cpus[i].handoffs);
 		} else
 			printf("cpu%u inactive", data->cpus[i].id);
 
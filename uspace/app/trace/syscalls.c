@@ -81,6 +81,7 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_IPC_POKE] = { "ipc_poke", 0, V_ERRNO },
 	[SYS_IPC_HANGUP] = { "ipc_hangup", 1, V_ERRNO },
 	[SYS_IPC_CONNECT_KBOX] = { "ipc_connect_kbox", 2, V_ERRNO },
+	[SYS_IPC_XFER_FETCH] = { "ipc_xfer_fetch", 3, V_ERRNO },
 
 	/* Event notification syscalls. */
 	[SYS_IPC_EVENT_SUBSCRIBE] = { "ipc_event_subscribe", 2, V_ERRNO },
@@ -235,6 +235,7 @@ static driver_t e1000_driver = {
 static errno_t e1000_on_activating(nic_t *);
 static errno_t e1000_on_stopping(nic_t *);
 static void e1000_send_frame(nic_t *, void *, size_t);
+static size_t e1000_send_frames(nic_t *, void *, const size_t *, size_t);
 
 /** PIO ranges used in the IRQ code. */
 irq_pio_range_t e1000_irq_pio_ranges[] = {
@@ -1167,12 +1168,17 @@ static uint32_t e1000_inc_tail(uint32_t tail, uint32_t descriptors_count)
 
 /** Receive frames
  *
- * @param nic NIC data
+ * @param nic    NIC data
+ * @param budget Maximum number of frames to receive
+ *
+ * @return Number of frames received
  *
  */
-static void e1000_receive_frames(nic_t *nic)
+static size_t e1000_receive_frames(nic_t *nic, size_t budget)
 {
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	nic_frame_list_t *frames = nic_alloc_frame_list();
+	size_t count = 0;
 
 	fibril_mutex_lock(&e1000->rx_lock);
 
@@ -1182,13 +1188,16 @@ static void e1000_receive_frames(nic_t *nic)
 	e1000_rx_descriptor_t *rx_descriptor = (e1000_rx_descriptor_t *)
 	    (e1000->rx_ring_virt + next_tail * sizeof(e1000_rx_descriptor_t));
 
-	while (rx_descriptor->status & 0x01) {
+	while (count < budget && (rx_descriptor->status & 0x01)) {
 		uint32_t frame_size = rx_descriptor->length - E1000_CRC_SIZE;
 
 		nic_frame_t *frame = nic_alloc_frame(nic, frame_size);
 		if (frame != NULL) {
 			memcpy(frame->data, e1000->rx_frame_virt[next_tail], frame_size);
-			nic_received_frame(nic, frame);
+			if (frames != NULL)
+				nic_frame_list_append(frames, frame);
+			else
+				nic_received_frame(nic, frame);
 		} else {
 			ddf_msg(LVL_ERROR, "Memory allocation failed. Frame dropped.");
 		}
@@ -1200,9 +1209,14 @@ static void e1000_receive_frames(nic_t *nic)
 
 		rx_descriptor = (e1000_rx_descriptor_t *)
 		    (e1000->rx_ring_virt + next_tail * sizeof(e1000_rx_descriptor_t));
+		count++;
 	}
 
 	fibril_mutex_unlock(&e1000->rx_lock);
+
+	/* Pass all frames received in this round up at once */
+	nic_received_frame_list(nic, frames);
+	return count;
 }
 
 /** Enable E1000 interupts
@@ -1237,7 +1251,7 @@ static void e1000_disable_interrupts(e1000_t *e1000)
 static void e1000_interrupt_handler_impl(nic_t *nic, uint32_t icr)
 {
 	if (icr & ICR_RXT0)
-		e1000_receive_frames(nic);
+		e1000_receive_frames(nic, SIZE_MAX);
 }
 
 /** Handle device interrupt
@@ -1253,10 +1267,45 @@ static void e1000_interrupt_handler(ipc_call_t *icall,
 	nic_t *nic = NIC_DATA_DEV(dev);
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
 
-	e1000_interrupt_handler_impl(nic, icr);
+	/*
+	 * Receive interrupts are the only ones enabled. Leave them
+	 * disabled if libnic has switched to polling the receive ring.
+	 */
+	if ((icr & ICR_RXT0) && !nic_rx_interrupt(nic))
+		return;
+
 	e1000_enable_interrupts(e1000);
 }
 
+/** Receive frames in the adaptive polling mode
+ *
+ * @param nic    NIC data
+ * @param budget Maximum number of frames to receive
+ *
+ * @return Number of frames received
+ *
+ */
+static size_t e1000_rx_poll(nic_t *nic, size_t budget)
+{
+	return e1000_receive_frames(nic, budget);
+}
+
+/** Enable or disable receive interrupts in the adaptive polling mode
+ *
+ * @param nic    NIC data
+ * @param enable True to enable receive interrupts
+ *
+ */
+static void e1000_rx_irq(nic_t *nic, bool enable)
+{
+	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+
+	if (enable)
+		E1000_REG_WRITE(e1000, E1000_IMS, ICR_RXT0);
+	else
+		E1000_REG_WRITE(e1000, E1000_IMC, ICR_RXT0);
+}
+
 /** Register interrupt handler for the card in the system
  *
  * Note: The global irq_reg_mutex is locked because of work with global
@@ -1898,12 +1947,14 @@ static e1000_t *e1000_create_dev_data(ddf_dev_t *dev)
 
 	nic_set_specific(nic, e1000);
 	nic_set_send_frame_handler(nic, e1000_send_frame);
+	nic_set_send_frames_handler(nic, e1000_send_frames);
 	nic_set_state_change_handlers(nic, e1000_on_activating,
 	    e1000_on_down, e1000_on_stopping);
 	nic_set_filtering_change_handlers(nic,
 	    e1000_on_unicast_mode_change, e1000_on_multicast_mode_change,
 	    e1000_on_broadcast_mode_change, NULL, e1000_on_vlan_mask_change);
 	nic_set_poll_handlers(nic, e1000_poll_mode_change, e1000_poll);
+	nic_set_rx_poll_handlers(nic, e1000_rx_poll, e1000_rx_irq);
 
 	fibril_mutex_initialize(&e1000->ctrl_lock);
 	fibril_mutex_initialize(&e1000->rx_lock);
@@ -2327,24 +2378,21 @@ static void e1000_eeprom_get_address(e1000_t *e1000,
 	*mac4_dest = e1000_eeprom_read(e1000, 2);
 }
 
-/** Send frame
+/** Fill transmit descriptor
  *
- * @param nic    NIC driver data structure
+ * The caller must hold the TX lock.
+ *
+ * @param e1000  E1000 data structure
+ * @param tdt    Index of the descriptor
  * @param data   Frame data
  * @param size   Frame size in bytes
  *
- * @return EOK if succeed
- * @return Error code in the case of error
+ * @return True if the descriptor was free and has been filled
  *
  */
-static void e1000_send_frame(nic_t *nic, void *data, size_t size)
+static bool e1000_tx_descriptor_fill(e1000_t *e1000, uint32_t tdt,
+    void *data, size_t size)
 {
-	assert(nic);
-
-	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
-	fibril_mutex_lock(&e1000->tx_lock);
-
-	uint32_t tdt = E1000_REG_READ(e1000, E1000_TDT);
 	e1000_tx_descriptor_t *tx_descriptor_addr = (e1000_tx_descriptor_t *)
 	    (e1000->tx_ring_virt + tdt * sizeof(e1000_tx_descriptor_t));
 
@@ -2358,11 +2406,8 @@ static void e1000_send_frame(nic_t *nic, void *data, size_t size)
 	if (tx_descriptor_addr->status & TXDESCRIPTOR_STATUS_DD)
 		descriptor_available = true;
 
-	if (!descriptor_available) {
-		/* Frame lost */
-		fibril_mutex_unlock(&e1000->tx_lock);
-		return;
-	}
+	if (!descriptor_available)
+		return false;
 
 	memcpy(e1000->tx_frame_virt[tdt], data, size);
 
@@ -2387,6 +2432,34 @@ static void e1000_send_frame(nic_t *nic, void *data, size_t size)
 
 	tx_descriptor_addr->checksum_start_field = 0;
 
+	return true;
+}
+
+/** Send frame
+ *
+ * @param nic    NIC driver data structure
+ * @param data   Frame data
+ * @param size   Frame size in bytes
+ *
+ * @return EOK if succeed
+ * @return Error code in the case of error
+ *
+ */
+static void e1000_send_frame(nic_t *nic, void *data, size_t size)
+{
+	assert(nic);
+
+	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	fibril_mutex_lock(&e1000->tx_lock);
+
+	uint32_t tdt = E1000_REG_READ(e1000, E1000_TDT);
+
+	if (!e1000_tx_descriptor_fill(e1000, tdt, data, size)) {
+		/* Frame lost */
+		fibril_mutex_unlock(&e1000->tx_lock);
+		return;
+	}
+
 	tdt++;
 	if (tdt == E1000_TX_FRAME_COUNT)
 		tdt = 0;
@@ -2396,6 +2469,52 @@ static void e1000_send_frame(nic_t *nic, void *data, size_t size)
 	fibril_mutex_unlock(&e1000->tx_lock);
 }
 
+/** Send batch of frames
+ *
+ * All descriptors are filled first and the tail register is
+ * written only once for the whole batch.
+ *
+ * @param nic    NIC driver data structure
+ * @param data   Frame data packed back to back
+ * @param sizes  Frame sizes in bytes
+ * @param count  Number of frames
+ *
+ * @return Number of frames sent
+ *
+ */
+static size_t e1000_send_frames(nic_t *nic, void *data, const size_t *sizes,
+    size_t count)
+{
+	assert(nic);
+
+	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	uint8_t *frame = data;
+	size_t i;
+	fibril_mutex_lock(&e1000->tx_lock);
+
+	uint32_t tdt = E1000_REG_READ(e1000, E1000_TDT);
+	uint32_t old_tdt = tdt;
+
+	for (i = 0; i < count; i++) {
+		if (!e1000_tx_descriptor_fill(e1000, tdt, frame, sizes[i])) {
+			/* Remaining frames are left to the caller */
+			break;
+		}
+
+		frame += sizes[i];
+
+		tdt++;
+		if (tdt == E1000_TX_FRAME_COUNT)
+			tdt = 0;
+	}
+
+	if (tdt != old_tdt)
+		E1000_REG_WRITE(e1000, E1000_TDT, tdt);
+
+	fibril_mutex_unlock(&e1000->tx_lock);
+	return i;
+}
+
 int main(void)
 {
 	printf("%s: HelenOS E1000 network adapter driver\n", NAME);
@@ -74,6 +74,8 @@ static errno_t rtl8169_on_activated(nic_t *nic_data);
 static errno_t rtl8169_on_stopped(nic_t *nic_data);
 static void rtl8169_send_frame(nic_t *nic_data, void *data, size_t size);
 static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev);
+static size_t rtl8169_rx_poll(nic_t *nic_data, size_t budget);
+static void rtl8169_rx_irq(nic_t *nic_data, bool enable);
 static inline errno_t rtl8169_register_int_handler(nic_t *nic_data,
     cap_irq_handle_t *handle);
 static inline void rtl8169_get_hwaddr(rtl8169_t *rtl8169, nic_address_t *addr);
@@ -316,6 +318,7 @@ static rtl8169_t *rtl8169_create_dev_data(ddf_dev_t *dev)
 	nic_set_filtering_change_handlers(nic_data,
 	    rtl8169_unicast_set, rtl8169_multicast_set, rtl8169_broadcast_set,
 	    NULL, NULL);
+	nic_set_rx_poll_handlers(nic_data, rtl8169_rx_poll, rtl8169_rx_irq);
 
 	fibril_mutex_initialize(&rtl8169->rx_lock);
 	fibril_mutex_initialize(&rtl8169->tx_lock);
@@ -747,7 +750,8 @@ static errno_t rtl8169_on_activated(nic_t *nic_data)
 	pio_write_32(rtl8169->regs + RCR, rcr);
 	pio_write_16(rtl8169->regs + RMS, BUFFER_SIZE);
 
-	pio_write_16(rtl8169->regs + IMR, 0xffff);
+	rtl8169->int_mask = 0xffff;
+	pio_write_16(rtl8169->regs + IMR, rtl8169->int_mask);
 	/* XXX Check return value */
 	hw_res_enable_interrupt(rtl8169->parent_sess, rtl8169->irq);
 
@@ -974,9 +978,15 @@ static void rtl8169_transmit_done(ddf_dev_t *dev)
 	fibril_mutex_unlock(&rtl8169->tx_lock);
 }
 
-static void rtl8169_receive_done(ddf_dev_t *dev)
+/** Receive frames
+ *
+ * @param nic_data NIC data
+ * @param budget   Maximum number of frames to receive
+ *
+ * @return Number of frames received
+ */
+static size_t rtl8169_receive_done(nic_t *nic_data, size_t budget)
 {
-	nic_t *nic_data = nic_get_from_ddf_dev(dev);
 	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
 	rtl8169_descr_t *descr;
 	nic_frame_list_t *frames = nic_alloc_frame_list();
@@ -984,6 +994,7 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 	void *buffer;
 	unsigned int tail, fsidx = 0;
 	int frame_size;
+	size_t count = 0;
 
 	ddf_msg(LVL_DEBUG, "rtl8169_receive_done()");
 
@@ -991,7 +1002,7 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 
 	tail = rtl8169->rx_tail;
 
-	while (true) {
+	while (count < budget) {
 		descr = &rtl8169->rx_ring[tail];
 
 		if (descr->control & CONTROL_OWN)
@@ -1017,6 +1028,7 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 			frame = nic_alloc_frame(nic_data, frame_size);
 			memcpy(frame->data, buffer, frame_size);
 			nic_frame_list_append(frames, frame);
+			count++;
 		}
 
 		tail = (tail + 1) % RX_BUFFERS_COUNT;
@@ -1029,7 +1041,42 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 	fibril_mutex_unlock(&rtl8169->rx_lock);
 
 	nic_received_frame_list(nic_data, frames);
+	return count;
+}
+
+/** Receive frames in the adaptive polling mode
+ *
+ * @param nic_data NIC data
+ * @param budget   Maximum number of frames to receive
+ *
+ * @return Number of frames received
+ */
+static size_t rtl8169_rx_poll(nic_t *nic_data, size_t budget)
+{
+	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
+	size_t count;
+
+	/* Acknowledge first so that no newly received frame goes unnoticed */
+	pio_write_16(rtl8169->regs + ISR, (INT_RER | INT_ROK));
+	count = rtl8169_receive_done(nic_data, budget);
+	return count;
+}
+
+/** Enable or disable receive interrupts in the adaptive polling mode
+ *
+ * @param nic_data NIC data
+ * @param enable   True to enable receive interrupts
+ */
+static void rtl8169_rx_irq(nic_t *nic_data, bool enable)
+{
+	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
+
+	if (enable)
+		rtl8169->int_mask |= INT_RER | INT_ROK;
+	else
+		rtl8169->int_mask &= ~(INT_RER | INT_ROK);
 
+	pio_write_16(rtl8169->regs + IMR, rtl8169->int_mask);
 }
 
 static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
@@ -1042,7 +1089,7 @@ static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
 
 	ddf_msg(LVL_DEBUG, "rtl8169_irq_handler(): isr=0x%04x", isr);
-	pio_write_16(rtl8169->regs + IMR, 0xffff);
+	pio_write_16(rtl8169->regs + IMR, rtl8169->int_mask);
 
 	while (isr != 0) {
 		ddf_msg(LVL_DEBUG, "irq handler: remaining isr=0x%04x", isr);
@@ -1071,11 +1118,12 @@ static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 		}
 
 		if (isr & (INT_RER | INT_ROK)) {
-			rtl8169_receive_done(dev);
-			pio_write_16(rtl8169->regs + ISR, (INT_RER | INT_ROK));
+			/* May switch to polling and mask receive interrupts */
+			(void) nic_rx_interrupt(nic_data);
 		}
 
-		isr = pio_read_16(rtl8169->regs + ISR) & INT_KNOWN;
+		isr = pio_read_16(rtl8169->regs + ISR) & INT_KNOWN &
+		    rtl8169->int_mask;
 	}
 
 	pio_write_16(rtl8169->regs + ISR, 0xffff);
@@ -69,15 +69,26 @@ static driver_t virtio_net_driver = {
 	.driver_ops = &virtio_net_driver_ops
 };
 
-static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
+/** Receive frames
+ *
+ * @param nic     NIC data
+ * @param budget  Maximum number of frames to receive
+ *
+ * @return Number of frames received
+ */
+static size_t virtio_net_rx_poll(nic_t *nic, size_t budget)
 {
-	nic_t *nic = ddf_dev_data_get(dev);
 	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	nic_frame_list_t *frames = nic_alloc_frame_list();
+	size_t count = 0;
 
 	uint16_t descno;
 	uint32_t len;
-	while (virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
+	while (count < budget &&
+	    virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
+		count++;
+
 		virtio_net_hdr_t *hdr =
 		    (virtio_net_hdr_t *) virtio_net->rx_buf[descno];
 		if (len <= sizeof(*hdr)) {
@@ -91,7 +102,10 @@ static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 		nic_frame_t *frame = nic_alloc_frame(nic, len - sizeof(*hdr));
 		if (frame) {
 			memcpy(frame->data, &hdr[1], len - sizeof(*hdr));
-			nic_received_frame(nic, frame);
+			if (frames != NULL)
+				nic_frame_list_append(frames, frame);
+			else
+				nic_received_frame(nic, frame);
 		} else {
 			ddf_msg(LVL_WARN,
 			    "Cannot allocate RX frame, packet dropped");
@@ -100,10 +114,53 @@ static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 		virtio_virtq_produce_available(vdev, RX_QUEUE_1, descno);
 	}
 
+	/* Pass all frames received in this round up at once */
+	nic_received_frame_list(nic, frames);
+	return count;
+}
+
+/** Enable or disable receive interrupts
+ *
+ * @param nic     NIC data
+ * @param enable  True to enable receive interrupts
+ */
+static void virtio_net_rx_irq(nic_t *nic, bool enable)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+
+	virtio_virtq_set_interrupts(&virtio_net->virtio_dev, RX_QUEUE_1,
+	    enable);
+}
+
+/** Return TX descriptors used by the device to the free list
+ *
+ * @param virtio_net  VIRTIO net device
+ */
+static void virtio_net_tx_reclaim(virtio_net_t *virtio_net)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t descno;
+	uint32_t len;
+
 	while (virtio_virtq_consume_used(vdev, TX_QUEUE_1, &descno, &len)) {
 		virtio_free_desc(vdev, TX_QUEUE_1, &virtio_net->tx_free_head,
 		    descno);
 	}
+}
+
+static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
+{
+	nic_t *nic = ddf_dev_data_get(dev);
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+
+	uint16_t descno;
+	uint32_t len;
+
+	/* May switch to polling and suppress receive interrupts */
+	(void) nic_rx_interrupt(nic);
+
+	virtio_net_tx_reclaim(virtio_net);
 	while (virtio_virtq_consume_used(vdev, CT_QUEUE_1, &descno, &len)) {
 		virtio_free_desc(vdev, CT_QUEUE_1, &virtio_net->ct_free_head,
 		    descno);
@@ -324,26 +381,41 @@ static void virtio_net_uninitialize(ddf_dev_t *dev)
 	virtio_pci_dev_cleanup(&virtio_net->virtio_dev);
 }
 
-static void virtio_net_send(nic_t *nic, void *data, size_t size)
+/** Copy frame into a TX buffer and set up its descriptor
+ *
+ * @param virtio_net  VIRTIO net device
+ * @param data        Frame data
+ * @param size        Frame size in bytes
+ * @param descno      Place to store the descriptor number
+ *
+ * @return True on success, false if the frame cannot be sent
+ */
+static bool virtio_net_tx_desc_fill(virtio_net_t *virtio_net, void *data,
+    size_t size, uint16_t *descno)
 {
-	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
 
 	if (size > sizeof(virtio_net) + TX_BUF_SIZE) {
 		ddf_msg(LVL_WARN, "TX data too big, frame dropped");
-		return;
+		return false;
 	}
 
-	uint16_t descno = virtio_alloc_desc(vdev, TX_QUEUE_1,
+	uint16_t desc = virtio_alloc_desc(vdev, TX_QUEUE_1,
 	    &virtio_net->tx_free_head);
-	if (descno == (uint16_t) -1U) {
-		ddf_msg(LVL_WARN, "No TX buffers available, frame dropped");
-		return;
+	if (desc == (uint16_t) -1U) {
+		/* The descriptors may have been used without an interrupt yet */
+		virtio_net_tx_reclaim(virtio_net);
+		desc = virtio_alloc_desc(vdev, TX_QUEUE_1,
+		    &virtio_net->tx_free_head);
 	}
-	assert(descno < TX_BUFFERS);
+	if (desc == (uint16_t) -1U) {
+		ddf_msg(LVL_DEBUG, "No TX buffers available");
+		return false;
+	}
+	assert(desc < TX_BUFFERS);
 
 	/* Setup the packet header */
-	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) virtio_net->tx_buf[descno];
+	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) virtio_net->tx_buf[desc];
 	memset(hdr, 0, sizeof(virtio_net_hdr_t));
 	hdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
 	hdr->num_buffers = 0;
@@ -351,12 +423,51 @@ static void virtio_net_send(nic_t *nic, void *data, size_t size)
 	/* Copy packet data into the buffer just past the header */
 	memcpy(&hdr[1], data, size);
 
-	/*
-	 * Set the descriptor, put it into the virtqueue and notify the device
-	 */
-	virtio_virtq_desc_set(vdev, TX_QUEUE_1, descno,
-	    virtio_net->tx_buf_p[descno], sizeof(virtio_net_hdr_t) + size, 0, 0);
-	virtio_virtq_produce_available(vdev, TX_QUEUE_1, descno);
+	/* Set the descriptor */
+	virtio_virtq_desc_set(vdev, TX_QUEUE_1, desc,
+	    virtio_net->tx_buf_p[desc], sizeof(virtio_net_hdr_t) + size, 0, 0);
+
+	*descno = desc;
+	return true;
+}
+
+static void virtio_net_send(nic_t *nic, void *data, size_t size)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	uint16_t descno;
+
+	if (!virtio_net_tx_desc_fill(virtio_net, data, size, &descno)) {
+		ddf_msg(LVL_WARN, "Frame dropped");
+		return;
+	}
+
+	/* Put the descriptor into the virtqueue and notify the device */
+	virtio_virtq_produce_available(&virtio_net->virtio_dev, TX_QUEUE_1,
+	    descno);
+}
+
+static size_t virtio_net_send_frames(nic_t *nic, void *data,
+    const size_t *sizes, size_t count)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	uint16_t descs[TX_BUFFERS];
+	uint8_t *frame = data;
+	size_t n = 0;
+
+	/* Frames which do not fit into the ring are left to the caller */
+	while (n < count && n < TX_BUFFERS) {
+		if (!virtio_net_tx_desc_fill(virtio_net, frame, sizes[n],
+		    &descs[n]))
+			break;
+		frame += sizes[n];
+		n++;
+	}
+
+	/* Make all descriptors available and notify the device once */
+	virtio_virtq_produce_available_n(&virtio_net->virtio_dev, TX_QUEUE_1,
+	    descs, n);
+
+	return n;
 }
 
 static errno_t virtio_net_on_multicast_mode_change(nic_t *nic,
@@ -411,6 +522,8 @@ static errno_t virtio_net_dev_add(ddf_dev_t *dev)
 	ddf_fun_set_ops(fun, &virtio_net_dev_ops);
 
 	nic_set_send_frame_handler(nic, virtio_net_send);
+	nic_set_send_frames_handler(nic, virtio_net_send_frames);
+	nic_set_rx_poll_handlers(nic, virtio_net_rx_poll, virtio_net_rx_irq);
 	nic_set_filtering_change_handlers(nic, NULL,
 	    virtio_net_on_multicast_mode_change,
 	    virtio_net_on_broadcast_mode_change, NULL, NULL);
@@ -34,7 +34,8 @@
 #include <nic/nic.h>
 
 #define RX_BUFFERS	8
-#define TX_BUFFERS	8
+/** Enough TX buffers for a full batch of frames (NIC_FRAMES_MAX). */
+#define TX_BUFFERS	64
 #define CT_BUFFERS	4
 
 /** Device handles packets with partial checksum. */
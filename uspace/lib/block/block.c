@@ -43,6 +43,7 @@
 #include <as.h>
 #include <assert.h>
 #include <bd.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <adt/list.h>
 #include <adt/hash_table.h>
@@ -54,24 +55,95 @@
 #include <str_error.h>
 #include <offset.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 #include "block.h"
 
 #define MAX_WRITE_RETRIES 10
 
+/** Number of independently locked parts of a block cache. */
+#define CACHE_SHARDS		8
+/**
+ * Default limit of memory used by the cached blocks of a device.
+ *
+ * Blocks are allocated on demand, so this is only an upper bound. It leaves
+ * each shard room for its 2Q queues and for a full read-ahead window, which
+ * the former limit of 20 blocks per device did not.
+ */
+#define CACHE_DEFAULT_SIZE	(1024 * 1024)
+/** Minimal number of blocks cached by a shard. */
+#define CACHE_SHARD_MIN		8
+
+/** Initial read-ahead window once sequential access is detected (blocks). */
+#define CACHE_RA_MIN		2
+/** Maximal read-ahead window (blocks). */
+#define CACHE_RA_MAX		16
+
+/** Default number of dirty blocks which wakes up the flusher early. */
+#define CACHE_DIRTY_BG		8
+/** Default number of dirty blocks which makes block_put() write through. */
+#define CACHE_DIRTY_MAX		16
+/** Default period of the write-back flusher (usec). */
+#define CACHE_FLUSH_INTERVAL	1000000
+/** Maximal number of blocks written back by one flusher pass. */
+#define CACHE_FLUSH_BATCH	32
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
 static LIST_INITIALIZE(dcl);
 
+/*
+ * The cached blocks are replaced according to the 2Q policy. A block
+ * which is not known to the cache starts in the CACHE_Q_IN queue. When
+ * evicted from there, its address is remembered for a while and should
+ * the block be requested again in the meantime, it is admitted to the
+ * CACHE_Q_AM queue of frequently used blocks. Blocks read only once,
+ * e.g. by a long sequential read, thus cannot push the hot blocks out
+ * of the cache.
+ */
+enum {
+	CACHE_Q_IN,
+	CACHE_Q_AM
+};
+
+/** Remembered address of a block evicted from the CACHE_Q_IN queue. */
+typedef struct {
+	ht_link_t hash_link;
+	link_t link;
+	aoff64_t lba;
+} cache_ghost_t;
+
 typedef struct {
 	fibril_mutex_t lock;
+	hash_table_t block_hash;
+	list_t free_in;           /**< Unused blocks of CACHE_Q_IN. */
+	list_t free_am;           /**< Unused blocks of CACHE_Q_AM. */
+	unsigned capacity;        /**< Number of blocks to cache. */
+	unsigned blocks_cached;   /**< Number of cached blocks. */
+	unsigned blocks_in;       /**< Number of cached blocks in CACHE_Q_IN. */
+	hash_table_t ghost_hash;
+	list_t ghost_list;        /**< Remembered addresses in FIFO order. */
+	unsigned ghosts;          /**< Number of remembered addresses. */
+	block_cache_stats_t stats;
+} cache_shard_t;
+
+typedef struct {
+	fibril_mutex_t lock;      /**< Protects read-ahead and flusher state. */
 	size_t lblock_size;       /**< Logical block size. */
 	unsigned blocks_cluster;  /**< Physical blocks per block_t */
-	unsigned block_count;     /**< Total number of blocks. */
-	unsigned blocks_cached;   /**< Number of cached blocks. */
-	hash_table_t block_hash;
-	list_t free_list;
+	unsigned block_count;     /**< Total number of blocks to cache. */
 	enum cache_mode mode;
+	cache_shard_t shards[CACHE_SHARDS];
+	aoff64_t ra_next;         /**< Next block of a sequential reader. */
+	unsigned ra_window;       /**< Current read-ahead window. */
+	atomic_uint dirty_hint;   /**< Approximate number of unused dirty blocks. */
+	atomic_uint dirty_bg;     /**< Dirty blocks which wake up the flusher. */
+	atomic_uint dirty_max;    /**< Dirty blocks which force write-through. */
+	usec_t flush_interval;    /**< Period of the flusher. */
+	fibril_condvar_t flush_cv;
+	bool flusher_running;
+	bool flusher_stop;
+	uint64_t writebacks;      /**< Blocks written back by the flusher. */
 } cache_t;
 
 typedef struct {
@@ -89,6 +161,7 @@ typedef struct {
 static errno_t read_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static errno_t write_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static aoff64_t ba_ltop(devcon_t *, aoff64_t);
+static errno_t cache_flusher(void *);
 
 static devcon_t *devcon_search(service_id_t service_id)
 {
@@ -243,13 +316,13 @@ void *block_bb_get(service_id_t service_id)
 static size_t cache_key_hash(const void *key)
 {
 	const aoff64_t *lba = key;
-	return *lba;
+	return *lba / CACHE_SHARDS;
 }
 
 static size_t cache_hash(const ht_link_t *item)
 {
 	block_t *b = hash_table_get_inst(item, block_t, hash_link);
-	return b->lba;
+	return b->lba / CACHE_SHARDS;
 }
 
 static bool cache_key_equal(const void *key, const ht_link_t *item)
@@ -267,6 +340,69 @@ static hash_table_ops_t cache_ops = {
 	.remove_callback = NULL
 };
 
+static size_t ghost_hash(const ht_link_t *item)
+{
+	cache_ghost_t *g = hash_table_get_inst(item, cache_ghost_t, hash_link);
+	return g->lba / CACHE_SHARDS;
+}
+
+static bool ghost_key_equal(const void *key, const ht_link_t *item)
+{
+	const aoff64_t *lba = key;
+	cache_ghost_t *g = hash_table_get_inst(item, cache_ghost_t, hash_link);
+	return g->lba == *lba;
+}
+
+static hash_table_ops_t ghost_ops = {
+	.hash = ghost_hash,
+	.key_hash = cache_key_hash,
+	.key_equal = ghost_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static cache_shard_t *cache_shard(cache_t *cache, aoff64_t lba)
+{
+	return &cache->shards[lba % CACHE_SHARDS];
+}
+
+static bool cache_shard_init(cache_shard_t *shard, unsigned capacity)
+{
+	fibril_mutex_initialize(&shard->lock);
+	list_initialize(&shard->free_in);
+	list_initialize(&shard->free_am);
+	list_initialize(&shard->ghost_list);
+	shard->capacity = capacity;
+	shard->blocks_cached = 0;
+	shard->blocks_in = 0;
+	shard->ghosts = 0;
+	memset(&shard->stats, 0, sizeof(shard->stats));
+
+	if (!hash_table_create(&shard->block_hash, 0, 0, &cache_ops))
+		return false;
+	if (!hash_table_create(&shard->ghost_hash, 0, 0, &ghost_ops)) {
+		hash_table_destroy(&shard->block_hash);
+		return false;
+	}
+
+	return true;
+}
+
+static void cache_shard_fini(cache_shard_t *shard)
+{
+	while (!list_empty(&shard->ghost_list)) {
+		cache_ghost_t *g = list_get_instance(
+		    list_first(&shard->ghost_list), cache_ghost_t, link);
+
+		list_remove(&g->link);
+		hash_table_remove_item(&shard->ghost_hash, &g->hash_link);
+		free(g);
+	}
+
+	hash_table_destroy(&shard->ghost_hash);
+	hash_table_destroy(&shard->block_hash);
+}
+
 errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
     enum cache_mode mode)
 {
@@ -281,11 +417,18 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 		return ENOMEM;
 
 	fibril_mutex_initialize(&cache->lock);
-	list_initialize(&cache->free_list);
 	cache->lblock_size = size;
-	cache->block_count = blocks;
-	cache->blocks_cached = 0;
 	cache->mode = mode;
+	cache->ra_next = 0;
+	cache->ra_window = 0;
+	atomic_init(&cache->dirty_hint, 0);
+	atomic_init(&cache->dirty_bg, CACHE_DIRTY_BG);
+	atomic_init(&cache->dirty_max, CACHE_DIRTY_MAX);
+	cache->flush_interval = CACHE_FLUSH_INTERVAL;
+	fibril_condvar_initialize(&cache->flush_cv);
+	cache->flusher_running = false;
+	cache->flusher_stop = false;
+	cache->writebacks = 0;
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -295,35 +438,147 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 
 	cache->blocks_cluster = cache->lblock_size / devcon->pblock_size;
 
-	if (!hash_table_create(&cache->block_hash, 0, 0, &cache_ops)) {
-		free(cache);
-		return ENOMEM;
+	/* Unless told otherwise, cache a fixed amount of data. */
+	if (blocks == 0)
+		blocks = CACHE_DEFAULT_SIZE / cache->lblock_size;
+	unsigned shard_blocks = max(blocks / CACHE_SHARDS, CACHE_SHARD_MIN);
+	cache->block_count = shard_blocks * CACHE_SHARDS;
+
+	for (unsigned i = 0; i < CACHE_SHARDS; i++) {
+		if (!cache_shard_init(&cache->shards[i], shard_blocks)) {
+			while (i-- > 0)
+				cache_shard_fini(&cache->shards[i]);
+			free(cache);
+			return ENOMEM;
+		}
+	}
+
+	fid_t flusher = 0;
+	if (mode == CACHE_MODE_WB) {
+		flusher = fibril_create(cache_flusher, devcon);
+		if (flusher == 0) {
+			for (unsigned i = 0; i < CACHE_SHARDS; i++)
+				cache_shard_fini(&cache->shards[i]);
+			free(cache);
+			return ENOMEM;
+		}
+		cache->flusher_running = true;
 	}
 
 	devcon->cache = cache;
+
+	if (flusher != 0)
+		fibril_add_ready(flusher);
+
 	return EOK;
 }
 
-errno_t block_cache_fini(service_id_t service_id)
+/** Set write-back parameters of the block cache.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param dirty_bg	Number of unused dirty blocks at which the flusher
+ * 			starts writing them back ahead of its period.
+ * @param dirty_max	Number of unused dirty blocks at which block_put()
+ * 			writes released dirty blocks back synchronously.
+ * @param interval	Period of the flusher (usec).
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_cache_set_writeback(service_id_t service_id, unsigned dirty_bg,
+    unsigned dirty_max, usec_t interval)
 {
 	devcon_t *devcon = devcon_search(service_id);
-	cache_t *cache;
-	errno_t rc;
+	if (!devcon)
+		return ENOENT;
+	if (!devcon->cache)
+		return ENOENT;
+	if ((dirty_bg == 0) || (dirty_bg > dirty_max) || (interval == 0))
+		return EINVAL;
+
+	cache_t *cache = devcon->cache;
 
+	fibril_mutex_lock(&cache->lock);
+	atomic_store(&cache->dirty_bg, dirty_bg);
+	atomic_store(&cache->dirty_max, dirty_max);
+	cache->flush_interval = interval;
+	fibril_condvar_broadcast(&cache->flush_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
+/** Get statistics of the block cache.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param stats		Place to store the statistics.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_cache_get_stats(service_id_t service_id,
+    block_cache_stats_t *stats)
+{
+	devcon_t *devcon = devcon_search(service_id);
 	if (!devcon)
 		return ENOENT;
 	if (!devcon->cache)
-		return EOK;
-	cache = devcon->cache;
+		return ENOENT;
 
-	/*
-	 * We are expecting to find all blocks for this device handle on the
-	 * free list, i.e. the block reference count should be zero. Do not
-	 * bother with the cache and block locks because we are single-threaded.
-	 */
-	while (!list_empty(&cache->free_list)) {
-		block_t *b = list_get_instance(list_first(&cache->free_list),
-		    block_t, free_link);
+	cache_t *cache = devcon->cache;
+
+	memset(stats, 0, sizeof(*stats));
+	for (unsigned i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		fibril_mutex_lock(&shard->lock);
+		stats->hits += shard->stats.hits;
+		stats->misses += shard->stats.misses;
+		stats->evictions += shard->stats.evictions;
+		stats->readahead += shard->stats.readahead;
+		fibril_mutex_unlock(&shard->lock);
+	}
+
+	fibril_mutex_lock(&cache->lock);
+	stats->writebacks = cache->writebacks;
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
+/** Fill in the block cache statistics of a file system.
+ *
+ * File systems which use the block cache can use this function as
+ * their libfs cache_stats operation.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param st		File system statistics to fill in.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t block_cache_statfs(service_id_t service_id, vfs_statfs_t *st)
+{
+	block_cache_stats_t stats;
+
+	errno_t rc = block_cache_get_stats(service_id, &stats);
+	if (rc != EOK)
+		return rc;
+
+	st->c_hits = stats.hits;
+	st->c_misses = stats.misses;
+	st->c_evictions = stats.evictions;
+	st->c_readahead = stats.readahead;
+	st->c_writebacks = stats.writebacks;
+	return EOK;
+}
+
+static errno_t cache_shard_drop(devcon_t *devcon, cache_shard_t *shard,
+    list_t *list)
+{
+	cache_t *cache = devcon->cache;
+	errno_t rc;
+
+	while (!list_empty(list)) {
+		block_t *b = list_get_instance(list_first(list), block_t,
+		    free_link);
 
 		list_remove(&b->free_link);
 		if (b->dirty) {
@@ -333,30 +588,189 @@ errno_t block_cache_fini(service_id_t service_id)
 				return rc;
 		}
 
-		hash_table_remove_item(&cache->block_hash, &b->hash_link);
+		hash_table_remove_item(&shard->block_hash, &b->hash_link);
 
 		free(b->data);
 		free(b);
 	}
 
-	hash_table_destroy(&cache->block_hash);
+	return EOK;
+}
+
+errno_t block_cache_fini(service_id_t service_id)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	cache_t *cache;
+	errno_t rc;
+
+	if (!devcon)
+		return ENOENT;
+	if (!devcon->cache)
+		return EOK;
+	cache = devcon->cache;
+
+	/* Stop the flusher, the remaining dirty blocks are written below. */
+	fibril_mutex_lock(&cache->lock);
+	cache->flusher_stop = true;
+	fibril_condvar_broadcast(&cache->flush_cv);
+	while (cache->flusher_running)
+		fibril_condvar_wait(&cache->flush_cv, &cache->lock);
+	fibril_mutex_unlock(&cache->lock);
+
+	/*
+	 * We are expecting to find all blocks for this device handle on the
+	 * free lists, i.e. the block reference count should be zero. Do not
+	 * bother with the cache and block locks because we are single-threaded.
+	 */
+	for (unsigned i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		rc = cache_shard_drop(devcon, shard, &shard->free_in);
+		if (rc != EOK)
+			return rc;
+		rc = cache_shard_drop(devcon, shard, &shard->free_am);
+		if (rc != EOK)
+			return rc;
+	}
+
+	for (unsigned i = 0; i < CACHE_SHARDS; i++)
+		cache_shard_fini(&cache->shards[i]);
 	devcon->cache = NULL;
 	free(cache);
 
 	return EOK;
 }
 
-#define CACHE_LO_WATERMARK	10
-#define CACHE_HI_WATERMARK	20
-static bool cache_can_grow(cache_t *cache)
+static bool cache_can_grow(cache_shard_t *shard)
 {
-	if (cache->blocks_cached < CACHE_LO_WATERMARK)
+	if (shard->blocks_cached < shard->capacity)
 		return true;
-	if (!list_empty(&cache->free_list))
+	if (!list_empty(&shard->free_in) || !list_empty(&shard->free_am))
 		return false;
 	return true;
 }
 
+/** Get the free list of the replacement queue of a block. */
+static list_t *cache_free_list(cache_shard_t *shard, block_t *b)
+{
+	return (b->queue == CACHE_Q_AM) ? &shard->free_am : &shard->free_in;
+}
+
+/** Choose an unused block to be recycled.
+ *
+ * Should be called only with the shard lock held. Blocks of CACHE_Q_IN
+ * are preferred as long as the queue holds more than its share of the
+ * shard.
+ *
+ * @param shard		Cache shard.
+ *
+ * @return		Least recently used block of the chosen queue or NULL.
+ */
+static block_t *cache_victim(cache_shard_t *shard)
+{
+	link_t *link = NULL;
+
+	if (shard->blocks_in > shard->capacity / 4)
+		link = list_first(&shard->free_in);
+	if (!link)
+		link = list_first(&shard->free_am);
+	if (!link)
+		link = list_first(&shard->free_in);
+	if (!link)
+		return NULL;
+
+	return list_get_instance(link, block_t, free_link);
+}
+
+/** Remember the address of a block evicted from CACHE_Q_IN. */
+static void cache_ghost_add(cache_shard_t *shard, aoff64_t lba)
+{
+	cache_ghost_t *g;
+
+	if (shard->ghosts >= max(shard->capacity / 2, 1)) {
+		/* Reuse the oldest entry. */
+		g = list_get_instance(list_first(&shard->ghost_list),
+		    cache_ghost_t, link);
+		list_remove(&g->link);
+		hash_table_remove_item(&shard->ghost_hash, &g->hash_link);
+	} else {
+		g = malloc(sizeof(cache_ghost_t));
+		if (!g)
+			return;
+		shard->ghosts++;
+	}
+
+	g->lba = lba;
+	hash_table_insert(&shard->ghost_hash, &g->hash_link);
+	list_append(&g->link, &shard->ghost_list);
+}
+
+/** Choose the replacement queue of a block which is being instantiated. */
+static unsigned cache_admit(cache_shard_t *shard, aoff64_t lba)
+{
+	ht_link_t *hlink = hash_table_find(&shard->ghost_hash, &lba);
+	if (!hlink)
+		return CACHE_Q_IN;
+
+	cache_ghost_t *g = hash_table_get_inst(hlink, cache_ghost_t, hash_link);
+	list_remove(&g->link);
+	hash_table_remove_item(&shard->ghost_hash, &g->hash_link);
+	free(g);
+	shard->ghosts--;
+
+	return CACHE_Q_AM;
+}
+
+/** Insert a block into the hash table and a replacement queue. */
+static void cache_insert(cache_shard_t *shard, block_t *b, unsigned queue)
+{
+	b->queue = queue;
+	if (queue == CACHE_Q_IN)
+		shard->blocks_in++;
+	hash_table_insert(&shard->block_hash, &b->hash_link);
+}
+
+/** Remove a block from the hash table and its replacement queue.
+ *
+ * @param shard		Cache shard.
+ * @param b		Removed block.
+ * @param evict		If true, the block is being replaced by another
+ * 			block and the eviction is accounted for.
+ */
+static void cache_remove(cache_shard_t *shard, block_t *b, bool evict)
+{
+	hash_table_remove_item(&shard->block_hash, &b->hash_link);
+	if (b->queue == CACHE_Q_IN) {
+		shard->blocks_in--;
+		if (evict)
+			cache_ghost_add(shard, b->lba);
+	}
+	if (evict)
+		shard->stats.evictions++;
+}
+
+static void cache_dirty_inc(cache_t *cache, bool wakeup)
+{
+	unsigned hint = atomic_fetch_add(&cache->dirty_hint, 1) + 1;
+
+	if (wakeup && (hint >= atomic_load(&cache->dirty_bg))) {
+		fibril_mutex_lock(&cache->lock);
+		fibril_condvar_signal(&cache->flush_cv);
+		fibril_mutex_unlock(&cache->lock);
+	}
+}
+
+static void cache_dirty_dec(cache_t *cache)
+{
+	unsigned hint = atomic_load(&cache->dirty_hint);
+
+	while (hint > 0) {
+		if (atomic_compare_exchange_weak(&cache->dirty_hint, &hint,
+		    hint - 1))
+			break;
+	}
+}
+
 static void block_initialize(block_t *b)
 {
 	fibril_mutex_initialize(&b->lock);
@@ -364,10 +778,212 @@ static void block_initialize(block_t *b)
 	b->write_failures = 0;
 	b->dirty = false;
 	b->toxic = false;
+	b->filling = false;
 	fibril_rwlock_initialize(&b->contents_lock);
 	link_initialize(&b->free_link);
 }
 
+/** Get a block structure to read ahead into.
+ *
+ * Should be called only with the shard lock held. Read-ahead neither
+ * writes dirty blocks back nor waits for busy blocks, so it simply
+ * gives up if no block can be spared right away. Only blocks of
+ * CACHE_Q_IN are recycled so that read-ahead does not evict hot blocks.
+ *
+ * @param cache		Block cache.
+ * @param shard		Cache shard.
+ *
+ * @return		Unused block structure or NULL.
+ */
+static block_t *ra_block_alloc(cache_t *cache, cache_shard_t *shard)
+{
+	block_t *b;
+
+	if (shard->blocks_cached < shard->capacity) {
+		b = malloc(sizeof(block_t));
+		if (b) {
+			b->data = malloc(cache->lblock_size);
+			if (b->data) {
+				shard->blocks_cached++;
+				return b;
+			}
+			free(b);
+		}
+	}
+
+	link_t *link = list_first(&shard->free_in);
+	if (!link)
+		return NULL;
+
+	b = list_get_instance(link, block_t, free_link);
+	if (!fibril_mutex_trylock(&b->lock))
+		return NULL;
+	if (b->dirty) {
+		fibril_mutex_unlock(&b->lock);
+		return NULL;
+	}
+	fibril_mutex_unlock(&b->lock);
+
+	list_remove(&b->free_link);
+	cache_remove(shard, b, true);
+	return b;
+}
+
+/** Instantiate blocks to be read ahead after a block.
+ *
+ * Should be called with the lock of the block being read held, but no
+ * shard lock held. Since the block lock is held, the shards of the
+ * read-ahead blocks are only try-locked. The read-ahead window grows
+ * while the blocks are requested sequentially. The returned blocks are
+ * locked and unreferenced, and they are not on the free list yet.
+ *
+ * @param devcon	Device connection.
+ * @param ba		Logical address of the block being read.
+ * @param ra		Array for storing the read-ahead blocks.
+ *
+ * @return		Number of read-ahead blocks.
+ */
+static unsigned ra_blocks_get(devcon_t *devcon, aoff64_t ba, block_t **ra)
+{
+	cache_t *cache = devcon->cache;
+	unsigned window;
+	unsigned count = 0;
+
+	fibril_mutex_lock(&cache->lock);
+	if (ba == cache->ra_next) {
+		cache->ra_window = (cache->ra_window == 0) ? CACHE_RA_MIN :
+		    min(cache->ra_window * 2, CACHE_RA_MAX);
+	} else {
+		cache->ra_window = 0;
+	}
+	window = cache->ra_window;
+	fibril_mutex_unlock(&cache->lock);
+
+	while (count < window) {
+		aoff64_t lba = ba + count + 1;
+		cache_shard_t *shard = cache_shard(cache, lba);
+
+		if (ba_ltop(devcon, lba) + cache->blocks_cluster >
+		    devcon->pblocks)
+			break;
+		if (!fibril_mutex_trylock(&shard->lock))
+			break;
+		if (hash_table_find(&shard->block_hash, &lba)) {
+			fibril_mutex_unlock(&shard->lock);
+			break;
+		}
+
+		block_t *b = ra_block_alloc(cache, shard);
+		if (!b) {
+			fibril_mutex_unlock(&shard->lock);
+			break;
+		}
+
+		block_initialize(b);
+		b->refcnt = 0;
+		b->service_id = devcon->service_id;
+		b->size = cache->lblock_size;
+		b->lba = lba;
+		b->pba = ba_ltop(devcon, lba);
+		cache_insert(shard, b, CACHE_Q_IN);
+		shard->stats.readahead++;
+		fibril_mutex_lock(&b->lock);
+		fibril_mutex_unlock(&shard->lock);
+
+		ra[count++] = b;
+	}
+
+	fibril_mutex_lock(&cache->lock);
+	cache->ra_next = ba + count + 1;
+	fibril_mutex_unlock(&cache->lock);
+
+	return count;
+}
+
+/** Read a block together with the blocks read ahead after it.
+ *
+ * All blocks must be locked. Should the combined read fail, the blocks
+ * are read one by one so that a failure does not spoil blocks which
+ * can be read on their own.
+ *
+ * @param devcon	Device connection.
+ * @param b		Block being read.
+ * @param ra		Blocks to be read ahead.
+ * @param ra_count	Number of blocks to be read ahead.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t ra_read(devcon_t *devcon, block_t *b, block_t **ra,
+    unsigned ra_count)
+{
+	cache_t *cache = devcon->cache;
+	size_t size = cache->lblock_size;
+
+	if (ra_count > 0) {
+		void *buf = malloc((ra_count + 1) * size);
+		if (buf) {
+			errno_t rc = read_blocks(devcon, b->pba,
+			    (ra_count + 1) * cache->blocks_cluster, buf,
+			    (ra_count + 1) * size);
+			if (rc == EOK) {
+				memcpy(b->data, buf, size);
+				for (unsigned i = 0; i < ra_count; i++) {
+					memcpy(ra[i]->data, buf + (i + 1) * size,
+					    size);
+				}
+			}
+
+			free(buf);
+			if (rc == EOK)
+				return EOK;
+		}
+
+		for (unsigned i = 0; i < ra_count; i++) {
+			if (read_blocks(devcon, ra[i]->pba, cache->blocks_cluster,
+			    ra[i]->data, size) != EOK)
+				ra[i]->toxic = true;
+		}
+	}
+
+	return read_blocks(devcon, b->pba, cache->blocks_cluster, b->data,
+	    size);
+}
+
+/** Release blocks which were read ahead.
+ *
+ * The blocks nobody has asked for in the meantime are put on the free
+ * list. Blocks which failed to read are dropped.
+ *
+ * @param cache		Block cache.
+ * @param ra		Blocks which were read ahead (unlocked).
+ * @param ra_count	Number of blocks which were read ahead.
+ */
+static void ra_blocks_put(cache_t *cache, block_t **ra, unsigned ra_count)
+{
+	for (unsigned i = 0; i < ra_count; i++) {
+		block_t *b = ra[i];
+		cache_shard_t *shard = cache_shard(cache, b->lba);
+
+		fibril_mutex_lock(&shard->lock);
+		fibril_mutex_lock(&b->lock);
+		if ((b->refcnt == 0) && !link_used(&b->free_link)) {
+			if (b->toxic) {
+				cache_remove(shard, b, false);
+				fibril_mutex_unlock(&b->lock);
+				free(b->data);
+				free(b);
+				shard->blocks_cached--;
+				fibril_mutex_unlock(&shard->lock);
+				continue;
+			}
+
+			list_append(&b->free_link, cache_free_list(shard, b));
+		}
+		fibril_mutex_unlock(&b->lock);
+		fibril_mutex_unlock(&shard->lock);
+	}
+}
+
 /** Instantiate a block in memory and get a reference to it.
  *
  * @param block			Pointer to where the function will store the
@@ -384,9 +1000,11 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 {
 	devcon_t *devcon;
 	cache_t *cache;
+	cache_shard_t *shard;
 	block_t *b;
-	link_t *link;
 	aoff64_t p_ba;
+	block_t *ra[CACHE_RA_MAX];
+	unsigned ra_count = 0;
 	errno_t rc;
 
 	devcon = devcon_search(service_id);
@@ -407,12 +1025,14 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 		return EIO;
 	}
 
+	shard = cache_shard(cache, ba);
+
 retry:
 	rc = EOK;
 	b = NULL;
 
-	fibril_mutex_lock(&cache->lock);
-	ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
+	fibril_mutex_lock(&shard->lock);
+	ht_link_t *hlink = hash_table_find(&shard->block_hash, &ba);
 	if (hlink) {
 	found:
 		/*
@@ -420,17 +1040,21 @@ retry:
 		 */
 		b = hash_table_get_inst(hlink, block_t, hash_link);
 		fibril_mutex_lock(&b->lock);
-		if (b->refcnt++ == 0)
+		if (b->refcnt++ == 0) {
+			if (b->dirty)
+				cache_dirty_dec(cache);
 			list_remove(&b->free_link);
+		}
 		if (b->toxic)
 			rc = EIO;
+		shard->stats.hits++;
 		fibril_mutex_unlock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
+		fibril_mutex_unlock(&shard->lock);
 	} else {
 		/*
 		 * The block was not found in the cache.
 		 */
-		if (cache_can_grow(cache)) {
+		if (cache_can_grow(shard)) {
 			/*
 			 * We can grow the cache by allocating new blocks.
 			 * Should the allocation fail, we fail over and try to
@@ -445,34 +1069,33 @@ retry:
 				b = NULL;
 				goto recycle;
 			}
-			cache->blocks_cached++;
+			shard->blocks_cached++;
 		} else {
 			/*
-			 * Try to recycle a block from the free list.
+			 * Try to recycle a block from the free lists.
 			 */
 		recycle:
-			if (list_empty(&cache->free_list)) {
-				fibril_mutex_unlock(&cache->lock);
+			b = cache_victim(shard);
+			if (!b) {
+				fibril_mutex_unlock(&shard->lock);
 				rc = ENOMEM;
 				goto out;
 			}
-			link = list_first(&cache->free_list);
-			b = list_get_instance(link, block_t, free_link);
 
 			fibril_mutex_lock(&b->lock);
 			if (b->dirty) {
 				/*
 				 * The block needs to be written back to the
 				 * device before it changes identity. Do this
-				 * while not holding the cache lock so that
+				 * while not holding the shard lock so that
 				 * concurrency is not impeded. Also move the
-				 * block to the end of the free list so that we
+				 * block to the end of its free list so that we
 				 * do not slow down other instances of
 				 * block_get() draining the free list.
 				 */
 				list_remove(&b->free_link);
-				list_append(&b->free_link, &cache->free_list);
-				fibril_mutex_unlock(&cache->lock);
+				list_append(&b->free_link, cache_free_list(shard, b));
+				fibril_mutex_unlock(&shard->lock);
 				rc = write_blocks(devcon, b->pba,
 				    cache->blocks_cluster, b->data, b->size);
 				if (rc != EOK) {
@@ -496,7 +1119,8 @@ retry:
 					b->write_failures = 0;
 
 				b->dirty = false;
-				if (!fibril_mutex_trylock(&cache->lock)) {
+				cache_dirty_dec(cache);
+				if (!fibril_mutex_trylock(&shard->lock)) {
 					/*
 					 * Somebody is probably racing with us.
 					 * Unlock the block and retry.
@@ -504,12 +1128,12 @@ retry:
 					fibril_mutex_unlock(&b->lock);
 					goto retry;
 				}
-				hlink = hash_table_find(&cache->block_hash, &ba);
+				hlink = hash_table_find(&shard->block_hash, &ba);
 				if (hlink) {
 					/*
 					 * Someone else must have already
 					 * instantiated the block while we were
-					 * not holding the cache lock.
+					 * not holding the shard lock.
 					 * Leave the recycled block on the
 					 * freelist and continue as if we
 					 * found the block of interest during
@@ -527,7 +1151,7 @@ retry:
 			 * table.
 			 */
 			list_remove(&b->free_link);
-			hash_table_remove_item(&cache->block_hash, &b->hash_link);
+			cache_remove(shard, b, true);
 		}
 
 		block_initialize(b);
@@ -535,29 +1159,44 @@ retry:
 		b->size = cache->lblock_size;
 		b->lba = ba;
 		b->pba = ba_ltop(devcon, b->lba);
-		hash_table_insert(&cache->block_hash, &b->hash_link);
+		cache_insert(shard, b, cache_admit(shard, ba));
+		shard->stats.misses++;
 
 		/*
-		 * Lock the block before releasing the cache lock. Thus we don't
+		 * Lock the block before releasing the shard lock. Thus we don't
 		 * kill concurrent operations on the cache while doing I/O on
 		 * the block.
 		 */
 		fibril_mutex_lock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
+		fibril_mutex_unlock(&shard->lock);
 
 		if (!(flags & BLOCK_FLAGS_NOREAD)) {
+			/*
+			 * If the blocks are being read sequentially, read
+			 * some of the following blocks along with this one.
+			 */
+			ra_count = ra_blocks_get(devcon, ba, ra);
+
 			/*
 			 * The block contains old or no data. We need to read
 			 * the new contents from the device.
 			 */
-			rc = read_blocks(devcon, b->pba, cache->blocks_cluster,
-			    b->data, cache->lblock_size);
+			rc = ra_read(devcon, b, ra, ra_count);
 			if (rc != EOK)
 				b->toxic = true;
-		} else
+		} else {
+			/* The caller is going to fill in the block. */
+			b->filling = true;
 			rc = EOK;
+		}
 
 		fibril_mutex_unlock(&b->lock);
+
+		if (ra_count > 0) {
+			for (unsigned i = 0; i < ra_count; i++)
+				fibril_mutex_unlock(&ra[i]->lock);
+			ra_blocks_put(cache, ra, ra_count);
+		}
 	}
 out:
 	if ((rc != EOK) && b) {
@@ -581,8 +1220,9 @@ errno_t block_put(block_t *block)
 {
 	devcon_t *devcon = devcon_search(block->service_id);
 	cache_t *cache;
-	unsigned blocks_cached;
-	enum cache_mode mode;
+	cache_shard_t *shard;
+	bool over_capacity;
+	bool wakeup = false;
 	errno_t rc = EOK;
 
 	assert(devcon);
@@ -590,25 +1230,28 @@ errno_t block_put(block_t *block)
 	assert(block->refcnt >= 1);
 
 	cache = devcon->cache;
+	shard = cache_shard(cache, block->lba);
 
 retry:
-	fibril_mutex_lock(&cache->lock);
-	blocks_cached = cache->blocks_cached;
-	mode = cache->mode;
-	fibril_mutex_unlock(&cache->lock);
+	fibril_mutex_lock(&shard->lock);
+	over_capacity = shard->blocks_cached > shard->capacity;
+	fibril_mutex_unlock(&shard->lock);
 
 	/*
 	 * Determine whether to sync the block. Syncing the block is best done
-	 * when not holding the cache lock as it does not impede concurrency.
-	 * Since the situation may have changed when we unlocked the cache, the
-	 * blocks_cached and mode variables are mere hints. We will recheck the
-	 * conditions later when the cache lock is held again.
+	 * when not holding the shard lock as it does not impede concurrency.
+	 * Since the situation may have changed when we unlocked the shard, the
+	 * over_capacity and dirty_hint values are mere hints. We will recheck
+	 * the conditions later when the shard lock is held again. Unless there
+	 * are too many dirty blocks already, dirty blocks of a write-back
+	 * cache are left to the flusher.
 	 */
 	fibril_mutex_lock(&block->lock);
 	if (block->toxic)
 		block->dirty = false;	/* will not write back toxic block */
 	if (block->dirty && (block->refcnt == 1) &&
-	    (blocks_cached > CACHE_HI_WATERMARK || mode != CACHE_MODE_WB)) {
+	    (over_capacity || cache->mode != CACHE_MODE_WB ||
+	    atomic_load(&cache->dirty_hint) >= atomic_load(&cache->dirty_max))) {
 		rc = write_blocks(devcon, block->pba, cache->blocks_cluster,
 		    block->data, block->size);
 		if (rc == EOK)
@@ -617,7 +1260,7 @@ retry:
 	}
 	fibril_mutex_unlock(&block->lock);
 
-	fibril_mutex_lock(&cache->lock);
+	fibril_mutex_lock(&shard->lock);
 	fibril_mutex_lock(&block->lock);
 	if (!--block->refcnt) {
 		/*
@@ -625,8 +1268,8 @@ retry:
 		 * block or put it on the free list. In case of an I/O error,
 		 * free the block.
 		 */
-		if ((cache->blocks_cached > CACHE_HI_WATERMARK) ||
-		    (rc != EOK)) {
+		block->filling = false;
+		if ((shard->blocks_cached > shard->capacity) || (rc != EOK)) {
 			/*
 			 * Currently there are too many cached blocks or there
 			 * was an I/O error when writing the block back to the
@@ -635,14 +1278,14 @@ retry:
 			if (block->dirty) {
 				/*
 				 * We cannot sync the block while holding the
-				 * cache lock. Release everything and retry.
+				 * shard lock. Release everything and retry.
 				 */
 				block->refcnt++;
 
 				if (block->write_failures < MAX_WRITE_RETRIES) {
 					block->write_failures++;
 					fibril_mutex_unlock(&block->lock);
-					fibril_mutex_unlock(&cache->lock);
+					fibril_mutex_unlock(&shard->lock);
 					goto retry;
 				} else {
 					printf("Too many errors writing block %"
@@ -654,12 +1297,12 @@ retry:
 			/*
 			 * Take the block out of the cache and free it.
 			 */
-			hash_table_remove_item(&cache->block_hash, &block->hash_link);
+			cache_remove(shard, block, false);
 			fibril_mutex_unlock(&block->lock);
 			free(block->data);
 			free(block);
-			cache->blocks_cached--;
-			fibril_mutex_unlock(&cache->lock);
+			shard->blocks_cached--;
+			fibril_mutex_unlock(&shard->lock);
 			return rc;
 		}
 		/*
@@ -667,22 +1310,248 @@ retry:
 		 */
 		if (cache->mode != CACHE_MODE_WB && block->dirty) {
 			/*
-			 * We cannot sync the block while holding the cache
+			 * We cannot sync the block while holding the shard
 			 * lock. Release everything and retry.
 			 */
 			block->refcnt++;
 			fibril_mutex_unlock(&block->lock);
-			fibril_mutex_unlock(&cache->lock);
+			fibril_mutex_unlock(&shard->lock);
 			goto retry;
 		}
-		list_append(&block->free_link, &cache->free_list);
+		list_append(&block->free_link, cache_free_list(shard, block));
+		wakeup = block->dirty;
 	}
 	fibril_mutex_unlock(&block->lock);
-	fibril_mutex_unlock(&cache->lock);
+	fibril_mutex_unlock(&shard->lock);
+
+	if (wakeup)
+		cache_dirty_inc(cache, true);
 
 	return rc;
 }
 
+static int block_pba_cmp(const void *a, const void *b)
+{
+	block_t *b1 = *((block_t **) a);
+	block_t *b2 = *((block_t **) b);
+
+	if (b1->pba < b2->pba)
+		return -1;
+	if (b1->pba > b2->pba)
+		return 1;
+	return 0;
+}
+
+/** Collect unused dirty blocks of a free list to be written back.
+ *
+ * Should be called only with the shard lock held. The collected blocks
+ * are taken off the free list, referenced and locked.
+ *
+ * @param list		Free list to scan.
+ * @param batch		Array for storing the collected blocks.
+ * @param count		Number of blocks collected so far.
+ * @param skipped	Counter of dirty blocks which could not be collected.
+ *
+ * @return		Number of blocks collected so far.
+ */
+static unsigned cache_flush_collect_list(list_t *list, block_t **batch,
+    unsigned count, unsigned *skipped)
+{
+	list_foreach_safe(*list, cur, next) {
+		block_t *b = list_get_instance(cur, block_t, free_link);
+
+		if (!b->dirty)
+			continue;
+
+		if ((count == CACHE_FLUSH_BATCH) ||
+		    !fibril_mutex_trylock(&b->lock)) {
+			(*skipped)++;
+			continue;
+		}
+
+		if (!b->dirty) {
+			fibril_mutex_unlock(&b->lock);
+			continue;
+		}
+
+		list_remove(&b->free_link);
+		b->refcnt++;
+		batch[count++] = b;
+	}
+
+	return count;
+}
+
+/** Collect unused dirty blocks to be written back.
+ *
+ * @param cache		Block cache.
+ * @param batch		Array for storing the collected blocks.
+ *
+ * @return		Number of collected blocks.
+ */
+static unsigned cache_flush_collect(cache_t *cache, block_t **batch)
+{
+	unsigned count = 0;
+	unsigned skipped = 0;
+
+	for (unsigned i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		fibril_mutex_lock(&shard->lock);
+		count = cache_flush_collect_list(&shard->free_in, batch, count,
+		    &skipped);
+		count = cache_flush_collect_list(&shard->free_am, batch, count,
+		    &skipped);
+		fibril_mutex_unlock(&shard->lock);
+	}
+
+	atomic_store(&cache->dirty_hint, skipped);
+	return count;
+}
+
+/** Write back collected dirty blocks.
+ *
+ * Blocks with contiguous physical addresses are written by a single
+ * request. The blocks are unlocked when done.
+ *
+ * @param devcon	Device connection.
+ * @param batch		Collected blocks.
+ * @param count		Number of collected blocks.
+ *
+ * @return		Number of blocks written back.
+ */
+static unsigned cache_flush_write(devcon_t *devcon, block_t **batch,
+    unsigned count)
+{
+	cache_t *cache = devcon->cache;
+	size_t size = cache->lblock_size;
+	unsigned written = 0;
+
+	qsort(batch, count, sizeof(block_t *), block_pba_cmp);
+
+	unsigned i = 0;
+	while (i < count) {
+		unsigned n = 1;
+		while ((i + n < count) && (batch[i + n]->pba ==
+		    batch[i + n - 1]->pba + cache->blocks_cluster))
+			n++;
+
+		void *buf = NULL;
+		if (n > 1) {
+			buf = malloc(n * size);
+			if (!buf)
+				n = 1;
+		}
+
+		errno_t rc;
+		if (buf) {
+			for (unsigned j = 0; j < n; j++)
+				memcpy(buf + j * size, batch[i + j]->data, size);
+			rc = write_blocks(devcon, batch[i]->pba,
+			    n * cache->blocks_cluster, buf, n * size);
+			free(buf);
+		} else {
+			rc = write_blocks(devcon, batch[i]->pba,
+			    cache->blocks_cluster, batch[i]->data, size);
+		}
+
+		if (rc == EOK)
+			written += n;
+
+		for (unsigned j = 0; j < n; j++) {
+			block_t *b = batch[i + j];
+
+			if (rc == EOK) {
+				b->write_failures = 0;
+				b->dirty = false;
+			} else if (++b->write_failures >= MAX_WRITE_RETRIES) {
+				printf("Too many errors writing block %"
+				    PRIuOFF64 "from device handle %" PRIun "\n"
+				    "SEVERE DATA LOSS POSSIBLE\n",
+				    b->lba, devcon->service_id);
+				b->dirty = false;
+			}
+
+			fibril_mutex_unlock(&b->lock);
+		}
+
+		i += n;
+	}
+
+	return written;
+}
+
+/** Return written back blocks to the free lists.
+ *
+ * @param cache		Block cache.
+ * @param batch		Written back blocks.
+ * @param count		Number of written back blocks.
+ */
+static void cache_flush_release(cache_t *cache, block_t **batch,
+    unsigned count)
+{
+	for (unsigned i = 0; i < count; i++) {
+		block_t *b = batch[i];
+		cache_shard_t *shard = cache_shard(cache, b->lba);
+
+		fibril_mutex_lock(&shard->lock);
+		fibril_mutex_lock(&b->lock);
+		if (--b->refcnt == 0) {
+			list_append(&b->free_link, cache_free_list(shard, b));
+			if (b->dirty)
+				cache_dirty_inc(cache, false);
+		}
+		fibril_mutex_unlock(&b->lock);
+		fibril_mutex_unlock(&shard->lock);
+	}
+}
+
+/** Write-back flusher fibril.
+ *
+ * Periodically writes back unused dirty blocks of a write-back cache,
+ * or earlier if there are too many of them.
+ *
+ * @param arg		Device connection.
+ *
+ * @return		EOK.
+ */
+static errno_t cache_flusher(void *arg)
+{
+	devcon_t *devcon = (devcon_t *) arg;
+	cache_t *cache = devcon->cache;
+	block_t *batch[CACHE_FLUSH_BATCH];
+	bool idle = true;
+
+	fibril_mutex_lock(&cache->lock);
+	while (!cache->flusher_stop) {
+		if (idle || (atomic_load(&cache->dirty_hint) <
+		    atomic_load(&cache->dirty_bg))) {
+			(void) fibril_condvar_wait_timeout(&cache->flush_cv,
+			    &cache->lock, cache->flush_interval);
+			if (cache->flusher_stop)
+				break;
+		}
+		fibril_mutex_unlock(&cache->lock);
+
+		unsigned written = 0;
+		unsigned count = cache_flush_collect(cache, batch);
+		if (count > 0) {
+			written = cache_flush_write(devcon, batch, count);
+			cache_flush_release(cache, batch, count);
+		}
+
+		fibril_mutex_lock(&cache->lock);
+		cache->writebacks += written;
+		idle = (count == 0);
+	}
+
+	cache->flusher_running = false;
+	fibril_condvar_broadcast(&cache->flush_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
 /** Read sequential data from a block device.
  *
  * @param service_id	Service ID of the block device.
@@ -787,6 +1656,222 @@ errno_t block_write_direct(service_id_t service_id, aoff64_t ba, size_t cnt,
 	return write_blocks(devcon, ba, cnt, (void *)data, devcon->pblock_size * cnt);
 }
 
+/** Look up a cached block and lock it.
+ *
+ * @param cache		Block cache.
+ * @param ba		Logical block address.
+ *
+ * @return		Locked block or NULL if the block is not cached.
+ */
+static block_t *cache_lookup_lock(cache_t *cache, aoff64_t ba)
+{
+	cache_shard_t *shard = cache_shard(cache, ba);
+	block_t *b = NULL;
+
+	fibril_mutex_lock(&shard->lock);
+	ht_link_t *hlink = hash_table_find(&shard->block_hash, &ba);
+	if (hlink) {
+		b = hash_table_get_inst(hlink, block_t, hash_link);
+		fibril_mutex_lock(&b->lock);
+	}
+	fibril_mutex_unlock(&shard->lock);
+
+	return b;
+}
+
+/** Copy a cached block out of the cache.
+ *
+ * @param cache		Block cache.
+ * @param ba		Address of the block (logical).
+ * @param buf		Buffer for storing the data.
+ *
+ * @return		True if the block is cached and its data is valid.
+ */
+static bool cache_read_block(cache_t *cache, aoff64_t ba, void *buf)
+{
+	block_t *b = cache_lookup_lock(cache, ba);
+	bool valid;
+
+	if (!b)
+		return false;
+
+	/*
+	 * The block lock is held by block_get() while the block is
+	 * being read in, so the data is valid unless the block is
+	 * toxic or it has been got without reading it and its owner
+	 * may still be filling it in. In that case, the caller reads
+	 * the block from the device.
+	 */
+	valid = !b->toxic && !b->filling;
+	if (valid)
+		memcpy(buf, b->data, cache->lblock_size);
+	fibril_mutex_unlock(&b->lock);
+
+	return valid;
+}
+
+/** Check whether a block is present in the cache. */
+static bool cache_has_block(cache_t *cache, aoff64_t ba)
+{
+	cache_shard_t *shard = cache_shard(cache, ba);
+	bool found;
+
+	fibril_mutex_lock(&shard->lock);
+	found = hash_table_find(&shard->block_hash, &ba) != NULL;
+	fibril_mutex_unlock(&shard->lock);
+
+	return found;
+}
+
+/** Read a range of logical blocks coherently with the block cache.
+ *
+ * Blocks which are present in the cache are copied from it, possibly with
+ * modifications which have not been written back yet. Each run of blocks
+ * missing in the cache is read from the device by a single request. The
+ * blocks which are not cached are not brought into the cache.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ba		Address of first block (logical).
+ * @param cnt		Number of blocks.
+ * @param buf		Buffer for storing the data.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_read_range(service_id_t service_id, aoff64_t ba, size_t cnt,
+    void *buf)
+{
+	devcon_t *devcon;
+	cache_t *cache;
+	size_t lbs;
+	errno_t rc;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+	cache = devcon->cache;
+	assert(cache);
+	lbs = cache->lblock_size;
+
+	if (ba_ltop(devcon, ba + cnt) > devcon->pblocks)
+		return EIO;
+
+	size_t i = 0;
+	while (i < cnt) {
+		if (cache_read_block(cache, ba + i, buf + i * lbs)) {
+			i++;
+			continue;
+		}
+
+		/* Find the run of blocks missing in the cache */
+		size_t n = 1;
+		while (i + n < cnt && !cache_has_block(cache, ba + i + n))
+			n++;
+
+		rc = read_blocks(devcon, ba_ltop(devcon, ba + i),
+		    n * cache->blocks_cluster, buf + i * lbs, n * lbs);
+		if (rc != EOK)
+			return rc;
+
+		/*
+		 * The blocks may have been brought into the cache and
+		 * modified while we were reading them.
+		 */
+		for (size_t j = i; j < i + n; j++)
+			(void) cache_read_block(cache, ba + j, buf + j * lbs);
+
+		i += n;
+	}
+
+	return EOK;
+}
+
+/** Copy new data of a block into its cached copy.
+ *
+ * @param cache		Block cache.
+ * @param ba		Address of the block (logical).
+ * @param data		New data of the block.
+ * @param written	If false, the data is about to be written to the
+ *			device and the cached copy is updated, dirty or not.
+ *			If true, the data has been written. A clean cached
+ *			copy is updated and a dirty one which still holds the
+ *			data is marked clean.
+ */
+static void cache_write_block(cache_t *cache, aoff64_t ba, const void *data,
+    bool written)
+{
+	block_t *b = cache_lookup_lock(cache, ba);
+
+	if (!b)
+		return;
+
+	if (!b->toxic) {
+		if (!written || !b->dirty) {
+			memcpy(b->data, data, cache->lblock_size);
+		} else if (memcmp(b->data, data, cache->lblock_size) == 0) {
+			b->dirty = false;
+			if (b->refcnt == 0)
+				cache_dirty_dec(cache);
+		}
+	}
+	fibril_mutex_unlock(&b->lock);
+}
+
+/** Write a range of logical blocks coherently with the block cache.
+ *
+ * Blocks which are present in the cache are updated with the new data
+ * before the whole range is written to the device by a single request.
+ * Doing it in this order guarantees that the write-back of an older
+ * version of a block cannot overwrite the data written here. Dirty blocks
+ * are marked clean only once the write has succeeded, unless they have
+ * been modified in the meantime. If the write fails, they are written
+ * back later.
+ *
+ * A block may also enter the cache while the range is being written, e.g.
+ * by read-ahead, and hold the old contents of the device. Therefore the
+ * clean cached copies are updated once more after the write completes.
+ * The blocks which are not cached are not brought into the cache.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ba		Address of first block (logical).
+ * @param cnt		Number of blocks.
+ * @param data		The data to be written.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_write_range(service_id_t service_id, aoff64_t ba, size_t cnt,
+    const void *data)
+{
+	devcon_t *devcon;
+	cache_t *cache;
+	size_t lbs;
+	errno_t rc;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+	cache = devcon->cache;
+	assert(cache);
+	lbs = cache->lblock_size;
+
+	if (ba_ltop(devcon, ba + cnt) > devcon->pblocks)
+		return EIO;
+
+	for (size_t i = 0; i < cnt; i++)
+		cache_write_block(cache, ba + i, data + i * lbs, false);
+
+	rc = write_blocks(devcon, ba_ltop(devcon, ba),
+	    cnt * cache->blocks_cluster, (void *) data, cnt * lbs);
+
+	/*
+	 * Refresh the blocks cached while the device was being written and
+	 * mark clean the dirty blocks which hold the written data.
+	 */
+	if (rc == EOK) {
+		for (size_t i = 0; i < cnt; i++)
+			cache_write_block(cache, ba + i, data + i * lbs, true);
+	}
+
+	return rc;
+}
+
 /** Synchronize blocks to persistent storage.
  *
  * @param service_id	Service ID of the block device.
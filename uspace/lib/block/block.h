@@ -44,6 +44,7 @@
 #include <adt/hash_table.h>
 #include <adt/list.h>
 #include <loc.h>
+#include <vfs/vfs.h>
 
 /*
  * Flags that can be used with block_get().
@@ -70,6 +71,11 @@ typedef struct block {
 	bool dirty;
 	/** If true, the blcok does not contain valid data. */
 	bool toxic;
+	/**
+	 * If true, the block has been instantiated without reading it and
+	 * its contents are not valid until the last reference is put.
+	 */
+	bool filling;
 	/** Readers / Writer lock protecting the contents of the block. */
 	fibril_rwlock_t contents_lock;
 	/** Service ID of service providing the block device. */
@@ -86,6 +92,8 @@ typedef struct block {
 	link_t free_link;
 	/** Link for placing the block into the block hash table. */
 	ht_link_t hash_link;
+	/** Replacement queue of the block. */
+	unsigned queue;
 	/** Buffer with the block data. */
 	void *data;
 } block_t;
@@ -98,6 +106,20 @@ enum cache_mode {
 	CACHE_MODE_WB
 };
 
+/** Block cache statistics */
+typedef struct {
+	/** Number of requests satisfied from the cache. */
+	uint64_t hits;
+	/** Number of requests which had to instantiate the block. */
+	uint64_t misses;
+	/** Number of blocks evicted to make room for other blocks. */
+	uint64_t evictions;
+	/** Number of blocks read ahead. */
+	uint64_t readahead;
+	/** Number of blocks written back by the flusher. */
+	uint64_t writebacks;
+} block_cache_stats_t;
+
 extern errno_t block_init(service_id_t, size_t);
 extern void block_fini(service_id_t);
 
@@ -106,6 +128,10 @@ extern void *block_bb_get(service_id_t);
 
 extern errno_t block_cache_init(service_id_t, size_t, unsigned, enum cache_mode);
 extern errno_t block_cache_fini(service_id_t);
+extern errno_t block_cache_set_writeback(service_id_t, unsigned, unsigned,
+    usec_t);
+extern errno_t block_cache_get_stats(service_id_t, block_cache_stats_t *);
+extern errno_t block_cache_statfs(service_id_t, vfs_statfs_t *);
 
 extern errno_t block_get(block_t **, service_id_t, aoff64_t, int);
 extern errno_t block_put(block_t *);
@@ -119,6 +145,9 @@ extern errno_t block_read_toc(service_id_t, uint8_t, void *, size_t);
 extern errno_t block_read_direct(service_id_t, aoff64_t, size_t, void *);
 extern errno_t block_read_bytes_direct(service_id_t, aoff64_t, size_t, void *);
 extern errno_t block_write_direct(service_id_t, aoff64_t, size_t, const void *);
+extern errno_t block_read_range(service_id_t, aoff64_t, size_t, void *);
+extern errno_t block_write_range(service_id_t, aoff64_t, size_t,
+    const void *);
 extern errno_t block_sync_cache(service_id_t, aoff64_t, size_t);
 
 #endif
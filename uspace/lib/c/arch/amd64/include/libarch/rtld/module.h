@@ -36,10 +36,17 @@
 #define _LIBC_amd64_RTLD_MODULE_H_
 
 #include <elf/elf_mod.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /** ELF module load flags */
 #define RTLD_MODULE_LDF 0
 
+struct module;
+
+extern void __rtld_lazy_entry(void);
+extern uintptr_t rtld_lazy_bind(struct module *, size_t);
+
 #endif
 
 /** @}
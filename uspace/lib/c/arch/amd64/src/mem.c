@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Memory copy and fill routines for amd64
+ *
+ * Blocks are handled according to their size:
+ *
+ *  - up to 16 bytes by two possibly overlapping scalar moves,
+ *  - up to 128 bytes by loading the whole block into SSE registers
+ *    (head and tail vectors may overlap) and then storing it,
+ *  - larger blocks by a loop of aligned 64-byte SSE stores, or by
+ *    rep movsb/stosb when the CPU supports enhanced rep movsb/stosb
+ *    (ERMS) and the block is large enough for the string instruction
+ *    startup cost to pay off.
+ *
+ * Since blocks of up to 128 bytes are loaded in full before being stored,
+ * these size classes are safe for overlapping memmove() as well.
+ *
+ * AVX is not used since the kernel only preserves the SSE register state.
+ */
+
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../../generic/private/cc.h"
+
+/** Minimum size of a block to be moved using rep movsb/stosb */
+#define MEM_REP_THRESHOLD  2048
+
+/** CPUID.(EAX=7,ECX=0):EBX Enhanced rep movsb/stosb */
+#define CPUID_EBX_ERMS  (1 << 9)
+
+enum {
+	/** CPU features have been detected */
+	mem_feat_valid = 1,
+	/** Enhanced rep movsb/stosb */
+	mem_feat_erms = 2
+};
+
+/*
+ * Note that no function pointers are used for the dispatch as memcpy()
+ * can be called before relocations have been processed.
+ */
+static atomic_int mem_features;
+
+typedef struct {
+	uint64_t v;
+} __attribute__((packed)) unaligned64_t;
+
+typedef struct {
+	uint32_t v;
+} __attribute__((packed)) unaligned32_t;
+
+typedef struct {
+	uint16_t v;
+} __attribute__((packed)) unaligned16_t;
+
+static int mem_features_detect(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	int features = mem_feat_valid;
+
+	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 &&
+	    (ebx & CPUID_EBX_ERMS) != 0)
+		features |= mem_feat_erms;
+
+	atomic_store_explicit(&mem_features, features, memory_order_relaxed);
+	return features;
+}
+
+static inline bool mem_have_erms(void)
+{
+	int features = atomic_load_explicit(&mem_features,
+	    memory_order_relaxed);
+
+	if (features == 0)
+		features = mem_features_detect();
+
+	return (features & mem_feat_erms) != 0;
+}
+
+static inline __m128i load16(const uint8_t *s)
+{
+	return _mm_loadu_si128((const __m128i *) s);
+}
+
+static inline void store16(uint8_t *d, __m128i v)
+{
+	_mm_storeu_si128((__m128i *) d, v);
+}
+
+/** Move up to 16 bytes. Overlapping blocks are allowed. */
+static inline void move_small(uint8_t *d, const uint8_t *s, size_t n)
+{
+	if (n >= 8) {
+		uint64_t a = ((const unaligned64_t *) s)->v;
+		uint64_t b = ((const unaligned64_t *) (s + n - 8))->v;
+		((unaligned64_t *) d)->v = a;
+		((unaligned64_t *) (d + n - 8))->v = b;
+	} else if (n >= 4) {
+		uint32_t a = ((const unaligned32_t *) s)->v;
+		uint32_t b = ((const unaligned32_t *) (s + n - 4))->v;
+		((unaligned32_t *) d)->v = a;
+		((unaligned32_t *) (d + n - 4))->v = b;
+	} else if (n >= 2) {
+		uint16_t a = ((const unaligned16_t *) s)->v;
+		uint16_t b = ((const unaligned16_t *) (s + n - 2))->v;
+		((unaligned16_t *) d)->v = a;
+		((unaligned16_t *) (d + n - 2))->v = b;
+	} else if (n == 1) {
+		*d = *s;
+	}
+}
+
+/** Move 17 to 128 bytes. Overlapping blocks are allowed. */
+static inline void move_medium(uint8_t *d, const uint8_t *s, size_t n)
+{
+	if (n <= 32) {
+		__m128i a = load16(s);
+		__m128i b = load16(s + n - 16);
+		store16(d, a);
+		store16(d + n - 16, b);
+	} else if (n <= 64) {
+		__m128i a = load16(s);
+		__m128i b = load16(s + 16);
+		__m128i c = load16(s + n - 32);
+		__m128i e = load16(s + n - 16);
+		store16(d, a);
+		store16(d + 16, b);
+		store16(d + n - 32, c);
+		store16(d + n - 16, e);
+	} else {
+		__m128i a0 = load16(s);
+		__m128i a1 = load16(s + 16);
+		__m128i a2 = load16(s + 32);
+		__m128i a3 = load16(s + 48);
+		__m128i b0 = load16(s + n - 64);
+		__m128i b1 = load16(s + n - 48);
+		__m128i b2 = load16(s + n - 32);
+		__m128i b3 = load16(s + n - 16);
+		store16(d, a0);
+		store16(d + 16, a1);
+		store16(d + 32, a2);
+		store16(d + 48, a3);
+		store16(d + n - 64, b0);
+		store16(d + n - 48, b1);
+		store16(d + n - 32, b2);
+		store16(d + n - 16, b3);
+	}
+}
+
+/** Move more than 128 bytes forwards.
+ *
+ * The destination may overlap the source if it starts below it. The head
+ * and tail of the source are loaded before anything is stored and written
+ * last, the rest is moved by aligned 64-byte stores.
+ */
+static void move_forward(uint8_t *d, const uint8_t *s, size_t n)
+{
+	__m128i head = load16(s);
+	__m128i t0 = load16(s + n - 64);
+	__m128i t1 = load16(s + n - 48);
+	__m128i t2 = load16(s + n - 32);
+	__m128i t3 = load16(s + n - 16);
+
+	size_t skip = 16 - ((uintptr_t) d & 15);
+	uint8_t *dp = d + skip;
+	const uint8_t *sp = s + skip;
+	size_t left = n - skip;
+
+	while (left > 64) {
+		__m128i v0 = load16(sp);
+		__m128i v1 = load16(sp + 16);
+		__m128i v2 = load16(sp + 32);
+		__m128i v3 = load16(sp + 48);
+		_mm_store_si128((__m128i *) dp, v0);
+		_mm_store_si128((__m128i *) (dp + 16), v1);
+		_mm_store_si128((__m128i *) (dp + 32), v2);
+		_mm_store_si128((__m128i *) (dp + 48), v3);
+		dp += 64;
+		sp += 64;
+		left -= 64;
+	}
+
+	store16(d + n - 64, t0);
+	store16(d + n - 48, t1);
+	store16(d + n - 32, t2);
+	store16(d + n - 16, t3);
+	store16(d, head);
+}
+
+/** Move more than 128 bytes backwards.
+ *
+ * The destination may overlap the source if it starts above it. This is
+ * the mirror image of move_forward().
+ */
+static void move_backward(uint8_t *d, const uint8_t *s, size_t n)
+{
+	__m128i tail = load16(s + n - 16);
+	__m128i h0 = load16(s);
+	__m128i h1 = load16(s + 16);
+	__m128i h2 = load16(s + 32);
+	__m128i h3 = load16(s + 48);
+
+	size_t skip = (uintptr_t) (d + n) & 15;
+	uint8_t *dp = d + n - skip;
+	const uint8_t *sp = s + n - skip;
+	size_t left = n - skip;
+
+	while (left > 64) {
+		dp -= 64;
+		sp -= 64;
+		left -= 64;
+
+		__m128i v0 = load16(sp);
+		__m128i v1 = load16(sp + 16);
+		__m128i v2 = load16(sp + 32);
+		__m128i v3 = load16(sp + 48);
+		_mm_store_si128((__m128i *) dp, v0);
+		_mm_store_si128((__m128i *) (dp + 16), v1);
+		_mm_store_si128((__m128i *) (dp + 32), v2);
+		_mm_store_si128((__m128i *) (dp + 48), v3);
+	}
+
+	store16(d, h0);
+	store16(d + 16, h1);
+	store16(d + 32, h2);
+	store16(d + 48, h3);
+	store16(d + n - 16, tail);
+}
+
+static inline void rep_movsb(void *d, const void *s, size_t n)
+{
+	asm volatile (
+	    "rep movsb\n"
+	    : "+D" (d), "+S" (s), "+c" (n)
+	    :
+	    : "memory"
+	);
+}
+
+static inline void rep_stosb(void *d, int c, size_t n)
+{
+	asm volatile (
+	    "rep stosb\n"
+	    : "+D" (d), "+c" (n)
+	    : "a" (c)
+	    : "memory"
+	);
+}
+
+/** Fill memory block with a constant value. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memset(void *dest, int b, size_t n)
+{
+	uint8_t *d = dest;
+
+	if (n < 16) {
+		uint64_t pattern = UINT64_C(0x0101010101010101) * (uint8_t) b;
+
+		if (n >= 8) {
+			((unaligned64_t *) d)->v = pattern;
+			((unaligned64_t *) (d + n - 8))->v = pattern;
+		} else if (n >= 4) {
+			((unaligned32_t *) d)->v = pattern;
+			((unaligned32_t *) (d + n - 4))->v = pattern;
+		} else if (n >= 2) {
+			((unaligned16_t *) d)->v = pattern;
+			((unaligned16_t *) (d + n - 2))->v = pattern;
+		} else if (n == 1) {
+			*d = b;
+		}
+
+		return dest;
+	}
+
+	__m128i v = _mm_set1_epi8((char) b);
+
+	if (n <= 32) {
+		store16(d, v);
+		store16(d + n - 16, v);
+		return dest;
+	}
+
+	if (n <= 64) {
+		store16(d, v);
+		store16(d + 16, v);
+		store16(d + n - 32, v);
+		store16(d + n - 16, v);
+		return dest;
+	}
+
+	if (n >= MEM_REP_THRESHOLD && mem_have_erms()) {
+		rep_stosb(d, b, n);
+		return dest;
+	}
+
+	store16(d, v);
+
+	uint8_t *dp = d + 16 - ((uintptr_t) d & 15);
+	size_t left = d + n - dp;
+
+	while (left > 64) {
+		_mm_store_si128((__m128i *) dp, v);
+		_mm_store_si128((__m128i *) (dp + 16), v);
+		_mm_store_si128((__m128i *) (dp + 32), v);
+		_mm_store_si128((__m128i *) (dp + 48), v);
+		dp += 64;
+		left -= 64;
+	}
+
+	store16(d + n - 64, v);
+	store16(d + n - 48, v);
+	store16(d + n - 32, v);
+	store16(d + n - 16, v);
+
+	return dest;
+}
+
+/** Copy memory block. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memcpy(void *dst, const void *src, size_t n)
+{
+	if (n <= 16)
+		move_small(dst, src, n);
+	else if (n <= 128)
+		move_medium(dst, src, n);
+	else if (n >= MEM_REP_THRESHOLD && mem_have_erms())
+		rep_movsb(dst, src, n);
+	else
+		move_forward(dst, src, n);
+
+	return dst;
+}
+
+/** Move memory block with possible overlapping. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memmove(void *dst, const void *src, size_t n)
+{
+	uintptr_t d = (uintptr_t) dst;
+	uintptr_t s = (uintptr_t) src;
+
+	if (n <= 16) {
+		move_small(dst, src, n);
+	} else if (n <= 128) {
+		move_medium(dst, src, n);
+	} else if (d - s >= n) {
+		/* Destination does not start within the source */
+		if (s - d >= n)
+			return memcpy(dst, src, n);
+		move_forward(dst, src, n);
+	} else {
+		move_backward(dst, src, n);
+	}
+
+	return dst;
+}
+
+/** @}
+ */
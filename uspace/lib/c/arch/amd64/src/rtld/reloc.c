@@ -39,14 +39,44 @@
 #include <stdlib.h>
 
 #include <libarch/rtld/elf_dyn.h>
+#include <libarch/rtld/module.h>
 #include <rtld/symbol.h>
 #include <rtld/rtld.h>
 #include <rtld/rtld_debug.h>
 #include <rtld/rtld_arch.h>
 
+/** Prepare a module for lazy PLT binding.
+ *
+ * GOT[1] and GOT[2] are reserved for the dynamic linker. PLT0 pushes GOT[1]
+ * and jumps to GOT[2], so we store the module pointer and the address of
+ * the lazy binding entry point there.
+ *
+ * The entry point is looked up by name so that it is the copy in the
+ * libc the program runs with. The module that defines it must itself be
+ * bound eagerly, otherwise resolving a PLT entry would recurse.
+ */
 void module_process_pre_arch(module_t *m)
 {
-	/* Unused */
+	elf_symbol_t *sym;
+	module_t *dm;
+	uintptr_t *got;
+
+	m->lazy = false;
+
+	if (m->dyn.bind_now || m->dyn.plt_got == NULL ||
+	    m->dyn.jmp_rel == NULL)
+		return;
+
+	sym = symbol_def_find("__rtld_lazy_entry", m, ssf_noexec, &dm);
+	if (sym == NULL || dm == m)
+		return;
+
+	got = m->dyn.plt_got;
+	got[1] = (uintptr_t) m;
+	got[2] = (uintptr_t) symbol_get_addr(sym, dm, NULL);
+	m->lazy = true;
+
+	DPRINTF("module '%s' uses lazy PLT binding\n", m->dyn.soname);
 }
 
 /**
@@ -116,6 +146,16 @@ void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 		r_ptr = (uintptr_t *)(r_offset + m->bias);
 		r_ptr32 = (uint32_t *)r_ptr;
 
+		if (rel_type == R_X86_64_JUMP_SLOT && m->lazy) {
+			/*
+			 * Leave the symbol unresolved. The GOT entry points
+			 * back into the PLT entry which will call
+			 * __rtld_lazy_entry on first use. Just relocate it.
+			 */
+			*r_ptr += m->bias;
+			continue;
+		}
+
 		if (sym->st_name != 0) {
 			DPRINTF("rel_type: %x, rel_offset: 0x%zx\n", rel_type, r_offset);
 			sym_def = symbol_def_find(str_tab + sym->st_name,
@@ -233,6 +273,48 @@ void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 	}
 }
 
+/** Bind a PLT entry on first call.
+ *
+ * Called from __rtld_lazy_entry.
+ *
+ * @param m Module whose PLT entry is being bound
+ * @param idx Index of the relocation in the PLT relocation table of @a m
+ * @return Address of the function
+ */
+uintptr_t rtld_lazy_bind(module_t *m, size_t idx)
+{
+	elf_rela_t *rela;
+	elf_symbol_t *sym_table;
+	elf_symbol_t *sym;
+	elf_symbol_t *sym_def;
+	module_t *dest;
+	uintptr_t sym_addr;
+	char *name;
+
+	rela = (elf_rela_t *) m->dyn.jmp_rel + idx;
+	sym_table = m->dyn.sym_tab;
+	sym = &sym_table[ELF64_R_SYM(rela->r_info)];
+	name = m->dyn.str_tab + sym->st_name;
+
+	DPRINTF("rtld_lazy_bind('%s', '%s')\n", m->dyn.soname, name);
+
+	/*
+	 * Bypass the symbol cache. It is only updated while modules
+	 * are being loaded and lazy binding can happen in any thread.
+	 */
+	sym_def = symbol_def_find(name, m, ssf_nocache, &dest);
+	if (sym_def == NULL) {
+		printf("Definition of '%s' not found.\n", name);
+		abort();
+	}
+
+	sym_addr = (uintptr_t) symbol_get_addr(sym_def, dest, NULL);
+
+	/* Subsequent calls go directly to the function */
+	*(uintptr_t *)(rela->r_offset + m->bias) = sym_addr;
+	return sym_addr;
+}
+
 /** Get the adress of a function.
  *
  * @param sym Symbol
@@ -27,6 +27,10 @@
  */
 
 #include <adt/checksum.h>
+#include <byteorder.h>
+#include <mem.h>
+#include <stdatomic.h>
+#include "../private/checksum.h"
 
 /**
  * 256-value table of precomputed polynomials for CRC32. Note
@@ -102,6 +106,109 @@ uint32_t poly_table[256] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
+/*
+ * Unaligned word access. Note that libc is built with -fno-builtin, so
+ * memcpy() cannot be used for this purpose without a function call.
+ */
+typedef struct {
+	uint64_t v;
+} __attribute__((packed)) unaligned64_t;
+
+typedef struct {
+	uint32_t v;
+} __attribute__((packed)) unaligned32_t;
+
+typedef struct {
+	uint16_t v;
+} __attribute__((packed)) unaligned16_t;
+
+/** Slicing-by-8 tables, crc32_table[0] is a copy of poly_table */
+static uint32_t crc32_table[8][256];
+
+typedef uint32_t (*crc32_update_t)(uint32_t, const uint8_t *, size_t);
+
+static uint32_t crc32_update_init(uint32_t, const uint8_t *, size_t);
+
+/** CRC32 implementation selected on first use */
+static _Atomic(crc32_update_t) crc32_update = crc32_update_init;
+
+/** Architecture CRC32 routine for long blocks or @c NULL */
+static crc32_bulk_t crc32_bulk;
+
+/** Update CRC state eight bytes at a time. */
+static uint32_t crc32_update_slice8(uint32_t crc, const uint8_t *data,
+    size_t length)
+{
+	uint32_t lo;
+	uint32_t hi;
+
+	while (length >= 8) {
+		lo = uint32_t_le2host(((const unaligned32_t *) data)->v) ^ crc;
+		hi = uint32_t_le2host(((const unaligned32_t *) data)[1].v);
+
+		crc = crc32_table[7][lo & 0xff] ^
+		    crc32_table[6][(lo >> 8) & 0xff] ^
+		    crc32_table[5][(lo >> 16) & 0xff] ^
+		    crc32_table[4][lo >> 24] ^
+		    crc32_table[3][hi & 0xff] ^
+		    crc32_table[2][(hi >> 8) & 0xff] ^
+		    crc32_table[1][(hi >> 16) & 0xff] ^
+		    crc32_table[0][hi >> 24];
+
+		data += 8;
+		length -= 8;
+	}
+
+	for (; length > 0; length--)
+		crc = crc32_table[0][(uint8_t) crc ^ *(data++)] ^ (crc >> 8);
+
+	return crc;
+}
+
+/** Update CRC state using the architecture routine for the bulk of data. */
+static uint32_t crc32_update_arch(uint32_t crc, const uint8_t *data,
+    size_t length)
+{
+	if (length >= CRC32_BULK_MIN) {
+		size_t bulk = length & ~((size_t) CRC32_BULK_ALIGN - 1);
+
+		crc = crc32_bulk(crc, data, bulk);
+		data += bulk;
+		length -= bulk;
+	}
+
+	return crc32_update_slice8(crc, data, length);
+}
+
+/** Prepare tables and select CRC32 implementation.
+ *
+ * Concurrent callers may race to perform the initialization, but they
+ * all store the same values.
+ */
+static uint32_t crc32_update_init(uint32_t crc, const uint8_t *data,
+    size_t length)
+{
+	crc32_update_t update = crc32_update_slice8;
+
+	memcpy(crc32_table[0], poly_table, sizeof(crc32_table[0]));
+	for (unsigned i = 0; i < 256; i++) {
+		for (unsigned j = 1; j < 8; j++) {
+			uint32_t prev = crc32_table[j - 1][i];
+			crc32_table[j][i] = (prev >> 8) ^
+			    crc32_table[0][prev & 0xff];
+		}
+	}
+
+#ifdef LIBC_ARCH_CHECKSUM
+	crc32_bulk = __crc32_arch_bulk();
+	if (crc32_bulk != NULL)
+		update = crc32_update_arch;
+#endif
+
+	atomic_store_explicit(&crc32_update, update, memory_order_release);
+	return update(crc, data, length);
+}
+
 /** Compute CRC32 value.
  *
  * See wiki.osdev.org/CRC32 for reference.
@@ -134,12 +241,171 @@ uint32_t compute_crc32(uint8_t *data, size_t length)
  */
 uint32_t compute_crc32_seed(uint8_t *data, size_t length, uint32_t seed)
 {
-	uint32_t crc;
+	crc32_update_t update;
+
+	update = atomic_load_explicit(&crc32_update, memory_order_acquire);
+	return ~update(~seed, data, length);
+}
+
+/** One's complement addition of 64-bit words (with end-around carry). */
+static inline uint64_t inet_csum_add(uint64_t sum, uint64_t w)
+{
+	sum += w;
+	return sum + (sum < w);
+}
+
+/** Fold 64-bit one's complement sum to 16 bits. */
+static inline uint16_t inet_csum_fold(uint64_t sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return sum;
+}
+
+/** Add trailing bytes (less than eight) to one's complement sum. */
+static uint64_t inet_csum_tail(uint64_t sum, const uint8_t *data, size_t size)
+{
+	if (size >= 4) {
+		sum = inet_csum_add(sum, ((const unaligned32_t *) data)->v);
+		data += 4;
+		size -= 4;
+	}
+
+	if (size >= 2) {
+		sum = inet_csum_add(sum, ((const unaligned16_t *) data)->v);
+		data += 2;
+		size -= 2;
+	}
+
+	if (size > 0) {
+		/* Odd byte is padded with zero */
+		sum = inet_csum_add(sum, uint16_t_be2host((uint16_t) *data << 8));
+	}
+
+	return sum;
+}
+
+/** Finish Internet checksum computation.
+ *
+ * @param ivalue Initial value
+ * @param sum    One's complement sum of the data in host byte order
+ */
+static uint16_t inet_csum_finish(uint16_t ivalue, uint64_t sum)
+{
+	uint32_t s;
+
+	/*
+	 * One's complement sum is independent of byte order, so the sum
+	 * of host-order words only needs to be converted once.
+	 */
+	s = (uint16_t) ~ivalue;
+	s += uint16_t_be2host(inet_csum_fold(sum));
+	s = (s & 0xffff) + (s >> 16);
+
+	return ~s;
+}
+
+/** Compute Internet checksum.
+ *
+ * Computes the 16-bit one's complement of the one's complement sum
+ * of the data, taken as big-endian 16-bit words (RFC 1071). An odd
+ * trailing byte is padded with zero. The data is processed eight bytes
+ * at a time.
+ *
+ * To checksum non-contiguous data, pass the result of the previous call
+ * as @a ivalue (all blocks except the last one must have even length).
+ *
+ * @param ivalue Initial value (0xffff for the first block)
+ * @param data   Data to process
+ * @param size   Size of data in bytes
+ *
+ * @return Computed checksum
+ */
+uint16_t compute_inet_checksum(uint16_t ivalue, const void *data, size_t size)
+{
+	const uint8_t *bdata = data;
+	const unaligned64_t *w;
+	uint64_t sum = 0;
+
+	while (size >= 4 * sizeof(uint64_t)) {
+		w = (const unaligned64_t *) bdata;
+		sum = inet_csum_add(sum, w[0].v);
+		sum = inet_csum_add(sum, w[1].v);
+		sum = inet_csum_add(sum, w[2].v);
+		sum = inet_csum_add(sum, w[3].v);
+		bdata += 4 * sizeof(uint64_t);
+		size -= 4 * sizeof(uint64_t);
+	}
+
+	while (size >= sizeof(uint64_t)) {
+		w = (const unaligned64_t *) bdata;
+		sum = inet_csum_add(sum, w->v);
+		bdata += sizeof(uint64_t);
+		size -= sizeof(uint64_t);
+	}
+
+	sum = inet_csum_tail(sum, bdata, size);
+	return inet_csum_finish(ivalue, sum);
+}
+
+/** Copy data and compute its Internet checksum.
+ *
+ * Equivalent to memcpy() followed by compute_inet_checksum(), but reads
+ * the source data only once.
+ *
+ * @param ivalue Initial value (0xffff for the first block)
+ * @param dst    Destination buffer
+ * @param src    Source data
+ * @param size   Size of data in bytes
+ *
+ * @return Computed checksum
+ */
+uint16_t compute_inet_checksum_copy(uint16_t ivalue, void *dst,
+    const void *src, size_t size)
+{
+	const uint8_t *bsrc = src;
+	uint8_t *bdst = dst;
+	const unaligned64_t *sw;
+	unaligned64_t *dw;
+	uint64_t w0, w1, w2, w3;
+	uint64_t sum = 0;
+
+	while (size >= 4 * sizeof(uint64_t)) {
+		sw = (const unaligned64_t *) bsrc;
+		dw = (unaligned64_t *) bdst;
+		w0 = sw[0].v;
+		w1 = sw[1].v;
+		w2 = sw[2].v;
+		w3 = sw[3].v;
+		dw[0].v = w0;
+		dw[1].v = w1;
+		dw[2].v = w2;
+		dw[3].v = w3;
+		sum = inet_csum_add(sum, w0);
+		sum = inet_csum_add(sum, w1);
+		sum = inet_csum_add(sum, w2);
+		sum = inet_csum_add(sum, w3);
+		bsrc += 4 * sizeof(uint64_t);
+		bdst += 4 * sizeof(uint64_t);
+		size -= 4 * sizeof(uint64_t);
+	}
+
+	while (size >= sizeof(uint64_t)) {
+		w0 = ((const unaligned64_t *) bsrc)->v;
+		((unaligned64_t *) bdst)->v = w0;
+		sum = inet_csum_add(sum, w0);
+		bsrc += sizeof(uint64_t);
+		bdst += sizeof(uint64_t);
+		size -= sizeof(uint64_t);
+	}
 
-	for (crc = ~seed; length > 0; length--)
-		crc = poly_table[((uint8_t) crc ^ *(data++))] ^ (crc >> 8);
+	sum = inet_csum_tail(sum, bsrc, size);
+	while (size-- > 0)
+		*bdst++ = *bsrc++;
 
-	return (~crc);
+	return inet_csum_finish(ivalue, sum);
 }
 
 /** @}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+
+/** @file Hashed timer wheel
+ *
+ * The wheel does not keep time by itself, its user is expected to call
+ * twheel_tick() periodically.
+ */
+
+#include <adt/list.h>
+#include <adt/twheel.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+
+/** Initialize timer wheel.
+ *
+ * @param tw Timer wheel
+ * @param nslots Number of slots. Timers set at most @a nslots - 1 ticks
+ *        ahead are visited only once, at their expiration.
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t twheel_init(twheel_t *tw, size_t nslots)
+{
+	size_t i;
+
+	assert(nslots > 0);
+
+	tw->slots = calloc(nslots, sizeof(list_t));
+	if (tw->slots == NULL)
+		return ENOMEM;
+
+	for (i = 0; i < nslots; i++)
+		list_initialize(&tw->slots[i]);
+
+	tw->nslots = nslots;
+	tw->now = 0;
+	return EOK;
+}
+
+/** Finalize timer wheel.
+ *
+ * All timers must have been cleared or must have expired.
+ *
+ * @param tw Timer wheel
+ */
+void twheel_fini(twheel_t *tw)
+{
+	free(tw->slots);
+	tw->slots = NULL;
+}
+
+/** Initialize timer.
+ *
+ * @param timer Timer
+ */
+void twheel_timer_initialize(twheel_timer_t *timer)
+{
+	link_initialize(&timer->link);
+	timer->expires = 0;
+}
+
+/** Determine if timer is set.
+ *
+ * @param timer Timer
+ * @return @c true if timer is set
+ */
+bool twheel_timer_is_set(twheel_timer_t *timer)
+{
+	return link_in_use(&timer->link);
+}
+
+/** Set timer.
+ *
+ * If the timer is already set, it is moved to the new expiration time.
+ *
+ * @param tw Timer wheel
+ * @param timer Timer
+ * @param ticks Number of ticks from now (at least 1)
+ */
+void twheel_set(twheel_t *tw, twheel_timer_t *timer, uint64_t ticks)
+{
+	if (ticks == 0)
+		ticks = 1;
+
+	if (link_in_use(&timer->link))
+		list_remove(&timer->link);
+
+	timer->expires = tw->now + ticks;
+	list_append(&timer->link, &tw->slots[timer->expires % tw->nslots]);
+}
+
+/** Clear timer.
+ *
+ * @param tw Timer wheel
+ * @param timer Timer
+ */
+void twheel_clear(twheel_t *tw, twheel_timer_t *timer)
+{
+	(void) tw;
+
+	if (link_in_use(&timer->link))
+		list_remove(&timer->link);
+}
+
+/** Advance timer wheel by one tick.
+ *
+ * Calls @a expire for each timer that expires at the new time.
+ *
+ * @param tw Timer wheel
+ * @param expire Expiration callback
+ * @param arg Argument to @a expire
+ */
+void twheel_tick(twheel_t *tw, twheel_expire_t expire, void *arg)
+{
+	list_t expired;
+	list_t *slot;
+	link_t *link;
+
+	tw->now++;
+	slot = &tw->slots[tw->now % tw->nslots];
+
+	/*
+	 * Collect expired timers first. The callbacks may then freely set
+	 * or clear any timers, including the ones not yet processed.
+	 */
+	list_initialize(&expired);
+	list_foreach_safe(*slot, cur, next) {
+		twheel_timer_t *timer = list_get_instance(cur, twheel_timer_t,
+		    link);
+
+		if (timer->expires <= tw->now) {
+			list_remove(&timer->link);
+			list_append(&timer->link, &expired);
+		}
+	}
+
+	while ((link = list_first(&expired)) != NULL) {
+		twheel_timer_t *timer = list_get_instance(link, twheel_timer_t,
+		    link);
+
+		list_remove(&timer->link);
+		expire(timer, arg);
+	}
+}
+
+/** @}
+ */
@@ -1346,6 +1346,97 @@ errno_t async_data_write_start(async_exch_t *exch, const void *src, size_t size)
 	    (sysarg_t) size);
 }
 
+/** Send a request together with data using IPC_M_DATA_XFER.
+ *
+ * The request, its inline arguments and the gathered @a out_cnt segments
+ * are delivered to the recipient in a single call. The recipient's reply
+ * data is scattered to the following @a in_cnt segments when the answer
+ * arrives, so they must stay valid until then. The descriptor itself is
+ * consumed by the kernel before this function returns.
+ *
+ * @param exch    Exchange for sending the message.
+ * @param imethod Service-defined interface and method.
+ * @param arg1    Service-defined payload argument.
+ * @param arg2    Service-defined payload argument.
+ * @param iov     Array of @a out_cnt request segments followed by
+ *                @a in_cnt reply segments.
+ * @param out_cnt Number of request segments.
+ * @param in_cnt  Number of reply segments.
+ * @param dataptr Storage of call data (arg 2 holds the reply size,
+ *                arg 3 and arg 4 hold service-defined return values).
+ *
+ * @return Hash of the sent message or 0 on error.
+ *
+ */
+aid_t async_xfer(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
+    sysarg_t arg2, const ipc_iovec_t *iov, size_t out_cnt, size_t in_cnt,
+    ipc_call_t *dataptr)
+{
+	ipc_xfer_t xfer;
+
+	if (out_cnt > IPC_XFER_MAX_IOV || in_cnt > IPC_XFER_MAX_IOV)
+		return 0;
+
+	xfer.out_cnt = out_cnt;
+	xfer.in_cnt = in_cnt;
+	memcpy(xfer.iov, iov, (out_cnt + in_cnt) * sizeof(ipc_iovec_t));
+
+	return async_send_5(exch, IPC_M_DATA_XFER, (sysarg_t) &xfer, imethod,
+	    0, arg1, arg2, dataptr);
+}
+
+/** Wrapper for IPC_M_DATA_XFER calls with one buffer in each direction.
+ *
+ * @param exch     Exchange for sending the message.
+ * @param imethod  Service-defined interface and method.
+ * @param arg1     Service-defined payload argument.
+ * @param arg2     Service-defined payload argument.
+ * @param src      Request data.
+ * @param src_size Size of the request data.
+ * @param dst      Buffer for the reply data.
+ * @param dst_size Size of the reply buffer.
+ * @param received If not NULL, the size of the reply data is stored here.
+ *
+ * @return Zero on success or an error code from errno.h.
+ *
+ */
+errno_t async_xfer_start(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
+    sysarg_t arg2, const void *src, size_t src_size, void *dst,
+    size_t dst_size, size_t *received)
+{
+	ipc_iovec_t iov[2];
+	size_t out_cnt = 0;
+	size_t in_cnt = 0;
+	ipc_call_t answer;
+	errno_t rc;
+
+	if (exch == NULL)
+		return ENOENT;
+
+	if (src_size > 0) {
+		iov[out_cnt].base = (void *) src;
+		iov[out_cnt].size = src_size;
+		out_cnt++;
+	}
+
+	if (dst_size > 0) {
+		iov[out_cnt].base = dst;
+		iov[out_cnt].size = dst_size;
+		in_cnt++;
+	}
+
+	aid_t req = async_xfer(exch, imethod, arg1, arg2, iov, out_cnt, in_cnt,
+	    &answer);
+	if (req == 0)
+		return ENOMEM;
+
+	async_wait_for(req, &rc);
+	if (rc == EOK && received != NULL)
+		*received = ipc_get_arg2(&answer);
+
+	return rc;
+}
+
 errno_t async_state_change_start(async_exch_t *exch, sysarg_t arg1, sysarg_t arg2,
     sysarg_t arg3, async_exch_t *other_exch)
 {
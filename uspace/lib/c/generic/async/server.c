@@ -1515,6 +1515,80 @@ errno_t async_data_write_finalize(ipc_call_t *call, void *dst, size_t size)
 	return async_answer_2(call, EOK, (sysarg_t) dst, (sysarg_t) size);
 }
 
+/** Wrapper for receiving the IPC_M_DATA_XFER calls using the async framework.
+ *
+ * Unlike async_data_write_receive(), this does not wait for a call. It
+ * decodes a call already obtained by the connection fibril and whose
+ * interface and method is IPC_M_DATA_XFER.
+ *
+ * @param call      IPC_M_DATA_XFER call.
+ * @param imethod   Storage for the service-defined interface and method.
+ * @param size      Storage for the size of the request data. May be NULL.
+ * @param max_reply Storage for the maximum size of the reply data.
+ *                  May be NULL.
+ *
+ * @return True on success, false on failure.
+ *
+ */
+bool async_xfer_receive(ipc_call_t *call, sysarg_t *imethod, size_t *size,
+    size_t *max_reply)
+{
+	assert(call);
+
+	if (ipc_get_imethod(call) != IPC_M_DATA_XFER)
+		return false;
+
+	*imethod = ipc_get_arg2(call);
+	if (size)
+		*size = (size_t) ipc_get_arg1(call);
+	if (max_reply)
+		*max_reply = (size_t) ipc_get_arg3(call);
+
+	return true;
+}
+
+/** Copy the request data of an IPC_M_DATA_XFER call.
+ *
+ * The data was already copied by the kernel when the call was sent, so
+ * this does not involve the sender. It can be called repeatedly until
+ * the call is answered.
+ *
+ * @param call IPC_M_DATA_XFER call.
+ * @param dst  Destination buffer.
+ * @param size Size of the destination buffer. Must be at least the size
+ *             of the request data.
+ *
+ * @return Zero on success or a value from @ref errno.h on failure.
+ *
+ */
+errno_t async_xfer_fetch(ipc_call_t *call, void *dst, size_t size)
+{
+	assert(call);
+
+	return ipc_xfer_fetch(call->cap_handle, dst, size);
+}
+
+/** Wrapper for answering the IPC_M_DATA_XFER calls using the async framework.
+ *
+ * @param call IPC_M_DATA_XFER call to answer.
+ * @param src  Reply data.
+ * @param size Size of the reply data. Must not exceed the maximum reply
+ *             size reported by async_xfer_receive().
+ * @param arg1 Service-defined return value.
+ * @param arg2 Service-defined return value.
+ *
+ * @return Zero on success or a value from @ref errno.h on failure.
+ *
+ */
+errno_t async_xfer_finalize(ipc_call_t *call, const void *src, size_t size,
+    sysarg_t arg1, sysarg_t arg2)
+{
+	assert(call);
+
+	return async_answer_4(call, EOK, (sysarg_t) src, (sysarg_t) size,
+	    arg1, arg2);
+}
+
 /** Wrapper for receiving binary data or strings
  *
  * This wrapper only makes it more comfortable to use async_data_write_*
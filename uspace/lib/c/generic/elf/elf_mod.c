@@ -37,15 +37,17 @@
  * @brief	Userspace ELF module loader.
  *
  * This module allows loading ELF binaries (both executables and
- * shared objects) from VFS. The current implementation allocates
- * anonymous memory, fills it with segment data and then adjusts
- * the memory areas' flags to the final value. In the future,
- * the segments will be mapped directly from the file.
+ * shared objects) from VFS. Read-only segments are mapped from the file
+ * through the VFS pager, which caches the file's pages, so that all tasks
+ * running the same binary or library share the physical memory. Other
+ * segments are loaded into anonymous memory, which is filled with the
+ * segment data before the memory areas' flags are set to the final value.
  */
 
 #include <errno.h>
 #include <stdio.h>
 #include <vfs/vfs.h>
+#include <ipc/vfs.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <align.h>
@@ -58,6 +60,9 @@
 #include <str_error.h>
 #include <stdlib.h>
 #include <macros.h>
+#include <async.h>
+#include <ns.h>
+#include <fibril_synch.h>
 
 #include <elf/elf_load.h>
 
@@ -66,6 +71,13 @@
 static errno_t elf_load_module(elf_ld_t *elf);
 static errno_t segment_header(elf_ld_t *elf, elf_segment_header_t *entry);
 static errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry);
+static errno_t elf_file_map(int fd, int *id);
+static void elf_file_unmap(int id);
+
+/** Session to the VFS pager, shared by all loads */
+static async_sess_t *pager_sess;
+/** Protects pager_sess */
+static FIBRIL_MUTEX_INITIALIZE(pager_sess_lock);
 
 /** Load ELF binary from a file.
  *
@@ -98,9 +110,25 @@ errno_t elf_load_file(int file, eld_flags_t flags, elf_finfo_t *info)
 	elf.fd = ofile;
 	elf.info = info;
 	elf.flags = flags;
+	elf.paged = false;
+
+	/*
+	 * Map the file before reading anything from it. VFS does not let
+	 * the file change while it is mapped, so the segments loaded into
+	 * memory and the pages the pager reads later come from the same
+	 * version of the file. If the file cannot be mapped, all segments
+	 * are loaded into memory.
+	 */
+	elf.mapped = (elf_file_map(ofile, &elf.map_id) == EOK);
 
 	rc = elf_load_module(&elf);
 
+	/*
+	 * The mapping keeps the file available to the pager, so our file
+	 * descriptor is not needed any more.
+	 */
+	if (elf.mapped && (rc != EOK || !elf.paged))
+		elf_file_unmap(elf.map_id);
 	vfs_put(ofile);
 	return rc;
 }
@@ -371,6 +399,105 @@ static errno_t segment_header(elf_ld_t *elf, elf_segment_header_t *entry)
 	return EOK;
 }
 
+/** Get session to the VFS pager.
+ *
+ * @return Session or @c NULL if the pager is not available
+ */
+static async_sess_t *elf_pager_sess(void)
+{
+	fibril_mutex_lock(&pager_sess_lock);
+
+	if (pager_sess == NULL) {
+		pager_sess = service_connect(SERVICE_VFS, INTERFACE_PAGER, 0,
+		    NULL);
+	}
+
+	fibril_mutex_unlock(&pager_sess_lock);
+	return pager_sess;
+}
+
+/** Map a file through the VFS pager.
+ *
+ * The mapping lasts until it is unmapped or the task terminates, the file
+ * descriptor can be closed in the meantime. VFS limits the number of files
+ * a task can have mapped.
+ *
+ * @param fd File descriptor of the file
+ * @param id Place to store the mapping ID
+ *
+ * @return EOK on success, error code otherwise.
+ */
+static errno_t elf_file_map(int fd, int *id)
+{
+	async_sess_t *pager;
+	sysarg_t map_id;
+
+	pager = elf_pager_sess();
+	if (pager == NULL)
+		return ENOENT;
+
+	async_exch_t *exch = async_exchange_begin(pager);
+	errno_t rc = async_req_1_1(exch, VFS_PAGER_MAP, fd, &map_id);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*id = (int) map_id;
+	return EOK;
+}
+
+/** Unmap a file mapped through the VFS pager.
+ *
+ * @param id Mapping ID
+ */
+static void elf_file_unmap(int id)
+{
+	async_exch_t *exch = async_exchange_begin(pager_sess);
+	(void) async_req_1_0(exch, VFS_PAGER_UNMAP, id);
+	async_exchange_end(exch);
+}
+
+/** Map a read-only segment from the file.
+ *
+ * The VFS pager hands out the same cached pages to every task that maps
+ * the file, so the segment's physical memory is shared. Any part of the
+ * last page beyond the end of the segment contains the following data
+ * from the file, which is harmless as the area is read-only.
+ *
+ * @param elf	Loader state.
+ * @param entry Program header entry describing segment to be mapped.
+ * @param flags Memory area flags
+ *
+ * @return EOK on success, error code otherwise.
+ */
+static errno_t map_segment(elf_ld_t *elf, elf_segment_header_t *entry,
+    int flags)
+{
+	uintptr_t base;
+	aoff64_t file_base;
+	size_t mem_sz;
+	void *a;
+
+	if (!elf->mapped)
+		return ENOENT;
+
+	base = ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE);
+	file_base = ALIGN_DOWN(entry->p_offset, PAGE_SIZE);
+	mem_sz = entry->p_memsz + (entry->p_vaddr - base);
+
+	a = async_as_area_create((uint8_t *) base + elf->bias, mem_sz, flags,
+	    pager_sess, elf->map_id, file_base, 0);
+	if (a == AS_MAP_FAILED) {
+		DPRINTF("paged mapping failed (%p, %zu)\n",
+		    (void *) (base + elf->bias), mem_sz);
+		return ENOMEM;
+	}
+
+	elf->paged = true;
+	return EOK;
+}
+
 /** Load segment described by program header entry.
  *
  * @param elf	Loader state.
@@ -387,6 +514,7 @@ errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 	void *seg_ptr;
 	uintptr_t seg_addr;
 	size_t mem_sz;
+	size_t file_sz;
 	aoff64_t pos;
 	errno_t rc;
 	size_t nr;
@@ -425,6 +553,19 @@ errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 		flags |= AS_AREA_READ;
 	flags |= AS_AREA_CACHEABLE;
 
+	/*
+	 * Map read-only segments from the file unless the caller wants to
+	 * modify them. If that is not possible, fall back to loading.
+	 * Instruction cache coherence of the pages is taken care of by
+	 * the pager.
+	 */
+	if ((entry->p_flags & PF_W) == 0 && (elf->flags & ELDF_RW) == 0 &&
+	    entry->p_filesz == entry->p_memsz &&
+	    (entry->p_offset % PAGE_SIZE) == (entry->p_vaddr % PAGE_SIZE)) {
+		if (map_segment(elf, entry, flags) == EOK)
+			return EOK;
+	}
+
 	base = ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE);
 	mem_sz = entry->p_memsz + (entry->p_vaddr - base);
 
@@ -434,17 +575,42 @@ errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 
 	/*
 	 * For the course of loading, the area needs to be readable
-	 * and writeable.
+	 * and writeable. The segment data are read in right away,
+	 * so map the pages holding them upfront instead of faulting
+	 * them in. The area is then extended to cover the rest of the
+	 * segment, e.g. .bss, which is faulted in on first use.
 	 */
-	a = as_area_create((uint8_t *) base + bias, mem_sz,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
-	    AS_AREA_UNPAGED);
+	file_sz = 0;
+	if (entry->p_filesz > 0) {
+		file_sz = min((size_t) ALIGN_UP(entry->p_filesz +
+		    (entry->p_vaddr - base), PAGE_SIZE), mem_sz);
+	}
+
+	if (file_sz > 0) {
+		a = as_area_create((uint8_t *) base + bias, file_sz,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE |
+		    AS_AREA_POPULATE, AS_AREA_UNPAGED);
+	} else {
+		a = as_area_create((uint8_t *) base + bias, mem_sz,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+		    AS_AREA_UNPAGED);
+	}
 	if (a == AS_MAP_FAILED) {
 		DPRINTF("memory mapping failed (%p, %zu)\n",
 		    (void *) (base + bias), mem_sz);
 		return ENOMEM;
 	}
 
+	if ((file_sz > 0) && (file_sz < mem_sz)) {
+		rc = as_area_resize(a, mem_sz, 0);
+		if (rc != EOK) {
+			DPRINTF("memory area resize failed (%p, %zu)\n",
+			    (void *) (base + bias), mem_sz);
+			as_area_destroy(a);
+			return ENOMEM;
+		}
+	}
+
 	DPRINTF("as_area_create(%p, %#zx, %d) -> %p\n",
 	    (void *) (base + bias), mem_sz, flags, (void *) a);
 
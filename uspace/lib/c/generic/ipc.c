@@ -239,5 +239,21 @@ errno_t ipc_connect_kbox(task_id_t id, cap_phone_handle_t *phone)
 	return (errno_t) __SYSCALL2(SYS_IPC_CONNECT_KBOX, (sysarg_t) &id, (sysarg_t) phone);
 }
 
+/** Fetch the request payload of a received IPC_M_DATA_XFER call.
+ *
+ * @param chandle Handle of the received call.
+ * @param dst     Destination buffer.
+ * @param size    Size of the destination buffer. Must be at least the size
+ *                of the payload.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t ipc_xfer_fetch(cap_call_handle_t chandle, void *dst, size_t size)
+{
+	return (errno_t) __SYSCALL3(SYS_IPC_XFER_FETCH, cap_handle_raw(chandle),
+	    (sysarg_t) dst, (sysarg_t) size);
+}
+
 /** @}
  */
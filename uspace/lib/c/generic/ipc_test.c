@@ -220,5 +220,44 @@ errno_t ipc_test_share_in_rw(ipc_test_t *test, size_t size, void **rptr)
 	return EOK;
 }
 
+/** Test a request carrying data in both directions.
+ *
+ * The service replies with @a reply_size bytes made of the request data
+ * repeated over and over.
+ *
+ * @param test       IPC test service
+ * @param forward    If true, the service forwards the request to itself
+ *                   before answering it
+ * @param iov        Request segments followed by reply segments
+ * @param out_cnt    Number of request segments
+ * @param in_cnt     Number of reply segments
+ * @param reply_size Number of bytes the service should reply with
+ * @param received   Place to store the size of the reply data
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_xfer(ipc_test_t *test, bool forward, const ipc_iovec_t *iov,
+    size_t out_cnt, size_t in_cnt, size_t reply_size, size_t *received)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	aid_t req;
+	errno_t retval;
+
+	exch = async_exchange_begin(test->sess);
+	req = async_xfer(exch, forward ? IPC_TEST_XFER_FORWARD : IPC_TEST_XFER,
+	    reply_size, 0, iov, out_cnt, in_cnt, &answer);
+	async_exchange_end(exch);
+
+	if (req == 0)
+		return ENOMEM;
+
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	*received = ipc_get_arg2(&answer);
+	return EOK;
+}
+
 /** @}
  */
@@ -45,7 +45,10 @@
 #include <bitops.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <stdatomic.h>
+#include <tls.h>
 #include <adt/gcdlcm.h>
+#include <adt/list.h>
 
 #include "private/malloc.h"
 #include "private/fibril.h"
@@ -59,6 +62,15 @@
 /** Magic used in heap descriptor. */
 #define HEAP_AREA_MAGIC  UINT32_C(0xBEEFCAFE)
 
+/** Magic used in headers of allocated small blocks. */
+#define HEAP_SMALL_MAGIC  UINT32_C(0xBEEF0303)
+
+/** Magic used in headers of cached or free small blocks. */
+#define HEAP_SMALL_FREE_MAGIC  UINT32_C(0xBEEF0404)
+
+/** Magic used in run descriptor. */
+#define HEAP_RUN_MAGIC  UINT32_C(0xBEEF0505)
+
 /** Allocation alignment.
  *
  * This also covers the alignment of fields
@@ -77,6 +89,30 @@
  */
 #define SHRINK_GRANULARITY  (64 * PAGE_SIZE)
 
+/** Largest allocation served by the small block allocator. */
+#define SMALL_MAX  1024
+
+/** Number of small block size classes. */
+#define SMALL_CLASSES  20
+
+/** Size of a run of small blocks (including the run descriptor). */
+#define RUN_SIZE  (16 * 1024)
+
+/** Number of arenas the runs are distributed among. */
+#define ARENA_COUNT  4
+
+/** Amount of memory a fibril cache keeps in one size class. */
+#define CACHE_BYTES  8192
+
+/** Minimal number of blocks a fibril cache keeps in one size class. */
+#define CACHE_MIN  4
+
+/** Maximal number of blocks a fibril cache keeps in one size class. */
+#define CACHE_MAX  32
+
+/** Amount of memory a fibril cache keeps in all size classes together. */
+#define CACHE_TOTAL_BYTES  (16 * 1024)
+
 /** Overhead of each heap block. */
 #define STRUCT_OVERHEAD \
 	(sizeof(heap_block_head_t) + sizeof(heap_block_foot_t))
@@ -185,6 +221,123 @@ typedef struct {
 	uint32_t magic;
 } heap_block_foot_t;
 
+struct heap_run;
+struct heap_arena;
+
+/** Header of a small block
+ *
+ * The header immediately precedes the block data and overlays
+ * the trailing fields of heap_block_head_t, so that the magic
+ * value tells small blocks and heap blocks apart.
+ *
+ */
+typedef struct {
+	/** Run this block belongs to */
+	struct heap_run *run;
+
+	/* A magic value to detect overwrite of small block header */
+	uint32_t magic;
+} heap_small_head_t;
+
+/** Run of small blocks
+ *
+ * A run is a heap block which is carved into small blocks
+ * of a single size class. Runs are owned by arenas and
+ * are manipulated only with the arena lock held.
+ *
+ */
+typedef struct heap_run {
+	/** Link in the arena list of runs with free blocks */
+	link_t link;
+
+	/** Link in the arena list of all runs */
+	link_t arena_link;
+
+	/** Arena owning this run */
+	struct heap_arena *arena;
+
+	/** Size class of the blocks */
+	unsigned int sclass;
+
+	/** Size of the blocks (including header) */
+	size_t bsize;
+
+	/** List of free blocks */
+	void *free;
+
+	/** Beginning of the part of the run which was never used */
+	uintptr_t top;
+
+	/** End of the run */
+	uintptr_t end;
+
+	/** Number of blocks handed out of the run */
+	size_t used;
+
+	/** A magic value */
+	uint32_t magic;
+} heap_run_t;
+
+/** Arena
+ *
+ * Arenas spread the runs of small blocks so that
+ * refills and flushes of fibril caches from multiple
+ * threads do not contend on a single lock.
+ *
+ */
+typedef struct heap_arena {
+	/** Serializes access to the runs of the arena */
+	fibril_rmutex_t lock;
+
+	/** Runs with free blocks for each size class */
+	list_t bins[SMALL_CLASSES];
+
+	/** All runs of the arena */
+	list_t runs;
+
+	/** Blocks freed without holding the arena lock */
+	_Atomic(void *) remote;
+} heap_arena_t;
+
+/** Fibril cache of small blocks
+ *
+ * Each fibril which allocates small blocks has its own cache,
+ * so that most allocations and deallocations do not need
+ * to take any lock at all. The cached blocks are linked
+ * through their first word.
+ *
+ */
+typedef struct {
+	/** Arena the cache refills from */
+	heap_arena_t *arena;
+
+	/** Lists of cached blocks for each size class */
+	void *bins[SMALL_CLASSES];
+
+	/** Number of cached blocks for each size class */
+	unsigned int count[SMALL_CLASSES];
+
+	/** Usable size of all cached blocks */
+	size_t bytes;
+} heap_cache_t;
+
+/** Size of small block header including alignment padding. */
+#define SMALL_HEAD_SIZE \
+	ALIGN_UP(sizeof(heap_small_head_t), BASE_ALIGN)
+
+/** Get header of small block. */
+#define SMALL_HEAD(addr) \
+	((heap_small_head_t *) \
+	    (((uintptr_t) (addr)) - sizeof(heap_small_head_t)))
+
+/** Get next block in a list of free small blocks. */
+#define SMALL_NEXT(addr) \
+	(*((void **) (addr)))
+
+/** Get first block in a run. */
+#define RUN_FIRST_BLOCK(run) \
+	(ALIGN_UP(((uintptr_t) (run)) + sizeof(heap_run_t), BASE_ALIGN))
+
 /** First heap area */
 static heap_area_t *first_heap_area = NULL;
 
@@ -197,6 +350,20 @@ static heap_block_head_t *next_fit = NULL;
 /** Futex for thread-safe heap manipulation */
 static fibril_rmutex_t malloc_mutex;
 
+/** Arenas of small blocks */
+static heap_arena_t arenas[ARENA_COUNT];
+
+/** Arena to be assigned to the next fibril cache */
+static atomic_uint next_arena = 0;
+
+/** Net sizes of small blocks in each size class */
+static const size_t small_sizes[SMALL_CLASSES] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512,
+	640, 768, 896, 1024
+};
+
 #define malloc_assert(expr) safe_assert(expr)
 
 /*
@@ -206,6 +373,16 @@ static_assert(BASE_ALIGN >= alignof(heap_area_t), "");
 static_assert(BASE_ALIGN >= alignof(heap_block_head_t), "");
 static_assert(BASE_ALIGN >= alignof(heap_block_foot_t), "");
 static_assert(BASE_ALIGN >= alignof(max_align_t), "");
+static_assert(BASE_ALIGN >= alignof(heap_run_t), "");
+
+/*
+ * Make sure the magic value of a small block header and a heap
+ * block header are found at the same place relative to the data.
+ */
+static_assert(sizeof(heap_block_head_t) - offsetof(heap_block_head_t, magic) ==
+    sizeof(heap_small_head_t) - offsetof(heap_small_head_t, magic), "");
+
+static void free_internal(void *const);
 
 /** Serializes access to the heap from multiple threads. */
 static inline void heap_lock(void)
@@ -495,12 +672,26 @@ void __malloc_init(void)
 	if (fibril_rmutex_initialize(&malloc_mutex) != EOK)
 		abort();
 
+	for (size_t i = 0; i < ARENA_COUNT; i++) {
+		if (fibril_rmutex_initialize(&arenas[i].lock) != EOK)
+			abort();
+
+		for (size_t j = 0; j < SMALL_CLASSES; j++)
+			list_initialize(&arenas[i].bins[j]);
+
+		list_initialize(&arenas[i].runs);
+		atomic_init(&arenas[i].remote, NULL);
+	}
+
 	if (!area_create(PAGE_SIZE))
 		abort();
 }
 
 void __malloc_fini(void)
 {
+	for (size_t i = 0; i < ARENA_COUNT; i++)
+		fibril_rmutex_destroy(&arenas[i].lock);
+
 	fibril_rmutex_destroy(&malloc_mutex);
 }
 
@@ -772,6 +963,465 @@ static void *malloc_internal(const size_t size, const size_t align)
 	return heap_grow_and_alloc(gross_size, falign);
 }
 
+/** Get size class of a small block
+ *
+ * @param size Requested size (at most SMALL_MAX).
+ *
+ * @return Index of the smallest size class which fits the request.
+ *
+ */
+static unsigned int small_class(size_t size)
+{
+	malloc_assert(size <= SMALL_MAX);
+
+	if (size <= 128)
+		return (size > 0) ? (size - 1) / 16 : 0;
+
+	/* Four size classes between consecutive powers of two */
+	size_t order = fnzb(size - 1);
+	return 8 + (order - 7) * 4 + (((size - 1) >> (order - 2)) & 3);
+}
+
+/** Get the number of blocks a fibril cache keeps in a size class.
+ *
+ */
+static unsigned int cache_limit(unsigned int sclass)
+{
+	size_t limit = CACHE_BYTES / small_sizes[sclass];
+	return (unsigned int) min(max(limit, CACHE_MIN), CACHE_MAX);
+}
+
+/** Check a run structure
+ *
+ * @param run Run of small blocks.
+ *
+ */
+static void run_check(heap_run_t *run)
+{
+	malloc_assert(run->magic == HEAP_RUN_MAGIC);
+	malloc_assert(run->sclass < SMALL_CLASSES);
+	malloc_assert(run->top <= run->end);
+}
+
+/** Create new run of small blocks
+ *
+ * Should be called only with the arena lock held.
+ *
+ * @param arena  Arena to own the run.
+ * @param sclass Size class of the blocks.
+ *
+ * @return New run or NULL on not enough memory.
+ *
+ */
+static heap_run_t *run_create(heap_arena_t *arena, unsigned int sclass)
+{
+	heap_lock();
+	heap_run_t *run = malloc_internal(RUN_SIZE, BASE_ALIGN);
+	heap_unlock();
+
+	if (run == NULL)
+		return NULL;
+
+	link_initialize(&run->link);
+	link_initialize(&run->arena_link);
+	run->arena = arena;
+	run->sclass = sclass;
+	run->bsize = SMALL_HEAD_SIZE + small_sizes[sclass];
+	run->free = NULL;
+	run->top = RUN_FIRST_BLOCK(run);
+	run->end = ((uintptr_t) run) + RUN_SIZE;
+	run->used = 0;
+	run->magic = HEAP_RUN_MAGIC;
+
+	list_append(&run->arena_link, &arena->runs);
+	list_prepend(&run->link, &arena->bins[sclass]);
+
+	return run;
+}
+
+/** Return an empty run to the heap
+ *
+ * Should be called only with the arena lock held.
+ *
+ * @param run Run of small blocks.
+ *
+ */
+static void run_destroy(heap_run_t *run)
+{
+	malloc_assert(run->used == 0);
+
+	list_remove(&run->link);
+	list_remove(&run->arena_link);
+	run->magic = 0;
+
+	heap_lock();
+	free_internal(run);
+	heap_unlock();
+}
+
+/** Check whether a run has no free block left
+ *
+ */
+static bool run_full(heap_run_t *run)
+{
+	return (run->free == NULL) && (run->top + run->bsize > run->end);
+}
+
+/** Take a block out of a run
+ *
+ * Should be called only with the arena lock held.
+ *
+ * @param run Run of small blocks which is not full.
+ *
+ * @return Address of the block.
+ *
+ */
+static void *run_alloc(heap_run_t *run)
+{
+	void *addr;
+
+	if (run->free != NULL) {
+		addr = run->free;
+		run->free = SMALL_NEXT(addr);
+		malloc_assert(SMALL_HEAD(addr)->magic == HEAP_SMALL_FREE_MAGIC);
+	} else {
+		addr = (void *) (run->top + SMALL_HEAD_SIZE);
+		run->top += run->bsize;
+		SMALL_HEAD(addr)->run = run;
+		SMALL_HEAD(addr)->magic = HEAP_SMALL_FREE_MAGIC;
+	}
+
+	malloc_assert(SMALL_HEAD(addr)->run == run);
+
+	run->used++;
+	return addr;
+}
+
+/** Return a block to its run
+ *
+ * Should be called only with the arena lock held.
+ * Empty runs are returned to the heap unless they are
+ * the only runs with free blocks of their size class.
+ *
+ * @param arena Arena owning the run of the block.
+ * @param addr  Address of the block.
+ *
+ */
+static void arena_put(heap_arena_t *arena, void *addr)
+{
+	heap_run_t *run = SMALL_HEAD(addr)->run;
+
+	run_check(run);
+	malloc_assert(run->arena == arena);
+	malloc_assert(run->used > 0);
+	malloc_assert(SMALL_HEAD(addr)->magic == HEAP_SMALL_FREE_MAGIC);
+
+	SMALL_NEXT(addr) = run->free;
+	run->free = addr;
+	run->used--;
+
+	list_t *bin = &arena->bins[run->sclass];
+
+	if (!link_used(&run->link))
+		list_prepend(&run->link, bin);
+
+	if ((run->used == 0) && ((list_first(bin) != &run->link) ||
+	    (list_last(bin) != &run->link)))
+		run_destroy(run);
+}
+
+/** Return a block to a foreign arena
+ *
+ * The block is pushed to the list of remotely freed blocks
+ * of the arena without taking the arena lock. The list is
+ * drained by the next fibril which takes the lock to refill
+ * or flush its cache.
+ *
+ * @param arena Arena owning the run of the block.
+ * @param addr  Address of the block.
+ *
+ */
+static void arena_put_remote(heap_arena_t *arena, void *addr)
+{
+	void *head = atomic_load_explicit(&arena->remote, memory_order_relaxed);
+
+	do {
+		SMALL_NEXT(addr) = head;
+	} while (!atomic_compare_exchange_weak_explicit(&arena->remote, &head,
+	    addr, memory_order_release, memory_order_relaxed));
+}
+
+/** Return remotely freed blocks to their runs
+ *
+ * Should be called only with the arena lock held.
+ *
+ * @param arena Arena.
+ *
+ */
+static void arena_drain(heap_arena_t *arena)
+{
+	void *addr = atomic_exchange_explicit(&arena->remote, NULL,
+	    memory_order_acquire);
+
+	while (addr != NULL) {
+		void *next = SMALL_NEXT(addr);
+		arena_put(arena, addr);
+		addr = next;
+	}
+}
+
+/** Return remotely freed blocks of other arenas to their runs
+ *
+ * Called on the allocation slow path so that blocks freed to arenas
+ * whose lock is rarely taken do not stay on their remote lists. Busy
+ * arenas are skipped.
+ *
+ * @param arena Arena of the caller, which is drained separately.
+ *
+ */
+static void arena_drain_others(heap_arena_t *arena)
+{
+	for (unsigned int i = 0; i < ARENA_COUNT; i++) {
+		heap_arena_t *other = &arenas[i];
+
+		if ((other == arena) || (atomic_load_explicit(&other->remote,
+		    memory_order_relaxed) == NULL))
+			continue;
+
+		if (fibril_rmutex_trylock(&other->lock)) {
+			arena_drain(other);
+			fibril_rmutex_unlock(&other->lock);
+		}
+	}
+}
+
+/** Get the small block cache of the current fibril
+ *
+ * The cache is created on first use.
+ *
+ * @return Cache of the current fibril or NULL if it cannot be used.
+ *
+ */
+static heap_cache_t *cache_get(void)
+{
+	if (!__tcb_is_set())
+		return NULL;
+
+	fibril_t *fibril = fibril_self();
+	if (fibril->malloc_cache != NULL)
+		return fibril->malloc_cache;
+
+	heap_lock();
+	heap_cache_t *cache = malloc_internal(sizeof(heap_cache_t), BASE_ALIGN);
+	heap_unlock();
+
+	if (cache == NULL)
+		return NULL;
+
+	memset(cache, 0, sizeof(heap_cache_t));
+	cache->arena = &arenas[atomic_fetch_add_explicit(&next_arena, 1,
+	    memory_order_relaxed) % ARENA_COUNT];
+
+	fibril->malloc_cache = cache;
+	return cache;
+}
+
+/** Refill a size class of a fibril cache from its arena
+ *
+ * @param cache  Fibril cache.
+ * @param sclass Size class.
+ *
+ * @return True if at least one block was added to the cache.
+ *
+ */
+static bool cache_refill(heap_cache_t *cache, unsigned int sclass)
+{
+	heap_arena_t *arena = cache->arena;
+	unsigned int want = max(cache_limit(sclass) / 2, 1);
+
+	arena_drain_others(arena);
+
+	fibril_rmutex_lock(&arena->lock);
+	arena_drain(arena);
+
+	list_t *bin = &arena->bins[sclass];
+
+	while (cache->count[sclass] < want) {
+		heap_run_t *run;
+
+		link_t *link = list_first(bin);
+		if (link != NULL)
+			run = list_get_instance(link, heap_run_t, link);
+		else
+			run = run_create(arena, sclass);
+
+		if (run == NULL)
+			break;
+
+		while ((cache->count[sclass] < want) && (!run_full(run))) {
+			void *addr = run_alloc(run);
+			SMALL_NEXT(addr) = cache->bins[sclass];
+			cache->bins[sclass] = addr;
+			cache->count[sclass]++;
+			cache->bytes += small_sizes[sclass];
+		}
+
+		if (run_full(run))
+			list_remove(&run->link);
+	}
+
+	fibril_rmutex_unlock(&arena->lock);
+
+	return cache->count[sclass] > 0;
+}
+
+/** Flush a size class of a fibril cache
+ *
+ * Blocks owned by the arena of the cache are returned directly,
+ * blocks owned by other arenas are handed over lock-free.
+ *
+ * @param cache  Fibril cache.
+ * @param sclass Size class.
+ * @param keep   Number of blocks to keep in the cache.
+ *
+ */
+static void cache_flush(heap_cache_t *cache, unsigned int sclass,
+    unsigned int keep)
+{
+	heap_arena_t *arena = cache->arena;
+
+	fibril_rmutex_lock(&arena->lock);
+
+	while (cache->count[sclass] > keep) {
+		void *addr = cache->bins[sclass];
+		cache->bins[sclass] = SMALL_NEXT(addr);
+		cache->count[sclass]--;
+		cache->bytes -= small_sizes[sclass];
+
+		heap_run_t *run = SMALL_HEAD(addr)->run;
+		if (run->arena == arena)
+			arena_put(arena, addr);
+		else
+			arena_put_remote(run->arena, addr);
+	}
+
+	arena_drain(arena);
+
+	fibril_rmutex_unlock(&arena->lock);
+}
+
+/** Keep a fibril cache within CACHE_TOTAL_BYTES
+ *
+ * Empty whole size classes, largest blocks first, until
+ * the cache holds at most half of the limit.
+ *
+ * @param cache  Fibril cache.
+ * @param sclass Size class to leave alone.
+ *
+ */
+static void cache_trim(heap_cache_t *cache, unsigned int sclass)
+{
+	if (cache->bytes <= CACHE_TOTAL_BYTES)
+		return;
+
+	for (unsigned int i = SMALL_CLASSES; i-- > 0;) {
+		if (cache->bytes <= CACHE_TOTAL_BYTES / 2)
+			break;
+
+		if ((i != sclass) && (cache->count[i] > 0))
+			cache_flush(cache, i, 0);
+	}
+}
+
+/** Release the small block cache of a fibril
+ *
+ * Called when the fibril is being destroyed. While the fibril
+ * lives, the memory the cache keeps is bounded by cache_trim().
+ *
+ * @param arg Cache of the fibril.
+ *
+ */
+void __malloc_cache_release(void *arg)
+{
+	heap_cache_t *cache = (heap_cache_t *) arg;
+
+	for (unsigned int i = 0; i < SMALL_CLASSES; i++) {
+		if (cache->count[i] > 0)
+			cache_flush(cache, i, 0);
+	}
+
+	heap_lock();
+	free_internal(cache);
+	heap_unlock();
+}
+
+/** Allocate a small block
+ *
+ * @param size Number of bytes to allocate (at most SMALL_MAX).
+ *
+ * @return Allocated block or NULL if the heap has to be used instead.
+ *
+ */
+static void *small_alloc(size_t size)
+{
+	heap_cache_t *cache = cache_get();
+	if (cache == NULL)
+		return NULL;
+
+	unsigned int sclass = small_class(size);
+
+	if (cache->count[sclass] == 0) {
+		if (!cache_refill(cache, sclass))
+			return NULL;
+
+		cache_trim(cache, sclass);
+	}
+
+	void *addr = cache->bins[sclass];
+	cache->bins[sclass] = SMALL_NEXT(addr);
+	cache->count[sclass]--;
+	cache->bytes -= small_sizes[sclass];
+
+	heap_small_head_t *head = SMALL_HEAD(addr);
+	malloc_assert(head->magic == HEAP_SMALL_FREE_MAGIC);
+	head->magic = HEAP_SMALL_MAGIC;
+
+	return addr;
+}
+
+/** Free a small block
+ *
+ * @param addr The address of the block.
+ *
+ */
+static void small_free(void *addr)
+{
+	heap_small_head_t *head = SMALL_HEAD(addr);
+	heap_run_t *run = head->run;
+
+	run_check(run);
+	head->magic = HEAP_SMALL_FREE_MAGIC;
+
+	heap_cache_t *cache = cache_get();
+	if (cache == NULL) {
+		arena_put_remote(run->arena, addr);
+		return;
+	}
+
+	unsigned int sclass = run->sclass;
+
+	SMALL_NEXT(addr) = cache->bins[sclass];
+	cache->bins[sclass] = addr;
+	cache->count[sclass]++;
+	cache->bytes += small_sizes[sclass];
+
+	unsigned int limit = cache_limit(sclass);
+	if (cache->count[sclass] > limit)
+		cache_flush(cache, sclass, limit / 2);
+
+	cache_trim(cache, sclass);
+}
+
 /** Allocate memory by number of elements
  *
  * @param nmemb Number of members to allocate.
@@ -801,6 +1451,12 @@ void *calloc(const size_t nmemb, const size_t size)
  */
 void *malloc(const size_t size)
 {
+	if (size <= SMALL_MAX) {
+		void *block = small_alloc(size);
+		if (block != NULL)
+			return block;
+	}
+
 	heap_lock();
 	void *block = malloc_internal(size, BASE_ALIGN);
 	heap_unlock();
@@ -824,6 +1480,10 @@ void *memalign(const size_t align, const size_t size)
 	size_t palign =
 	    1 << (fnzb(max(sizeof(void *), align) - 1) + 1);
 
+	/* Small blocks are aligned on BASE_ALIGN */
+	if (palign <= BASE_ALIGN)
+		return malloc(size);
+
 	heap_lock();
 	void *block = malloc_internal(size, palign);
 	heap_unlock();
@@ -849,6 +1509,23 @@ void *realloc(void *const addr, const size_t size)
 	if (addr == NULL)
 		return malloc(size);
 
+	heap_small_head_t *small_head = SMALL_HEAD(addr);
+	if (small_head->magic == HEAP_SMALL_MAGIC) {
+		run_check(small_head->run);
+
+		size_t small_size = small_sizes[small_head->run->sclass];
+		if (size <= small_size)
+			return addr;
+
+		void *ptr = malloc(size);
+		if (ptr != NULL) {
+			memcpy(ptr, addr, small_size);
+			small_free(addr);
+		}
+
+		return ptr;
+	}
+
 	heap_lock();
 
 	/* Calculate the position of the header. */
@@ -948,18 +1625,15 @@ void *realloc(void *const addr, const size_t size)
 	return ptr;
 }
 
-/** Free a memory block
+/** Free a heap block
+ *
+ * Should be called only inside the critical section.
  *
  * @param addr The address of the block.
  *
  */
-void free(void *const addr)
+static void free_internal(void *const addr)
 {
-	if (addr == NULL)
-		return;
-
-	heap_lock();
-
 	/* Calculate the position of the header. */
 	heap_block_head_t *head =
 	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
@@ -1002,12 +1676,80 @@ void free(void *const addr)
 	}
 
 	heap_shrink(area);
+}
+
+/** Free a memory block
+ *
+ * @param addr The address of the block.
+ *
+ */
+void free(void *const addr)
+{
+	if (addr == NULL)
+		return;
 
+	if (SMALL_HEAD(addr)->magic == HEAP_SMALL_MAGIC) {
+		small_free(addr);
+		return;
+	}
+
+	heap_lock();
+	free_internal(addr);
 	heap_unlock();
 }
 
+/** Check consistency of the runs of an arena
+ *
+ * @param arena Arena.
+ *
+ * @return NULL if the runs are consistent or the address of
+ *         the first inconsistent structure.
+ *
+ */
+static void *arena_check(heap_arena_t *arena)
+{
+	void *bad = NULL;
+
+	fibril_rmutex_lock(&arena->lock);
+
+	list_foreach(arena->runs, arena_link, heap_run_t, run) {
+		if ((run->magic != HEAP_RUN_MAGIC) || (run->arena != arena) ||
+		    (run->sclass >= SMALL_CLASSES) || (run->top > run->end)) {
+			bad = (void *) run;
+			break;
+		}
+
+		/* Walk all small blocks handed out of the run */
+		for (uintptr_t block = RUN_FIRST_BLOCK(run); block < run->top;
+		    block += run->bsize) {
+			heap_small_head_t *head =
+			    SMALL_HEAD(block + SMALL_HEAD_SIZE);
+
+			if ((head->run != run) ||
+			    ((head->magic != HEAP_SMALL_MAGIC) &&
+			    (head->magic != HEAP_SMALL_FREE_MAGIC))) {
+				bad = (void *) head;
+				break;
+			}
+		}
+
+		if (bad != NULL)
+			break;
+	}
+
+	fibril_rmutex_unlock(&arena->lock);
+
+	return bad;
+}
+
 void *heap_check(void)
 {
+	for (size_t i = 0; i < ARENA_COUNT; i++) {
+		void *bad = arena_check(&arenas[i]);
+		if (bad != NULL)
+			return bad;
+	}
+
 	heap_lock();
 
 	if (first_heap_area == NULL) {
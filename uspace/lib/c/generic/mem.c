@@ -39,6 +39,12 @@
 #include <stdint.h>
 #include "private/cc.h"
 
+/*
+ * Architectures with optimized memset(), memcpy() and memmove()
+ * define LIBC_ARCH_MEM and provide them in arch/$(UARCH)/src/mem.c.
+ */
+#ifndef LIBC_ARCH_MEM
+
 /** Fill memory block with a constant value. */
 ATTRIBUTE_OPTIMIZE_NO_TLDP
     void *memset(void *dest, int b, size_t n)
@@ -227,6 +233,8 @@ void *memmove(void *dst, const void *src, size_t n)
 	return dst;
 }
 
+#endif
+
 /** Compare two memory areas.
  *
  * @param s1  Pointer to the first area to compare.
@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup libc
+ * @{
+ */
+
+/** @file Shared-memory packet ring
+ *
+ * Packets are passed between two tasks through a ring of fixed-size slots
+ * in a shared memory area instead of being copied through IPC one by one.
+ * Both sides work with the packet data in place. The producer only needs
+ * to notify the consumer (by an IPC message of its choice) when it puts
+ * a packet into an empty ring. The consumer drains the ring completely
+ * each time it is notified.
+ *
+ * Head and tail are free-running indices. Each side writes only its own
+ * index. Geometry is validated once when the ring is set up and only
+ * local copies of it are used afterwards. The contents of a slot are
+ * never trusted, the packet size is checked on each access.
+ */
+
+#include <align.h>
+#include <as.h>
+#include <async.h>
+#include <errno.h>
+#include <mem.h>
+#include <pktring.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Slot and header alignment (avoid false sharing between head and tail) */
+#define PKTRING_ALIGN 64
+
+/** Shared ring header */
+typedef struct pktring_hdr {
+	/** Number of slots */
+	uint32_t nslots;
+	/** Maximum packet size */
+	uint32_t slot_size;
+	uint8_t pad0[PKTRING_ALIGN - 2 * sizeof(uint32_t)];
+	/** Producer index */
+	_Atomic uint32_t head;
+	uint8_t pad1[PKTRING_ALIGN - sizeof(uint32_t)];
+	/** Consumer index */
+	_Atomic uint32_t tail;
+	uint8_t pad2[PKTRING_ALIGN - sizeof(uint32_t)];
+} pktring_hdr_t;
+
+/** Slot header, followed by packet data */
+typedef struct {
+	/** Size of packet in bytes */
+	uint32_t size;
+	uint32_t reserved;
+} pktring_slot_t;
+
+static size_t pktring_stride(uint32_t slot_size)
+{
+	return ALIGN_UP(sizeof(pktring_slot_t) + slot_size, PKTRING_ALIGN);
+}
+
+static pktring_slot_t *pktring_slot(pktring_t *ring, uint32_t idx)
+{
+	return (pktring_slot_t *) (ring->slots +
+	    (idx & (ring->nslots - 1)) * ring->stride);
+}
+
+/** Set up ring endpoint structure for a mapped area.
+ *
+ * @param area Shared area
+ * @param area_size Size of shared area
+ * @param rring Place to store pointer to new ring endpoint
+ * @return EOK on success, EINVAL if the ring geometry is invalid,
+ *         ENOMEM if out of memory
+ */
+static errno_t pktring_setup(void *area, size_t area_size, pktring_t **rring)
+{
+	pktring_hdr_t *hdr = (pktring_hdr_t *) area;
+	pktring_t *ring;
+	uint32_t nslots;
+	uint32_t slot_size;
+	size_t stride;
+
+	if (area_size < sizeof(pktring_hdr_t))
+		return EINVAL;
+
+	nslots = hdr->nslots;
+	slot_size = hdr->slot_size;
+
+	if (nslots == 0 || (nslots & (nslots - 1)) != 0 || slot_size == 0 ||
+	    slot_size > area_size)
+		return EINVAL;
+
+	stride = pktring_stride(slot_size);
+	if ((area_size - sizeof(pktring_hdr_t)) / stride < nslots)
+		return EINVAL;
+
+	ring = calloc(1, sizeof(pktring_t));
+	if (ring == NULL)
+		return ENOMEM;
+
+	ring->hdr = hdr;
+	ring->slots = (uint8_t *) area + sizeof(pktring_hdr_t);
+	ring->area_size = area_size;
+	ring->nslots = nslots;
+	ring->slot_size = slot_size;
+	ring->stride = stride;
+
+	*rring = ring;
+	return EOK;
+}
+
+/** Create packet ring.
+ *
+ * The ring is created by the consumer.
+ *
+ * @param nslots Number of slots (rounded up to a power of two)
+ * @param slot_size Maximum size of packet
+ * @param rring Place to store pointer to new ring
+ * @return EOK on success, EINVAL if parameters are invalid,
+ *         ENOMEM if out of memory
+ */
+errno_t pktring_create(size_t nslots, size_t slot_size, pktring_t **rring)
+{
+	pktring_hdr_t *hdr;
+	size_t n;
+	size_t size;
+	void *area;
+	errno_t rc;
+
+	if (nslots == 0 || nslots > UINT32_MAX / 2 || slot_size == 0 ||
+	    slot_size > UINT32_MAX / 2)
+		return EINVAL;
+
+	n = 1;
+	while (n < nslots)
+		n *= 2;
+
+	size = PAGES2SIZE(SIZE2PAGES(sizeof(pktring_hdr_t) +
+	    n * pktring_stride(slot_size)));
+
+	area = as_area_create(AS_AREA_ANY, size, AS_AREA_READ |
+	    AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED)
+		return ENOMEM;
+
+	hdr = (pktring_hdr_t *) area;
+	hdr->nslots = n;
+	hdr->slot_size = slot_size;
+	atomic_store(&hdr->head, 0);
+	atomic_store(&hdr->tail, 0);
+
+	rc = pktring_setup(area, size, rring);
+	if (rc != EOK) {
+		as_area_destroy(area);
+		return rc;
+	}
+
+	return EOK;
+}
+
+/** Attach producer endpoint to a mapped packet ring.
+ *
+ * The endpoint does not own the memory area, detach it using
+ * pktring_detach().
+ *
+ * @param area Memory area containing a ring created by pktring_create()
+ * @param size Size of memory area
+ * @param rring Place to store pointer to the producer side of the ring
+ * @return EOK on success, EINVAL if the ring geometry is invalid,
+ *         ENOMEM if out of memory
+ */
+errno_t pktring_attach(void *area, size_t size, pktring_t **rring)
+{
+	errno_t rc;
+
+	rc = pktring_setup(area, size, rring);
+	if (rc != EOK)
+		return rc;
+
+	/* Continue where the consumer is */
+	(*rring)->idx = atomic_load(&(*rring)->hdr->head);
+	return EOK;
+}
+
+/** Detach ring endpoint without unmapping the memory area.
+ *
+ * @param ring Packet ring endpoint
+ */
+void pktring_detach(pktring_t *ring)
+{
+	free(ring);
+}
+
+/** Share packet ring out to the producer.
+ *
+ * To be used by the consumer as part of a request, which the peer
+ * completes using pktring_share_accept().
+ *
+ * @param ring Packet ring
+ * @param exch Exchange
+ * @return EOK on success or an error code
+ */
+errno_t pktring_share_out(pktring_t *ring, async_exch_t *exch)
+{
+	return async_share_out_start(exch, ring->hdr, AS_AREA_READ |
+	    AS_AREA_WRITE | AS_AREA_CACHEABLE);
+}
+
+/** Accept packet ring shared out by the consumer.
+ *
+ * @param rring Place to store pointer to the producer side of the ring
+ * @return EOK on success or an error code
+ */
+errno_t pktring_share_accept(pktring_t **rring)
+{
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+	void *area;
+	errno_t rc;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if ((flags & AS_AREA_WRITE) == 0) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK)
+		return rc;
+	if (area == AS_MAP_FAILED)
+		return ENOMEM;
+
+	rc = pktring_attach(area, size, rring);
+	if (rc != EOK) {
+		as_area_destroy(area);
+		return rc;
+	}
+
+	return EOK;
+}
+
+/** Destroy packet ring endpoint.
+ *
+ * The shared area is unmapped from this task. The ring ceases to exist
+ * once both sides have destroyed their endpoints.
+ *
+ * @param ring Packet ring or @c NULL
+ */
+void pktring_destroy(pktring_t *ring)
+{
+	if (ring == NULL)
+		return;
+
+	as_area_destroy(ring->hdr);
+	pktring_detach(ring);
+}
+
+/** Get maximum packet size.
+ *
+ * @param ring Packet ring
+ * @return Maximum packet size in bytes
+ */
+size_t pktring_slot_size(pktring_t *ring)
+{
+	return ring->slot_size;
+}
+
+/** Allocate space for a packet (producer).
+ *
+ * The packet can be constructed in place and must be published with
+ * pktring_commit() before the next call.
+ *
+ * @param ring Packet ring
+ * @param size Packet size
+ * @param rbuf Place to store pointer to packet buffer
+ * @return EOK on success, ELIMIT if packet is too big for a slot,
+ *         ENOSPC if the ring is full
+ */
+errno_t pktring_alloc(pktring_t *ring, size_t size, void **rbuf)
+{
+	uint32_t tail;
+
+	if (size > ring->slot_size)
+		return ELIMIT;
+
+	tail = atomic_load_explicit(&ring->hdr->tail, memory_order_acquire);
+	if (ring->idx - tail >= ring->nslots)
+		return ENOSPC;
+
+	*rbuf = pktring_slot(ring, ring->idx) + 1;
+	return EOK;
+}
+
+/** Publish packet (producer).
+ *
+ * @param ring Packet ring
+ * @param size Packet size (at most the size passed to pktring_alloc())
+ * @return @c true if the ring was empty and the consumer must be notified
+ */
+bool pktring_commit(pktring_t *ring, size_t size)
+{
+	uint32_t head = ring->idx;
+	uint32_t tail;
+
+	pktring_slot(ring, head)->size = size;
+	ring->idx = head + 1;
+
+	/*
+	 * The store to head and the load of tail must not be reordered,
+	 * otherwise we could miss a consumer that has just found the ring
+	 * empty (see pktring_consume()).
+	 */
+	atomic_store_explicit(&ring->hdr->head, head + 1, memory_order_seq_cst);
+	tail = atomic_load_explicit(&ring->hdr->tail, memory_order_seq_cst);
+
+	return tail == head;
+}
+
+/** Copy packet into ring (producer).
+ *
+ * @param ring Packet ring
+ * @param data Packet data
+ * @param size Packet size
+ * @param notify Place to store @c true if the consumer must be notified
+ * @return EOK on success, ELIMIT if packet is too big for a slot,
+ *         ENOSPC if the ring is full
+ */
+errno_t pktring_put(pktring_t *ring, const void *data, size_t size,
+    bool *notify)
+{
+	void *buf;
+	errno_t rc;
+
+	rc = pktring_alloc(ring, size, &buf);
+	if (rc != EOK)
+		return rc;
+
+	memcpy(buf, data, size);
+	*notify = pktring_commit(ring, size);
+	return EOK;
+}
+
+/** Get next packet (consumer).
+ *
+ * The packet data stays valid and in place until pktring_consume() is
+ * called. If this function returns EIO, the slot contents are corrupt
+ * and the slot must still be consumed.
+ *
+ * @param ring Packet ring
+ * @param rbuf Place to store pointer to packet data
+ * @param rsize Place to store packet size
+ * @return EOK on success, ENOENT if the ring is empty, EIO if the
+ *         packet size is invalid
+ */
+errno_t pktring_peek(pktring_t *ring, void **rbuf, size_t *rsize)
+{
+	pktring_slot_t *slot;
+	uint32_t head;
+	uint32_t size;
+
+	head = atomic_load_explicit(&ring->hdr->head, memory_order_seq_cst);
+	if (head == ring->idx)
+		return ENOENT;
+
+	slot = pktring_slot(ring, ring->idx);
+	size = slot->size;
+	if (size > ring->slot_size)
+		return EIO;
+
+	*rbuf = slot + 1;
+	*rsize = size;
+	return EOK;
+}
+
+/** Release packet returned by pktring_peek() (consumer).
+ *
+ * @param ring Packet ring
+ */
+void pktring_consume(pktring_t *ring)
+{
+	ring->idx++;
+
+	/*
+	 * Paired with pktring_commit(). After this store, the producer either
+	 * sees the ring empty and notifies us, or our next pktring_peek()
+	 * sees its packet.
+	 */
+	atomic_store_explicit(&ring->hdr->tail, ring->idx, memory_order_seq_cst);
+}
+
+/** @}
+ */
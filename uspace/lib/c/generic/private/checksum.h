@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_PRIVATE_CHECKSUM_H_
+#define _LIBC_PRIVATE_CHECKSUM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Minimum block length accepted by an architecture CRC32 routine */
+#define CRC32_BULK_MIN  64
+/** Block length granularity of an architecture CRC32 routine */
+#define CRC32_BULK_ALIGN  16
+
+/** Architecture-accelerated CRC32 routine.
+ *
+ * Updates the (non-inverted) CRC state with a block of data. The length
+ * is at least CRC32_BULK_MIN and a multiple of CRC32_BULK_ALIGN.
+ */
+typedef uint32_t (*crc32_bulk_t)(uint32_t, const uint8_t *, size_t);
+
+#ifdef LIBC_ARCH_CHECKSUM
+
+/** Select accelerated CRC32 routine supported by the current CPU.
+ *
+ * @return CRC32 routine or @c NULL if the CPU lacks the necessary
+ *         instructions.
+ */
+extern crc32_bulk_t __crc32_arch_bulk(void);
+
+#endif
+
+#endif
+
+/** @}
+ */
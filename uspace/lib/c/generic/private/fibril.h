@@ -67,6 +67,9 @@ struct fibril {
 	/* In some places, we use fibril structs that can't be freed. */
 	bool is_freeable : 1;
 
+	/* Cache of small memory blocks. */
+	void *malloc_cache;
+
 	/* Debugging stuff. */
 	int rmutex_locks;
 	fibril_owner_info_t *waits_for;
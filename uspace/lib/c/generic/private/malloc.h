@@ -37,6 +37,7 @@
 
 extern void __malloc_init(void);
 extern void __malloc_fini(void);
+extern void __malloc_cache_release(void *);
 
 #endif
 
@@ -100,9 +100,11 @@ errno_t module_create_static_exec(rtld_t *rtld, module_t **rmodule)
 	return EOK;
 }
 
-/** (Eagerly) process all relocation tables in a module.
+/** Process all relocation tables in a module.
  *
- * Currently works as if LD_BIND_NOW was specified.
+ * The architecture-specific code may decide in module_process_pre_arch()
+ * to bind PLT entries lazily, i.e. on the first call of the function.
+ * Otherwise this works as if LD_BIND_NOW was specified.
  */
 void module_process_relocs(module_t *m)
 {
@@ -83,8 +83,13 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 
 	env->next_id = 1;
 
+	/* The symbol cache is optional, go on without it if out of memory */
+	env->symcache = calloc(RTLD_SYMCACHE_SIZE,
+	    sizeof(rtld_symcache_entry_t));
+
 	prog = calloc(1, sizeof(module_t));
 	if (prog == NULL) {
+		free(env->symcache);
 		free(env);
 		return ENOMEM;
 	}
@@ -34,6 +34,8 @@
  * @file
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -44,6 +46,23 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/symbol.h>
 
+/** Symbol lookup key
+ *
+ * Hashes of the name are computed once per lookup, not once per module.
+ */
+typedef struct {
+	/** Symbol name */
+	const char *name;
+	/** GNU hash of the name */
+	uint32_t gnu_hash;
+	/** SysV hash of the name, valid only if @c have_elf_hash is true */
+	elf_word elf_hash;
+	bool have_elf_hash;
+} symbol_key_t;
+
+/** Number of bits in a GNU hash bloom filter word */
+#define BLOOM_WORD_BITS (sizeof(uintptr_t) * 8)
+
 /*
  * Hash tables are 32-bit (elf_word) even for 64-bit ELF files.
  */
@@ -62,38 +81,129 @@ static elf_word elf_hash(const unsigned char *name)
 	return h;
 }
 
-static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
+/** Hash function used by DT_GNU_HASH tables (Bernstein hash). */
+static uint32_t gnu_hash(const unsigned char *name)
+{
+	uint32_t h = 5381;
+
+	while (*name)
+		h = (h << 5) + h + *name++;
+
+	return h;
+}
+
+static void symbol_key_init(symbol_key_t *key, const char *name)
+{
+	key->name = name;
+	key->gnu_hash = gnu_hash((const unsigned char *)name);
+	key->have_elf_hash = false;
+}
+
+/** Look up a symbol using the module's DT_GNU_HASH table.
+ *
+ * The table consists of a header (nbuckets, symoffset, bloom_size,
+ * bloom_shift), the bloom filter, the buckets and the hash value chain.
+ * Only symbols starting from index symoffset are hashed and symbols
+ * in the same bucket are stored contiguously in the symbol table.
+ */
+static elf_symbol_t *def_find_gnu(symbol_key_t *key, module_t *m)
+{
+	elf_symbol_t *sym_table = m->dyn.sym_tab;
+	elf_word *ht = m->dyn.gnu_hash;
+	elf_word nbuckets = ht[0];
+	elf_word symoffset = ht[1];
+	elf_word bloom_size = ht[2];
+	elf_word bloom_shift = ht[3];
+	const uintptr_t *bloom = (const uintptr_t *)&ht[4];
+	const elf_word *buckets = (const elf_word *)&bloom[bloom_size];
+	const elf_word *chain = &buckets[nbuckets];
+	uint32_t h = key->gnu_hash;
+	uintptr_t word;
+	uintptr_t mask;
+	elf_symbol_t *s;
+	elf_word ch;
+	elf_word i;
+
+	/*
+	 * The bloom filter rejects most lookups of symbols that the module
+	 * does not define without touching the buckets or string table.
+	 */
+	word = bloom[(h / BLOOM_WORD_BITS) & (bloom_size - 1)];
+	mask = ((uintptr_t)1 << (h % BLOOM_WORD_BITS)) |
+	    ((uintptr_t)1 << ((h >> bloom_shift) % BLOOM_WORD_BITS));
+	if ((word & mask) != mask)
+		return NULL;
+
+	i = buckets[h % nbuckets];
+	if (i < symoffset)
+		return NULL;	/* Empty bucket */
+
+	while (true) {
+		ch = chain[i - symoffset];
+
+		/* The lowest bit marks the end of the chain */
+		if (((ch ^ h) >> 1) == 0) {
+			s = &sym_table[i];
+			if (str_cmp(key->name, m->dyn.str_tab + s->st_name) == 0)
+				return s;
+		}
+
+		if ((ch & 1) != 0)
+			break;
+
+		++i;
+	}
+
+	return NULL;
+}
+
+/** Look up a symbol using the module's SysV DT_HASH table. */
+static elf_symbol_t *def_find_sysv(symbol_key_t *key, module_t *m)
 {
 	elf_symbol_t *sym_table;
-	elf_symbol_t *s, *sym;
+	elf_symbol_t *s;
 	elf_word nbucket;
 	/* elf_word nchain; */
 	elf_word i;
 	char *s_name;
 	elf_word bucket;
 
-	DPRINTF("def_find_in_module('%s', %s)\n", name, m->dyn.soname);
-
 	sym_table = m->dyn.sym_tab;
 	nbucket = m->dyn.hash[0];
 	/* nchain = m->dyn.hash[1]; XXX Use to check HT range */
 
-	bucket = elf_hash((unsigned char *)name) % nbucket;
+	if (!key->have_elf_hash) {
+		key->elf_hash = elf_hash((const unsigned char *)key->name);
+		key->have_elf_hash = true;
+	}
+
+	bucket = key->elf_hash % nbucket;
 	i = m->dyn.hash[2 + bucket];
 
-	sym = NULL;
 	while (i != STN_UNDEF) {
 		s = &sym_table[i];
 		s_name = m->dyn.str_tab + s->st_name;
 
-		if (str_cmp(name, s_name) == 0) {
-			sym = s;
-			break;
-		}
+		if (str_cmp(key->name, s_name) == 0)
+			return s;
 
 		i = m->dyn.hash[2 + nbucket + i];
 	}
 
+	return NULL;
+}
+
+static elf_symbol_t *def_find_in_module(symbol_key_t *key, module_t *m)
+{
+	elf_symbol_t *sym;
+
+	DPRINTF("def_find_in_module('%s', %s)\n", key->name, m->dyn.soname);
+
+	if (m->dyn.gnu_hash != NULL)
+		sym = def_find_gnu(key, m);
+	else
+		sym = def_find_sysv(key, m);
+
 	if (!sym)
 		return NULL;	/* Not found */
 
@@ -105,6 +215,52 @@ static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
 	return sym; /* Found */
 }
 
+/** Look up a symbol in the resolved symbol cache.
+ *
+ * @param rtld	Runtime environment
+ * @param key	Symbol lookup key
+ * @param mod	(output) Module containing the cached definition
+ * @return	Cached symbol definition or @c NULL if not cached
+ */
+static elf_symbol_t *symcache_find(rtld_t *rtld, symbol_key_t *key,
+    module_t **mod)
+{
+	rtld_symcache_entry_t *e;
+
+	if (rtld->symcache == NULL)
+		return NULL;
+
+	e = &rtld->symcache[key->gnu_hash & (RTLD_SYMCACHE_SIZE - 1)];
+	if (e->name == NULL || e->hash != key->gnu_hash ||
+	    str_cmp(e->name, key->name) != 0)
+		return NULL;
+
+	*mod = e->mod;
+	return e->sym;
+}
+
+/** Insert a resolved symbol into the resolved symbol cache.
+ *
+ * The cache is direct-mapped, an older entry with the same slot
+ * is simply replaced.
+ */
+static void symcache_insert(rtld_t *rtld, symbol_key_t *key,
+    elf_symbol_t *sym, module_t *mod)
+{
+	rtld_symcache_entry_t *e;
+
+	if (rtld->symcache == NULL)
+		return;
+
+	e = &rtld->symcache[key->gnu_hash & (RTLD_SYMCACHE_SIZE - 1)];
+
+	/* Use the defining module's copy of the name, it lives as long */
+	e->name = mod->dyn.str_tab + sym->st_name;
+	e->hash = key->gnu_hash;
+	e->sym = sym;
+	e->mod = mod;
+}
+
 /** Find the definition of a symbol in a module and its deps.
  *
  * Search the module dependency graph is breadth-first, beginning
@@ -121,9 +277,12 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 {
 	module_t *m, *dm;
 	elf_symbol_t *sym, *s;
+	symbol_key_t key;
 	list_t queue;
 	size_t i;
 
+	symbol_key_init(&key, name);
+
 	/*
 	 * Do a BFS using the queue_link and bfs_tag fields.
 	 * Vertices (modules) are tagged the moment they are inserted
@@ -149,7 +308,7 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 		list_remove(&m->queue_link);
 
 		/* If ssf_noroot is specified, do not look in start module */
-		s = def_find_in_module(name, m);
+		s = def_find_in_module(&key, m);
 		if (s != NULL) {
 			/* Symbol found */
 			sym = s;
@@ -190,25 +349,37 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
  *
  * @param name		Name of the symbol to search for.
  * @param origin	Module in which the dependency originates.
- * @param flags		@c ssf_none or @c ssf_noexec to not look for the symbol
- *			in the executable program.
+ * @param flags		@c ssf_none, @c ssf_noexec to not look for the symbol
+ *			in the executable program, @c ssf_nocache to bypass
+ *			the resolved symbol cache.
  * @param mod		(output) Will be filled with a pointer to the module
  *			that contains the symbol.
  */
 elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
     symbol_search_flags_t flags, module_t **mod)
 {
+	symbol_key_t key;
 	elf_symbol_t *s;
+	bool use_cache;
 
 	DPRINTF("symbol_def_find('%s', origin='%s'\n",
 	    name, origin->dyn.soname);
+
+	symbol_key_init(&key, name);
+
+	/*
+	 * Only results of the plain global search are cached. They cannot
+	 * change later on since modules are only ever appended.
+	 */
+	use_cache = (flags & (ssf_noexec | ssf_nocache)) == 0;
+
 	if (origin->dyn.symbolic && (!origin->exec || (flags & ssf_noexec) == 0)) {
 		DPRINTF("symbolic->find '%s' in module '%s'\n", name, origin->dyn.soname);
 		/*
 		 * Origin module has a DT_SYMBOLIC flag.
 		 * Try this module first
 		 */
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&key, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -218,13 +389,21 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 
 	/* Not DT_SYMBOLIC or no match. Now try other locations. */
 
+	if (use_cache) {
+		s = symcache_find(origin->rtld, &key, mod);
+		if (s != NULL)
+			return s;
+	}
+
 	list_foreach(origin->rtld->modules, modules_link, module_t, m) {
 		DPRINTF("module '%s' local?\n", m->dyn.soname);
 		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
 			DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
-			s = def_find_in_module(name, m);
+			s = def_find_in_module(&key, m);
 			if (s != NULL) {
 				/* Found */
+				if (use_cache)
+					symcache_insert(origin->rtld, &key, s, m);
 				*mod = m;
 				return s;
 			}
@@ -237,7 +416,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 	    origin->dyn.soname);
 
 	if (!origin->exec || (flags & ssf_noexec) == 0) {
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&key, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
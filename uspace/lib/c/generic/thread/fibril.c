@@ -52,6 +52,7 @@
 #include "../private/futex.h"
 #include "../private/fibril.h"
 #include "../private/libc.h"
+#include "../private/malloc.h"
 
 #define DPRINTF(...) ((void)0)
 #undef READY_DEBUG
@@ -195,6 +196,11 @@ void fibril_teardown(fibril_t *fibril)
 	list_remove(&fibril->all_link);
 	futex_unlock(&fibril_futex);
 
+	if (fibril->malloc_cache != NULL) {
+		__malloc_cache_release(fibril->malloc_cache);
+		fibril->malloc_cache = NULL;
+	}
+
 	if (fibril->is_freeable) {
 		tls_free(fibril->tcb);
 		free(fibril);
@@ -40,6 +40,9 @@
 
 extern uint32_t compute_crc32(uint8_t *, size_t);
 extern uint32_t compute_crc32_seed(uint8_t *, size_t, uint32_t);
+extern uint16_t compute_inet_checksum(uint16_t, const void *, size_t);
+extern uint16_t compute_inet_checksum_copy(uint16_t, void *, const void *,
+    size_t);
 
 #endif
 
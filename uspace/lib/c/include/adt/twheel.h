@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Hashed timer wheel
+ */
+
+#ifndef _LIBC_TWHEEL_H_
+#define _LIBC_TWHEEL_H_
+
+#include <adt/list.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Timer wheel timer
+ *
+ * Meant to be embedded in the structure whose lifetime it controls.
+ */
+typedef struct {
+	/** Link to twheel_t.slots */
+	link_t link;
+	/** Absolute expiration time in ticks */
+	uint64_t expires;
+} twheel_timer_t;
+
+/** Hashed timer wheel
+ *
+ * Timers are hashed into slots by their expiration tick, so setting,
+ * clearing and expiring a timer takes constant time. Timers expiring
+ * more than one revolution ahead stay in their slot for several rounds.
+ */
+typedef struct {
+	/** Array of slots (lists of twheel_timer_t) */
+	list_t *slots;
+	/** Number of slots */
+	size_t nslots;
+	/** Current time in ticks */
+	uint64_t now;
+} twheel_t;
+
+/** Timer expiration callback
+ *
+ * The timer is no longer set when the callback is called, it can be
+ * set again or the structure containing it can be freed.
+ */
+typedef void (*twheel_expire_t)(twheel_timer_t *, void *);
+
+extern errno_t twheel_init(twheel_t *, size_t);
+extern void twheel_fini(twheel_t *);
+extern void twheel_timer_initialize(twheel_timer_t *);
+extern bool twheel_timer_is_set(twheel_timer_t *);
+extern void twheel_set(twheel_t *, twheel_timer_t *, uint64_t);
+extern void twheel_clear(twheel_t *, twheel_timer_t *);
+extern void twheel_tick(twheel_t *, twheel_expire_t, void *);
+
+#endif
+
+/** @}
+ */
@@ -364,6 +364,15 @@ extern errno_t async_data_write_accept(void **, const bool, const size_t,
     const size_t, const size_t, size_t *);
 extern void async_data_write_void(errno_t);
 
+extern aid_t async_xfer(async_exch_t *, sysarg_t, sysarg_t, sysarg_t,
+    const ipc_iovec_t *, size_t, size_t, ipc_call_t *);
+extern errno_t async_xfer_start(async_exch_t *, sysarg_t, sysarg_t, sysarg_t,
+    const void *, size_t, void *, size_t, size_t *);
+extern bool async_xfer_receive(ipc_call_t *, sysarg_t *, size_t *, size_t *);
+extern errno_t async_xfer_fetch(ipc_call_t *, void *, size_t);
+extern errno_t async_xfer_finalize(ipc_call_t *, const void *, size_t,
+    sysarg_t, sysarg_t);
+
 extern async_sess_t *async_callback_receive(exch_mgmt_t);
 extern async_sess_t *async_callback_receive_start(exch_mgmt_t, ipc_call_t *);
 
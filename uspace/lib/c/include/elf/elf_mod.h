@@ -38,6 +38,7 @@
 #define ELF_MOD_H_
 
 #include <elf/elf.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <loader/pcb.h>
@@ -96,6 +97,15 @@ typedef struct {
 
 	/** Store extracted info here */
 	elf_finfo_t *info;
+
+	/** The file is mapped through the VFS pager */
+	bool mapped;
+
+	/** ID under which the file is mapped */
+	int map_id;
+
+	/** Some segments are mapped from the file, keep the mapping */
+	bool paged;
 } elf_ld_t;
 
 extern errno_t elf_load_file(int, eld_flags_t, elf_finfo_t *);
@@ -111,6 +111,7 @@ extern errno_t ipc_forward_slow(cap_call_handle_t, cap_phone_handle_t, sysarg_t,
     sysarg_t, sysarg_t, sysarg_t, sysarg_t, sysarg_t, unsigned int);
 
 extern errno_t ipc_connect_kbox(task_id_t, cap_phone_handle_t *);
+extern errno_t ipc_xfer_fetch(cap_call_handle_t, void *, size_t);
 
 #endif
 
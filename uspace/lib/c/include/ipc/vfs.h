@@ -90,6 +90,12 @@ typedef enum {
 	VFS_IN_WRITE,
 } vfs_in_request_t;
 
+/** Requests on the VFS pager port besides IPC_M_PAGE_IN */
+typedef enum {
+	VFS_PAGER_MAP = IPC_FIRST_USER_METHOD,
+	VFS_PAGER_UNMAP,
+} vfs_pager_request_t;
+
 typedef enum {
 	VFS_OUT_CLOSE = IPC_FIRST_USER_METHOD,
 	VFS_OUT_DESTROY,
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared-memory packet ring
+ */
+
+#ifndef _LIBC_PKTRING_H_
+#define _LIBC_PKTRING_H_
+
+#include <async.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct pktring_hdr;
+
+/** Packet ring endpoint.
+ *
+ * A packet ring is a single-producer, single-consumer queue of packets
+ * placed in a memory area shared between two tasks. The consumer creates
+ * the ring and shares it out to the producer.
+ */
+typedef struct {
+	/** Shared ring header (at the start of the shared area) */
+	struct pktring_hdr *hdr;
+	/** Start of the first slot */
+	uint8_t *slots;
+	/** Size of the shared area */
+	size_t area_size;
+	/** Number of slots (power of two) */
+	uint32_t nslots;
+	/** Maximum packet size */
+	uint32_t slot_size;
+	/** Distance between slots in bytes */
+	size_t stride;
+	/** Local copy of the index we advance (head or tail) */
+	uint32_t idx;
+} pktring_t;
+
+extern errno_t pktring_create(size_t, size_t, pktring_t **);
+extern errno_t pktring_attach(void *, size_t, pktring_t **);
+extern void pktring_detach(pktring_t *);
+extern errno_t pktring_share_out(pktring_t *, async_exch_t *);
+extern errno_t pktring_share_accept(pktring_t **);
+extern void pktring_destroy(pktring_t *);
+extern size_t pktring_slot_size(pktring_t *);
+
+extern errno_t pktring_alloc(pktring_t *, size_t, void **);
+extern bool pktring_commit(pktring_t *, size_t);
+extern errno_t pktring_put(pktring_t *, const void *, size_t, bool *);
+
+extern errno_t pktring_peek(pktring_t *, void **, size_t *);
+extern void pktring_consume(pktring_t *);
+
+#endif
+
+/** @}
+ */
@@ -68,6 +68,8 @@ typedef struct dyn_info {
 
 	/** Hash table */
 	elf_word *hash;
+	/** GNU-style hash table or @c NULL if the module does not have one */
+	elf_word *gnu_hash;
 
 	/** String table */
 	char *str_tab;
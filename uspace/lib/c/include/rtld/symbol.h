@@ -44,7 +44,9 @@ typedef enum {
 	/** No flags */
 	ssf_none = 0,
 	/** Do not search in the executable */
-	ssf_noexec = 0x1
+	ssf_noexec = 0x1,
+	/** Do not use the resolved symbol cache */
+	ssf_nocache = 0x2
 } symbol_search_flags_t;
 
 extern elf_symbol_t *symbol_bfs_find(const char *, module_t *, module_t **);
@@ -73,6 +73,8 @@ typedef struct module {
 
 	/** True iff relocations have already been processed in this module. */
 	bool relocated;
+	/** PLT entries are bound on first call rather than at load time */
+	bool lazy;
 
 	/** Link to list of all modules in runtime environment */
 	link_t modules_link;
@@ -42,6 +42,26 @@
 
 #include <types/rtld/module.h>
 
+/** Number of entries in the resolved symbol cache (must be a power of two) */
+#define RTLD_SYMCACHE_SIZE 1024
+
+/** Resolved symbol cache entry
+ *
+ * Caches the result of a global symbol lookup. Modules are only ever
+ * appended to the search order, so a cached definition stays valid
+ * for the lifetime of the runtime environment.
+ */
+typedef struct {
+	/** Symbol name or @c NULL if the entry is unused */
+	const char *name;
+	/** GNU hash of the name */
+	uint32_t hash;
+	/** Symbol definition */
+	elf_symbol_t *sym;
+	/** Module containing the definition */
+	module_t *mod;
+} rtld_symcache_entry_t;
+
 typedef struct rtld {
 	elf_dyn_t *rtld_dynamic;
 	module_t rtld;
@@ -60,6 +80,9 @@ typedef struct rtld {
 
 	/** List of initial modules */
 	list_t imodules;
+
+	/** Resolved symbol cache (RTLD_SYMCACHE_SIZE entries) or @c NULL */
+	rtld_symcache_entry_t *symcache;
 } rtld_t;
 
 #endif
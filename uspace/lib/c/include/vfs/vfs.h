@@ -66,9 +66,15 @@ typedef struct {
 
 typedef struct {
 	char fs_name[FS_NAME_MAXLEN + 1];
-	uint32_t f_bsize;    /* fundamental file system block size */
-	uint64_t f_blocks;   /* total data blocks in file system */
-	uint64_t f_bfree;    /* free blocks in fs */
+	uint32_t f_bsize;      /* fundamental file system block size */
+	uint64_t f_blocks;     /* total data blocks in file system */
+	uint64_t f_bfree;      /* free blocks in fs */
+	bool f_cached;         /* file system uses a block cache */
+	uint64_t c_hits;       /* block requests served from the cache */
+	uint64_t c_misses;     /* block requests that instantiated the block */
+	uint64_t c_evictions;  /* blocks evicted to make room for others */
+	uint64_t c_readahead;  /* blocks read ahead */
+	uint64_t c_writebacks; /* blocks written back by the flusher */
 } vfs_statfs_t;
 
 /** List of file system types */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/checksum.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+enum {
+	buffer_size = 1024
+};
+
+static uint8_t buffer[buffer_size + 8];
+static uint8_t copy[buffer_size + 8];
+
+/** Reference bit-by-bit CRC32 */
+static uint32_t crc32_ref(const uint8_t *data, size_t length)
+{
+	uint32_t crc = ~0U;
+
+	while (length-- > 0) {
+		crc ^= *data++;
+		for (int i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+
+	return ~crc;
+}
+
+/** Reference 16-bit word at a time Internet checksum */
+static uint16_t inet_checksum_ref(uint16_t ivalue, const uint8_t *data,
+    size_t size)
+{
+	uint32_t sum = (uint16_t) ~ivalue;
+
+	for (size_t i = 0; i < size; i += 2) {
+		sum += (uint16_t) data[i] << 8;
+		if (i + 1 < size)
+			sum += data[i + 1];
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return ~sum;
+}
+
+static void buffer_fill(void)
+{
+	uint32_t x = 12345;
+
+	for (size_t i = 0; i < sizeof(buffer); i++) {
+		x = x * 1103515245 + 12345;
+		buffer[i] = x >> 16;
+	}
+}
+
+/** CRC32 of the standard check string */
+PCUT_TEST(crc32_check)
+{
+	uint8_t check[] = "123456789";
+
+	PCUT_ASSERT_INT_EQUALS(0xcbf43926, compute_crc32(check, 9));
+	PCUT_ASSERT_INT_EQUALS(0, compute_crc32(check, 0));
+}
+
+/** CRC32 of various lengths and alignments matches the reference */
+PCUT_TEST(crc32_lengths)
+{
+	size_t lengths[] = { 1, 7, 8, 15, 63, 64, 65, 80, 127, 128, 1000 };
+
+	buffer_fill();
+
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		for (size_t off = 0; off < 4; off++) {
+			PCUT_ASSERT_INT_EQUALS(crc32_ref(buffer + off, lengths[i]),
+			    compute_crc32(buffer + off, lengths[i]));
+		}
+	}
+}
+
+/** Chained CRC32 equals CRC32 of the whole buffer */
+PCUT_TEST(crc32_seed)
+{
+	uint32_t crc;
+
+	buffer_fill();
+
+	crc = compute_crc32(buffer, 100);
+	crc = compute_crc32_seed(buffer + 100, buffer_size - 100, crc);
+	PCUT_ASSERT_INT_EQUALS(compute_crc32(buffer, buffer_size), crc);
+}
+
+/** Internet checksum of various lengths and alignments */
+PCUT_TEST(inet_checksum)
+{
+	size_t lengths[] = { 0, 1, 2, 3, 7, 8, 9, 31, 32, 33, 1000, 1023 };
+
+	buffer_fill();
+
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		for (size_t off = 0; off < 4; off++) {
+			PCUT_ASSERT_INT_EQUALS(inet_checksum_ref(0xffff,
+			    buffer + off, lengths[i]),
+			    compute_inet_checksum(0xffff, buffer + off,
+			    lengths[i]));
+			PCUT_ASSERT_INT_EQUALS(inet_checksum_ref(0x1234,
+			    buffer + off, lengths[i]),
+			    compute_inet_checksum(0x1234, buffer + off,
+			    lengths[i]));
+		}
+	}
+}
+
+/** Internet checksum of all-ones data */
+PCUT_TEST(inet_checksum_ones)
+{
+	memset(buffer, 0xff, buffer_size);
+
+	PCUT_ASSERT_INT_EQUALS(inet_checksum_ref(0xffff, buffer, buffer_size),
+	    compute_inet_checksum(0xffff, buffer, buffer_size));
+	PCUT_ASSERT_INT_EQUALS(0xffff, compute_inet_checksum(0xffff, buffer, 0));
+}
+
+/** Fused copy and checksum */
+PCUT_TEST(inet_checksum_copy)
+{
+	uint16_t cs;
+
+	buffer_fill();
+
+	for (size_t off = 0; off < 4; off++) {
+		memset(copy, 0, sizeof(copy));
+		cs = compute_inet_checksum_copy(0xffff, copy + off, buffer,
+		    buffer_size - 1);
+		PCUT_ASSERT_INT_EQUALS(inet_checksum_ref(0xffff, buffer,
+		    buffer_size - 1), cs);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(copy + off, buffer,
+		    buffer_size - 1));
+		PCUT_ASSERT_INT_EQUALS(0, copy[off + buffer_size - 1]);
+	}
+}
+
+PCUT_EXPORT(checksum);
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/twheel.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(twheel);
+
+typedef struct {
+	twheel_timer_t timer;
+	int fired;
+	uint64_t fired_at;
+} test_entry_t;
+
+static void entry_expire(twheel_timer_t *timer, void *arg)
+{
+	twheel_t *tw = (twheel_t *) arg;
+	test_entry_t *e = list_get_instance(timer, test_entry_t, timer);
+
+	e->fired++;
+	e->fired_at = tw->now;
+}
+
+/** Timers fire exactly at their expiration tick. */
+PCUT_TEST(set_expire)
+{
+	twheel_t tw;
+	test_entry_t e[3];
+	int i;
+	errno_t rc;
+
+	rc = twheel_init(&tw, 8);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (i = 0; i < 3; i++) {
+		twheel_timer_initialize(&e[i].timer);
+		e[i].fired = 0;
+	}
+
+	twheel_set(&tw, &e[0].timer, 1);
+	twheel_set(&tw, &e[1].timer, 5);
+	/* More than one revolution ahead */
+	twheel_set(&tw, &e[2].timer, 19);
+
+	PCUT_ASSERT_TRUE(twheel_timer_is_set(&e[0].timer));
+
+	for (i = 0; i < 20; i++)
+		twheel_tick(&tw, entry_expire, &tw);
+
+	for (i = 0; i < 3; i++) {
+		PCUT_ASSERT_INT_EQUALS(1, e[i].fired);
+		PCUT_ASSERT_FALSE(twheel_timer_is_set(&e[i].timer));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(1, e[0].fired_at);
+	PCUT_ASSERT_INT_EQUALS(5, e[1].fired_at);
+	PCUT_ASSERT_INT_EQUALS(19, e[2].fired_at);
+
+	twheel_fini(&tw);
+}
+
+/** Cleared timer does not fire, re-set timer fires at the new time. */
+PCUT_TEST(clear_reset)
+{
+	twheel_t tw;
+	test_entry_t a, b;
+	int i;
+	errno_t rc;
+
+	rc = twheel_init(&tw, 4);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	twheel_timer_initialize(&a.timer);
+	twheel_timer_initialize(&b.timer);
+	a.fired = 0;
+	b.fired = 0;
+
+	twheel_set(&tw, &a.timer, 2);
+	twheel_set(&tw, &b.timer, 2);
+	twheel_clear(&tw, &a.timer);
+	twheel_set(&tw, &b.timer, 3);
+
+	for (i = 0; i < 2; i++)
+		twheel_tick(&tw, entry_expire, &tw);
+
+	PCUT_ASSERT_INT_EQUALS(0, a.fired);
+	PCUT_ASSERT_INT_EQUALS(0, b.fired);
+
+	twheel_tick(&tw, entry_expire, &tw);
+	PCUT_ASSERT_INT_EQUALS(0, a.fired);
+	PCUT_ASSERT_INT_EQUALS(1, b.fired);
+	PCUT_ASSERT_INT_EQUALS(3, b.fired_at);
+
+	twheel_fini(&tw);
+}
+
+static void entry_free_expire(twheel_timer_t *timer, void *arg)
+{
+	int *count = (int *) arg;
+	test_entry_t *e = list_get_instance(timer, test_entry_t, timer);
+
+	(*count)++;
+	free(e);
+}
+
+/** Expiration callback may free the entry. */
+PCUT_TEST(expire_free)
+{
+	twheel_t tw;
+	test_entry_t *e;
+	int count;
+	int i;
+	errno_t rc;
+
+	rc = twheel_init(&tw, 4);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (i = 0; i < 10; i++) {
+		e = calloc(1, sizeof(test_entry_t));
+		PCUT_ASSERT_NOT_NULL(e);
+		twheel_timer_initialize(&e->timer);
+		twheel_set(&tw, &e->timer, 1 + i % 3);
+	}
+
+	count = 0;
+	for (i = 0; i < 3; i++)
+		twheel_tick(&tw, entry_free_expire, &count);
+
+	PCUT_ASSERT_INT_EQUALS(10, count);
+	twheel_fini(&tw);
+}
+
+PCUT_EXPORT(twheel);
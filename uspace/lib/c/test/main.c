@@ -33,6 +33,7 @@ PCUT_INIT;
 
 PCUT_IMPORT(capa);
 PCUT_IMPORT(casting);
+PCUT_IMPORT(checksum);
 PCUT_IMPORT(circ_buf);
 PCUT_IMPORT(double_to_str);
 PCUT_IMPORT(fibril_timer);
@@ -45,6 +46,7 @@ PCUT_IMPORT(mem);
 PCUT_IMPORT(odict);
 PCUT_IMPORT(perf);
 PCUT_IMPORT(perm);
+PCUT_IMPORT(pktring);
 PCUT_IMPORT(qsort);
 PCUT_IMPORT(scanf);
 PCUT_IMPORT(sprintf);
@@ -54,6 +56,7 @@ PCUT_IMPORT(str);
 PCUT_IMPORT(string);
 PCUT_IMPORT(strtol);
 PCUT_IMPORT(table);
+PCUT_IMPORT(twheel);
 PCUT_IMPORT(uuid);
 
 PCUT_MAIN();
@@ -28,11 +28,34 @@
 
 #include <mem.h>
 #include <pcut/pcut.h>
+#include <stdint.h>
 
 PCUT_INIT;
 
 PCUT_TEST_SUITE(mem);
 
+enum {
+	/** Size of test buffers for the size and alignment tests */
+	mem_buf_size = 4096 + 64
+};
+
+static uint8_t mem_src[mem_buf_size];
+static uint8_t mem_dst[mem_buf_size];
+
+/** Block sizes covering all size classes and their boundaries */
+static size_t mem_sizes[] = {
+	0, 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65,
+	127, 128, 129, 255, 1000, 2047, 2048, 2049, 4096
+};
+
+#define MEM_SIZES_COUNT (sizeof(mem_sizes) / sizeof(mem_sizes[0]))
+
+static void mem_buf_fill(uint8_t *buf, uint8_t seed)
+{
+	for (size_t i = 0; i < mem_buf_size; i++)
+		buf[i] = (uint8_t) (i * 31 + seed);
+}
+
 /** memcpy function */
 PCUT_TEST(memcpy)
 {
@@ -115,4 +138,94 @@ PCUT_TEST(memset)
 	PCUT_ASSERT_INT_EQUALS('x', buf[4]);
 }
 
+/** Copy block using memcpy and verify the destination buffer */
+static void mem_copy_check(size_t doff, size_t soff, size_t n)
+{
+	uint8_t exp;
+
+	mem_buf_fill(mem_src, 1);
+	mem_buf_fill(mem_dst, 2);
+
+	memcpy(mem_dst + doff, mem_src + soff, n);
+
+	for (size_t j = 0; j < mem_buf_size; j++) {
+		if (j >= doff && j < doff + n)
+			exp = mem_src[soff + j - doff];
+		else
+			exp = j * 31 + 2;
+		PCUT_ASSERT_INT_EQUALS(exp, mem_dst[j]);
+	}
+}
+
+/** memcpy with various sizes and alignments */
+PCUT_TEST(memcpy_sizes)
+{
+	for (size_t i = 0; i < MEM_SIZES_COUNT; i++) {
+		for (size_t soff = 0; soff < 32; soff += 7) {
+			for (size_t doff = 0; doff < 32; doff += 5)
+				mem_copy_check(doff, soff, mem_sizes[i]);
+		}
+	}
+}
+
+/** memmove with overlapping blocks in both directions */
+PCUT_TEST(memmove_overlap)
+{
+	size_t dists[] = { 1, 8, 15, 16, 17, 100 };
+	uint8_t exp;
+
+	for (size_t i = 0; i < MEM_SIZES_COUNT; i++) {
+		size_t n = mem_sizes[i];
+		if (n + 100 > mem_buf_size - 32)
+			continue;
+
+		for (size_t k = 0; k < sizeof(dists) / sizeof(dists[0]); k++) {
+			size_t d = dists[k];
+
+			/* Forwards (destination below source) */
+			mem_buf_fill(mem_dst, 3);
+			memmove(mem_dst + 3, mem_dst + 3 + d, n);
+			for (size_t j = 0; j < n; j++) {
+				exp = (j + 3 + d) * 31 + 3;
+				PCUT_ASSERT_INT_EQUALS(exp, mem_dst[j + 3]);
+			}
+
+			/* Backwards (destination above source) */
+			mem_buf_fill(mem_dst, 3);
+			memmove(mem_dst + 3 + d, mem_dst + 3, n);
+			for (size_t j = 0; j < n; j++) {
+				exp = (j + 3) * 31 + 3;
+				PCUT_ASSERT_INT_EQUALS(exp, mem_dst[j + 3 + d]);
+			}
+
+			exp = (3 + d + n) * 31 + 3;
+			PCUT_ASSERT_INT_EQUALS(exp, mem_dst[3 + d + n]);
+		}
+	}
+}
+
+/** memset with various sizes and alignments */
+PCUT_TEST(memset_sizes)
+{
+	uint8_t exp;
+
+	for (size_t i = 0; i < MEM_SIZES_COUNT; i++) {
+		size_t n = mem_sizes[i];
+
+		for (size_t doff = 0; doff < 32; doff += 5) {
+			mem_buf_fill(mem_dst, 4);
+
+			memset(mem_dst + doff, 0xa5, n);
+
+			for (size_t j = 0; j < mem_buf_size; j++) {
+				if (j >= doff && j < doff + n)
+					exp = 0xa5;
+				else
+					exp = j * 31 + 4;
+				PCUT_ASSERT_INT_EQUALS(exp, mem_dst[j]);
+			}
+		}
+	}
+}
+
 PCUT_EXPORT(mem);
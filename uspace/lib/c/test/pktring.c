@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <pktring.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(pktring);
+
+enum {
+	test_nslots = 8,
+	test_slot_size = 100
+};
+
+/** Create consumer ring and attach producer endpoint to it */
+static void test_ring_create(pktring_t **rcons, pktring_t **rprod)
+{
+	errno_t rc;
+
+	rc = pktring_create(test_nslots, test_slot_size, rcons);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = pktring_attach((*rcons)->hdr, (*rcons)->area_size, rprod);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+static void test_ring_destroy(pktring_t *cons, pktring_t *prod)
+{
+	pktring_detach(prod);
+	pktring_destroy(cons);
+}
+
+/** Creating a ring rounds the number of slots up to a power of two */
+PCUT_TEST(create_destroy)
+{
+	pktring_t *ring;
+	errno_t rc;
+
+	rc = pktring_create(5, test_slot_size, &ring);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(8, ring->nslots);
+	PCUT_ASSERT_INT_EQUALS(test_slot_size, pktring_slot_size(ring));
+	pktring_destroy(ring);
+
+	rc = pktring_create(0, test_slot_size, &ring);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** Packets are received in order and the consumer is notified only
+ * when the ring transitions from empty
+ */
+PCUT_TEST(put_peek_consume)
+{
+	pktring_t *cons, *prod;
+	bool notify;
+	void *buf;
+	size_t size;
+	int i, j;
+	errno_t rc;
+
+	test_ring_create(&cons, &prod);
+
+	rc = pktring_peek(cons, &buf, &size);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	for (i = 0; i < 3; i++) {
+		rc = pktring_put(prod, &i, sizeof(i), &notify);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(i == 0, notify);
+	}
+
+	for (i = 0; i < 3; i++) {
+		rc = pktring_peek(cons, &buf, &size);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(sizeof(j), size);
+		memcpy(&j, buf, sizeof(j));
+		PCUT_ASSERT_INT_EQUALS(i, j);
+		pktring_consume(cons);
+	}
+
+	rc = pktring_peek(cons, &buf, &size);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	/* Ring is empty again, next packet needs a notification */
+	rc = pktring_put(prod, &i, sizeof(i), &notify);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(notify);
+
+	test_ring_destroy(cons, prod);
+}
+
+/** Producer cannot overrun the consumer */
+PCUT_TEST(full)
+{
+	pktring_t *cons, *prod;
+	bool notify;
+	void *buf;
+	size_t size;
+	uint8_t data[test_slot_size + 1];
+	int round, i;
+	errno_t rc;
+
+	test_ring_create(&cons, &prod);
+
+	rc = pktring_put(prod, data, sizeof(data), &notify);
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+
+	/* Go around the ring several times */
+	for (round = 0; round < 3; round++) {
+		for (i = 0; i < test_nslots; i++) {
+			memset(data, round * test_nslots + i, test_slot_size);
+			rc = pktring_put(prod, data, test_slot_size, &notify);
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		}
+
+		rc = pktring_put(prod, data, 1, &notify);
+		PCUT_ASSERT_ERRNO_VAL(ENOSPC, rc);
+
+		for (i = 0; i < test_nslots; i++) {
+			rc = pktring_peek(cons, &buf, &size);
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+			PCUT_ASSERT_INT_EQUALS(test_slot_size, size);
+			PCUT_ASSERT_INT_EQUALS(round * test_nslots + i,
+			    ((uint8_t *) buf)[test_slot_size - 1]);
+			pktring_consume(cons);
+		}
+	}
+
+	test_ring_destroy(cons, prod);
+}
+
+/** Packet can be constructed in place */
+PCUT_TEST(alloc_commit)
+{
+	pktring_t *cons, *prod;
+	void *buf;
+	size_t size;
+	errno_t rc;
+
+	test_ring_create(&cons, &prod);
+
+	rc = pktring_alloc(prod, test_slot_size, &buf);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	memcpy(buf, "hello", 5);
+	PCUT_ASSERT_TRUE(pktring_commit(prod, 5));
+
+	rc = pktring_peek(cons, &buf, &size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(5, size);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, "hello", 5));
+	pktring_consume(cons);
+
+	test_ring_destroy(cons, prod);
+}
+
+PCUT_EXPORT(pktring);
@@ -26,6 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <adt/checksum.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <errno.h>
@@ -69,7 +70,7 @@ typedef struct {
  * data to 4 GiB (expanding input streams that actually
  * encode more data will always fail).
  *
- * So far, no CRC is perfomed.
+ * The CRC32 of the uncompressed data is verified.
  *
  * @param[in]  src     Source data buffer.
  * @param[in]  srclen  Source buffer size (bytes).
@@ -80,6 +81,7 @@ typedef struct {
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code, invalid deflate data,
  *                   invalid compression method or invalid stream.
+ * @return EIO on CRC mismatch.
  * @return ELIMIT on input buffer overrun.
  * @return ENOMEM on output buffer overrun.
  *
@@ -175,9 +177,14 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 
 	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
 	if (ret != EOK) {
-		free(dest);
+		free(*dest);
 		return ret;
 	}
 
+	if (compute_crc32(*dest, *destlen) != uint32_t_le2host(footer.crc32)) {
+		free(*dest);
+		return EIO;
+	}
+
 	return EOK;
 }
@@ -40,6 +40,9 @@
 #include <ipc/services.h>
 #include <time.h>
 #include <macros.h>
+#include <pktring.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 #include "ops/nic.h"
 #include "nic_iface.h"
@@ -85,7 +88,9 @@ typedef enum {
 	NIC_OFFLOAD_SET,
 	NIC_POLL_GET_MODE,
 	NIC_POLL_SET_MODE,
-	NIC_POLL_NOW
+	NIC_POLL_NOW,
+	NIC_RX_RING_SET,
+	NIC_SEND_FRAMES
 } nic_funcs_t;
 
 /** Send frame from NIC
@@ -117,6 +122,133 @@ errno_t nic_send_frame(async_sess_t *dev_sess, void *data, size_t size)
 	return retval;
 }
 
+/** Write a batch of frames to an exchange.
+ *
+ * Transfers the frame sizes followed by the frame data, which is packed
+ * back to back, using two data write transfers. The request carrying
+ * the frame count must have been sent by the caller. Both transfers are
+ * always started, so that the other side can answer them in any case.
+ *
+ * @param[in] exch   Exchange
+ * @param[in] data   Packed frame data
+ * @param[in] sizes  Frame sizes in bytes
+ * @param[in] count  Number of frames (at most NIC_FRAMES_MAX)
+ *
+ * @return EOK on success or an error code
+ *
+ */
+errno_t nic_frames_write(async_exch_t *exch, void *data, const size_t *sizes,
+    size_t count)
+{
+	size_t total = 0;
+
+	for (size_t i = 0; i < count; i++)
+		total += sizes[i];
+
+	errno_t rc = async_data_write_start(exch, sizes,
+	    count * sizeof(size_t));
+	errno_t rc_data = async_data_write_start(exch, data, total);
+
+	return (rc != EOK) ? rc : rc_data;
+}
+
+/** Refuse data write transfers of a malformed batch of frames.
+ *
+ * @param count Number of data write transfers to refuse
+ *
+ */
+static void nic_frames_refuse(unsigned count)
+{
+	for (unsigned i = 0; i < count; i++) {
+		ipc_call_t call;
+		if (async_data_write_receive(&call, NULL))
+			async_answer_0(&call, EINVAL);
+	}
+}
+
+/** Accept a batch of frames written by nic_frames_write().
+ *
+ * @param[in]  count   Number of frames announced by the request
+ * @param[out] rdata   Place to store packed frame data
+ * @param[out] rsizes  Place to store array of frame sizes
+ *
+ * @return EOK on success, EINVAL if the batch is malformed, or
+ *         an error code
+ *
+ */
+errno_t nic_frames_accept(size_t count, void **rdata, size_t **rsizes)
+{
+	size_t *sizes;
+	void *data;
+	size_t size;
+	size_t total;
+	errno_t rc;
+
+	if (count == 0 || count > NIC_FRAMES_MAX) {
+		nic_frames_refuse(2);
+		return EINVAL;
+	}
+
+	rc = async_data_write_accept((void **) &sizes, false,
+	    count * sizeof(size_t), count * sizeof(size_t), 0, NULL);
+	if (rc != EOK) {
+		nic_frames_refuse(1);
+		return rc;
+	}
+
+	total = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (sizes[i] == 0 || sizes[i] > SIZE_MAX - total) {
+			free(sizes);
+			nic_frames_refuse(1);
+			return EINVAL;
+		}
+
+		total += sizes[i];
+	}
+
+	rc = async_data_write_accept(&data, false, total, total, 0, &size);
+	if (rc != EOK) {
+		free(sizes);
+		return rc;
+	}
+
+	*rdata = data;
+	*rsizes = sizes;
+	return EOK;
+}
+
+/** Send a batch of frames from NIC
+ *
+ * @param[in] dev_sess
+ * @param[in] data     Frame data packed back to back
+ * @param[in] sizes    Frame sizes in bytes
+ * @param[in] count    Number of frames (at most NIC_FRAMES_MAX)
+ *
+ * @return EOK If the operation was successfully completed
+ *
+ */
+errno_t nic_send_frames(async_sess_t *dev_sess, void *data,
+    const size_t *sizes, size_t count)
+{
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_SEND_FRAMES, count, &answer);
+	errno_t retval = nic_frames_write(exch, data, sizes, count);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 /** Create callback connection from NIC service
  *
  * @param[in] dev_sess
@@ -1335,6 +1467,39 @@ errno_t nic_poll_now(async_sess_t *dev_sess)
 	return rc;
 }
 
+/** Set up shared-memory ring for passing received frames.
+ *
+ * Once the ring is set up, the driver stores received frames into the ring
+ * instead of sending them via NIC_EV_RECEIVED. It sends NIC_EV_RX_RING when
+ * a frame is stored into an empty ring.
+ *
+ * @param[in] dev_sess
+ * @param[in] ring     Receive ring (consumer side)
+ *
+ * @return EOK If the operation was successfully completed
+ * @return ENOTSUP If the driver does not support receive rings
+ *
+ */
+errno_t nic_rx_ring_set(async_sess_t *dev_sess, pktring_t *ring)
+{
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_RX_RING_SET, &answer);
+	errno_t retval = pktring_share_out(ring, exch);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 static void remote_nic_send_frame(ddf_fun_t *dev, void *iface,
     ipc_call_t *call)
 {
@@ -1356,6 +1521,41 @@ static void remote_nic_send_frame(ddf_fun_t *dev, void *iface,
 	free(data);
 }
 
+static void remote_nic_send_frames(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	assert(nic_iface->send_frame);
+
+	size_t count = ipc_get_arg2(call);
+	size_t *sizes;
+	void *data;
+	errno_t rc;
+
+	rc = nic_frames_accept(count, &data, &sizes);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	if (nic_iface->send_frames != NULL) {
+		rc = nic_iface->send_frames(dev, data, sizes, count);
+	} else {
+		uint8_t *frame = data;
+
+		for (size_t i = 0; i < count; i++) {
+			rc = nic_iface->send_frame(dev, frame, sizes[i]);
+			if (rc != EOK)
+				break;
+			frame += sizes[i];
+		}
+	}
+
+	async_answer_0(call, rc);
+	free(sizes);
+	free(data);
+}
+
 static void remote_nic_callback_create(ddf_fun_t *dev, void *iface,
     ipc_call_t *call)
 {
@@ -2485,6 +2685,36 @@ static void remote_nic_poll_now(ddf_fun_t *dev, void *iface,
 	async_answer_0(call, rc);
 }
 
+static void remote_nic_rx_ring_set(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	ipc_call_t data;
+	size_t size;
+	unsigned int flags;
+	pktring_t *ring;
+	errno_t rc;
+
+	if (nic_iface->rx_ring_set == NULL) {
+		(void) async_share_out_receive(&data, &size, &flags);
+		async_answer_0(&data, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = pktring_share_accept(&ring);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	rc = nic_iface->rx_ring_set(dev, ring);
+	if (rc != EOK)
+		pktring_destroy(ring);
+
+	async_answer_0(call, rc);
+}
+
 /** Remote NIC interface operations.
  *
  */
@@ -2529,7 +2759,9 @@ static const remote_iface_func_ptr_t remote_nic_iface_ops[] = {
 	[NIC_OFFLOAD_SET] = remote_nic_offload_set,
 	[NIC_POLL_GET_MODE] = remote_nic_poll_get_mode,
 	[NIC_POLL_SET_MODE] = remote_nic_poll_set_mode,
-	[NIC_POLL_NOW] = remote_nic_poll_now
+	[NIC_POLL_NOW] = remote_nic_poll_now,
+	[NIC_RX_RING_SET] = remote_nic_rx_ring_set,
+	[NIC_SEND_FRAMES] = remote_nic_send_frames
 };
 
 /** Remote NIC interface structure.
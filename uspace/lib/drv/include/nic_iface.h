@@ -38,14 +38,23 @@
 #include <async.h>
 #include <nic/nic.h>
 #include <ipc/common.h>
+#include <pktring.h>
 
 typedef enum {
 	NIC_EV_ADDR_CHANGED = IPC_FIRST_USER_METHOD,
 	NIC_EV_RECEIVED,
-	NIC_EV_DEVICE_STATE
+	NIC_EV_DEVICE_STATE,
+	NIC_EV_RX_RING,
+	NIC_EV_RECEIVED_FRAMES
 } nic_event_t;
 
+/** Maximum number of frames transferred in one batch */
+#define NIC_FRAMES_MAX 64
+
 extern errno_t nic_send_frame(async_sess_t *, void *, size_t);
+extern errno_t nic_send_frames(async_sess_t *, void *, const size_t *, size_t);
+extern errno_t nic_frames_write(async_exch_t *, void *, const size_t *, size_t);
+extern errno_t nic_frames_accept(size_t, void **, size_t **);
 extern errno_t nic_callback_create(async_sess_t *, async_port_handler_t, void *);
 extern errno_t nic_get_state(async_sess_t *, nic_device_state_t *);
 extern errno_t nic_set_state(async_sess_t *, nic_device_state_t);
@@ -108,6 +117,7 @@ extern errno_t nic_poll_get_mode(async_sess_t *, nic_poll_mode_t *,
 extern errno_t nic_poll_set_mode(async_sess_t *, nic_poll_mode_t,
     const struct timespec *);
 extern errno_t nic_poll_now(async_sess_t *);
+extern errno_t nic_rx_ring_set(async_sess_t *, pktring_t *);
 
 #endif
 
@@ -38,6 +38,7 @@
 
 #include <ipc/services.h>
 #include <nic/nic.h>
+#include <pktring.h>
 #include <time.h>
 #include "../ddf/driver.h"
 
@@ -50,6 +51,7 @@ typedef struct nic_iface {
 	errno_t (*get_address)(ddf_fun_t *, nic_address_t *);
 
 	/** Optional methods */
+	errno_t (*send_frames)(ddf_fun_t *, void *, const size_t *, size_t);
 	errno_t (*set_address)(ddf_fun_t *, const nic_address_t *);
 	errno_t (*get_stats)(ddf_fun_t *, nic_device_stats_t *);
 	errno_t (*get_device_info)(ddf_fun_t *, nic_device_info_t *);
@@ -107,6 +109,7 @@ typedef struct nic_iface {
 	errno_t (*poll_set_mode)(ddf_fun_t *, nic_poll_mode_t,
 	    const struct timespec *);
 	errno_t (*poll_now)(ddf_fun_t *);
+	errno_t (*rx_ring_set)(ddf_fun_t *, pktring_t *);
 } nic_iface_t;
 
 #endif
@@ -227,13 +227,37 @@ typedef struct ext4_superblock {
 	EXT4_FEATURE_RO_COMPAT_GDT_CSUM | \
 	EXT4_FEATURE_RO_COMPAT_EXTRA_ISIZE)
 
+/** Number of i-nodes whose preallocation windows are kept between requests */
+#define EXT4_PREALLOC_SLOTS  16
+
+/** Blocks preallocated for appending to an i-node */
+typedef struct {
+	uint32_t inode;  /* I-node index, 0 if the slot is unused */
+	uint32_t start;  /* First preallocated block */
+	uint32_t count;  /* Number of preallocated blocks */
+} ext4_prealloc_t;
+
 typedef struct ext4_filesystem {
 	service_id_t device;
 	ext4_superblock_t *superblock;
 	aoff64_t inode_block_limits[4];
 	aoff64_t inode_blocks_per_level[4];
+	/*
+	 * Upper bound of the longest run of free blocks for each block
+	 * group, used by the allocator to skip groups which cannot satisfy
+	 * a request for contiguous blocks.
+	 */
+	uint32_t *bg_free_run;
+	/*
+	 * Preallocation windows of i-nodes which are not referenced at the
+	 * moment. A window is kept until the file is closed or truncated.
+	 */
+	ext4_prealloc_t prealloc[EXT4_PREALLOC_SLOTS];
 } ext4_filesystem_t;
 
+/** Unknown length of the longest free run in a block group */
+#define EXT4_BG_FREE_RUN_UNKNOWN  UINT32_MAX
+
 /** Size of buffer for volume name. To hold 16 latin-1 chars encoded as UTF-8
  * and a null terminator we need 2 * 16 + 1 bytes
  */
@@ -393,6 +417,8 @@ typedef struct ext4_inode_ref {
 	ext4_filesystem_t *fs;
 	uint32_t index;         /* Index number of this inode */
 	bool dirty;
+	uint32_t prealloc_start; /* First block preallocated for appending */
+	uint32_t prealloc_count; /* Number of preallocated blocks */
 } ext4_inode_ref_t;
 
 #define EXT4_DIRECTORY_FILENAME_LEN  255
@@ -537,6 +563,12 @@ typedef struct ext4_extent_path {
 
 #define EXT4_EXTENT_MAGIC  0xF30A
 
+/*
+ * Extents longer than this are uninitialized (preallocated), the excess
+ * being their actual length.
+ */
+#define EXT4_EXTENT_MAX_INIT_LEN  32768
+
 #define	EXT4_EXTENT_FIRST(header) \
 	((ext4_extent_t *) (((void *) (header)) + sizeof(ext4_extent_header_t)))
 
@@ -46,6 +46,11 @@
 #include "ext4/superblock.h"
 #include "ext4/types.h"
 
+/** Minimal number of blocks preallocated for appending to an i-node */
+#define EXT4_BALLOC_PREALLOC_MIN  8
+/** Maximal number of blocks preallocated for appending to an i-node */
+#define EXT4_BALLOC_PREALLOC_MAX  256
+
 /** Free block.
  *
  * @param inode_ref  Inode, where the block is allocated
@@ -83,6 +88,7 @@ errno_t ext4_balloc_free_block(ext4_inode_ref_t *inode_ref, uint32_t block_addr)
 	/* Modify bitmap */
 	ext4_bitmap_free_bit(bitmap_block->data, index_in_group);
 	bitmap_block->dirty = true;
+	fs->bg_free_run[block_group] = EXT4_BG_FREE_RUN_UNKNOWN;
 
 	/* Release block with bitmap */
 	rc = block_put(bitmap_block);
@@ -120,7 +126,7 @@ errno_t ext4_balloc_free_block(ext4_inode_ref_t *inode_ref, uint32_t block_addr)
 }
 
 static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
-    uint32_t first, uint32_t count)
+    uint32_t first, uint32_t count, bool update_inode)
 {
 	ext4_filesystem_t *fs = inode_ref->fs;
 	ext4_superblock_t *sb = fs->superblock;
@@ -156,6 +162,7 @@ static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
 	/* Modify bitmap */
 	ext4_bitmap_free_bits(bitmap_block->data, index_in_group_first, count);
 	bitmap_block->dirty = true;
+	fs->bg_free_run[block_group_first] = EXT4_BG_FREE_RUN_UNKNOWN;
 
 	/* Release block with bitmap */
 	rc = block_put(bitmap_block);
@@ -174,11 +181,13 @@ static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
 	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
 
 	/* Update inode blocks count */
-	uint64_t ino_blocks =
-	    ext4_inode_get_blocks_count(sb, inode_ref->inode);
-	ino_blocks -= count * (block_size / EXT4_INODE_BLOCK_SIZE);
-	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
-	inode_ref->dirty = true;
+	if (update_inode) {
+		uint64_t ino_blocks =
+		    ext4_inode_get_blocks_count(sb, inode_ref->inode);
+		ino_blocks -= count * (block_size / EXT4_INODE_BLOCK_SIZE);
+		ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
+		inode_ref->dirty = true;
+	}
 
 	/* Update block group free blocks count */
 	uint32_t free_blocks =
@@ -221,7 +230,7 @@ errno_t ext4_balloc_free_blocks(ext4_inode_ref_t *inode_ref,
 			uint32_t s = limit - first;
 
 			r = ext4_balloc_free_blocks_internal(inode_ref,
-			    first, s);
+			    first, s, true);
 			if (r != EOK)
 				return r;
 
@@ -229,7 +238,7 @@ errno_t ext4_balloc_free_blocks(ext4_inode_ref_t *inode_ref,
 			count -= s;
 		} else {
 			return ext4_balloc_free_blocks_internal(inode_ref,
-			    first, count);
+			    first, count, true);
 		}
 	}
 
@@ -312,7 +321,7 @@ static errno_t ext4_balloc_find_goal(ext4_inode_ref_t *inode_ref, uint32_t *goal
 		if (rc != EOK)
 			return rc;
 
-		if (goal != 0) {
+		if (*goal != 0) {
 			(*goal)++;
 			return EOK;
 		}
@@ -614,6 +623,261 @@ success:
 	return rc;
 }
 
+/** Allocate a run of blocks in a block group.
+ *
+ * @param inode_ref  I-node to allocate blocks for
+ * @param bgid       Index of the block group
+ * @param start      Index in the group to start searching at
+ * @param contiguous Prefer the run at @a start if it is at least
+ *                   @a want blocks long
+ * @param want       Minimal acceptable length of the run
+ * @param max_len    Maximal length of the run
+ * @param fblock     Output value - first block of the run
+ * @param count      Output value - length of the run, 0 if no suitable
+ *                   run was found
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_balloc_alloc_run_in_group(ext4_inode_ref_t *inode_ref,
+    uint32_t bgid, uint32_t start, bool contiguous, uint32_t want,
+    uint32_t max_len, uint32_t *fblock, uint32_t *count)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_superblock_t *sb = fs->superblock;
+
+	*count = 0;
+
+	/* Skip groups which are known not to have a long enough run */
+	if (!contiguous && (fs->bg_free_run[bgid] < want))
+		return EOK;
+
+	ext4_block_group_ref_t *bg_ref;
+	errno_t rc = ext4_filesystem_get_block_group_ref(fs, bgid, &bg_ref);
+	if (rc != EOK)
+		return rc;
+
+	uint32_t free_blocks =
+	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
+	if (free_blocks < want)
+		goto out;
+
+	/* Compute indexes */
+	uint32_t first_in_group =
+	    ext4_balloc_get_first_data_block_in_group(sb, bg_ref);
+	uint32_t first_in_group_index =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, first_in_group);
+	uint32_t blocks_in_group = ext4_superblock_get_blocks_in_group(sb, bgid);
+
+	if (start < first_in_group_index)
+		start = first_in_group_index;
+
+	if (start >= blocks_in_group)
+		goto out;
+
+	/* Load block with bitmap */
+	uint32_t bitmap_block_addr =
+	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
+	block_t *bitmap_block;
+	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr,
+	    BLOCK_FLAGS_NONE);
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	uint32_t idx = start;
+	uint32_t len = 0;
+
+	if (contiguous) {
+		len = ext4_bitmap_free_run_length(bitmap_block->data, start,
+		    min(blocks_in_group, start + max_len));
+	}
+
+	if (len < want) {
+		/* Search from the start index first, then the whole group */
+		rc = ext4_bitmap_find_free_run(bitmap_block->data, start,
+		    blocks_in_group, max_len, &idx, &len);
+		if (((rc != EOK) || (len < want)) &&
+		    (start > first_in_group_index)) {
+			rc = ext4_bitmap_find_free_run(bitmap_block->data,
+			    first_in_group_index, blocks_in_group, max_len,
+			    &idx, &len);
+		}
+
+		if (rc != EOK)
+			len = 0;
+
+		/* The whole group has been searched */
+		if (len < want)
+			fs->bg_free_run[bgid] = len;
+	}
+
+	if (len < want) {
+		len = 0;
+		rc = block_put(bitmap_block);
+		goto out;
+	}
+
+	ext4_bitmap_set_bits(bitmap_block->data, idx, len);
+	bitmap_block->dirty = true;
+
+	rc = block_put(bitmap_block);
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	/* Update block group free blocks count */
+	ext4_block_group_set_free_blocks_count(bg_ref->block_group, sb,
+	    free_blocks - len);
+	bg_ref->dirty = true;
+
+	*fblock = ext4_filesystem_index_in_group2blockaddr(sb, idx, bgid);
+	*count = len;
+
+out:
+	if (rc != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc;
+	}
+
+	return ext4_filesystem_put_block_group_ref(bg_ref);
+}
+
+/** Allocate a run of contiguous data blocks.
+ *
+ * Blocks preallocated for the i-node are used first if they follow the
+ * last block of the i-node. Otherwise, a run of at least @a want free
+ * blocks is searched for, starting at the goal. The run is extended by a
+ * preallocation window, which grows with the size of the i-node, so that
+ * appending writers get contiguous blocks without searching the bitmaps
+ * on every request. If no run is long enough, a shorter one is returned.
+ *
+ * @param inode_ref I-node to allocate blocks for
+ * @param want      Number of blocks requested
+ * @param fblock    Output value - first allocated block
+ * @param count     Output value - number of allocated blocks (at least one)
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_alloc_blocks(ext4_inode_ref_t *inode_ref, uint32_t want,
+    uint32_t *fblock, uint32_t *count)
+{
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+	uint32_t goal;
+
+	assert(want > 0);
+
+	errno_t rc = ext4_balloc_find_goal(inode_ref, &goal);
+	if (rc != EOK)
+		return rc;
+
+	uint32_t first;
+	uint32_t n = 0;
+
+	if (inode_ref->prealloc_count > 0) {
+		if (inode_ref->prealloc_start == goal) {
+			/* Take the blocks from the preallocation window */
+			first = goal;
+			n = min(want, inode_ref->prealloc_count);
+			inode_ref->prealloc_start += n;
+			inode_ref->prealloc_count -= n;
+			goto success;
+		}
+
+		/* The window does not follow the i-node any more */
+		rc = ext4_balloc_discard_prealloc(inode_ref);
+		if (rc != EOK)
+			return rc;
+	}
+
+	/* Preallocation window grows with the size of the i-node */
+	uint64_t inode_size = ext4_inode_get_size(sb, inode_ref->inode);
+	uint32_t window = min(max(inode_size / block_size,
+	    EXT4_BALLOC_PREALLOC_MIN), EXT4_BALLOC_PREALLOC_MAX);
+
+	want = min(want, EXT4_EXTENT_MAX_INIT_LEN);
+	uint32_t max_len = min(want + window, EXT4_EXTENT_MAX_INIT_LEN);
+
+	uint32_t goal_group = ext4_filesystem_blockaddr2group(sb, goal);
+	uint32_t goal_index =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, goal);
+	uint32_t block_group_count = ext4_superblock_get_block_group_count(sb);
+
+	/*
+	 * Look for a long enough run first, then for any free blocks
+	 * without preallocating more.
+	 */
+	for (unsigned pass = 0; pass < 2; pass++) {
+		uint32_t bgid = goal_group;
+
+		for (uint32_t i = 0; i < block_group_count; i++) {
+			rc = ext4_balloc_alloc_run_in_group(inode_ref, bgid,
+			    (i == 0) ? goal_index : 0, i == 0,
+			    (pass == 0) ? want : 1, max_len, &first, &n);
+			if (rc != EOK)
+				return rc;
+
+			if (n > 0)
+				goto found;
+
+			bgid = (bgid + 1) % block_group_count;
+		}
+
+		max_len = want;
+	}
+
+	return ENOSPC;
+
+found:
+	/* Update superblock free blocks count */
+	ext4_superblock_set_free_blocks_count(sb,
+	    ext4_superblock_get_free_blocks_count(sb) - n);
+
+	/* Keep the blocks not requested for future appends */
+	if (n > want) {
+		inode_ref->prealloc_start = first + want;
+		inode_ref->prealloc_count = n - want;
+		n = want;
+	}
+
+success:
+	/* Update inode blocks (different block size!) count */
+	ext4_inode_set_blocks_count(sb, inode_ref->inode,
+	    ext4_inode_get_blocks_count(sb, inode_ref->inode) +
+	    n * (block_size / EXT4_INODE_BLOCK_SIZE));
+	inode_ref->dirty = true;
+
+	*fblock = first;
+	*count = n;
+	return EOK;
+}
+
+/** Return blocks preallocated for an i-node to the free blocks.
+ *
+ * @param inode_ref I-node to discard the preallocation window of
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_discard_prealloc(ext4_inode_ref_t *inode_ref)
+{
+	uint32_t first = inode_ref->prealloc_start;
+	uint32_t count = inode_ref->prealloc_count;
+
+	if (count == 0)
+		return EOK;
+
+	inode_ref->prealloc_start = 0;
+	inode_ref->prealloc_count = 0;
+
+	/* The window never spans more block groups */
+	return ext4_balloc_free_blocks_internal(inode_ref, first, count, false);
+}
+
 /** Try to allocate concrete block.
  *
  * @param inode_ref Inode to allocate block for
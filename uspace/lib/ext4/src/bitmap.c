@@ -36,6 +36,8 @@
 
 #include <errno.h>
 #include <block.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdint.h>
 #include "ext4/bitmap.h"
 
@@ -118,6 +120,42 @@ void ext4_bitmap_free_bits(uint8_t *bitmap, uint32_t index, uint32_t count)
 	}
 }
 
+/** Set continuous set of bits to 1 (used).
+ *
+ * Index and count must be checked by caller, if they aren't out of bounds.
+ *
+ * @param bitmap Pointer to bitmap
+ * @param index  Index of first bit to set
+ * @param count  Number of bits to set
+ *
+ */
+void ext4_bitmap_set_bits(uint8_t *bitmap, uint32_t index, uint32_t count)
+{
+	uint32_t idx = index;
+	uint32_t remaining = count;
+
+	/* Align index to multiple of 8 */
+	while (((idx % 8) != 0) && (remaining > 0)) {
+		bitmap[idx / 8] |= 1 << (idx % 8);
+		idx++;
+		remaining--;
+	}
+
+	/* Set the whole bytes */
+	while (remaining >= 8) {
+		bitmap[idx / 8] = 255;
+		idx += 8;
+		remaining -= 8;
+	}
+
+	/* Set remaining bits */
+	while (remaining != 0) {
+		bitmap[idx / 8] |= 1 << (idx % 8);
+		idx++;
+		remaining--;
+	}
+}
+
 /** Set bit in bitmap to 1 (used).
  *
  * @param bitmap Pointer to bitmap
@@ -264,6 +302,116 @@ errno_t ext4_bitmap_find_free_bit_and_set(uint8_t *bitmap, uint32_t start_idx,
 	return ENOSPC;
 }
 
+/** Load 64 bits of bitmap starting at a multiple of 64.
+ *
+ * Only used for checking whether all the bits are free or used, so the
+ * byte order does not matter.
+ *
+ * @param bitmap Pointer to bitmap
+ * @param index  Index of first bit (multiple of 64)
+ *
+ * @return Bitmap word
+ *
+ */
+static uint64_t ext4_bitmap_word(uint8_t *bitmap, uint32_t index)
+{
+	uint64_t word;
+
+	memcpy(&word, bitmap + index / 8, sizeof(word));
+	return word;
+}
+
+/** Compute length of a run of free bits.
+ *
+ * @param bitmap Pointer to bitmap
+ * @param start  Index of the first bit of the run
+ * @param max    Index of bit bounding the run
+ *
+ * @return Number of free bits starting with @a start
+ *
+ */
+uint32_t ext4_bitmap_free_run_length(uint8_t *bitmap, uint32_t start,
+    uint32_t max)
+{
+	uint32_t idx = start;
+
+	while (idx < max) {
+		/* Skip whole free words */
+		if (((idx % 64) == 0) && (idx + 64 <= max) &&
+		    (ext4_bitmap_word(bitmap, idx) == 0)) {
+			idx += 64;
+			continue;
+		}
+
+		if (!ext4_bitmap_is_free_bit(bitmap, idx))
+			break;
+
+		idx++;
+	}
+
+	return idx - start;
+}
+
+/** Find run of free bits.
+ *
+ * Walk through bitmap, skipping whole used words, and find the first run
+ * of at least @a want free bits. If there is no such run, the longest run
+ * found is returned instead. The bits are not modified.
+ *
+ * @param bitmap Pointer to bitmap
+ * @param start  Index of bit, where the algorithm will begin
+ * @param max    Maximum index of bit in bitmap
+ * @param want   Requested length of the run
+ * @param index  Output value - index of the first bit of the run
+ * @param count  Output value - length of the run (at most @a want)
+ *
+ * @return EOK if some free bit was found, ENOSPC otherwise
+ *
+ */
+errno_t ext4_bitmap_find_free_run(uint8_t *bitmap, uint32_t start,
+    uint32_t max, uint32_t want, uint32_t *index, uint32_t *count)
+{
+	uint32_t best_idx = 0;
+	uint32_t best_len = 0;
+	uint32_t idx = start;
+
+	while (idx < max) {
+		/* Skip whole used words */
+		if (((idx % 64) == 0) && (idx + 64 <= max) &&
+		    (ext4_bitmap_word(bitmap, idx) == UINT64_MAX)) {
+			idx += 64;
+			continue;
+		}
+
+		if (!ext4_bitmap_is_free_bit(bitmap, idx)) {
+			idx++;
+			continue;
+		}
+
+		uint32_t len = ext4_bitmap_free_run_length(bitmap, idx,
+		    min(max, idx + want));
+		if (len == want) {
+			*index = idx;
+			*count = len;
+			return EOK;
+		}
+
+		if (len > best_len) {
+			best_idx = idx;
+			best_len = len;
+		}
+
+		idx += len;
+	}
+
+	if (best_len == 0)
+		return ENOSPC;
+
+	*index = best_idx;
+	*count = best_len;
+	return EOK;
+}
+
 /**
  * @}
  */
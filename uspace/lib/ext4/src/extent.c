@@ -441,6 +441,114 @@ errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
 	return rc;
 }
 
+/** Find a run of physically contiguous blocks starting at a logical block.
+ *
+ * Unlike ext4_extent_find_block(), the extent tree is walked only once to
+ * map the whole run. Blocks which are not backed by an initialized extent
+ * form a hole, which is reported with the physical address 0.
+ *
+ * @param inode_ref I-node to find blocks in
+ * @param iblock    First logical block of the run
+ * @param fblock    Output value for the first physical block of the run
+ *                  or 0 for a hole
+ * @param count     Output value for the number of blocks in the run
+ *                  (at least one)
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_extent_find_run(ext4_inode_ref_t *inode_ref, uint32_t iblock,
+    uint32_t *fblock, uint32_t *count)
+{
+	errno_t rc = EOK;
+	/* Compute bound defined by i-node size */
+	uint64_t inode_size =
+	    ext4_inode_get_size(inode_ref->fs->superblock, inode_ref->inode);
+
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(inode_ref->fs->superblock);
+
+	uint32_t last_idx = (inode_size - 1) / block_size;
+
+	*fblock = 0;
+	*count = 1;
+
+	/* Check if requested iblock is not over size of i-node */
+	if ((inode_size == 0) || (iblock > last_idx))
+		return EOK;
+
+	block_t *block = NULL;
+
+	/* Walk through extent tree */
+	ext4_extent_header_t *header =
+	    ext4_inode_get_extent_header(inode_ref->inode);
+
+	while (ext4_extent_header_get_depth(header) != 0) {
+		/* Search index in node */
+		ext4_extent_index_t *index;
+		ext4_extent_binsearch_idx(header, &index, iblock);
+
+		/* Load child node and set values for the next iteration */
+		uint64_t child = ext4_extent_index_get_leaf(index);
+
+		if (block != NULL) {
+			rc = block_put(block);
+			if (rc != EOK)
+				return rc;
+		}
+
+		rc = block_get(&block, inode_ref->fs->device, child,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			return rc;
+
+		header = (ext4_extent_header_t *)block->data;
+	}
+
+	/* Search extent in the leaf block */
+	ext4_extent_t *extent = NULL;
+	ext4_extent_binsearch(header, &extent, iblock);
+
+	/* Empty leaf is a single block hole */
+	if (extent != NULL) {
+		uint32_t first = ext4_extent_get_first_block(extent);
+		uint32_t len = ext4_extent_get_block_count(extent);
+		bool uninit = len > EXT4_EXTENT_MAX_INIT_LEN;
+
+		if (uninit)
+			len -= EXT4_EXTENT_MAX_INIT_LEN;
+
+		if ((iblock >= first) && (iblock - first < len)) {
+			*count = first + len - iblock;
+			if (!uninit) {
+				*fblock = ext4_extent_get_start(extent) +
+				    iblock - first;
+			}
+		} else {
+			/* The hole extends up to the next extent in the leaf */
+			ext4_extent_t *next = extent;
+			if (iblock >= first)
+				next++;
+
+			ext4_extent_t *end = EXT4_EXTENT_FIRST(header) +
+			    ext4_extent_header_get_entries_count(header);
+
+			if (next < end)
+				*count = ext4_extent_get_first_block(next) - iblock;
+		}
+
+		/* Do not report blocks beyond the end of the i-node */
+		if (*count > last_idx - iblock + 1)
+			*count = last_idx - iblock + 1;
+	}
+
+	/* Cleanup */
+	if (block != NULL)
+		rc = block_put(block);
+
+	return rc;
+}
+
 /** Find extent for specified iblock.
  *
  * This function is used for finding block in the extent tree with
@@ -1107,6 +1215,282 @@ finish:
 	return rc;
 }
 
+/** Append a run of data blocks to the i-node.
+ *
+ * Allocates up to @a want physically contiguous blocks following the end
+ * of the i-node and maps them by extending the last extent, if possible,
+ * or by a new extent. The size of the i-node is not updated, the caller
+ * has to update it before appending more blocks.
+ *
+ * @param inode_ref I-node to append blocks to
+ * @param iblock    Output logical number of the first appended block
+ * @param want      Number of blocks requested
+ * @param fblock    Output physical address of the first appended block
+ * @param count     Output number of appended blocks
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_extent_append_blocks(ext4_inode_ref_t *inode_ref, uint32_t *iblock,
+    uint32_t want, uint32_t *fblock, uint32_t *count)
+{
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
+	uint64_t inode_size = ext4_inode_get_size(sb, inode_ref->inode);
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+
+	/* Calculate number of new logical block */
+	uint32_t new_block_idx = (inode_size + block_size - 1) / block_size;
+
+	/* Load the nearest leaf (with extent) */
+	ext4_extent_path_t *path;
+	errno_t rc2;
+	errno_t rc = ext4_extent_find_extent(inode_ref, new_block_idx, &path);
+	if (rc != EOK)
+		return rc;
+
+	/* Jump to last item of the path (extent) */
+	ext4_extent_path_t *path_ptr = path;
+	while (path_ptr->depth != 0)
+		path_ptr++;
+
+	uint32_t phys_block = 0;
+	uint32_t n = 0;
+	uint16_t block_count = 0;
+
+	/* Do not let the last extent grow over the limit */
+	if (path_ptr->extent != NULL) {
+		block_count = ext4_extent_get_block_count(path_ptr->extent);
+		if (block_count < EXT4_EXTENT_MAX_INIT_LEN)
+			want = min(want, EXT4_EXTENT_MAX_INIT_LEN - block_count);
+	}
+
+	rc = ext4_balloc_alloc_blocks(inode_ref, want, &phys_block, &n);
+	if (rc != EOK)
+		goto finish;
+
+	if ((path_ptr->extent != NULL) && (block_count == 0)) {
+		/* Existing extent is empty */
+		ext4_extent_set_first_block(path_ptr->extent, new_block_idx);
+		ext4_extent_set_start(path_ptr->extent, phys_block);
+		ext4_extent_set_block_count(path_ptr->extent, n);
+		path_ptr->block->dirty = true;
+		goto finish;
+	}
+
+	if ((path_ptr->extent != NULL) &&
+	    (block_count < EXT4_EXTENT_MAX_INIT_LEN) &&
+	    (ext4_extent_get_start(path_ptr->extent) + block_count ==
+	    phys_block)) {
+		/* The blocks follow the existing extent */
+		ext4_extent_set_block_count(path_ptr->extent, block_count + n);
+		path_ptr->block->dirty = true;
+		goto finish;
+	}
+
+	/* Append extent for new blocks (includes tree splitting if needed) */
+	rc = ext4_extent_append_extent(inode_ref, path, new_block_idx);
+	if (rc != EOK) {
+		ext4_balloc_free_blocks(inode_ref, phys_block, n);
+		n = 0;
+		goto finish;
+	}
+
+	uint32_t tree_depth = ext4_extent_header_get_depth(path->header);
+	path_ptr = path + tree_depth;
+
+	/* Initialize newly created extent */
+	ext4_extent_set_block_count(path_ptr->extent, n);
+	ext4_extent_set_first_block(path_ptr->extent, new_block_idx);
+	ext4_extent_set_start(path_ptr->extent, phys_block);
+
+	path_ptr->block->dirty = true;
+
+finish:
+	rc2 = EOK;
+
+	/* Set return values */
+	*iblock = new_block_idx;
+	*fblock = phys_block;
+	*count = n;
+
+	/*
+	 * Put loaded blocks
+	 * starting from 1: 0 is a block with inode data
+	 */
+	for (uint16_t i = 1; i <= path->depth; ++i) {
+		if (path[i].block) {
+			rc2 = block_put(path[i].block);
+			if (rc == EOK && rc2 != EOK)
+				rc = rc2;
+		}
+	}
+
+	/* Destroy temporary data structure */
+	free(path);
+
+	return rc;
+}
+
+/** Zero data blocks through the block cache.
+ *
+ * @param inode_ref I-node the blocks belong to
+ * @param fblock    Physical address of the first block
+ * @param count     Number of blocks
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_extent_zero_blocks(ext4_inode_ref_t *inode_ref,
+    uint64_t fblock, uint32_t count)
+{
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(inode_ref->fs->superblock);
+
+	for (uint32_t i = 0; i < count; i++) {
+		block_t *block;
+		errno_t rc = block_get(&block, inode_ref->fs->device,
+		    fblock + i, BLOCK_FLAGS_NOREAD);
+		if (rc != EOK)
+			return rc;
+
+		memset(block->data, 0, block_size);
+		block->dirty = true;
+
+		rc = block_put(block);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Make blocks of an uninitialized extent initialized.
+ *
+ * Blocks covered by an uninitialized extent are allocated, but read as
+ * zeros. The extent is split so that up to @a want blocks starting at
+ * @a iblock are covered by an initialized extent and the rest stays
+ * uninitialized. If the leaf has no room for the split, the rest of the
+ * extent is zeroed and the whole extent is initialized.
+ *
+ * The caller has to write all of the returned blocks. Parts of them that
+ * are not written must be zeroed.
+ *
+ * @param inode_ref I-node the blocks belong to
+ * @param iblock    Logical number of the first block
+ * @param want      Number of blocks requested
+ * @param fblock    Output physical address of the first block
+ * @param count     Output number of initialized blocks, 0 if @a iblock
+ *                  is not covered by an uninitialized extent
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_extent_init_blocks(ext4_inode_ref_t *inode_ref, uint32_t iblock,
+    uint32_t want, uint32_t *fblock, uint32_t *count)
+{
+	*fblock = 0;
+	*count = 0;
+
+	ext4_extent_path_t *path;
+	errno_t rc2;
+	errno_t rc = ext4_extent_find_extent(inode_ref, iblock, &path);
+	if (rc != EOK)
+		return rc;
+
+	/* Jump to last item of the path (extent) */
+	ext4_extent_path_t *path_ptr = path;
+	while (path_ptr->depth != 0)
+		path_ptr++;
+
+	ext4_extent_t *extent = path_ptr->extent;
+	if (extent == NULL)
+		goto cleanup;
+
+	uint32_t first = ext4_extent_get_first_block(extent);
+	uint32_t len = ext4_extent_get_block_count(extent);
+	uint64_t start = ext4_extent_get_start(extent);
+
+	if (len <= EXT4_EXTENT_MAX_INIT_LEN)
+		goto cleanup;
+
+	len -= EXT4_EXTENT_MAX_INIT_LEN;
+	if ((iblock < first) || (iblock - first >= len))
+		goto cleanup;
+
+	/* Blocks before and after the initialized part */
+	uint32_t head = iblock - first;
+	uint32_t n = min(want, len - head);
+	uint32_t tail = len - head - n;
+
+	ext4_extent_header_t *header = path_ptr->header;
+	uint16_t entries = ext4_extent_header_get_entries_count(header);
+	uint16_t extra = ((head > 0) ? 1 : 0) + ((tail > 0) ? 1 : 0);
+
+	if (entries + extra >
+	    ext4_extent_header_get_max_entries_count(header)) {
+		/* No room for splitting the extent */
+		rc = ext4_extent_zero_blocks(inode_ref, start, head);
+		if (rc != EOK)
+			goto cleanup;
+
+		rc = ext4_extent_zero_blocks(inode_ref, start + head + n, tail);
+		if (rc != EOK)
+			goto cleanup;
+
+		ext4_extent_set_block_count(extent, len);
+	} else {
+		/* Make room for the parts following the first one */
+		ext4_extent_t *next = extent + 1;
+		ext4_extent_t *end = EXT4_EXTENT_FIRST(header) + entries;
+		memmove(next + extra, next, (end - next) * sizeof(ext4_extent_t));
+
+		if (head > 0) {
+			ext4_extent_set_block_count(extent,
+			    head + EXT4_EXTENT_MAX_INIT_LEN);
+			extent++;
+		}
+
+		ext4_extent_set_first_block(extent, iblock);
+		ext4_extent_set_start(extent, start + head);
+		ext4_extent_set_block_count(extent, n);
+
+		if (tail > 0) {
+			extent++;
+			ext4_extent_set_first_block(extent, iblock + n);
+			ext4_extent_set_start(extent, start + head + n);
+			ext4_extent_set_block_count(extent,
+			    tail + EXT4_EXTENT_MAX_INIT_LEN);
+		}
+
+		ext4_extent_header_set_entries_count(header, entries + extra);
+	}
+
+	path_ptr->block->dirty = true;
+
+	*fblock = start + head;
+	*count = n;
+
+cleanup:
+	rc2 = EOK;
+
+	/*
+	 * Put loaded blocks
+	 * starting from 1: 0 is a block with inode data
+	 */
+	for (uint16_t i = 1; i <= path->depth; ++i) {
+		if (path[i].block) {
+			rc2 = block_put(path[i].block);
+			if (rc == EOK && rc2 != EOK)
+				rc = rc2;
+		}
+	}
+
+	/* Destroy temporary data structure */
+	free(path);
+
+	return rc;
+}
+
 /**
  * @}
  */
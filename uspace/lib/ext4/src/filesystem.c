@@ -40,6 +40,8 @@
 #include <errno.h>
 #include <mem.h>
 #include <align.h>
+#include <assert.h>
+#include <macros.h>
 #include <crypto.h>
 #include <ipc/vfs.h>
 #include <libfs.h>
@@ -137,6 +139,19 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 	if (rc != EOK)
 		goto err_2;
 
+	/* Nothing is known about free runs in block groups yet */
+	uint32_t bg_count = ext4_superblock_get_block_group_count(fs->superblock);
+	fs->bg_free_run = malloc(bg_count * sizeof(uint32_t));
+	if (fs->bg_free_run == NULL) {
+		rc = ENOMEM;
+		goto err_2;
+	}
+
+	for (uint32_t i = 0; i < bg_count; i++)
+		fs->bg_free_run[i] = EXT4_BG_FREE_RUN_UNKNOWN;
+
+	memset(fs->prealloc, 0, sizeof(fs->prealloc));
+
 	return EOK;
 err_2:
 	block_cache_fini(fs->device);
@@ -157,6 +172,7 @@ static void ext4_filesystem_fini(ext4_filesystem_t *fs)
 {
 	/* Release memory space for superblock */
 	free(fs->superblock);
+	free(fs->bg_free_run);
 
 	/* Finish work with block library */
 	block_cache_fini(fs->device);
@@ -481,6 +497,17 @@ error:
  */
 errno_t ext4_filesystem_close(ext4_filesystem_t *fs)
 {
+	/* Return blocks preallocated for files which were not closed */
+	for (unsigned i = 0; i < EXT4_PREALLOC_SLOTS; i++) {
+		if (fs->prealloc[i].inode == 0)
+			continue;
+
+		errno_t rc = ext4_filesystem_release_prealloc(fs,
+		    fs->prealloc[i].inode);
+		if (rc != EOK)
+			return rc;
+	}
+
 	/* Write the superblock to the device */
 	ext4_superblock_set_state(fs->superblock, EXT4_SUPERBLOCK_STATE_VALID_FS);
 	errno_t rc = ext4_superblock_write_direct(fs->device, fs->superblock);
@@ -1178,6 +1205,18 @@ errno_t ext4_filesystem_get_inode_ref(ext4_filesystem_t *fs, uint32_t index,
 	newref->index = index + 1;
 	newref->fs = fs;
 	newref->dirty = false;
+	newref->prealloc_start = 0;
+	newref->prealloc_count = 0;
+
+	/* Take over blocks preallocated for the i-node by earlier requests */
+	for (unsigned i = 0; i < EXT4_PREALLOC_SLOTS; i++) {
+		if (fs->prealloc[i].inode == newref->index) {
+			newref->prealloc_start = fs->prealloc[i].start;
+			newref->prealloc_count = fs->prealloc[i].count;
+			fs->prealloc[i].inode = 0;
+			break;
+		}
+	}
 
 	*ref = newref;
 
@@ -1193,6 +1232,55 @@ errno_t ext4_filesystem_get_inode_ref(ext4_filesystem_t *fs, uint32_t index,
  */
 errno_t ext4_filesystem_put_inode_ref(ext4_inode_ref_t *ref)
 {
+	ext4_filesystem_t *fs = ref->fs;
+	ext4_prealloc_t *same = NULL;
+	ext4_prealloc_t *empty = NULL;
+
+	/* Keep blocks preallocated for the i-node for further appends */
+	for (unsigned i = 0; i < EXT4_PREALLOC_SLOTS &&
+	    ref->prealloc_count > 0; i++) {
+		if (fs->prealloc[i].inode == ref->index) {
+			same = &fs->prealloc[i];
+			break;
+		}
+
+		if ((fs->prealloc[i].inode == 0) && (empty == NULL))
+			empty = &fs->prealloc[i];
+	}
+
+	if (same != NULL) {
+		/*
+		 * Another reference to the i-node has already parked its
+		 * window. Join the two windows if they are adjacent,
+		 * otherwise return this one. An i-node never has more
+		 * than one window parked.
+		 */
+		if (same->start + same->count == ref->prealloc_start) {
+			same->count += ref->prealloc_count;
+			ref->prealloc_count = 0;
+		} else if (ref->prealloc_start + ref->prealloc_count ==
+		    same->start) {
+			same->start = ref->prealloc_start;
+			same->count += ref->prealloc_count;
+			ref->prealloc_count = 0;
+		}
+	} else if (empty != NULL) {
+		empty->inode = ref->index;
+		empty->start = ref->prealloc_start;
+		empty->count = ref->prealloc_count;
+		ref->prealloc_count = 0;
+	}
+
+	/* Return them if they cannot be kept */
+	if (ref->prealloc_count > 0) {
+		errno_t rc = ext4_balloc_discard_prealloc(ref);
+		if (rc != EOK) {
+			block_put(ref->block);
+			free(ref);
+			return rc;
+		}
+	}
+
 	/* Check if reference modified */
 	if (ref->dirty) {
 		/* Mark block dirty for writing changes to physical device */
@@ -1206,6 +1294,38 @@ errno_t ext4_filesystem_put_inode_ref(ext4_inode_ref_t *ref)
 	return rc;
 }
 
+/** Return blocks preallocated for an i-node which is not referenced.
+ *
+ * @param fs    Filesystem
+ * @param index I-node index
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_filesystem_release_prealloc(ext4_filesystem_t *fs, uint32_t index)
+{
+	unsigned i;
+
+	for (i = 0; i < EXT4_PREALLOC_SLOTS; i++) {
+		if (fs->prealloc[i].inode == index)
+			break;
+	}
+
+	if (i == EXT4_PREALLOC_SLOTS)
+		return EOK;
+
+	/* The reference takes over the window */
+	ext4_inode_ref_t *inode_ref;
+	errno_t rc = ext4_filesystem_get_inode_ref(fs, index, &inode_ref);
+	if (rc != EOK)
+		return rc;
+
+	rc = ext4_balloc_discard_prealloc(inode_ref);
+	errno_t const rc2 = ext4_filesystem_put_inode_ref(inode_ref);
+
+	return rc == EOK ? rc2 : rc;
+}
+
 /** Initialize newly allocated i-node in the filesystem.
  *
  * @param fs        Filesystem to initialize i-node on
@@ -1538,6 +1658,13 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
 	if (old_size < new_size)
 		return EINVAL;
 
+	/* Blocks preallocated past the old end of file are of no use now */
+	if (inode_ref->prealloc_count > 0) {
+		errno_t rc = ext4_balloc_discard_prealloc(inode_ref);
+		if (rc != EOK)
+			return rc;
+	}
+
 	/* Compute how many blocks will be released */
 	aoff64_t size_diff = old_size - new_size;
 	uint32_t block_size  = ext4_superblock_get_block_size(sb);
@@ -1576,6 +1703,65 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
 	return EOK;
 }
 
+/** Get a run of physically contiguous data blocks of an i-node.
+ *
+ * Holes are reported as runs with the physical address 0.
+ *
+ * @param inode_ref I-node to read block addresses from
+ * @param iblock    Logical index of the first block of the run
+ * @param max       Maximum number of blocks in the run
+ * @param fblock    Output pointer for the first physical block address
+ * @param count     Output pointer for the number of blocks in the run
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_filesystem_get_inode_data_block_run(ext4_inode_ref_t *inode_ref,
+    aoff64_t iblock, uint32_t max, uint32_t *fblock, uint32_t *count)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	uint32_t first;
+	uint32_t n;
+	errno_t rc;
+
+	assert(max > 0);
+
+	/* Handle i-node using extents */
+	if ((ext4_superblock_has_feature_incompatible(fs->superblock,
+	    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
+	    (ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS))) {
+		rc = ext4_extent_find_run(inode_ref, iblock, &first, &n);
+		if (rc != EOK)
+			return rc;
+
+		*fblock = first;
+		*count = min(n, max);
+		return EOK;
+	}
+
+	/* Coalesce the blocks mapped by the indirect block scheme */
+	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, iblock,
+	    &first);
+	if (rc != EOK)
+		return rc;
+
+	for (n = 1; n < max; n++) {
+		uint32_t next;
+
+		rc = ext4_filesystem_get_inode_data_block_index(inode_ref,
+		    iblock + n, &next);
+		if (rc != EOK)
+			return rc;
+
+		if (first == 0 ? next != 0 : next != first + n)
+			break;
+	}
+
+	*fblock = first;
+	*count = n;
+	return EOK;
+}
+
 /** Get physical block address by logical index of the block.
  *
  * @param inode_ref I-node to read block address from
@@ -61,6 +61,8 @@ static errno_t ext4_read_directory(ipc_call_t *, aoff64_t, size_t,
     ext4_instance_t *, ext4_inode_ref_t *, size_t *);
 static errno_t ext4_read_file(ipc_call_t *, aoff64_t, size_t, ext4_instance_t *,
     ext4_inode_ref_t *, size_t *);
+static errno_t ext4_read_file_blocks(ipc_call_t *, aoff64_t, size_t,
+    ext4_instance_t *, ext4_inode_ref_t *, size_t *);
 static bool ext4_is_dots(const uint8_t *, size_t);
 static errno_t ext4_instance_get(service_id_t, ext4_instance_t **);
 
@@ -888,7 +890,8 @@ libfs_ops_t ext4_libfs_ops = {
 	.service_get = ext4_service_get,
 	.size_block = ext4_size_block,
 	.total_block_count = ext4_total_block_count,
-	.free_block_count = ext4_free_block_count
+	.free_block_count = ext4_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 /*
@@ -1204,20 +1207,30 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 		return EOK;
 	}
 
-	/* For now, we only read data from one block at a time */
 	uint32_t block_size = ext4_superblock_get_block_size(sb);
 	aoff64_t file_block = pos / block_size;
 	uint32_t offset_in_block = pos % block_size;
-	uint32_t bytes = min(block_size - offset_in_block, size);
 
 	/* Handle end of file */
-	if (pos + bytes > file_size)
-		bytes = file_size - pos;
+	if (size > file_size - pos)
+		size = file_size - pos;
+
+	/* Requests spanning more blocks are read by runs of blocks */
+	if (offset_in_block + size > block_size) {
+		return ext4_read_file_blocks(call, pos, size, inst, inode_ref,
+		    rbytes);
+	}
+
+	uint32_t bytes = size;
 
-	/* Get the real block number */
+	/*
+	 * Get the real block number. Use the same mapping as reads of
+	 * multiple blocks so that uninitialized extents read as zeros too.
+	 */
 	uint32_t fs_block;
-	errno_t rc = ext4_filesystem_get_inode_data_block_index(inode_ref,
-	    file_block, &fs_block);
+	uint32_t count;
+	errno_t rc = ext4_filesystem_get_inode_data_block_run(inode_ref,
+	    file_block, 1, &fs_block, &count);
 	if (rc != EOK) {
 		async_answer_0(call, rc);
 		return rc;
@@ -1225,9 +1238,9 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 
 	/*
 	 * Check for sparse file.
-	 * If ext4_filesystem_get_inode_data_block_index returned
+	 * If ext4_filesystem_get_inode_data_block_run returned
 	 * fs_block == 0, it means that the given block is not allocated for the
-	 * file and we need to return a buffer of zeros
+	 * file (or not initialized) and we need to return a buffer of zeros
 	 */
 	uint8_t *buffer;
 	if (fs_block == 0) {
@@ -1269,7 +1282,224 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 	return EOK;
 }
 
+/** Read data from file spanning multiple blocks.
+ *
+ * The blocks are mapped by runs of physically contiguous blocks and
+ * each run is read from the device by a single request. Holes are filled
+ * with zeros.
+ *
+ * @param call      IPC call
+ * @param pos       Position to start reading from
+ * @param bytes     How many bytes to read (must not cross end of file)
+ * @param inst      Filesystem instance
+ * @param inode_ref Node to read data from
+ * @param rbytes    Output value to return real number of bytes was read
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_read_file_blocks(ipc_call_t *call, aoff64_t pos,
+    size_t bytes, ext4_instance_t *inst, ext4_inode_ref_t *inode_ref,
+    size_t *rbytes)
+{
+	ext4_superblock_t *sb = inst->filesystem->superblock;
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+	aoff64_t file_block = pos / block_size;
+	uint32_t offset_in_block = pos % block_size;
+	uint32_t blocks = (offset_in_block + bytes + block_size - 1) /
+	    block_size;
+
+	uint8_t *buffer = malloc((size_t) blocks * block_size);
+	if (buffer == NULL) {
+		async_answer_0(call, ENOMEM);
+		return ENOMEM;
+	}
+
+	errno_t rc;
+	uint32_t done = 0;
+	while (done < blocks) {
+		uint32_t fs_block;
+		uint32_t count;
+
+		rc = ext4_filesystem_get_inode_data_block_run(inode_ref,
+		    file_block + done, blocks - done, &fs_block, &count);
+		if (rc != EOK)
+			goto error;
+
+		uint8_t *dst = buffer + (size_t) done * block_size;
+		if (fs_block == 0) {
+			/* Sparse file, the blocks are not allocated */
+			memset(dst, 0, (size_t) count * block_size);
+		} else {
+			rc = block_read_range(inst->service_id, fs_block, count,
+			    dst);
+			if (rc != EOK)
+				goto error;
+		}
+
+		done += count;
+	}
+
+	rc = async_data_read_finalize(call, buffer + offset_in_block, bytes);
+	free(buffer);
+	if (rc != EOK)
+		return rc;
+
+	*rbytes = bytes;
+	return EOK;
+
+error:
+	free(buffer);
+	async_answer_0(call, rc);
+	return rc;
+}
+
+/** Get data blocks of a file for writing, allocating them if necessary.
+ *
+ * Blocks appended to a file using extents are allocated by runs and the
+ * size of the i-node is extended to cover them, up to @a end. Blocks of
+ * uninitialized extents are initialized by runs, too.
+ *
+ * @param inode_ref I-node to get the blocks of
+ * @param iblock    Logical index of the first block
+ * @param want      Number of blocks to be written
+ * @param end       Position in file where the write ends
+ * @param fblock    Output value - physical address of the first block
+ * @param count     Output value - number of contiguous blocks
+ * @param fresh     Output value - true if the blocks have just been allocated
+ *                  or initialized
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_write_get_blocks(ext4_inode_ref_t *inode_ref,
+    uint32_t iblock, uint32_t want, aoff64_t end, uint32_t *fblock,
+    uint32_t *count, bool *fresh)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+	uint32_t block_size = ext4_superblock_get_block_size(fs->superblock);
+
+	bool extents = (ext4_superblock_has_feature_incompatible(fs->superblock,
+	    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
+	    (ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS));
+	errno_t rc;
+
+	*fresh = false;
+
+	if (extents) {
+		/*
+		 * Blocks of uninitialized extents read as zeros, they must be
+		 * initialized before they are written to.
+		 */
+		rc = ext4_extent_init_blocks(inode_ref, iblock, want, fblock,
+		    count);
+		if (rc != EOK)
+			return rc;
+
+		if (*count > 0) {
+			*fresh = true;
+			inode_ref->dirty = true;
+			return EOK;
+		}
+	}
+
+	*count = 1;
+
+	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, iblock,
+	    fblock);
+	if (rc != EOK)
+		return rc;
+
+	/* Check for sparse file */
+	if (*fblock != 0)
+		return EOK;
+
+	if (extents) {
+		uint64_t inode_size = ext4_inode_get_size(fs->superblock,
+		    inode_ref->inode);
+		uint32_t next_iblock = (inode_size + block_size - 1) / block_size;
+
+		if (next_iblock > iblock) {
+			/*
+			 * Hole inside of the file, allocate a single block
+			 * the way this has always been done.
+			 */
+			uint32_t last_iblock = inode_size / block_size;
+
+			rc = ext4_extent_append_block(inode_ref, &last_iblock,
+			    fblock, false);
+			if (rc != EOK)
+				return rc;
+
+			*fresh = true;
+			inode_ref->dirty = true;
+			return EOK;
+		}
+
+		/* Fill the gap past the end of file with zeroed blocks */
+		while (next_iblock < iblock) {
+			uint32_t gap_iblock;
+			uint32_t gap_fblock;
+			block_t *block;
+
+			rc = ext4_extent_append_block(inode_ref, &gap_iblock,
+			    &gap_fblock, true);
+			if (rc != EOK)
+				return rc;
+
+			rc = block_get(&block, fs->device, gap_fblock,
+			    BLOCK_FLAGS_NOREAD);
+			if (rc != EOK)
+				return rc;
+
+			memset(block->data, 0, block_size);
+			block->dirty = true;
+
+			rc = block_put(block);
+			if (rc != EOK)
+				return rc;
+
+			next_iblock = gap_iblock + 1;
+		}
+
+		rc = ext4_extent_append_blocks(inode_ref, &next_iblock, want,
+		    fblock, count);
+		if (rc != EOK)
+			return rc;
+
+		assert(next_iblock == iblock);
+
+		/* Cover the new blocks so that the next run is appended after */
+		aoff64_t new_size = min((aoff64_t) (iblock + *count) * block_size,
+		    end);
+		if (new_size > ext4_inode_get_size(fs->superblock,
+		    inode_ref->inode))
+			ext4_inode_set_size(inode_ref->inode, new_size);
+	} else {
+		uint32_t n;
+
+		rc = ext4_balloc_alloc_blocks(inode_ref, 1, fblock, &n);
+		if (rc != EOK)
+			return rc;
+
+		rc = ext4_filesystem_set_inode_data_block_index(inode_ref,
+		    iblock, *fblock);
+		if (rc != EOK) {
+			ext4_balloc_free_block(inode_ref, *fblock);
+			return rc;
+		}
+	}
+
+	*fresh = true;
+	inode_ref->dirty = true;
+	return EOK;
+}
+
 /** Write bytes to file
+ *
+ * Whole blocks with contiguous physical addresses are written to the
+ * device by a single request, partially written blocks go through the
+ * block cache.
  *
  * @param service_id Device identifier
  * @param index      I-node number of file
@@ -1299,106 +1529,133 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	ext4_node_t *enode = EXT4_NODE(fn);
 	ext4_filesystem_t *fs = enode->instance->filesystem;
+	ext4_inode_ref_t *inode_ref = enode->inode_ref;
 
 	uint32_t block_size = ext4_superblock_get_block_size(fs->superblock);
+	uint64_t old_size = ext4_inode_get_size(fs->superblock,
+	    inode_ref->inode);
 
-	/* Prevent writing to more than one block */
-	uint32_t bytes = min(len, block_size - (pos % block_size));
-
-	int flags = BLOCK_FLAGS_NONE;
-	if (bytes == block_size)
-		flags = BLOCK_FLAGS_NOREAD;
-
-	uint32_t iblock =  pos / block_size;
-	uint32_t fblock;
+	uint8_t *buffer = malloc(len);
+	if ((buffer == NULL) && (len > 0)) {
+		rc = ENOMEM;
+		async_answer_0(&call, rc);
+		goto exit;
+	}
 
-	/* Load inode */
-	ext4_inode_ref_t *inode_ref = enode->inode_ref;
-	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, iblock,
-	    &fblock);
+	rc = async_data_write_finalize(&call, buffer, len);
 	if (rc != EOK) {
-		async_answer_0(&call, rc);
+		free(buffer);
 		goto exit;
 	}
 
-	/* Check for sparse file */
-	if (fblock == 0) {
-		if ((ext4_superblock_has_feature_incompatible(fs->superblock,
-		    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
-		    (ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS))) {
-			uint32_t last_iblock =
-			    ext4_inode_get_size(fs->superblock, inode_ref->inode) /
-			    block_size;
-
-			while (last_iblock < iblock) {
-				rc = ext4_extent_append_block(inode_ref, &last_iblock,
-				    &fblock, true);
-				if (rc != EOK) {
-					async_answer_0(&call, rc);
-					goto exit;
-				}
+	/* Pending run of whole blocks with contiguous physical addresses */
+	uint32_t run_start = 0;
+	uint32_t run_cnt = 0;
+	size_t run_off = 0;
+
+	/* Last mapped run of blocks */
+	uint32_t map_iblock = 0;
+	uint32_t map_fblock = 0;
+	uint32_t map_cnt = 0;
+	bool map_fresh = false;
+
+	uint32_t last_iblock = (pos + len - 1) / block_size;
+
+	size_t off = 0;
+	while (off < len) {
+		uint32_t iblock = (pos + off) / block_size;
+		uint32_t offset_in_block = (pos + off) % block_size;
+		size_t bytes = min(len - off, block_size - offset_in_block);
+
+		if ((map_cnt == 0) || (iblock - map_iblock >= map_cnt)) {
+			map_iblock = iblock;
+			rc = ext4_write_get_blocks(inode_ref, iblock,
+			    last_iblock - iblock + 1, pos + len, &map_fblock,
+			    &map_cnt, &map_fresh);
+			if (rc != EOK) {
+				map_cnt = 0;
+				break;
 			}
+		}
 
-			rc = ext4_extent_append_block(inode_ref, &last_iblock,
-			    &fblock, false);
-			if (rc != EOK) {
-				async_answer_0(&call, rc);
-				goto exit;
+		uint32_t fblock = map_fblock + (iblock - map_iblock);
+		bool fresh = map_fresh;
+
+		if ((run_cnt > 0) && ((bytes != block_size) ||
+		    (fblock != run_start + run_cnt))) {
+			rc = block_write_range(service_id, run_start, run_cnt,
+			    buffer + run_off);
+			if (rc != EOK)
+				break;
+			run_cnt = 0;
+		}
+
+		if (bytes == block_size) {
+			if (run_cnt == 0) {
+				run_start = fblock;
+				run_off = off;
 			}
+			run_cnt++;
 		} else {
-			rc = ext4_balloc_alloc_block(inode_ref, &fblock);
-			if (rc != EOK) {
-				async_answer_0(&call, rc);
-				goto exit;
-			}
+			block_t *write_block;
+			rc = block_get(&write_block, service_id, fblock,
+			    fresh ? BLOCK_FLAGS_NOREAD : BLOCK_FLAGS_NONE);
+			if (rc != EOK)
+				break;
 
-			rc = ext4_filesystem_set_inode_data_block_index(inode_ref,
-			    iblock, fblock);
-			if (rc != EOK) {
-				ext4_balloc_free_block(inode_ref, fblock);
-				async_answer_0(&call, rc);
-				goto exit;
-			}
+			if (fresh)
+				memset(write_block->data, 0, block_size);
+
+			memcpy(write_block->data + offset_in_block, buffer + off,
+			    bytes);
+			write_block->dirty = true;
+
+			rc = block_put(write_block);
+			if (rc != EOK)
+				break;
 		}
 
-		flags = BLOCK_FLAGS_NOREAD;
-		inode_ref->dirty = true;
+		off += bytes;
+
+		/*
+		 * Keep the size up to date, appending extents relies on it
+		 * to determine the index of the next block.
+		 */
+		if (pos + off > ext4_inode_get_size(fs->superblock,
+		    inode_ref->inode)) {
+			ext4_inode_set_size(inode_ref->inode, pos + off);
+			inode_ref->dirty = true;
+		}
 	}
 
-	/* Load target block */
-	block_t *write_block;
-	rc = block_get(&write_block, service_id, fblock, flags);
-	if (rc != EOK) {
-		async_answer_0(&call, rc);
-		goto exit;
+	if ((rc == EOK) && (run_cnt > 0)) {
+		rc = block_write_range(service_id, run_start, run_cnt,
+		    buffer + run_off);
+		if (rc == EOK)
+			run_cnt = 0;
 	}
 
-	if (flags == BLOCK_FLAGS_NOREAD)
-		memset(write_block->data, 0, block_size);
+	free(buffer);
 
-	rc = async_data_write_finalize(&call, write_block->data +
-	    (pos % block_size), bytes);
 	if (rc != EOK) {
-		block_put(write_block);
-		goto exit;
-	}
+		/* Only the data up to the pending run has been written */
+		size_t done = (run_cnt > 0) ? run_off : off;
+		uint64_t new_size = max(old_size, pos + done);
 
-	write_block->dirty = true;
+		if (ext4_inode_get_size(fs->superblock, inode_ref->inode) >
+		    new_size)
+			(void) ext4_filesystem_truncate_inode(inode_ref, new_size);
 
-	rc = block_put(write_block);
-	if (rc != EOK)
-		goto exit;
+		if (done == 0)
+			goto exit;
 
-	/* Do some counting */
-	uint32_t old_inode_size = ext4_inode_get_size(fs->superblock,
-	    inode_ref->inode);
-	if (pos + bytes > old_inode_size) {
-		ext4_inode_set_size(inode_ref->inode, pos + bytes);
-		inode_ref->dirty = true;
+		/* Report the partial write */
+		off = done;
+		rc = EOK;
 	}
 
 	*nsize = ext4_inode_get_size(fs->superblock, inode_ref->inode);
-	*wbytes = bytes;
+	*wbytes = off;
 
 exit:
 	rc2 = ext4_node_put(fn);
@@ -1443,7 +1700,13 @@ static errno_t ext4_truncate(service_id_t service_id, fs_index_t index,
  */
 static errno_t ext4_close(service_id_t service_id, fs_index_t index)
 {
-	return EOK;
+	ext4_instance_t *inst;
+	errno_t rc = ext4_instance_get(service_id, &inst);
+	if (rc != EOK)
+		return rc;
+
+	/* Blocks preallocated for appending are not needed any more */
+	return ext4_filesystem_release_prealloc(inst->filesystem, index);
 }
 
 /** Destroy node specified by index.
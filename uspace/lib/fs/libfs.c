@@ -789,6 +789,11 @@ void libfs_statfs(libfs_ops_t *ops, fs_handle_t fs_handle, ipc_call_t *req)
 			goto error;
 	}
 
+	/* File systems not backed by a block device have no block cache */
+	if ((ops->cache_stats != NULL) &&
+	    (ops->cache_stats(service_id, &st) == EOK))
+		st.f_cached = true;
+
 	ops->node_put(fn);
 	async_data_read_finalize(&call, &st, sizeof(vfs_statfs_t));
 	async_answer_0(req, EOK);
@@ -37,6 +37,7 @@
 #define LIBFS_LIBFS_H_
 
 #include <ipc/vfs.h>
+#include <vfs/vfs.h>
 #include <offset.h>
 #include <async.h>
 #include <loc.h>
@@ -87,6 +88,8 @@ typedef struct {
 	errno_t (*size_block)(service_id_t, uint32_t *);
 	errno_t (*total_block_count)(service_id_t, uint64_t *);
 	errno_t (*free_block_count)(service_id_t, uint64_t *);
+	/* Optional, fills in the block cache statistics of the instance. */
+	errno_t (*cache_stats)(service_id_t, vfs_statfs_t *);
 } libfs_ops_t;
 
 typedef struct {
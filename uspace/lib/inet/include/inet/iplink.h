@@ -38,6 +38,7 @@
 #include <async.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
+#include <pktring.h>
 
 struct iplink_ev_ops;
 
@@ -45,6 +46,8 @@ typedef struct {
 	async_sess_t *sess;
 	struct iplink_ev_ops *ev_ops;
 	void *arg;
+	/** Receive ring shared with the link or @c NULL */
+	pktring_t *rx_ring;
 } iplink_t;
 
 /** IPv4 link Service Data Unit */
@@ -40,6 +40,7 @@
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
+#include <pktring.h>
 #include <stdbool.h>
 
 struct iplink_ops;
@@ -50,6 +51,10 @@ typedef struct {
 	struct iplink_ops *ops;
 	void *arg;
 	async_sess_t *client_sess;
+	/** Protects rx_ring */
+	fibril_mutex_t rx_lock;
+	/** Receive ring shared by the client or @c NULL */
+	pktring_t *rx_ring;
 } iplink_srv_t;
 
 typedef struct iplink_ops {
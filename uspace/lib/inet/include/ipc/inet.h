@@ -35,21 +35,38 @@
 #ifndef LIBINET_IPC_INET_H
 #define LIBINET_IPC_INET_H
 
+#include <inet/addr.h>
 #include <ipc/common.h>
+#include <ipc/loc.h>
+#include <stdint.h>
 
 /** Requests on Inet default port */
 typedef enum {
 	INET_CALLBACK_CREATE = IPC_FIRST_USER_METHOD,
 	INET_GET_SRCADDR,
 	INET_SEND,
-	INET_SET_PROTO
+	INET_SET_PROTO,
+	INET_RX_RING_SET
 } inet_request_t;
 
 /** Events on Inet default port */
 typedef enum {
-	INET_EV_RECV = IPC_FIRST_USER_METHOD
+	INET_EV_RECV = IPC_FIRST_USER_METHOD,
+	INET_EV_RX_RING
 } inet_event_t;
 
+/** Receive ring entry header, followed by the datagram payload */
+typedef struct {
+	/** Source address */
+	inet_addr_t src;
+	/** Destination address */
+	inet_addr_t dest;
+	/** Local IP link service ID */
+	service_id_t iplink;
+	/** Type of service */
+	uint8_t tos;
+} inet_ring_hdr_t;
+
 /** Requests on Inet configuration port */
 typedef enum {
 	INETCFG_ADDR_CREATE_STATIC = IPC_FIRST_USER_METHOD,
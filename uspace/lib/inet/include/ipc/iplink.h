@@ -36,6 +36,7 @@
 #define LIBINET_IPC_IPLINK_H
 
 #include <ipc/common.h>
+#include <stdint.h>
 
 typedef enum {
 	IPLINK_GET_MTU = IPC_FIRST_USER_METHOD,
@@ -44,14 +45,22 @@ typedef enum {
 	IPLINK_SEND,
 	IPLINK_SEND6,
 	IPLINK_ADDR_ADD,
-	IPLINK_ADDR_REMOVE
+	IPLINK_ADDR_REMOVE,
+	IPLINK_RX_RING_SET
 } iplink_request_t;
 
 typedef enum {
 	IPLINK_EV_RECV = IPC_FIRST_USER_METHOD,
 	IPLINK_EV_CHANGE_ADDR,
+	IPLINK_EV_RX_RING
 } iplink_event_t;
 
+/** Receive ring entry header, followed by the datagram */
+typedef struct {
+	/** IP version (ip_ver_t) */
+	uint32_t ver;
+} iplink_ring_hdr_t;
+
 #endif
 
 /**
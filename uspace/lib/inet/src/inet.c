@@ -33,13 +33,22 @@
 #include <ipc/inet.h>
 #include <ipc/services.h>
 #include <loc.h>
+#include <mem.h>
+#include <pktring.h>
 #include <stdlib.h>
 
+/** Number of slots in the receive ring */
+#define INET_RX_RING_SLOTS 256
+/** Receive ring slot size (enough for a datagram of Ethernet MTU) */
+#define INET_RX_RING_SLOT_SIZE 2048
+
 static void inet_cb_conn(ipc_call_t *icall, void *arg);
 
 static async_sess_t *inet_sess = NULL;
 static inet_ev_ops_t *inet_ev_ops = NULL;
 static uint8_t inet_protocol = 0;
+/** Receive ring shared with inetsrv or @c NULL */
+static pktring_t *inet_rx_ring = NULL;
 
 static errno_t inet_callback_create(void)
 {
@@ -63,6 +72,45 @@ static errno_t inet_callback_create(void)
 	return retval;
 }
 
+/** Set up receive ring shared with inetsrv.
+ *
+ * If inetsrv does not support receive rings, datagrams keep being
+ * delivered using INET_EV_RECV.
+ */
+static void inet_rx_ring_setup(void)
+{
+	pktring_t *ring;
+
+	errno_t rc = pktring_create(INET_RX_RING_SLOTS, INET_RX_RING_SLOT_SIZE,
+	    &ring);
+	if (rc != EOK)
+		return;
+
+	/*
+	 * Inetsrv notifies us only when the ring becomes non-empty.
+	 * Publish the ring first so that no notification is dropped.
+	 */
+	inet_rx_ring = ring;
+
+	async_exch_t *exch = async_exchange_begin(inet_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, INET_RX_RING_SET, &answer);
+	rc = pktring_share_out(ring, exch);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		async_forget(req);
+	else
+		async_wait_for(req, &rc);
+
+	if (rc != EOK) {
+		inet_rx_ring = NULL;
+		pktring_destroy(ring);
+	}
+}
+
 static errno_t inet_set_proto(uint8_t protocol)
 {
 	async_exch_t *exch = async_exchange_begin(inet_sess);
@@ -106,6 +154,8 @@ errno_t inet_init(uint8_t protocol, inet_ev_ops_t *ev_ops)
 	inet_protocol = protocol;
 	inet_ev_ops = ev_ops;
 
+	inet_rx_ring_setup();
+
 	return EOK;
 }
 
@@ -233,6 +283,40 @@ static void inet_ev_recv(ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+/** Process datagrams waiting in the receive ring.
+ *
+ * Inetsrv only notifies us when the ring goes from empty to non-empty,
+ * so we must drain it completely.
+ */
+static void inet_ev_rx_ring(ipc_call_t *icall)
+{
+	inet_ring_hdr_t hdr;
+	inet_dgram_t dgram;
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	async_answer_0(icall, EOK);
+
+	if (inet_rx_ring == NULL)
+		return;
+
+	while ((rc = pktring_peek(inet_rx_ring, &data, &size)) != ENOENT) {
+		if (rc == EOK && size >= sizeof(hdr)) {
+			memcpy(&hdr, data, sizeof(hdr));
+			dgram.iplink = hdr.iplink;
+			dgram.src = hdr.src;
+			dgram.dest = hdr.dest;
+			dgram.tos = hdr.tos;
+			dgram.data = (uint8_t *) data + sizeof(hdr);
+			dgram.size = size - sizeof(hdr);
+			(void) inet_ev_ops->recv(&dgram);
+		}
+
+		pktring_consume(inet_rx_ring);
+	}
+}
+
 static void inet_cb_conn(ipc_call_t *icall, void *arg)
 {
 	while (true) {
@@ -248,6 +332,9 @@ static void inet_cb_conn(ipc_call_t *icall, void *arg)
 		case INET_EV_RECV:
 			inet_ev_recv(&call);
 			break;
+		case INET_EV_RX_RING:
+			inet_ev_rx_ring(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -43,10 +43,58 @@
 #include <ipc/iplink.h>
 #include <ipc/services.h>
 #include <loc.h>
+#include <mem.h>
+#include <pktring.h>
 #include <stdlib.h>
 
+/** Number of slots in the receive ring */
+#define IPLINK_RX_RING_SLOTS 256
+/** Receive ring slot size (enough for a datagram of Ethernet MTU) */
+#define IPLINK_RX_RING_SLOT_SIZE 2048
+
 static void iplink_cb_conn(ipc_call_t *icall, void *arg);
 
+/** Set up receive ring shared with the link.
+ *
+ * If the link does not support receive rings, datagrams keep being
+ * delivered using IPLINK_EV_RECV.
+ *
+ * @param iplink IP link
+ */
+static void iplink_rx_ring_setup(iplink_t *iplink)
+{
+	pktring_t *ring;
+
+	errno_t rc = pktring_create(IPLINK_RX_RING_SLOTS,
+	    IPLINK_RX_RING_SLOT_SIZE, &ring);
+	if (rc != EOK)
+		return;
+
+	/*
+	 * The link notifies us only when the ring becomes non-empty.
+	 * Publish the ring first so that no notification is dropped.
+	 */
+	iplink->rx_ring = ring;
+
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, IPLINK_RX_RING_SET, &answer);
+	rc = pktring_share_out(ring, exch);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		async_forget(req);
+	else
+		async_wait_for(req, &rc);
+
+	if (rc != EOK) {
+		iplink->rx_ring = NULL;
+		pktring_destroy(ring);
+	}
+}
+
 errno_t iplink_open(async_sess_t *sess, iplink_ev_ops_t *ev_ops, void *arg,
     iplink_t **riplink)
 {
@@ -69,6 +117,8 @@ errno_t iplink_open(async_sess_t *sess, iplink_ev_ops_t *ev_ops, void *arg,
 	if (rc != EOK)
 		goto error;
 
+	iplink_rx_ring_setup(iplink);
+
 	*riplink = iplink;
 	return EOK;
 
@@ -82,6 +132,7 @@ error:
 void iplink_close(iplink_t *iplink)
 {
 	/* XXX Synchronize with iplink_cb_conn */
+	pktring_destroy(iplink->rx_ring);
 	free(iplink);
 }
 
@@ -262,6 +313,36 @@ static void iplink_ev_recv(iplink_t *iplink, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+/** Process datagrams waiting in the receive ring.
+ *
+ * The link only notifies us when the ring goes from empty to non-empty,
+ * so we must drain it completely.
+ */
+static void iplink_ev_rx_ring(iplink_t *iplink, ipc_call_t *icall)
+{
+	iplink_ring_hdr_t hdr;
+	iplink_recv_sdu_t sdu;
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	async_answer_0(icall, EOK);
+
+	if (iplink->rx_ring == NULL)
+		return;
+
+	while ((rc = pktring_peek(iplink->rx_ring, &data, &size)) != ENOENT) {
+		if (rc == EOK && size >= sizeof(hdr)) {
+			memcpy(&hdr, data, sizeof(hdr));
+			sdu.data = (uint8_t *) data + sizeof(hdr);
+			sdu.size = size - sizeof(hdr);
+			(void) iplink->ev_ops->recv(iplink, &sdu, hdr.ver);
+		}
+
+		pktring_consume(iplink->rx_ring);
+	}
+}
+
 static void iplink_ev_change_addr(iplink_t *iplink, ipc_call_t *icall)
 {
 	eth_addr_t *addr;
@@ -299,6 +380,9 @@ static void iplink_cb_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_EV_CHANGE_ADDR:
 			iplink_ev_change_addr(iplink, &call);
 			break;
+		case IPLINK_EV_RX_RING:
+			iplink_ev_rx_ring(iplink, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -37,6 +37,8 @@
 #include <errno.h>
 #include <inet/eth_addr.h>
 #include <ipc/iplink.h>
+#include <mem.h>
+#include <pktring.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <inet/addr.h>
@@ -213,13 +215,35 @@ static void iplink_send6_srv(iplink_srv_t *srv, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void iplink_rx_ring_set_srv(iplink_srv_t *srv, ipc_call_t *icall)
+{
+	pktring_t *ring;
+	pktring_t *old_ring;
+
+	errno_t rc = pktring_share_accept(&ring);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	fibril_mutex_lock(&srv->rx_lock);
+	old_ring = srv->rx_ring;
+	srv->rx_ring = ring;
+	fibril_mutex_unlock(&srv->rx_lock);
+
+	pktring_destroy(old_ring);
+	async_answer_0(icall, EOK);
+}
+
 void iplink_srv_init(iplink_srv_t *srv)
 {
 	fibril_mutex_initialize(&srv->lock);
+	fibril_mutex_initialize(&srv->rx_lock);
 	srv->connected = false;
 	srv->ops = NULL;
 	srv->arg = NULL;
 	srv->client_sess = NULL;
+	srv->rx_ring = NULL;
 }
 
 errno_t iplink_conn(ipc_call_t *icall, void *arg)
@@ -260,6 +284,12 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 			fibril_mutex_lock(&srv->lock);
 			srv->connected = false;
 			fibril_mutex_unlock(&srv->lock);
+
+			fibril_mutex_lock(&srv->rx_lock);
+			pktring_destroy(srv->rx_ring);
+			srv->rx_ring = NULL;
+			fibril_mutex_unlock(&srv->rx_lock);
+
 			async_answer_0(&call, EOK);
 			break;
 		}
@@ -286,6 +316,9 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_ADDR_REMOVE:
 			iplink_addr_remove_srv(srv, &call);
 			break;
+		case IPLINK_RX_RING_SET:
+			iplink_rx_ring_set_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -294,19 +327,79 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 	return srv->ops->close(srv);
 }
 
+/** Store received datagram into the receive ring.
+ *
+ * @param srv    IP link server
+ * @param sdu    Received datagram
+ * @param ver    IP version
+ * @param notify Place to store @c true if the client must be notified
+ * @return EOK on success, ENOSPC if the ring is full, ELIMIT if there
+ *         is no ring or the datagram does not fit into a slot
+ */
+static errno_t iplink_rx_ring_put(iplink_srv_t *srv, iplink_recv_sdu_t *sdu,
+    ip_ver_t ver, bool *notify)
+{
+	iplink_ring_hdr_t hdr;
+	void *buf;
+	errno_t rc = ELIMIT;
+
+	hdr.ver = ver;
+
+	fibril_mutex_lock(&srv->rx_lock);
+	if (srv->rx_ring != NULL) {
+		rc = pktring_alloc(srv->rx_ring, sizeof(hdr) + sdu->size,
+		    &buf);
+		if (rc == EOK) {
+			memcpy(buf, &hdr, sizeof(hdr));
+			memcpy((uint8_t *) buf + sizeof(hdr), sdu->data,
+			    sdu->size);
+			*notify = pktring_commit(srv->rx_ring,
+			    sizeof(hdr) + sdu->size);
+		}
+	}
+	fibril_mutex_unlock(&srv->rx_lock);
+
+	return rc;
+}
+
 /* XXX Version should be part of @a sdu */
+/** Deliver received datagram to the client.
+ *
+ * If the client has set up a receive ring, the datagram is stored into it
+ * and the client is notified only if the ring was empty. If the ring is
+ * full, the datagram is dropped. Datagrams that do not fit into a ring
+ * slot and all datagrams for clients without a ring are sent via IPC.
+ */
 errno_t iplink_ev_recv(iplink_srv_t *srv, iplink_recv_sdu_t *sdu, ip_ver_t ver)
 {
 	if (srv->client_sess == NULL)
 		return EIO;
 
+	bool notify = false;
+	errno_t rc = iplink_rx_ring_put(srv, sdu, ver, &notify);
+	if (rc == EOK) {
+		if (notify) {
+			async_exch_t *exch = async_exchange_begin(
+			    srv->client_sess);
+			async_msg_0(exch, IPLINK_EV_RX_RING);
+			async_exchange_end(exch);
+		}
+
+		return EOK;
+	}
+
+	if (rc == ENOSPC) {
+		/* Client is not keeping up */
+		return rc;
+	}
+
 	async_exch_t *exch = async_exchange_begin(srv->client_sess);
 
 	ipc_call_t answer;
 	aid_t req = async_send_1(exch, IPLINK_EV_RECV, (sysarg_t)ver,
 	    &answer);
 
-	errno_t rc = async_data_write_start(exch, sdu->data, sdu->size);
+	rc = async_data_write_start(exch, sdu->data, sdu->size);
 	async_exchange_end(exch);
 
 	if (rc != EOK) {
@@ -255,12 +255,30 @@ errno_t udp_assoc_send_msg(udp_assoc_t *assoc, inet_ep_t *dest, void *data,
     size_t bytes)
 {
 	async_exch_t *exch;
+	errno_t rc;
 
 	exch = async_exchange_begin(assoc->udp->sess);
+
+	if (bytes <= DATA_XFER_LIMIT - sizeof(inet_ep_t)) {
+		/* Pass destination and data along with the request */
+		ipc_iovec_t iov[2] = {
+			{ .base = dest, .size = sizeof(inet_ep_t) },
+			{ .base = data, .size = bytes }
+		};
+
+		aid_t req = async_xfer(exch, UDP_ASSOC_SEND_MSG, assoc->id, 0,
+		    iov, 2, 0, NULL);
+		async_exchange_end(exch);
+		if (req == 0)
+			return ENOMEM;
+
+		async_wait_for(req, &rc);
+		return rc;
+	}
+
 	aid_t req = async_send_1(exch, UDP_ASSOC_SEND_MSG, assoc->id, NULL);
 
-	errno_t rc = async_data_write_start(exch, (void *)dest,
-	    sizeof(inet_ep_t));
+	rc = async_data_write_start(exch, (void *)dest, sizeof(inet_ep_t));
 	if (rc != EOK) {
 		async_exchange_end(exch);
 		async_forget(req);
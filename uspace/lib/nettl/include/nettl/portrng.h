@@ -36,13 +36,14 @@
 #ifndef LIBNETTL_PORTRNG_H_
 #define LIBNETTL_PORTRNG_H_
 
+#include <adt/odict.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 /** Allocated port */
 typedef struct {
 	/** Link to portrng_t.used */
-	link_t lprng;
+	odlink_t lprng;
 	/** Port number */
 	uint16_t pn;
 	/** User argument */
@@ -50,7 +51,14 @@ typedef struct {
 } portrng_port_t;
 
 typedef struct {
-	list_t used; /* of portrng_port_t */
+	/** Used ports ordered by port number */
+	odict_t used; /* of portrng_port_t */
+	/** Number of used ports from the dynamic range */
+	unsigned dyn_used;
+	/** Dynamic port from which to start looking for a free one */
+	uint16_t dyn_next;
+	/** Bitmap of used dynamic ports or @c NULL while there are few */
+	uint64_t *dyn_map;
 } portrng_t;
 
 typedef enum {
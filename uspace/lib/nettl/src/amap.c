@@ -47,8 +47,14 @@
  *
  * In the unspecified case only the local port is known and the entry matches
  * all remote and local addresses.
+ *
+ * There is a repla entry for every connected association, so the repla
+ * entries are kept in a hash table. There are only a few entries of the
+ * other types.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <errno.h>
 #include <inet/addr.h>
@@ -74,6 +80,83 @@ static portrng_flags_t aflags_to_pflags(amap_flags_t flags)
 	return pflags;
 }
 
+/** Repla key */
+typedef struct {
+	/** Remote endpoint */
+	inet_ep_t *rep;
+	/** Local address */
+	inet_addr_t *laddr;
+} amap_repla_key_t;
+
+/** Compute hash of address.
+ *
+ * @param addr Address
+ * @return Hash of @a addr
+ */
+static size_t amap_addr_hash(inet_addr_t *addr)
+{
+	size_t hash;
+	unsigned i;
+
+	switch (addr->version) {
+	case ip_v4:
+		return addr->addr;
+	case ip_v6:
+		hash = 0;
+		for (i = 0; i < sizeof(addr128_t); i++)
+			hash = hash_combine(hash, addr->addr6[i]);
+		return hash;
+	default:
+		return 0;
+	}
+}
+
+/** Compute hash of repla key.
+ *
+ * @param rep Remote endpoint
+ * @param la  Local address
+ * @return Hash of the key
+ */
+static size_t amap_repla_hash_ep(inet_ep_t *rep, inet_addr_t *la)
+{
+	size_t hash;
+
+	hash = amap_addr_hash(&rep->addr);
+	hash = hash_combine(hash, rep->port);
+	return hash_combine(hash, amap_addr_hash(la));
+}
+
+static size_t amap_repla_key_hash(const void *arg)
+{
+	const amap_repla_key_t *key = arg;
+	return amap_repla_hash_ep(key->rep, key->laddr);
+}
+
+static size_t amap_repla_hash(const ht_link_t *item)
+{
+	amap_repla_t *repla = hash_table_get_inst(item, amap_repla_t, lamap);
+	return amap_repla_hash_ep(&repla->rep, &repla->laddr);
+}
+
+static bool amap_repla_key_equal(const void *arg, const ht_link_t *item)
+{
+	const amap_repla_key_t *key = arg;
+	amap_repla_t *repla = hash_table_get_inst(item, amap_repla_t, lamap);
+
+	return inet_addr_compare(&repla->rep.addr, &key->rep->addr) &&
+	    repla->rep.port == key->rep->port &&
+	    inet_addr_compare(&repla->laddr, key->laddr);
+}
+
+/** Repla hash table operations. */
+static hash_table_ops_t amap_repla_ops = {
+	.hash = amap_repla_hash,
+	.key_hash = amap_repla_key_hash,
+	.key_equal = amap_repla_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
 /** Create association map.
  *
  * @param rmap Place to store pointer to new association map
@@ -97,7 +180,12 @@ errno_t amap_create(amap_t **rmap)
 		return ENOMEM;
 	}
 
-	list_initialize(&map->repla);
+	if (!hash_table_create(&map->repla, 0, 0, &amap_repla_ops)) {
+		portrng_destroy(map->unspec);
+		free(map);
+		return ENOMEM;
+	}
+
 	list_initialize(&map->laddr);
 	list_initialize(&map->llink);
 
@@ -113,9 +201,11 @@ void amap_destroy(amap_t *map)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_destroy()");
 
-	assert(list_empty(&map->repla));
+	assert(hash_table_empty(&map->repla));
 	assert(list_empty(&map->laddr));
 	assert(list_empty(&map->llink));
+	hash_table_destroy(&map->repla);
+	portrng_destroy(map->unspec);
 	free(map);
 }
 
@@ -133,34 +223,23 @@ void amap_destroy(amap_t *map)
 static errno_t amap_repla_find(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
     amap_repla_t **rrepla)
 {
-	char *sraddr, *sladdr;
-
-	(void) inet_addr_format(&rep->addr, &sraddr);
-	(void) inet_addr_format(la, &sladdr);
-
-	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_repla_find(): rep=(%s,%" PRIu16
-	    ") la=%s", sraddr, rep->port, sladdr);
-	free(sraddr);
-	free(sladdr);
-
-	list_foreach(map->repla, lamap, amap_repla_t, repla) {
-		(void) inet_addr_format(&repla->rep.addr, &sraddr);
-		(void) inet_addr_format(&repla->laddr, &sladdr);
-		log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_repla_find(): "
-		    "compare to rep=(%s, %" PRIu16 ") la=%s",
-		    sraddr, repla->rep.port, sladdr);
-		free(sraddr);
-		free(sladdr);
-		if (inet_addr_compare(&repla->rep.addr, &rep->addr) &&
-		    repla->rep.port == rep->port &&
-		    inet_addr_compare(&repla->laddr, la)) {
-			*rrepla = repla;
-			return EOK;
-		}
+	amap_repla_key_t key;
+	ht_link_t *link;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_repla_find(): rep.port=%" PRIu16,
+	    rep->port);
+
+	key.rep = rep;
+	key.laddr = la;
+
+	link = hash_table_find(&map->repla, &key);
+	if (link == NULL) {
+		*rrepla = NULL;
+		return ENOENT;
 	}
 
-	*rrepla = NULL;
-	return ENOENT;
+	*rrepla = hash_table_get_inst(link, amap_repla_t, lamap);
+	return EOK;
 }
 
 /** Insert repla.
@@ -194,7 +273,7 @@ static errno_t amap_repla_insert(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
 
 	repla->rep = *rep;
 	repla->laddr = *la;
-	list_append(&repla->lamap, &map->repla);
+	hash_table_insert(&map->repla, &repla->lamap);
 
 	*rrepla = repla;
 	return EOK;
@@ -209,7 +288,7 @@ static errno_t amap_repla_insert(amap_t *map, inet_ep_t *rep, inet_addr_t *la,
  */
 static void amap_repla_remove(amap_t *map, amap_repla_t *repla)
 {
-	list_remove(&repla->lamap);
+	hash_table_remove_item(&map->repla, &repla->lamap);
 	portrng_destroy(repla->portrng);
 	free(repla);
 }
@@ -376,6 +455,7 @@ static errno_t amap_insert_repla(amap_t *map, inet_ep2_t *epp, void *arg,
 {
 	amap_repla_t *repla;
 	inet_ep2_t mepp;
+	bool created = false;
 	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_repla()");
@@ -383,6 +463,7 @@ static errno_t amap_insert_repla(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = amap_repla_find(map, &epp->remote, &epp->local.addr, &repla);
 	if (rc != EOK) {
 		/* New repla */
+		created = true;
 		rc = amap_repla_insert(map, &epp->remote, &epp->local.addr,
 		    &repla);
 		if (rc != EOK) {
@@ -396,6 +477,8 @@ static errno_t amap_insert_repla(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = portrng_alloc(repla->portrng, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		if (created)
+			amap_repla_remove(map, repla);
 		return rc;
 	}
 
@@ -421,6 +504,7 @@ static errno_t amap_insert_laddr(amap_t *map, inet_ep2_t *epp, void *arg,
 {
 	amap_laddr_t *laddr;
 	inet_ep2_t mepp;
+	bool created = false;
 	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_laddr()");
@@ -428,6 +512,7 @@ static errno_t amap_insert_laddr(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = amap_laddr_find(map, &epp->local.addr, &laddr);
 	if (rc != EOK) {
 		/* New laddr */
+		created = true;
 		rc = amap_laddr_insert(map, &epp->local.addr, &laddr);
 		if (rc != EOK) {
 			assert(rc == ENOMEM);
@@ -440,6 +525,8 @@ static errno_t amap_insert_laddr(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = portrng_alloc(laddr->portrng, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		if (created)
+			amap_laddr_remove(map, laddr);
 		return rc;
 	}
 
@@ -465,6 +552,7 @@ static errno_t amap_insert_llink(amap_t *map, inet_ep2_t *epp, void *arg,
 {
 	amap_llink_t *llink;
 	inet_ep2_t mepp;
+	bool created = false;
 	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "amap_insert_llink()");
@@ -472,6 +560,7 @@ static errno_t amap_insert_llink(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = amap_llink_find(map, epp->local_link, &llink);
 	if (rc != EOK) {
 		/* New llink */
+		created = true;
 		rc = amap_llink_insert(map, epp->local_link, &llink);
 		if (rc != EOK) {
 			assert(rc == ENOMEM);
@@ -484,6 +573,8 @@ static errno_t amap_insert_llink(amap_t *map, inet_ep2_t *epp, void *arg,
 	rc = portrng_alloc(llink->portrng, epp->local.port, arg, aflags_to_pflags(flags),
 	    &mepp.local.port);
 	if (rc != EOK) {
+		if (created)
+			amap_llink_remove(map, llink);
 		return rc;
 	}
 
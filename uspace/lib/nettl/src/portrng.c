@@ -36,7 +36,8 @@
  * Allocates port numbers from IETF port number ranges.
  */
 
-#include <adt/list.h>
+#include <adt/odict.h>
+#include <assert.h>
 #include <errno.h>
 #include <inet/endpoint.h>
 #include <nettl/portrng.h>
@@ -45,6 +46,39 @@
 
 #include <io/log.h>
 
+/** Number of ports in the dynamic range */
+#define PORTRNG_DYN_NUM (inet_port_dyn_hi - inet_port_dyn_lo + 1)
+/** Number of words of the bitmap of used dynamic ports */
+#define PORTRNG_MAP_WORDS (PORTRNG_DYN_NUM / 64)
+/** Number of used dynamic ports from which the bitmap is maintained */
+#define PORTRNG_MAP_MIN 64
+
+/** Get key of port range entry. */
+static void *portrng_port_getkey(odlink_t *odlink)
+{
+	return &odict_get_instance(odlink, portrng_port_t, lprng)->pn;
+}
+
+/** Compare port numbers. */
+static int portrng_port_cmp(void *a, void *b)
+{
+	uint16_t *pa = (uint16_t *) a;
+	uint16_t *pb = (uint16_t *) b;
+
+	if (*pa < *pb)
+		return -1;
+	else if (*pa == *pb)
+		return 0;
+	else
+		return 1;
+}
+
+/** Determine if port number is from the dynamic range. */
+static bool portrng_is_dyn(uint16_t pnum)
+{
+	return pnum >= inet_port_dyn_lo;
+}
+
 /** Create port range.
  *
  * @param rpr Place to store pointer to new port range
@@ -60,7 +94,8 @@ errno_t portrng_create(portrng_t **rpr)
 	if (pr == NULL)
 		return ENOMEM;
 
-	list_initialize(&pr->used);
+	odict_initialize(&pr->used, portrng_port_getkey, portrng_port_cmp);
+	pr->dyn_next = inet_port_dyn_lo;
 	*rpr = pr;
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_create() - end");
 	return EOK;
@@ -73,10 +108,126 @@ errno_t portrng_create(portrng_t **rpr)
 void portrng_destroy(portrng_t *pr)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_destroy()");
-	assert(list_empty(&pr->used));
+	assert(odict_empty(&pr->used));
+	free(pr->dyn_map);
 	free(pr);
 }
 
+/** Find port range entry.
+ *
+ * @param pr   Port range
+ * @param pnum Port number
+ * @return Port range entry or @c NULL if @a pnum is not allocated
+ */
+static portrng_port_t *portrng_port_find(portrng_t *pr, uint16_t pnum)
+{
+	odlink_t *odlink;
+
+	odlink = odict_find_eq(&pr->used, &pnum, NULL);
+	if (odlink == NULL)
+		return NULL;
+
+	return odict_get_instance(odlink, portrng_port_t, lprng);
+}
+
+/** Mark dynamic port as used or free in the bitmap of used ports.
+ *
+ * @param pr   Port range
+ * @param pnum Port number from the dynamic range
+ * @param used @c true to mark the port as used, @c false to mark it free
+ */
+static void portrng_map_set(portrng_t *pr, uint16_t pnum, bool used)
+{
+	unsigned idx = pnum - inet_port_dyn_lo;
+	uint64_t mask = (uint64_t) 1 << (idx % 64);
+
+	if (used)
+		pr->dyn_map[idx / 64] |= mask;
+	else
+		pr->dyn_map[idx / 64] &= ~mask;
+}
+
+/** Create the bitmap of used dynamic ports.
+ *
+ * Failure to allocate the bitmap is not fatal, free ports are then looked
+ * up in the dictionary of used ports.
+ *
+ * @param pr Port range
+ */
+static void portrng_map_create(portrng_t *pr)
+{
+	uint16_t lo = inet_port_dyn_lo;
+	odlink_t *odlink;
+
+	pr->dyn_map = calloc(PORTRNG_MAP_WORDS, sizeof(uint64_t));
+	if (pr->dyn_map == NULL)
+		return;
+
+	odlink = odict_find_geq(&pr->used, &lo, NULL);
+	while (odlink != NULL) {
+		portrng_map_set(pr, odict_get_instance(odlink, portrng_port_t,
+		    lprng)->pn, true);
+		odlink = odict_next(odlink, &pr->used);
+	}
+}
+
+/** Select free port from the dynamic range.
+ *
+ * The search starts where the previous one ended so that recently freed
+ * port numbers are not reused immediately.
+ *
+ * @param pr    Port range
+ * @param rpnum Place to store free port number
+ * @return EOK on success, ENOENT if there is no free dynamic port
+ */
+static errno_t portrng_dyn_select(portrng_t *pr, uint16_t *rpnum)
+{
+	unsigned start;
+	unsigned i;
+
+	if (pr->dyn_used >= PORTRNG_DYN_NUM)
+		return ENOENT;
+
+	if (pr->dyn_map == NULL && pr->dyn_used >= PORTRNG_MAP_MIN)
+		portrng_map_create(pr);
+
+	start = pr->dyn_next - inet_port_dyn_lo;
+
+	if (pr->dyn_map == NULL) {
+		/* Few ports are used, the first candidates are most likely free */
+		for (i = 0; i < PORTRNG_DYN_NUM; i++) {
+			uint16_t pnum = inet_port_dyn_lo +
+			    (start + i) % PORTRNG_DYN_NUM;
+			if (portrng_port_find(pr, pnum) == NULL) {
+				*rpnum = pnum;
+				return EOK;
+			}
+		}
+
+		return ENOENT;
+	}
+
+	/*
+	 * Look for a word with a free port. The word containing the start
+	 * is visited twice, first ignoring the ports below the start.
+	 */
+	for (i = 0; i <= PORTRNG_MAP_WORDS; i++) {
+		unsigned w = (start / 64 + i) % PORTRNG_MAP_WORDS;
+		uint64_t used = pr->dyn_map[w];
+
+		if (i == 0)
+			used |= ((uint64_t) 1 << (start % 64)) - 1;
+
+		if (used != UINT64_MAX) {
+			*rpnum = inet_port_dyn_lo + w * 64 +
+			    __builtin_ctzll(~used);
+			return EOK;
+		}
+	}
+
+	return ENOENT;
+}
+
 /** Allocate port number from port range.
  *
  * @param pr    Port range
@@ -96,30 +247,15 @@ errno_t portrng_alloc(portrng_t *pr, uint16_t pnum, void *arg,
     portrng_flags_t flags, uint16_t *apnum)
 {
 	portrng_port_t *p;
-	uint32_t i;
-	bool found;
+	bool any;
+	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_alloc() - begin");
 
-	if (pnum == inet_port_any) {
-
-		for (i = inet_port_dyn_lo; i <= inet_port_dyn_hi; i++) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG2, "trying %" PRIu32, i);
-			found = false;
-			list_foreach(pr->used, lprng, portrng_port_t, port) {
-				if (port->pn == pnum) {
-					found = true;
-					break;
-				}
-			}
-
-			if (!found) {
-				pnum = i;
-				break;
-			}
-		}
-
-		if (pnum == inet_port_any) {
+	any = (pnum == inet_port_any);
+	if (any) {
+		rc = portrng_dyn_select(pr, &pnum);
+		if (rc != EOK) {
 			/* No free port found */
 			return ENOENT;
 		}
@@ -133,11 +269,9 @@ errno_t portrng_alloc(portrng_t *pr, uint16_t pnum, void *arg,
 			return EINVAL;
 		}
 
-		list_foreach(pr->used, lprng, portrng_port_t, port) {
-			if (port->pn == pnum) {
-				log_msg(LOG_DEFAULT, LVL_DEBUG2, "port already used");
-				return EEXIST;
-			}
+		if (portrng_port_find(pr, pnum) != NULL) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG2, "port already used");
+			return EEXIST;
 		}
 	}
 
@@ -147,7 +281,19 @@ errno_t portrng_alloc(portrng_t *pr, uint16_t pnum, void *arg,
 
 	p->pn = pnum;
 	p->arg = arg;
-	list_append(&p->lprng, &pr->used);
+	odict_insert(&p->lprng, &pr->used, NULL);
+
+	if (portrng_is_dyn(pnum)) {
+		pr->dyn_used++;
+		if (pr->dyn_map != NULL)
+			portrng_map_set(pr, pnum, true);
+	}
+
+	if (any) {
+		pr->dyn_next = (pnum == inet_port_dyn_hi) ?
+		    inet_port_dyn_lo : pnum + 1;
+	}
+
 	*apnum = pnum;
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_alloc() - end OK pn=%" PRIu16,
 	    pnum);
@@ -164,14 +310,14 @@ errno_t portrng_alloc(portrng_t *pr, uint16_t pnum, void *arg,
  */
 errno_t portrng_find_port(portrng_t *pr, uint16_t pnum, void **rarg)
 {
-	list_foreach(pr->used, lprng, portrng_port_t, port) {
-		if (port->pn == pnum) {
-			*rarg = port->arg;
-			return EOK;
-		}
-	}
+	portrng_port_t *port;
 
-	return ENOENT;
+	port = portrng_port_find(pr, pnum);
+	if (port == NULL)
+		return ENOENT;
+
+	*rarg = port->arg;
+	return EOK;
 }
 
 /** Free port in port range.
@@ -181,21 +327,27 @@ errno_t portrng_find_port(portrng_t *pr, uint16_t pnum, void **rarg)
  */
 void portrng_free_port(portrng_t *pr, uint16_t pnum)
 {
+	portrng_port_t *port;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port(%u)", pnum);
-	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port() - begin");
-	list_foreach(pr->used, lprng, portrng_port_t, port) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port - check port %u", port->pn);
-		if (port->pn == pnum) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port - OK");
-			list_remove(&port->lprng);
-			free(port);
-			log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port() - end");
-			return;
-		}
+
+	port = portrng_port_find(pr, pnum);
+	if (port == NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port - FAIL");
+		assert(false);
+		return;
+	}
+
+	odict_remove(&port->lprng);
+	free(port);
+
+	if (portrng_is_dyn(pnum)) {
+		pr->dyn_used--;
+		if (pr->dyn_map != NULL)
+			portrng_map_set(pr, pnum, false);
 	}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port - FAIL");
-	assert(false);
+	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_free_port() - end");
 }
 
 /** Determine if port range is empty.
@@ -206,7 +358,7 @@ void portrng_free_port(portrng_t *pr, uint16_t pnum)
 bool portrng_empty(portrng_t *pr)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "portrng_empty()");
-	return list_empty(&pr->used);
+	return odict_empty(&pr->used);
 }
 
 /**
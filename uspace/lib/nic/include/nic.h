@@ -84,6 +84,21 @@ typedef list_t nic_frame_list_t;
  */
 typedef void (*send_frame_handler)(nic_t *, void *, size_t);
 
+/**
+ * Handler for writing a batch of frames to the NIC device. Allows the
+ * driver to fill several descriptors and notify the device only once.
+ * The driver stops at the first frame it cannot send, e.g. when it runs
+ * out of transmit descriptors, and reports how far it got.
+ *
+ * @param nic_data
+ * @param data		Frame data packed back to back
+ * @param sizes		Sizes of the frames in bytes
+ * @param count		Number of frames
+ *
+ * @return Number of frames from the start of the batch which were sent
+ */
+typedef size_t (*send_frames_handler)(nic_t *, void *, const size_t *, size_t);
+
 /**
  * The handler for transitions between driver states.
  * If the handler returns error code, the transition between
@@ -205,6 +220,25 @@ typedef errno_t (*poll_mode_change_handler)(nic_t *,
  */
 typedef void (*poll_request_handler)(nic_t *);
 
+/**
+ * Handler processing received frames in the adaptive polling mode.
+ * The handler must not process more than @a budget frames.
+ *
+ * @param nic_data	NICF main structure
+ * @param budget	Maximum number of frames to process
+ *
+ * @return Number of frames processed
+ */
+typedef size_t (*rx_poll_handler)(nic_t *, size_t);
+
+/**
+ * Handler enabling or disabling receive interrupts of the device.
+ *
+ * @param nic_data	NICF main structure
+ * @param enable	True to enable, false to disable receive interrupts
+ */
+typedef void (*rx_irq_handler)(nic_t *, bool);
+
 /* nic_t allocation and deallocation */
 extern nic_t *nic_create_and_bind(ddf_dev_t *);
 extern void nic_unbind_and_destroy(ddf_dev_t *);
@@ -218,6 +252,7 @@ extern void nic_driver_implement(driver_ops_t *, ddf_dev_ops_t *,
 extern errno_t nic_get_resources(nic_t *, hw_res_list_parsed_t *);
 extern void nic_set_specific(nic_t *, void *);
 extern void nic_set_send_frame_handler(nic_t *, send_frame_handler);
+extern void nic_set_send_frames_handler(nic_t *, send_frames_handler);
 extern void nic_set_state_change_handlers(nic_t *,
     state_change_handler, state_change_handler, state_change_handler);
 extern void nic_set_filtering_change_handlers(nic_t *,
@@ -228,6 +263,8 @@ extern void nic_set_wol_virtue_change_handlers(nic_t *,
     wol_virtue_add_handler, wol_virtue_remove_handler);
 extern void nic_set_poll_handlers(nic_t *,
     poll_mode_change_handler, poll_request_handler);
+extern void nic_set_rx_poll_handlers(nic_t *, rx_poll_handler,
+    rx_irq_handler);
 
 /* General driver functions */
 extern ddf_dev_t *nic_get_ddf_dev(nic_t *);
@@ -277,6 +314,9 @@ extern uint64_t nic_query_mcast_hash(nic_t *);
 extern void nic_sw_period_start(nic_t *);
 extern void nic_sw_period_stop(nic_t *);
 
+/* Adaptive receive polling */
+extern bool nic_rx_interrupt(nic_t *);
+
 #endif // __NIC_H__
 
 /** @}
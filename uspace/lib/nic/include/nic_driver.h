@@ -45,6 +45,7 @@
 #include <fibril_synch.h>
 #include <nic/nic.h>
 #include <async.h>
+#include <pktring.h>
 
 #include "nic.h"
 #include "nic_rx_control.h"
@@ -56,6 +57,14 @@ struct sw_poll_info {
 	volatile int running;
 };
 
+struct rx_poll_info {
+	fibril_mutex_t lock;
+	fibril_condvar_t cv;
+	fid_t fibril;
+	/** Receive interrupts are disabled and the poll fibril is active */
+	bool polling;
+};
+
 struct nic {
 	/**
 	 * Device from device manager's point of view.
@@ -79,6 +88,16 @@ struct nic {
 	nic_address_t default_mac;
 	/** Client callback session */
 	async_sess_t *client_session;
+	/**
+	 * Ring for passing received frames to the client through shared memory
+	 * or NULL if frames are sent via IPC.
+	 */
+	pktring_t *rx_ring;
+	/**
+	 * Lock for the receive ring. Serializes producers. No other lock from
+	 * nic_t may be acquired while holding it.
+	 */
+	fibril_mutex_t rx_ring_lock;
 	/** Current polling mode of the NIC */
 	nic_poll_mode_t poll_mode;
 	/** Polling period (applicable when poll_mode == NIC_POLL_PERIODIC) */
@@ -126,6 +145,12 @@ struct nic {
 	 * Called with the main_lock locked for reading.
 	 */
 	send_frame_handler send_frame;
+	/**
+	 * Function sending a batch of frames. The implementation is optional,
+	 * if it is missing, send_frame is called for each frame.
+	 * Called with the main_lock locked for reading.
+	 */
+	send_frames_handler send_frames;
 	/**
 	 * Event handler called when device goes to the ACTIVE state.
 	 * The implementation is optional.
@@ -194,6 +219,20 @@ struct nic {
 	 * The implementation is optional.
 	 */
 	poll_request_handler on_poll_request;
+	/**
+	 * Handler processing received frames with a budget. If it is set,
+	 * receive interrupts are turned off under high load and the frames
+	 * are polled by a fibril instead (see nic_rx_interrupt()).
+	 * The implementation is optional.
+	 */
+	rx_poll_handler on_rx_poll;
+	/**
+	 * Handler turning receive interrupts on and off. Mandatory if
+	 * on_rx_poll is set.
+	 */
+	rx_irq_handler on_rx_irq;
+	/** Adaptive receive polling information */
+	struct rx_poll_info rx_poll_info;
 	/** Data specific for particular driver */
 	void *specific;
 };
@@ -41,6 +41,7 @@
 #include <assert.h>
 #include <nic/nic.h>
 #include <ddf/driver.h>
+#include <pktring.h>
 
 /*
  * Inclusion of this file is not prohibited, because drivers could want to
@@ -49,6 +50,8 @@
 
 extern errno_t nic_get_address_impl(ddf_fun_t *dev_fun, nic_address_t *address);
 extern errno_t nic_send_frame_impl(ddf_fun_t *dev_fun, void *data, size_t size);
+extern errno_t nic_send_frames_impl(ddf_fun_t *dev_fun, void *data,
+    const size_t *sizes, size_t count);
 extern errno_t nic_callback_create_impl(ddf_fun_t *dev_fun);
 extern errno_t nic_get_state_impl(ddf_fun_t *dev_fun, nic_device_state_t *state);
 extern errno_t nic_set_state_impl(ddf_fun_t *dev_fun, nic_device_state_t state);
@@ -81,6 +84,7 @@ extern errno_t nic_poll_get_mode_impl(ddf_fun_t *,
 extern errno_t nic_poll_set_mode_impl(ddf_fun_t *,
     nic_poll_mode_t, const struct timespec *);
 extern errno_t nic_poll_now_impl(ddf_fun_t *);
+extern errno_t nic_rx_ring_set_impl(ddf_fun_t *, pktring_t *);
 
 extern void nic_default_handler_impl(ddf_fun_t *dev_fun, ipc_call_t *call);
 extern errno_t nic_open_impl(ddf_fun_t *fun);
@@ -38,13 +38,16 @@
 
 #include <assert.h>
 #include <fibril_synch.h>
+#include <mem.h>
 #include <ns.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <str_error.h>
 #include <sysinfo.h>
 #include <as.h>
 #include <ddf/interrupt.h>
 #include <ops/nic.h>
+#include <nic_iface.h>
 #include <errno.h>
 
 #include "nic_driver.h"
@@ -53,6 +56,9 @@
 
 #define NIC_GLOBALS_MAX_CACHE_SIZE 16
 
+/** Maximum number of frames processed by one adaptive polling round */
+#define NIC_RX_POLL_BUDGET NIC_FRAMES_MAX
+
 nic_globals_t nic_globals;
 
 /**
@@ -99,8 +105,11 @@ void nic_driver_implement(driver_ops_t *driver_ops, ddf_dev_ops_t *dev_ops,
 			iface->get_state = nic_get_state_impl;
 		if (!iface->set_state)
 			iface->set_state = nic_set_state_impl;
-		if (!iface->send_frame)
+		if (!iface->send_frame) {
 			iface->send_frame = nic_send_frame_impl;
+			if (!iface->send_frames)
+				iface->send_frames = nic_send_frames_impl;
+		}
 		if (!iface->callback_create)
 			iface->callback_create = nic_callback_create_impl;
 		if (!iface->get_address)
@@ -143,6 +152,8 @@ void nic_driver_implement(driver_ops_t *driver_ops, ddf_dev_ops_t *dev_ops,
 			iface->poll_set_mode = nic_poll_set_mode_impl;
 		if (!iface->poll_now)
 			iface->poll_now = nic_poll_now_impl;
+		if (!iface->rx_ring_set)
+			iface->rx_ring_set = nic_rx_ring_set_impl;
 	}
 }
 
@@ -160,6 +171,20 @@ void nic_set_send_frame_handler(nic_t *nic_data, send_frame_handler sffunc)
 	nic_data->send_frame = sffunc;
 }
 
+/**
+ * Setup handler for sending batches of frames. This can be called in the
+ * add_device handler if the driver is able to submit several frames to
+ * the device at once. If it is not set, the send_frame handler is called
+ * for each frame of the batch.
+ *
+ * @param nic_data
+ * @param sffunc	Function handling the send_frames request
+ */
+void nic_set_send_frames_handler(nic_t *nic_data, send_frames_handler sffunc)
+{
+	nic_data->send_frames = sffunc;
+}
+
 /**
  * Setup event handlers for transitions between driver states.
  * This function can be called only in the add_device handler.
@@ -232,6 +257,24 @@ void nic_set_poll_handlers(nic_t *nic_data,
 	nic_data->on_poll_request = on_poll_req;
 }
 
+static errno_t nic_rx_poll_fibril(void *);
+
+/**
+ * Setup handlers for adaptive receive polling.
+ * This function can be called only in the add_device handler.
+ *
+ * @param on_rx_poll	Called to process received frames with a budget
+ * @param on_rx_irq	Called to turn receive interrupts on and off
+ */
+void nic_set_rx_poll_handlers(nic_t *nic_data, rx_poll_handler on_rx_poll,
+    rx_irq_handler on_rx_irq)
+{
+	assert(on_rx_poll != NULL && on_rx_irq != NULL);
+
+	nic_data->on_rx_poll = on_rx_poll;
+	nic_data->on_rx_irq = on_rx_irq;
+}
+
 /**
  * Connect to the parent's driver and get HW resources list in parsed format.
  * Note: this function should be called only from add_device handler, therefore
@@ -507,20 +550,56 @@ void nic_set_tx_busy(nic_t *nic_data, int busy)
 	nic_data->tx_busy = busy;
 }
 
+/** Pass received frame to the client.
+ *
+ * If the client has set up a receive ring, the frame is stored into it and
+ * the client is notified only if the ring was empty. If the ring is full,
+ * the frame is dropped. Frames that do not fit into a ring slot and all
+ * frames for clients without a ring are sent via IPC.
+ *
+ * @param nic_data
+ * @param data		Frame data
+ * @param size		Frame size
+ */
+static void nic_deliver_frame(nic_t *nic_data, void *data, size_t size)
+{
+	bool notify = false;
+	errno_t rc = ELIMIT;
+
+	fibril_mutex_lock(&nic_data->rx_ring_lock);
+	if (nic_data->rx_ring != NULL)
+		rc = pktring_put(nic_data->rx_ring, data, size, &notify);
+	fibril_mutex_unlock(&nic_data->rx_ring_lock);
+
+	switch (rc) {
+	case EOK:
+		if (notify)
+			nic_ev_rx_ring(nic_data->client_session);
+		break;
+	case ENOSPC:
+		/* Client is not keeping up */
+		fibril_rwlock_write_lock(&nic_data->stats_lock);
+		nic_data->stats.receive_dropped++;
+		fibril_rwlock_write_unlock(&nic_data->stats_lock);
+		break;
+	default:
+		nic_ev_received(nic_data->client_session, data, size);
+		break;
+	}
+}
+
 /**
- * This is the function that the driver should call when it receives a frame.
- * The frame is checked by filters and then sent up to the NIL layer or
- * discarded. The frame is released.
+ * Check received frame by filters and update statistics.
  *
  * @param nic_data
  * @param frame		The received frame
+ *
+ * @return True if the frame should be passed to the client
  */
-void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+static bool nic_frame_accept(nic_t *nic_data, nic_frame_t *frame)
 {
-	/*
-	 * Note: this function must not lock main lock, because loopback driver
-	 * 		 calls it inside send_frame handler (with locked main lock)
-	 */
+	bool accept;
+
 	fibril_rwlock_read_lock(&nic_data->rxc_lock);
 	nic_frame_type_t frame_type;
 	bool check = nic_rxc_check(&nic_data->rx_control, frame->data,
@@ -542,9 +621,7 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 		default:
 			break;
 		}
-		fibril_rwlock_write_unlock(&nic_data->stats_lock);
-		nic_ev_received(nic_data->client_session, frame->data,
-		    frame->size);
+		accept = true;
 	} else {
 		switch (frame_type) {
 		case NIC_FRAME_UNICAST:
@@ -557,30 +634,120 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 			nic_data->stats.receive_filtered_broadcast++;
 			break;
 		}
-		fibril_rwlock_write_unlock(&nic_data->stats_lock);
+		accept = false;
 	}
+
+	fibril_rwlock_write_unlock(&nic_data->stats_lock);
+	return accept;
+}
+
+/**
+ * Pass a batch of accepted frames to the client in a single
+ * NIC_EV_RECEIVED_FRAMES event. Falls back to one event per frame
+ * if the batch cannot be sent.
+ *
+ * @param nic_data
+ * @param frames	Array of accepted frames
+ * @param count		Number of frames (at most NIC_FRAMES_MAX)
+ */
+static void nic_deliver_frames(nic_t *nic_data, nic_frame_t **frames,
+    size_t count)
+{
+	size_t sizes[NIC_FRAMES_MAX];
+	size_t total = 0;
+	uint8_t *data;
+	uint8_t *dp;
+	errno_t rc;
+
+	/*
+	 * A single frame does not need packing. Frames are passed through
+	 * the receive ring if there is one (this is re-checked under the
+	 * ring lock in nic_deliver_frame()).
+	 */
+	if (count == 1 || nic_data->rx_ring != NULL)
+		goto single;
+
+	for (size_t i = 0; i < count; i++) {
+		sizes[i] = frames[i]->size;
+		total += frames[i]->size;
+	}
+
+	data = malloc(total);
+	if (data == NULL)
+		goto single;
+
+	dp = data;
+	for (size_t i = 0; i < count; i++) {
+		memcpy(dp, frames[i]->data, frames[i]->size);
+		dp += frames[i]->size;
+	}
+
+	rc = nic_ev_received_frames(nic_data->client_session, data, sizes,
+	    count);
+	free(data);
+	if (rc == EOK)
+		return;
+
+single:
+	for (size_t i = 0; i < count; i++)
+		nic_deliver_frame(nic_data, frames[i]->data, frames[i]->size);
+}
+
+/**
+ * This is the function that the driver should call when it receives a frame.
+ * The frame is checked by filters and then sent up to the NIL layer or
+ * discarded. The frame is released.
+ *
+ * @param nic_data
+ * @param frame		The received frame
+ */
+void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+{
+	/*
+	 * Note: this function must not lock main lock, because loopback driver
+	 * 		 calls it inside send_frame handler (with locked main lock)
+	 */
+	if (nic_frame_accept(nic_data, frame))
+		nic_deliver_frame(nic_data, frame->data, frame->size);
 	nic_release_frame(nic_data, frame);
 }
 
 /**
  * Some NICs can receive multiple frames during single interrupt. These can
  * send them in whole list of frames (actually nic_frame_t structures), then
- * the list is deallocated and each frame is passed to the
- * nic_received_packet function.
+ * the list is deallocated. Frames accepted by filters are passed to the
+ * client in batches of up to NIC_FRAMES_MAX frames, using a single IPC
+ * transaction per batch.
  *
  * @param nic_data
  * @param frames		List of received frames
  */
 void nic_received_frame_list(nic_t *nic_data, nic_frame_list_t *frames)
 {
+	nic_frame_t *batch[NIC_FRAMES_MAX];
+	size_t count;
+
 	if (frames == NULL)
 		return;
+
 	while (!list_empty(frames)) {
-		nic_frame_t *frame =
-		    list_get_instance(list_first(frames), nic_frame_t, link);
+		count = 0;
+		while (!list_empty(frames) && count < NIC_FRAMES_MAX) {
+			nic_frame_t *frame =
+			    list_get_instance(list_first(frames), nic_frame_t, link);
+
+			list_remove(&frame->link);
+			if (nic_frame_accept(nic_data, frame))
+				batch[count++] = frame;
+			else
+				nic_release_frame(nic_data, frame);
+		}
+
+		if (count > 0)
+			nic_deliver_frames(nic_data, batch, count);
 
-		list_remove(&frame->link);
-		nic_received_frame(nic_data, frame);
+		for (size_t i = 0; i < count; i++)
+			nic_release_frame(nic_data, batch[i]);
 	}
 	nic_driver_release_frame_list(frames);
 }
@@ -609,9 +776,11 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	nic_data->fun = NULL;
 	nic_data->state = NIC_STATE_STOPPED;
 	nic_data->client_session = NULL;
+	nic_data->rx_ring = NULL;
 	nic_data->poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->default_poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->send_frame = NULL;
+	nic_data->send_frames = NULL;
 	nic_data->on_activating = NULL;
 	nic_data->on_going_down = NULL;
 	nic_data->on_stopping = NULL;
@@ -621,6 +790,13 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	fibril_rwlock_initialize(&nic_data->stats_lock);
 	fibril_rwlock_initialize(&nic_data->rxc_lock);
 	fibril_rwlock_initialize(&nic_data->wv_lock);
+	fibril_mutex_initialize(&nic_data->rx_ring_lock);
+	fibril_mutex_initialize(&nic_data->rx_poll_info.lock);
+	fibril_condvar_initialize(&nic_data->rx_poll_info.cv);
+	nic_data->rx_poll_info.fibril = 0;
+	nic_data->rx_poll_info.polling = false;
+	nic_data->on_rx_poll = NULL;
+	nic_data->on_rx_irq = NULL;
 
 	memset(&nic_data->mac, 0, sizeof(nic_address_t));
 	memset(&nic_data->default_mac, 0, sizeof(nic_address_t));
@@ -658,6 +834,7 @@ nic_t *nic_create_and_bind(ddf_dev_t *device)
  */
 static void nic_destroy(nic_t *nic_data)
 {
+	pktring_destroy(nic_data->rx_ring);
 	free(nic_data->specific);
 }
 
@@ -1132,5 +1309,115 @@ void nic_sw_period_stop(nic_t *nic_data)
 	nic_data->sw_poll_info.running = 0;
 }
 
+/** Process receive interrupt
+ *
+ * To be called by drivers supporting adaptive polling (see
+ * nic_set_rx_poll_handlers()) from their interrupt handler when
+ * a receive interrupt is signalled. Frames are processed immediately,
+ * up to a budget. If the budget is exhausted, the receive rate is high
+ * and the NIC is switched to polling: receive interrupts are disabled
+ * and a fibril keeps processing frames in budgeted rounds until the
+ * receive ring drains, then it enables the interrupts again.
+ *
+ * Drivers without adaptive polling support just process all frames.
+ *
+ * @param nic_data NIC structure
+ *
+ * @return True if receive interrupts should be enabled by the driver,
+ *         false if they must stay disabled
+ */
+bool nic_rx_interrupt(nic_t *nic_data)
+{
+	struct rx_poll_info *info = &nic_data->rx_poll_info;
+
+	if (nic_data->on_rx_poll == NULL)
+		return true;
+
+	fibril_mutex_lock(&info->lock);
+	bool polling = info->polling;
+	fibril_mutex_unlock(&info->lock);
+
+	/* The poll fibril takes care of received frames */
+	if (polling)
+		return false;
+
+	size_t count = nic_data->on_rx_poll(nic_data, NIC_RX_POLL_BUDGET);
+	if (count < NIC_RX_POLL_BUDGET)
+		return true;
+
+	/* High receive rate, switch to polling */
+	fibril_mutex_lock(&info->lock);
+	if (info->fibril == 0) {
+		info->fibril = fibril_create(nic_rx_poll_fibril, nic_data);
+		if (info->fibril == 0) {
+			/* Keep using interrupts */
+			fibril_mutex_unlock(&info->lock);
+			return true;
+		}
+
+		fibril_add_ready(info->fibril);
+	}
+
+	if (!info->polling) {
+		info->polling = true;
+		nic_data->on_rx_irq(nic_data, false);
+		fibril_condvar_signal(&info->cv);
+	}
+	fibril_mutex_unlock(&info->lock);
+
+	return false;
+}
+
+/** Check whether the NIC is in a mode where interrupts are used */
+static bool nic_rx_irq_mode(nic_t *nic_data)
+{
+	fibril_rwlock_read_lock(&nic_data->main_lock);
+	nic_poll_mode_t mode = nic_data->poll_mode;
+	fibril_rwlock_read_unlock(&nic_data->main_lock);
+
+	return mode == NIC_POLL_IMMEDIATE || mode == NIC_POLL_PERIODIC;
+}
+
+/** Main function of the adaptive receive polling fibril
+ *
+ *  @param data The NIC structure pointer
+ *
+ *  @return 0, never reached
+ */
+static errno_t nic_rx_poll_fibril(void *data)
+{
+	nic_t *nic = data;
+	struct rx_poll_info *info = &nic->rx_poll_info;
+
+	while (true) {
+		fibril_mutex_lock(&info->lock);
+		while (!info->polling)
+			fibril_condvar_wait(&info->cv, &info->lock);
+		fibril_mutex_unlock(&info->lock);
+
+		size_t count = nic->on_rx_poll(nic, NIC_RX_POLL_BUDGET);
+		if (count >= NIC_RX_POLL_BUDGET) {
+			/* Let other fibrils (and IPC) run between the rounds */
+			fibril_yield();
+			continue;
+		}
+
+		/* The ring has drained, go back to interrupts */
+		fibril_mutex_lock(&info->lock);
+		info->polling = false;
+		if (nic_rx_irq_mode(nic))
+			nic->on_rx_irq(nic, true);
+		fibril_mutex_unlock(&info->lock);
+
+		/*
+		 * Frames which arrived after the last round but before
+		 * the interrupts were enabled may not raise an interrupt.
+		 */
+		(void) nic_rx_interrupt(nic);
+	}
+
+	return EOK;
+}
+
 /** @}
  */
@@ -93,5 +93,34 @@ errno_t nic_ev_received(async_sess_t *sess, void *data, size_t size)
 	return retval;
 }
 
+/** Batch of frames received. */
+errno_t nic_ev_received_frames(async_sess_t *sess, void *data,
+    const size_t *sizes, size_t count)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, NIC_EV_RECEIVED_FRAMES, count, &answer);
+	errno_t retval = nic_frames_write(exch, data, sizes, count);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Frame stored into empty receive ring. */
+void nic_ev_rx_ring(async_sess_t *sess)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	async_msg_0(exch, NIC_EV_RX_RING);
+	async_exchange_end(exch);
+}
+
 /** @}
  */
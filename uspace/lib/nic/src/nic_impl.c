@@ -184,6 +184,53 @@ errno_t nic_send_frame_impl(ddf_fun_t *fun, void *data, size_t size)
 	return EOK;
 }
 
+/**
+ * Default implementation of the send_frames method.
+ * Send a batch of messages to the network.
+ *
+ * @param	fun
+ * @param	data	Frame data packed back to back
+ * @param	sizes	Frame sizes in bytes
+ * @param	count	Number of frames
+ *
+ * @return EOK		If the messages were sent
+ * @return EBUSY	If the device is not in state when the frames can be
+ *			sent or it cannot take all of them now. Some of the
+ *			frames may have been sent already.
+ */
+errno_t nic_send_frames_impl(ddf_fun_t *fun, void *data, const size_t *sizes,
+    size_t count)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	uint8_t *frame = data;
+
+	fibril_rwlock_read_lock(&nic_data->main_lock);
+	if (nic_data->state != NIC_STATE_ACTIVE || nic_data->tx_busy) {
+		fibril_rwlock_read_unlock(&nic_data->main_lock);
+		return EBUSY;
+	}
+
+	if (nic_data->send_frames != NULL) {
+		size_t sent = nic_data->send_frames(nic_data, data, sizes,
+		    count);
+		fibril_rwlock_read_unlock(&nic_data->main_lock);
+		return (sent < count) ? EBUSY : EOK;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (nic_data->tx_busy) {
+			fibril_rwlock_read_unlock(&nic_data->main_lock);
+			return EBUSY;
+		}
+
+		nic_data->send_frame(nic_data, frame, sizes[i]);
+		frame += sizes[i];
+	}
+
+	fibril_rwlock_read_unlock(&nic_data->main_lock);
+	return EOK;
+}
+
 /**
  * Default implementation of the connect_client method.
  * Creates callback connection to the client.
@@ -203,6 +250,12 @@ errno_t nic_callback_create_impl(ddf_fun_t *fun)
 		return ENOMEM;
 	}
 
+	/* Receive ring belongs to the previous client */
+	fibril_mutex_lock(&nic->rx_ring_lock);
+	pktring_destroy(nic->rx_ring);
+	nic->rx_ring = NULL;
+	fibril_mutex_unlock(&nic->rx_ring_lock);
+
 	fibril_rwlock_write_unlock(&nic->main_lock);
 	return EOK;
 }
@@ -780,6 +833,30 @@ errno_t nic_poll_set_mode_impl(ddf_fun_t *fun,
 	return rc;
 }
 
+/**
+ * Default implementation of the rx_ring_set method.
+ * Received frames are passed to the client through the ring from now on.
+ * A previously set ring is released.
+ *
+ * @param[in]	fun
+ * @param[in]	ring	Producer side of the receive ring
+ *
+ * @return EOK
+ */
+errno_t nic_rx_ring_set_impl(ddf_fun_t *fun, pktring_t *ring)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	pktring_t *old_ring;
+
+	fibril_mutex_lock(&nic_data->rx_ring_lock);
+	old_ring = nic_data->rx_ring;
+	nic_data->rx_ring = ring;
+	fibril_mutex_unlock(&nic_data->rx_ring_lock);
+
+	pktring_destroy(old_ring);
+	return EOK;
+}
+
 /**
  * Default implementation of the poll_now method.
  * Wrapper for the actual poll implementation.
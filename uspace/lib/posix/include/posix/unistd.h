@@ -104,21 +104,36 @@ typedef int64_t off64_t;
 
 extern off64_t lseek64(int fildes, off64_t offset, int whence);
 extern int ftruncate64(int fildes, off64_t length);
+extern ssize_t pread64(int fildes, void *buf, size_t nbyte, off64_t offset);
+extern ssize_t pwrite64(int fildes, const void *buf, size_t nbyte,
+    off64_t offset);
 #endif
 
 #if _FILE_OFFSET_BITS == 64 && LONG_MAX == INT_MAX
 #ifdef __GNUC__
 extern off_t lseek(int fildes, off_t offset, int whence) __asm__("lseek64");
 extern int ftruncate(int fildes, off_t length) __asm__("ftruncate64");
+extern ssize_t pread(int fildes, void *buf, size_t nbyte, off_t offset)
+    __asm__("pread64");
+extern ssize_t pwrite(int fildes, const void *buf, size_t nbyte,
+    off_t offset) __asm__("pwrite64");
 #else
 extern off_t lseek64(int fildes, off_t offset, int whence);
 extern int ftruncate64(int fildes, off_t length);
+extern ssize_t pread64(int fildes, void *buf, size_t nbyte, off_t offset);
+extern ssize_t pwrite64(int fildes, const void *buf, size_t nbyte,
+    off_t offset);
 #define lseek lseek64
 #define ftruncate ftruncate64
+#define pread pread64
+#define pwrite pwrite64
 #endif
 #else
 extern off_t lseek(int fildes, off_t offset, int whence);
 extern int ftruncate(int fildes, off_t length);
+extern ssize_t pread(int fildes, void *buf, size_t nbyte, off_t offset);
+extern ssize_t pwrite(int fildes, const void *buf, size_t nbyte,
+    off_t offset);
 #endif
 
 /* File Accessibility */
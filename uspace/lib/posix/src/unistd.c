@@ -237,6 +237,68 @@ ssize_t write(int fildes, const void *buf, size_t nbyte)
 	return nwr;
 }
 
+/**
+ * Read from a file at a given offset.
+ *
+ * The file offset of the file descriptor is neither used nor changed.
+ *
+ * @param fildes File descriptor of the opened file.
+ * @param buf Buffer to which the read bytes shall be stored.
+ * @param nbyte Upper limit on the number of read bytes.
+ * @param offset Offset in the file to read from.
+ * @return Number of read bytes on success, -1 otherwise.
+ */
+ssize_t pread(int fildes, void *buf, size_t nbyte, off_t offset)
+{
+	return pread64(fildes, buf, nbyte, offset);
+}
+
+ssize_t pread64(int fildes, void *buf, size_t nbyte, off64_t offset)
+{
+	aoff64_t pos = offset;
+	size_t nread;
+
+	if (offset < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (failed(vfs_read(fildes, &pos, buf, nbyte, &nread)))
+		return -1;
+	return (ssize_t) nread;
+}
+
+/**
+ * Write to a file at a given offset.
+ *
+ * The file offset of the file descriptor is neither used nor changed.
+ *
+ * @param fildes File descriptor of the opened file.
+ * @param buf Buffer to write.
+ * @param nbyte Size of the buffer.
+ * @param offset Offset in the file to write to.
+ * @return Number of written bytes on success, -1 otherwise.
+ */
+ssize_t pwrite(int fildes, const void *buf, size_t nbyte, off_t offset)
+{
+	return pwrite64(fildes, buf, nbyte, offset);
+}
+
+ssize_t pwrite64(int fildes, const void *buf, size_t nbyte, off64_t offset)
+{
+	aoff64_t pos = offset;
+	size_t nwr;
+
+	if (offset < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (failed(vfs_write(fildes, &pos, buf, nbyte, &nwr)))
+		return -1;
+	return nwr;
+}
+
 static off64_t _lseek(int fildes, off64_t offset, off64_t max_pos, int whence)
 {
 	vfs_stat_t st;
@@ -30,6 +30,7 @@
 #include <pcut/pcut.h>
 #include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 PCUT_INIT;
@@ -75,4 +76,36 @@ PCUT_TEST(access_file)
 	close(file);
 }
 
+/** pread and pwrite do not use or change the file offset */
+PCUT_TEST(pread_pwrite)
+{
+	char name[L_tmpnam];
+	char buf[4];
+	char *p;
+	int file;
+	ssize_t n;
+
+	p = tmpnam(name);
+	PCUT_ASSERT_NOT_NULL(p);
+
+	file = open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	PCUT_ASSERT_TRUE(file >= 0);
+
+	n = write(file, "abcd", 4);
+	PCUT_ASSERT_INT_EQUALS(4, n);
+
+	n = pwrite(file, "XY", 2, 1);
+	PCUT_ASSERT_INT_EQUALS(2, n);
+
+	n = pread(file, buf, 4, 0);
+	PCUT_ASSERT_INT_EQUALS(4, n);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, "aXYd", 4));
+
+	/* The file offset is still at the end of the first write. */
+	PCUT_ASSERT_INT_EQUALS(4, lseek(file, 0, SEEK_CUR));
+
+	(void) unlink(name);
+	close(file);
+}
+
 PCUT_EXPORT(unistd);
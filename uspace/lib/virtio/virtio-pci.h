@@ -198,6 +198,9 @@ extern uint16_t virtio_alloc_desc(virtio_dev_t *, uint16_t, uint16_t *);
 extern void virtio_free_desc(virtio_dev_t *, uint16_t, uint16_t *, uint16_t);
 
 extern void virtio_virtq_produce_available(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_produce_available_n(virtio_dev_t *, uint16_t,
+    const uint16_t *, size_t);
+extern void virtio_virtq_set_interrupts(virtio_dev_t *, uint16_t, bool);
 extern bool virtio_virtq_consume_used(virtio_dev_t *, uint16_t, uint16_t *,
     uint32_t *);
 
@@ -172,19 +172,65 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 
 void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
+{
+	virtio_virtq_produce_available_n(vdev, num, &descno, 1);
+}
+
+/** Make several descriptors available to the device at once
+ *
+ * The available index is updated and the device is notified only once
+ * for the whole batch.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ * @param descs[in]   Array of descriptor numbers
+ * @param count[in]   Number of descriptors in @a descs
+ */
+void virtio_virtq_produce_available_n(virtio_dev_t *vdev, uint16_t num,
+    const uint16_t *descs, size_t count)
 {
 	virtq_t *q = &vdev->queues[num];
 
+	if (count == 0)
+		return;
+
 	fibril_mutex_lock(&q->lock);
 	uint16_t idx = pio_read_le16(&q->avail->idx);
-	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
+	for (size_t i = 0; i < count; i++) {
+		pio_write_le16(&q->avail->ring[(uint16_t) (idx + i) %
+		    q->queue_size], descs[i]);
+	}
 	write_barrier();
-	pio_write_le16(&q->avail->idx, idx + 1);
+	pio_write_le16(&q->avail->idx, idx + count);
 	write_barrier();
 	pio_write_le16(q->notify, num);
 	fibril_mutex_unlock(&q->lock);
 }
 
+/** Enable or disable interrupts signalling used buffers of a virtqueue
+ *
+ * This is only a hint for the device, an interrupt may still arrive after
+ * the interrupts have been disabled.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ * @param enable[in]  True to enable interrupts
+ */
+void virtio_virtq_set_interrupts(virtio_dev_t *vdev, uint16_t num, bool enable)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	fibril_mutex_lock(&q->lock);
+	uint16_t flags = pio_read_le16(&q->avail->flags);
+	if (enable)
+		flags &= ~VIRTQ_AVAIL_F_NO_INTERRUPT;
+	else
+		flags |= VIRTQ_AVAIL_F_NO_INTERRUPT;
+	pio_write_le16(&q->avail->flags, flags);
+	write_barrier();
+	fibril_mutex_unlock(&q->lock);
+}
+
 bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
     uint16_t *descno, uint32_t *len)
 {
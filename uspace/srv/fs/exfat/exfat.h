@@ -102,6 +102,29 @@ typedef enum {
 struct exfat_node;
 struct exfat_idx_t;
 
+/** Number of cluster runs cached for each fragmented node. */
+#define EXFAT_RUNS_CACHED	8
+
+/** Run of contiguous clusters of a node. */
+typedef struct {
+	/** Index of the first cluster of the run within the node. */
+	uint32_t	idx;
+	/** First cluster of the run. */
+	exfat_cluster_t	clst;
+	/** Number of clusters in the run. */
+	uint32_t	cnt;
+} exfat_run_t;
+
+/** exFAT file system instance. */
+typedef struct exfat_instance {
+	/** In-memory copy of the allocation bitmap. */
+	uint8_t		*bitmap;
+	/** Cluster where the search for free clusters continues. */
+	exfat_cluster_t	next_free;
+	/** Number of free clusters. */
+	uint32_t	free_cnt;
+} exfat_instance_t;
+
 typedef struct {
 	/** Used indices (position) hash table link. */
 	ht_link_t		uph_link;
@@ -151,16 +174,17 @@ typedef struct exfat_node {
 	bool			fragmented;
 
 	/*
-	 * Cache of the node's last and "current" cluster to avoid some
-	 * unnecessary FAT walks.
+	 * Cache of the node's last cluster and of runs of its clusters to
+	 * avoid some unnecessary FAT walks.
 	 */
 	/* Node's last cluster in FAT. */
 	bool		lastc_cached_valid;
 	exfat_cluster_t	lastc_cached_value;
-	/* Node's "current" cluster, i.e. where the last I/O took place. */
-	bool		currc_cached_valid;
-	aoff64_t	currc_cached_bn;
-	exfat_cluster_t	currc_cached_value;
+	/* Runs of contiguous clusters where recent I/O took place. */
+	exfat_run_t	runs[EXFAT_RUNS_CACHED];
+	unsigned	runs_cnt;
+	/* Next run to be replaced when the cache is full. */
+	unsigned	runs_victim;
 } exfat_node_t;
 
 extern vfs_out_ops_t exfat_ops;
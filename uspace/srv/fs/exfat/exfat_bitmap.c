@@ -44,92 +44,209 @@
 #include <align.h>
 #include <assert.h>
 #include <fibril_synch.h>
+#include <macros.h>
 #include <mem.h>
+#include <stdlib.h>
 
-errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
+/** Protects the in-memory copies of the allocation bitmaps. */
+static FIBRIL_MUTEX_INITIALIZE(exfat_bitmap_lock);
+
+/** Get the instance holding the in-memory copy of the allocation bitmap.
+ *
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		Instance data or NULL if the bitmap has not been loaded
+ *			(e.g. when probing the file system).
+ */
+static exfat_instance_t *exfat_bitmap_instance(service_id_t service_id)
+{
+	void *data;
+
+	if (fs_instance_get(service_id, &data) != EOK)
+		return NULL;
+
+	return (exfat_instance_t *) data;
+}
+
+static bool exfat_bitmap_map_used(exfat_instance_t *instance,
     exfat_cluster_t clst)
+{
+	clst -= EXFAT_CLST_FIRST;
+	return instance->bitmap[clst / 8] & (1 << (clst % 8));
+}
+
+/** Mark a range of clusters in the in-memory bitmap.
+ *
+ * Must be called with exfat_bitmap_lock held.
+ */
+static void exfat_bitmap_map_update(exfat_instance_t *instance,
+    exfat_cluster_t firstc, exfat_cluster_t count, bool used)
+{
+	exfat_cluster_t clst;
+
+	for (clst = firstc; clst < firstc + count; clst++) {
+		if (exfat_bitmap_map_used(instance, clst) == used)
+			continue;
+
+		exfat_cluster_t bit = clst - EXFAT_CLST_FIRST;
+		if (used) {
+			instance->bitmap[bit / 8] |= (1 << (bit % 8));
+			instance->free_cnt--;
+		} else {
+			instance->bitmap[bit / 8] &= ~(1 << (bit % 8));
+			instance->free_cnt++;
+		}
+	}
+}
+
+/** Set or clear a range of clusters in the on-disk allocation bitmap.
+ *
+ * The bitmap node is looked up once and every bitmap block is read and
+ * written once for the whole range.
+ */
+static errno_t exfat_bitmap_write(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t firstc, exfat_cluster_t count, bool used)
 {
 	fs_node_t *fn;
 	block_t *b = NULL;
 	exfat_node_t *bitmapp;
 	uint8_t *bitmap;
+	exfat_cluster_t clst, end;
+	aoff64_t bn;
 	errno_t rc;
-	bool alloc;
 
-	clst -= EXFAT_CLST_FIRST;
+	clst = firstc - EXFAT_CLST_FIRST;
+	end = clst + count;
 
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
 	bitmapp = EXFAT_NODE(fn);
 
-	aoff64_t offset = clst / 8;
-	rc = exfat_block_get(&b, bs, bitmapp, offset / BPS(bs), BLOCK_FLAGS_NONE);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
-	}
-	bitmap = (uint8_t *)b->data;
-	alloc = bitmap[offset % BPS(bs)] & (1 << (clst % 8));
+	while (clst < end) {
+		bn = clst / 8 / BPS(bs);
+		rc = exfat_block_get(&b, bs, bitmapp, bn, BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+		bitmap = (uint8_t *)b->data;
 
-	rc = block_put(b);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
-	}
-	rc = exfat_node_put(fn);
-	if (rc != EOK)
-		return rc;
+		for (; clst < end && clst / 8 / BPS(bs) == bn; clst++) {
+			if (used)
+				bitmap[(clst / 8) % BPS(bs)] |= (1 << (clst % 8));
+			else
+				bitmap[(clst / 8) % BPS(bs)] &= ~(1 << (clst % 8));
+		}
 
-	if (alloc)
-		return ENOENT;
+		b->dirty = true;
+		rc = block_put(b);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			return rc;
+		}
+	}
 
-	return EOK;
+	return exfat_node_put(fn);
 }
 
-errno_t exfat_bitmap_set_cluster(exfat_bs_t *bs, service_id_t service_id,
-    exfat_cluster_t clst)
+/** Load the allocation bitmap of a file system into memory.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param instance	Instance where the bitmap will be stored.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_bitmap_load(exfat_bs_t *bs, service_id_t service_id,
+    exfat_instance_t *instance)
 {
 	fs_node_t *fn;
-	block_t *b = NULL;
+	block_t *b;
 	exfat_node_t *bitmapp;
-	uint8_t *bitmap;
+	exfat_cluster_t clst;
+	size_t size, bytes, count;
+	aoff64_t bn;
 	errno_t rc;
 
-	clst -= EXFAT_CLST_FIRST;
+	/* Round up to whole words so that the allocator can skip them. */
+	size = ROUND_UP(DATA_CNT(bs), 32) / 8;
+	instance->bitmap = malloc(size);
+	if (instance->bitmap == NULL)
+		return ENOMEM;
+	memset(instance->bitmap, 0xff, size);
 
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
-		return rc;
+		goto error;
 	bitmapp = EXFAT_NODE(fn);
 
-	aoff64_t offset = clst / 8;
-	rc = exfat_block_get(&b, bs, bitmapp, offset / BPS(bs), BLOCK_FLAGS_NONE);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
+	bytes = min(ROUND_UP(DATA_CNT(bs), 8) / 8, bitmapp->size);
+	for (bn = 0; bn * BPS(bs) < bytes; bn++) {
+		rc = exfat_block_get(&b, bs, bitmapp, bn, BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto error;
+		}
+		count = min(BPS(bs), bytes - bn * BPS(bs));
+		memcpy(instance->bitmap + bn * BPS(bs), b->data, count);
+		rc = block_put(b);
+		if (rc != EOK) {
+			(void) exfat_node_put(fn);
+			goto error;
+		}
 	}
-	bitmap = (uint8_t *)b->data;
-	bitmap[offset % BPS(bs)] |= (1 << (clst % 8));
 
-	b->dirty = true;
-	rc = block_put(b);
-	if (rc != EOK) {
-		(void) exfat_node_put(fn);
-		return rc;
+	rc = exfat_node_put(fn);
+	if (rc != EOK)
+		goto error;
+
+	/* Clusters past the end of the volume are never free. */
+	for (clst = DATA_CNT(bs); clst < size * 8; clst++)
+		instance->bitmap[clst / 8] |= (1 << (clst % 8));
+
+	instance->free_cnt = 0;
+	for (clst = 0; clst < DATA_CNT(bs); clst++) {
+		if (!(instance->bitmap[clst / 8] & (1 << (clst % 8))))
+			instance->free_cnt++;
 	}
+	instance->next_free = EXFAT_CLST_FIRST;
 
-	return exfat_node_put(fn);
+	return EOK;
+
+error:
+	free(instance->bitmap);
+	instance->bitmap = NULL;
+	return rc;
 }
 
-errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
+/** Free the in-memory allocation bitmap of a file system. */
+void exfat_bitmap_unload(exfat_instance_t *instance)
+{
+	free(instance->bitmap);
+	instance->bitmap = NULL;
+}
+
+errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t clst)
 {
 	fs_node_t *fn;
 	block_t *b = NULL;
 	exfat_node_t *bitmapp;
+	exfat_instance_t *instance;
 	uint8_t *bitmap;
 	errno_t rc;
+	bool alloc;
+
+	instance = exfat_bitmap_instance(service_id);
+	if (instance != NULL) {
+		if (clst < EXFAT_CLST_FIRST ||
+		    clst - EXFAT_CLST_FIRST >= DATA_CNT(bs))
+			return ENOENT;
+		if (exfat_bitmap_map_used(instance, clst))
+			return ENOENT;
+		return EOK;
+	}
 
 	clst -= EXFAT_CLST_FIRST;
 
@@ -139,65 +256,169 @@ errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
 	bitmapp = EXFAT_NODE(fn);
 
 	aoff64_t offset = clst / 8;
-	rc = exfat_block_get(&b, bs, bitmapp, offset / BPS(bs),
-	    BLOCK_FLAGS_NONE);
+	rc = exfat_block_get(&b, bs, bitmapp, offset / BPS(bs), BLOCK_FLAGS_NONE);
 	if (rc != EOK) {
 		(void) exfat_node_put(fn);
 		return rc;
 	}
 	bitmap = (uint8_t *)b->data;
-	bitmap[offset % BPS(bs)] &= ~(1 << (clst % 8));
+	alloc = bitmap[offset % BPS(bs)] & (1 << (clst % 8));
 
-	b->dirty = true;
 	rc = block_put(b);
 	if (rc != EOK) {
 		(void) exfat_node_put(fn);
 		return rc;
 	}
+	rc = exfat_node_put(fn);
+	if (rc != EOK)
+		return rc;
 
-	return exfat_node_put(fn);
+	if (alloc)
+		return ENOENT;
+
+	return EOK;
+}
+
+errno_t exfat_bitmap_set_cluster(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t clst)
+{
+	return exfat_bitmap_set_clusters(bs, service_id, clst, 1);
+}
+
+errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t clst)
+{
+	return exfat_bitmap_clear_clusters(bs, service_id, clst, 1);
 }
 
 errno_t exfat_bitmap_set_clusters(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t firstc, exfat_cluster_t count)
 {
+	exfat_instance_t *instance;
 	errno_t rc;
-	exfat_cluster_t clst;
-	clst = firstc;
 
-	while (clst < firstc + count) {
-		rc = exfat_bitmap_set_cluster(bs, service_id, clst);
-		if (rc != EOK) {
-			if (clst - firstc > 0)
-				(void) exfat_bitmap_clear_clusters(bs, service_id,
-				    firstc, clst - firstc);
-			return rc;
+	instance = exfat_bitmap_instance(service_id);
+	if (instance != NULL) {
+		fibril_mutex_lock(&exfat_bitmap_lock);
+		exfat_bitmap_map_update(instance, firstc, count, true);
+		fibril_mutex_unlock(&exfat_bitmap_lock);
+	}
+
+	rc = exfat_bitmap_write(bs, service_id, firstc, count, true);
+	if (rc != EOK) {
+		(void) exfat_bitmap_write(bs, service_id, firstc, count, false);
+		if (instance != NULL) {
+			fibril_mutex_lock(&exfat_bitmap_lock);
+			exfat_bitmap_map_update(instance, firstc, count, false);
+			fibril_mutex_unlock(&exfat_bitmap_lock);
 		}
-		clst++;
 	}
-	return EOK;
+
+	return rc;
 }
 
 errno_t exfat_bitmap_clear_clusters(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t firstc, exfat_cluster_t count)
 {
+	exfat_instance_t *instance;
 	errno_t rc;
-	exfat_cluster_t clst;
-	clst = firstc;
 
-	while (clst < firstc + count) {
-		rc = exfat_bitmap_clear_cluster(bs, service_id, clst);
-		if (rc != EOK)
-			return rc;
-		clst++;
+	rc = exfat_bitmap_write(bs, service_id, firstc, count, false);
+	if (rc != EOK)
+		return rc;
+
+	instance = exfat_bitmap_instance(service_id);
+	if (instance != NULL) {
+		fibril_mutex_lock(&exfat_bitmap_lock);
+		exfat_bitmap_map_update(instance, firstc, count, false);
+		fibril_mutex_unlock(&exfat_bitmap_lock);
 	}
+
 	return EOK;
 }
 
+/** Find a run of free clusters in the in-memory bitmap.
+ *
+ * The search starts at the cluster where the previous allocation ended and
+ * wraps around to the beginning of the volume.
+ *
+ * Must be called with exfat_bitmap_lock held.
+ */
+static bool exfat_bitmap_map_find_run(exfat_bs_t *bs,
+    exfat_instance_t *instance, exfat_cluster_t count, exfat_cluster_t *firstc)
+{
+	exfat_cluster_t nclst = DATA_CNT(bs) + EXFAT_CLST_FIRST;
+	exfat_cluster_t start = instance->next_free;
+	exfat_cluster_t from, to, clst, run;
+	uint32_t *words = (uint32_t *) instance->bitmap;
+	unsigned pass;
+
+	if (start < EXFAT_CLST_FIRST || start >= nclst)
+		start = EXFAT_CLST_FIRST;
+
+	for (pass = 0; pass < 2; pass++) {
+		from = (pass == 0) ? start : EXFAT_CLST_FIRST;
+		to = (pass == 0) ? nclst : min(nclst, start + count);
+
+		run = 0;
+		for (clst = from; clst < to; clst++) {
+			exfat_cluster_t bit = clst - EXFAT_CLST_FIRST;
+
+			/* Skip whole words of used clusters. */
+			if (run == 0 && bit % 32 == 0 && clst + 32 <= to &&
+			    words[bit / 32] == UINT32_MAX) {
+				clst += 31;
+				continue;
+			}
+
+			if (exfat_bitmap_map_used(instance, clst)) {
+				run = 0;
+				continue;
+			}
+
+			if (++run == count) {
+				*firstc = clst - count + 1;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 errno_t exfat_bitmap_alloc_clusters(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t *firstc, exfat_cluster_t count)
 {
 	exfat_cluster_t startc, endc;
+	exfat_instance_t *instance;
+	errno_t rc;
+
+	instance = exfat_bitmap_instance(service_id);
+	if (instance != NULL) {
+		fibril_mutex_lock(&exfat_bitmap_lock);
+		if (count == 0 || instance->free_cnt < count ||
+		    !exfat_bitmap_map_find_run(bs, instance, count, &startc)) {
+			fibril_mutex_unlock(&exfat_bitmap_lock);
+			return ENOSPC;
+		}
+		exfat_bitmap_map_update(instance, startc, count, true);
+		instance->next_free = startc + count;
+		fibril_mutex_unlock(&exfat_bitmap_lock);
+
+		rc = exfat_bitmap_write(bs, service_id, startc, count, true);
+		if (rc != EOK) {
+			(void) exfat_bitmap_write(bs, service_id, startc,
+			    count, false);
+			fibril_mutex_lock(&exfat_bitmap_lock);
+			exfat_bitmap_map_update(instance, startc, count, false);
+			fibril_mutex_unlock(&exfat_bitmap_lock);
+			return rc;
+		}
+
+		*firstc = startc;
+		return EOK;
+	}
+
 	startc = EXFAT_CLST_FIRST;
 
 	while (startc < DATA_CNT(bs) + 2) {
@@ -214,6 +435,99 @@ errno_t exfat_bitmap_alloc_clusters(exfat_bs_t *bs, service_id_t service_id,
 	return ENOSPC;
 }
 
+/** Allocate clusters which need not be contiguous.
+ *
+ * Free clusters are taken in ascending order from the cluster where the
+ * previous allocation ended and are marked as used in the bitmap.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param clsts		Array where the allocated clusters will be stored.
+ * @param nclsts	Number of clusters to allocate.
+ *
+ * @return		EOK on success, ENOTSUP if the bitmap is not loaded in
+ *			memory or another error code.
+ */
+errno_t exfat_bitmap_alloc_free(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t *clsts, unsigned nclsts)
+{
+	exfat_cluster_t nclst = DATA_CNT(bs) + EXFAT_CLST_FIRST;
+	exfat_instance_t *instance;
+	uint32_t *words;
+	exfat_cluster_t clst, left;
+	unsigned found = 0;
+	unsigned c, runc;
+	errno_t rc = EOK;
+
+	instance = exfat_bitmap_instance(service_id);
+	if (instance == NULL)
+		return ENOTSUP;
+	words = (uint32_t *) instance->bitmap;
+
+	fibril_mutex_lock(&exfat_bitmap_lock);
+	if (nclsts == 0 || instance->free_cnt < nclsts) {
+		fibril_mutex_unlock(&exfat_bitmap_lock);
+		return ENOSPC;
+	}
+
+	clst = instance->next_free;
+	if (clst < EXFAT_CLST_FIRST || clst >= nclst)
+		clst = EXFAT_CLST_FIRST;
+
+	for (left = DATA_CNT(bs); found < nclsts && left > 0; left--, clst++) {
+		if (clst >= nclst)
+			clst = EXFAT_CLST_FIRST;
+
+		/* Skip whole words of used clusters. */
+		exfat_cluster_t bit = clst - EXFAT_CLST_FIRST;
+		if (bit % 32 == 0 && left > 32 &&
+		    words[bit / 32] == UINT32_MAX) {
+			clst += 31;
+			left -= 31;
+			continue;
+		}
+
+		if (!exfat_bitmap_map_used(instance, clst)) {
+			exfat_bitmap_map_update(instance, clst, 1, true);
+			clsts[found++] = clst;
+		}
+	}
+
+	if (found < nclsts) {
+		/* The free cluster count does not match the bitmap. */
+		for (c = 0; c < found; c++)
+			exfat_bitmap_map_update(instance, clsts[c], 1, false);
+		fibril_mutex_unlock(&exfat_bitmap_lock);
+		return EIO;
+	}
+
+	instance->next_free = clsts[nclsts - 1] + 1;
+	fibril_mutex_unlock(&exfat_bitmap_lock);
+
+	/* Write the runs of contiguous clusters to the on-disk bitmap. */
+	for (c = 0; c < nclsts; c += runc) {
+		for (runc = 1; c + runc < nclsts &&
+		    clsts[c + runc] == clsts[c] + runc; runc++)
+			;
+		rc = exfat_bitmap_write(bs, service_id, clsts[c], runc, true);
+		if (rc != EOK)
+			break;
+	}
+
+	if (rc != EOK) {
+		for (c = 0; c < nclsts; c++) {
+			(void) exfat_bitmap_write(bs, service_id, clsts[c], 1,
+			    false);
+		}
+		fibril_mutex_lock(&exfat_bitmap_lock);
+		for (c = 0; c < nclsts; c++)
+			exfat_bitmap_map_update(instance, clsts[c], 1, false);
+		fibril_mutex_unlock(&exfat_bitmap_lock);
+	}
+
+	return rc;
+}
+
 errno_t exfat_bitmap_append_clusters(exfat_bs_t *bs, exfat_node_t *nodep,
     exfat_cluster_t count)
 {
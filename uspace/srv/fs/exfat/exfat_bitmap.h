@@ -40,6 +40,13 @@
 /* forward declarations */
 struct exfat_node;
 struct exfat_bs;
+struct exfat_instance;
+
+extern errno_t exfat_bitmap_load(struct exfat_bs *, service_id_t,
+    struct exfat_instance *);
+extern void exfat_bitmap_unload(struct exfat_instance *);
+extern errno_t exfat_bitmap_alloc_free(struct exfat_bs *, service_id_t,
+    exfat_cluster_t *, unsigned);
 
 extern errno_t exfat_bitmap_alloc_clusters(struct exfat_bs *, service_id_t,
     exfat_cluster_t *, exfat_cluster_t);
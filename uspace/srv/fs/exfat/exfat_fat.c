@@ -124,49 +124,135 @@ errno_t
 exfat_block_get(block_t **block, exfat_bs_t *bs, exfat_node_t *nodep,
     aoff64_t bn, int flags)
 {
-	exfat_cluster_t firstc = nodep->firstc;
-	exfat_cluster_t currc = 0;
-	aoff64_t relbn = bn;
+	exfat_cluster_t c;
 	errno_t rc;
 
 	if (!nodep->size)
 		return ELIMIT;
 
-	if (nodep->fragmented) {
-		if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
-		    nodep->lastc_cached_valid) {
-			/*
-			 * This is a request to read a block within the last cluster
-			 * when fortunately we have the last cluster number cached.
-			 */
-			return block_get(block, nodep->idx->service_id, DATA_FS(bs) +
-			    (nodep->lastc_cached_value - EXFAT_CLST_FIRST) * SPC(bs) +
-			    (bn % SPC(bs)), flags);
-		}
+	if (!nodep->fragmented) {
+		return exfat_block_get_by_clst(block, bs,
+		    nodep->idx->service_id, false, nodep->firstc, NULL, bn,
+		    flags);
+	}
 
-		if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
-			/*
-			 * We can start with the cluster cached by the previous call to
-			 * fat_block_get().
-			 */
-			firstc = nodep->currc_cached_value;
-			relbn -= (nodep->currc_cached_bn / SPC(bs)) * SPC(bs);
-		}
+	if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
+	    nodep->lastc_cached_valid) {
+		/*
+		 * This is a request to read a block within the last cluster
+		 * when fortunately we have the last cluster number cached.
+		 */
+		return block_get(block, nodep->idx->service_id, DATA_FS(bs) +
+		    (nodep->lastc_cached_value - EXFAT_CLST_FIRST) * SPC(bs) +
+		    (bn % SPC(bs)), flags);
 	}
 
-	rc = exfat_block_get_by_clst(block, bs, nodep->idx->service_id,
-	    nodep->fragmented, firstc, &currc, relbn, flags);
+	rc = exfat_node_cluster_get(bs, nodep, bn / SPC(bs), &c);
 	if (rc != EOK)
 		return rc;
 
-	/*
-	 * Update the "current" cluster cache.
-	 */
-	nodep->currc_cached_valid = true;
-	nodep->currc_cached_bn = bn;
-	nodep->currc_cached_value = currc;
+	return block_get(block, nodep->idx->service_id, DATA_FS(bs) +
+	    (c - EXFAT_CLST_FIRST) * SPC(bs) + (bn % SPC(bs)), flags);
+}
 
-	return rc;
+/** Add a run of clusters to the node's run cache.
+ *
+ * @param nodep		exFAT node.
+ * @param run		Run to add.
+ * @param prev		Cached run which @a run extends or NULL.
+ */
+static void exfat_node_run_add(exfat_node_t *nodep, exfat_run_t *run,
+    exfat_run_t *prev)
+{
+	if (prev != NULL && prev->idx == run->idx) {
+		*prev = *run;
+		return;
+	}
+
+	if (nodep->runs_cnt < EXFAT_RUNS_CACHED) {
+		nodep->runs[nodep->runs_cnt++] = *run;
+		return;
+	}
+
+	nodep->runs[nodep->runs_victim] = *run;
+	nodep->runs_victim = (nodep->runs_victim + 1) % EXFAT_RUNS_CACHED;
+}
+
+/** Find a cluster of a node.
+ *
+ * For fragmented nodes, runs of contiguous clusters found along the way are
+ * cached in the node so that the FAT is walked from the nearest known cluster
+ * preceding the requested one instead of from the start of the node.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		exFAT node.
+ * @param idx		Index of the cluster within the node.
+ * @param clst		Output argument holding the cluster.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_node_cluster_get(exfat_bs_t *bs, exfat_node_t *nodep,
+    uint32_t idx, exfat_cluster_t *clst)
+{
+	service_id_t service_id = nodep->idx->service_id;
+	exfat_run_t *prev = NULL;
+	exfat_run_t run;
+	exfat_cluster_t c, nextc;
+	uint32_t i;
+	errno_t rc;
+
+	if (nodep->firstc < EXFAT_CLST_FIRST)
+		return ELIMIT;
+
+	if (!nodep->fragmented) {
+		*clst = nodep->firstc + idx;
+		return EOK;
+	}
+
+	for (i = 0; i < nodep->runs_cnt; i++) {
+		exfat_run_t *r = &nodep->runs[i];
+
+		if (idx < r->idx)
+			continue;
+		if (idx - r->idx < r->cnt) {
+			*clst = r->clst + (idx - r->idx);
+			return EOK;
+		}
+		if (prev == NULL || r->idx > prev->idx)
+			prev = r;
+	}
+
+	if (prev != NULL) {
+		run = *prev;
+	} else {
+		run.idx = 0;
+		run.clst = nodep->firstc;
+		run.cnt = 1;
+	}
+
+	/* Walk the chain from the last cluster of the run. */
+	c = run.clst + run.cnt - 1;
+	for (i = run.idx + run.cnt - 1; i < idx; i++) {
+		rc = exfat_get_cluster(bs, service_id, c, &nextc);
+		if (rc != EOK)
+			return rc;
+		if (nextc < EXFAT_CLST_FIRST || nextc >= EXFAT_CLST_BAD)
+			return EIO;
+
+		if (nextc == c + 1) {
+			run.cnt++;
+		} else {
+			run.idx = i + 1;
+			run.clst = nextc;
+			run.cnt = 1;
+		}
+		c = nextc;
+	}
+
+	exfat_node_run_add(nodep, &run, prev);
+
+	*clst = c;
+	return EOK;
 }
 
 /** Read block from file located on a exFAT file system.
@@ -307,6 +393,41 @@ exfat_alloc_clusters(exfat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 	if (!lifo)
 		return ENOMEM;
 
+	rc = exfat_bitmap_alloc_free(bs, service_id, lifo, nclsts);
+	if (rc != ENOTSUP) {
+		unsigned c;
+
+		if (rc != EOK) {
+			free(lifo);
+			return rc;
+		}
+
+		/* Chain the clusters in ascending order. */
+		for (c = 0; c < nclsts; c++) {
+			rc = exfat_set_cluster(bs, service_id, lifo[c],
+			    c + 1 < nclsts ? lifo[c + 1] : EXFAT_CLST_EOF);
+			if (rc != EOK)
+				break;
+		}
+
+		if (rc != EOK) {
+			for (c = 0; c < nclsts; c++) {
+				(void) exfat_set_cluster(bs, service_id,
+				    lifo[c], 0);
+				(void) exfat_bitmap_clear_cluster(bs,
+				    service_id, lifo[c]);
+			}
+			free(lifo);
+			return rc;
+		}
+
+		*mcl = lifo[0];
+		*lcl = lifo[nclsts - 1];
+		free(lifo);
+		return EOK;
+	}
+	rc = EOK;
+
 	fibril_mutex_lock(&exfat_alloc_lock);
 	for (clst = EXFAT_CLST_FIRST; clst < DATA_CNT(bs) + 2 && found < nclsts;
 	    clst++) {
@@ -364,9 +485,13 @@ errno_t
 exfat_free_clusters(exfat_bs_t *bs, service_id_t service_id, exfat_cluster_t firstc)
 {
 	exfat_cluster_t nextc;
+	exfat_cluster_t runc = 0, runlen = 0;
 	errno_t rc;
 
-	/* Mark all clusters in the chain as free */
+	/*
+	 * Mark all clusters in the chain as free, clearing them in the bitmap
+	 * by runs of contiguous clusters.
+	 */
 	while (firstc != EXFAT_CLST_EOF) {
 		assert(firstc >= EXFAT_CLST_FIRST && firstc < EXFAT_CLST_BAD);
 		rc = exfat_get_cluster(bs, service_id, firstc, &nextc);
@@ -375,12 +500,25 @@ exfat_free_clusters(exfat_bs_t *bs, service_id_t service_id, exfat_cluster_t fir
 		rc = exfat_set_cluster(bs, service_id, firstc, 0);
 		if (rc != EOK)
 			return rc;
-		rc = exfat_bitmap_clear_cluster(bs, service_id, firstc);
-		if (rc != EOK)
-			return rc;
+
+		if (runlen > 0 && firstc == runc + runlen) {
+			runlen++;
+		} else {
+			if (runlen > 0) {
+				rc = exfat_bitmap_clear_clusters(bs, service_id,
+				    runc, runlen);
+				if (rc != EOK)
+					return rc;
+			}
+			runc = firstc;
+			runlen = 1;
+		}
 		firstc = nextc;
 	}
 
+	if (runlen > 0)
+		return exfat_bitmap_clear_clusters(bs, service_id, runc, runlen);
+
 	return EOK;
 }
 
@@ -446,8 +584,8 @@ errno_t exfat_chop_clusters(exfat_bs_t *bs, exfat_node_t *nodep, exfat_cluster_t
 	 * Invalidate cached cluster numbers.
 	 */
 	nodep->lastc_cached_valid = false;
-	if (nodep->currc_cached_value != lcl)
-		nodep->currc_cached_valid = false;
+	nodep->runs_cnt = 0;
+	nodep->runs_victim = 0;
 
 	if (lcl == 0) {
 		/* The node will have zero size and no clusters allocated. */
@@ -64,6 +64,8 @@ extern errno_t exfat_cluster_walk(struct exfat_bs *, service_id_t,
     exfat_cluster_t, exfat_cluster_t *, uint32_t *, uint32_t);
 extern errno_t exfat_block_get(block_t **, struct exfat_bs *, struct exfat_node *,
     aoff64_t, int);
+extern errno_t exfat_node_cluster_get(struct exfat_bs *, struct exfat_node *,
+    uint32_t, exfat_cluster_t *);
 extern errno_t exfat_block_get_by_clst(block_t **, struct exfat_bs *, service_id_t,
     bool, exfat_cluster_t, exfat_cluster_t *, aoff64_t, int);
 
@@ -109,9 +109,8 @@ static void exfat_node_initialize(exfat_node_t *node)
 	node->fragmented = false;
 	node->lastc_cached_valid = false;
 	node->lastc_cached_value = 0;
-	node->currc_cached_valid = false;
-	node->currc_cached_bn = 0;
-	node->currc_cached_value = 0;
+	node->runs_cnt = 0;
+	node->runs_victim = 0;
 }
 
 static errno_t exfat_node_sync(exfat_node_t *node)
@@ -470,8 +469,8 @@ static errno_t exfat_node_shrink(service_id_t service_id, exfat_node_t *nodep,
 				return rc;
 		} else {
 			exfat_cluster_t lastc;
-			rc = exfat_cluster_walk(bs, service_id, nodep->firstc,
-			    &lastc, NULL, (size - 1) / BPC(bs));
+			rc = exfat_node_cluster_get(bs, nodep,
+			    (size - 1) / BPC(bs), &lastc);
 			if (rc != EOK)
 				return rc;
 			rc = exfat_chop_clusters(bs, nodep, lastc);
@@ -937,8 +936,14 @@ errno_t exfat_free_block_count(service_id_t service_id, uint64_t *count)
 	uint64_t free_block_count = 0;
 	uint64_t block_count;
 	unsigned sector;
+	void *data;
 	errno_t rc;
 
+	if (fs_instance_get(service_id, &data) == EOK) {
+		*count = ((exfat_instance_t *) data)->free_cnt;
+		return EOK;
+	}
+
 	rc = exfat_total_block_count(service_id, &block_count);
 	if (rc != EOK)
 		goto exit;
@@ -1008,7 +1013,8 @@ libfs_ops_t exfat_libfs_ops = {
 	.service_get = exfat_service_get,
 	.size_block = exfat_size_block,
 	.total_block_count = exfat_total_block_count,
-	.free_block_count = exfat_free_block_count
+	.free_block_count = exfat_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 static errno_t exfat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1285,6 +1291,7 @@ exfat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 {
 	errno_t rc;
 	enum cache_mode cmode;
+	exfat_instance_t *instance;
 	exfat_idx_t *ridxp;
 	fs_node_t *rfn;
 
@@ -1294,9 +1301,31 @@ exfat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	else
 		cmode = CACHE_MODE_WB;
 
+	instance = malloc(sizeof(exfat_instance_t));
+	if (instance == NULL)
+		return ENOMEM;
+
 	rc = exfat_fs_open(service_id, cmode, &rfn, &ridxp, NULL);
-	if (rc != EOK)
+	if (rc != EOK) {
+		free(instance);
 		return rc;
+	}
+
+	/* Keep a copy of the allocation bitmap for the allocator. */
+	rc = exfat_bitmap_load(block_bb_get(service_id), service_id, instance);
+	if (rc != EOK) {
+		exfat_fs_close(service_id, rfn);
+		free(instance);
+		return rc;
+	}
+
+	rc = fs_instance_create(service_id, instance);
+	if (rc != EOK) {
+		exfat_fs_close(service_id, rfn);
+		exfat_bitmap_unload(instance);
+		free(instance);
+		return rc;
+	}
 
 	*index = ridxp->index;
 	*size = EXFAT_NODE(rfn)->size;
@@ -1314,6 +1343,14 @@ static errno_t exfat_unmounted(service_id_t service_id)
 		return rc;
 
 	exfat_fs_close(service_id, rfn);
+
+	void *data;
+	if (fs_instance_get(service_id, &data) == EOK) {
+		fs_instance_destroy(service_id);
+		exfat_bitmap_unload((exfat_instance_t *) data);
+		free(data);
+	}
+
 	return EOK;
 }
 
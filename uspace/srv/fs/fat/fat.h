@@ -174,6 +174,19 @@ typedef enum {
 
 struct fat_node;
 
+/** Number of cluster runs cached for each node. */
+#define FAT_RUNS_CACHED	8
+
+/** Run of contiguous clusters of a node. */
+typedef struct {
+	/** Index of the first cluster of the run within the node. */
+	uint32_t	idx;
+	/** First cluster of the run. */
+	fat_cluster_t	clst;
+	/** Number of clusters in the run. */
+	uint32_t	cnt;
+} fat_run_t;
+
 /** FAT index structure.
  *
  * This structure exists to help us to overcome certain limitations of the FAT
@@ -243,20 +256,27 @@ typedef struct fat_node {
 	bool			dirty;
 
 	/*
-	 * Cache of the node's last and "current" cluster to avoid some
-	 * unnecessary FAT walks.
+	 * Cache of the node's last cluster and of runs of its clusters to
+	 * avoid some unnecessary FAT walks.
 	 */
 	/* Node's last cluster in FAT. */
 	bool		lastc_cached_valid;
 	fat_cluster_t	lastc_cached_value;
-	/* Node's "current" cluster, i.e. where the last I/O took place. */
-	bool		currc_cached_valid;
-	aoff64_t	currc_cached_bn;
-	fat_cluster_t	currc_cached_value;
+	/* Runs of contiguous clusters where recent I/O took place. */
+	fat_run_t	runs[FAT_RUNS_CACHED];
+	unsigned	runs_cnt;
+	/* Next run to be replaced when the cache is full. */
+	unsigned	runs_victim;
 } fat_node_t;
 
-typedef struct {
+typedef struct fat_instance {
 	bool lfn_enabled;
+	/** Map of used clusters, built at mount time. */
+	uint32_t *clst_map;
+	/** Cluster where the search for free clusters continues. */
+	fat_cluster_t next_free;
+	/** Number of free clusters. */
+	uint32_t free_cnt;
 } fat_instance_t;
 
 extern vfs_out_ops_t fat_ops;
@@ -126,16 +126,16 @@ errno_t
 fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
     aoff64_t bn, int flags)
 {
-	fat_cluster_t firstc = nodep->firstc;
-	fat_cluster_t currc = 0;
-	aoff64_t relbn = bn;
+	fat_cluster_t c;
 	errno_t rc;
 
 	if (!nodep->size)
 		return ELIMIT;
 
-	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT)
-		goto fall_through;
+	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT) {
+		return _fat_block_get(block, bs, nodep->idx->service_id,
+		    nodep->firstc, NULL, bn, flags);
+	}
 
 	if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
 	    nodep->lastc_cached_valid) {
@@ -147,29 +147,107 @@ fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
 		    CLBN2PBN(bs, nodep->lastc_cached_value, bn), flags);
 	}
 
-	if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
-		/*
-		 * We can start with the cluster cached by the previous call to
-		 * fat_block_get().
-		 */
-		firstc = nodep->currc_cached_value;
-		relbn -= (nodep->currc_cached_bn / SPC(bs)) * SPC(bs);
-	}
-
-fall_through:
-	rc = _fat_block_get(block, bs, nodep->idx->service_id, firstc,
-	    &currc, relbn, flags);
+	rc = fat_node_cluster_get(bs, nodep, bn / SPC(bs), &c);
 	if (rc != EOK)
 		return rc;
 
-	/*
-	 * Update the "current" cluster cache.
-	 */
-	nodep->currc_cached_valid = true;
-	nodep->currc_cached_bn = bn;
-	nodep->currc_cached_value = currc;
+	return block_get(block, nodep->idx->service_id, CLBN2PBN(bs, c, bn),
+	    flags);
+}
 
-	return rc;
+/** Add a run of clusters to the node's run cache.
+ *
+ * @param nodep		FAT node.
+ * @param run		Run to add.
+ * @param prev		Cached run which @a run extends or NULL.
+ */
+static void fat_node_run_add(fat_node_t *nodep, fat_run_t *run, fat_run_t *prev)
+{
+	if (prev != NULL && prev->idx == run->idx) {
+		*prev = *run;
+		return;
+	}
+
+	if (nodep->runs_cnt < FAT_RUNS_CACHED) {
+		nodep->runs[nodep->runs_cnt++] = *run;
+		return;
+	}
+
+	nodep->runs[nodep->runs_victim] = *run;
+	nodep->runs_victim = (nodep->runs_victim + 1) % FAT_RUNS_CACHED;
+}
+
+/** Find a cluster of a node.
+ *
+ * Runs of contiguous clusters found along the way are cached in the node so
+ * that the cluster chain is walked from the nearest known cluster preceding
+ * the requested one instead of from the start of the node.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param idx		Index of the cluster within the node.
+ * @param clst		Output argument holding the cluster.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_node_cluster_get(fat_bs_t *bs, fat_node_t *nodep, uint32_t idx,
+    fat_cluster_t *clst)
+{
+	service_id_t service_id = nodep->idx->service_id;
+	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_run_t *prev = NULL;
+	fat_run_t run;
+	fat_cluster_t c, nextc;
+	uint32_t i;
+	errno_t rc;
+
+	if (nodep->firstc == FAT_CLST_RES0)
+		return ELIMIT;
+
+	for (i = 0; i < nodep->runs_cnt; i++) {
+		fat_run_t *r = &nodep->runs[i];
+
+		if (idx < r->idx)
+			continue;
+		if (idx - r->idx < r->cnt) {
+			*clst = r->clst + (idx - r->idx);
+			return EOK;
+		}
+		if (prev == NULL || r->idx > prev->idx)
+			prev = r;
+	}
+
+	if (prev != NULL) {
+		run = *prev;
+	} else {
+		run.idx = 0;
+		run.clst = nodep->firstc;
+		run.cnt = 1;
+	}
+
+	/* Walk the chain from the last cluster of the run. */
+	c = run.clst + run.cnt - 1;
+	for (i = run.idx + run.cnt - 1; i < idx; i++) {
+		rc = fat_get_cluster(bs, service_id, FAT1, c, &nextc);
+		if (rc != EOK)
+			return rc;
+		if (nextc < FAT_CLST_FIRST || nextc >= clst_last1)
+			return EIO;
+
+		if (nextc == c + 1) {
+			run.cnt++;
+		} else {
+			run.idx = i + 1;
+			run.clst = nextc;
+			run.cnt = 1;
+		}
+		c = nextc;
+	}
+
+	fat_node_run_add(nodep, &run, prev);
+
+	*clst = c;
+	return EOK;
 }
 
 /** Read block from file located on a FAT file system.
@@ -654,6 +732,214 @@ errno_t fat_alloc_shadow_clusters(fat_bs_t *bs, service_id_t service_id,
 	return EOK;
 }
 
+/** Mark a cluster as used or free in the cluster map. */
+static void fat_clst_map_set(fat_instance_t *instance, fat_cluster_t clst,
+    bool used)
+{
+	if (used)
+		instance->clst_map[clst / 32] |= (uint32_t) 1 << (clst % 32);
+	else
+		instance->clst_map[clst / 32] &= ~((uint32_t) 1 << (clst % 32));
+}
+
+/** Test whether a cluster is marked as used in the cluster map. */
+static bool fat_clst_map_used(fat_instance_t *instance, fat_cluster_t clst)
+{
+	return (instance->clst_map[clst / 32] >> (clst % 32)) & 1;
+}
+
+/** Build the map of used clusters of a file system.
+ *
+ * The map lets the allocator find free clusters without reading FAT1
+ * entry by entry. Entries beyond the last cluster are marked as used.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param instance	Instance data where the map will be stored.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_clst_map_init(fat_bs_t *bs, service_id_t service_id,
+    fat_instance_t *instance)
+{
+	fat_cluster_t nclst = CC(bs) + 2;
+	size_t words = (nclst + 31) / 32;
+	fat_cluster_t clst, value;
+	block_t *b;
+	errno_t rc;
+
+	instance->clst_map = malloc(words * sizeof(uint32_t));
+	if (instance->clst_map == NULL)
+		return ENOMEM;
+
+	memset(instance->clst_map, 0, words * sizeof(uint32_t));
+	for (clst = nclst; clst < words * 32; clst++)
+		fat_clst_map_set(instance, clst, true);
+	fat_clst_map_set(instance, FAT_CLST_RES0, true);
+	fat_clst_map_set(instance, FAT_CLST_RES1, true);
+
+	instance->free_cnt = 0;
+	instance->next_free = FAT_CLST_FIRST;
+
+	clst = FAT_CLST_FIRST;
+	while (clst < nclst) {
+		if (FAT_IS_FAT12(bs)) {
+			/* FAT12 entries may straddle sectors, read them singly. */
+			rc = fat_get_cluster(bs, service_id, FAT1, clst,
+			    &value);
+			if (rc != EOK)
+				goto error;
+			if (value != FAT_CLST_RES0)
+				fat_clst_map_set(instance, clst, true);
+			else
+				instance->free_cnt++;
+			clst++;
+			continue;
+		}
+
+		/* Decode a whole sector of FAT1 at once. */
+		aoff64_t offset = clst * FAT_CLST_SIZE(bs);
+		rc = block_get(&b, service_id, RSCNT(bs) + offset / BPS(bs),
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			goto error;
+
+		for (; clst < nclst && offset / BPS(bs) ==
+		    clst * FAT_CLST_SIZE(bs) / BPS(bs); clst++) {
+			size_t o = clst * FAT_CLST_SIZE(bs) % BPS(bs);
+
+			if (FAT_IS_FAT32(bs)) {
+				value = uint32_t_le2host(*(uint32_t *)
+				    (b->data + o)) & FAT32_MASK;
+			} else {
+				value = uint16_t_le2host(*(uint16_t *)
+				    (b->data + o));
+			}
+
+			if (value != FAT_CLST_RES0)
+				fat_clst_map_set(instance, clst, true);
+			else
+				instance->free_cnt++;
+		}
+
+		rc = block_put(b);
+		if (rc != EOK)
+			goto error;
+	}
+
+	return EOK;
+
+error:
+	free(instance->clst_map);
+	instance->clst_map = NULL;
+	return rc;
+}
+
+/** Destroy the map of used clusters of a file system. */
+void fat_clst_map_fini(fat_instance_t *instance)
+{
+	free(instance->clst_map);
+	instance->clst_map = NULL;
+}
+
+/** Allocate clusters in all copies of FAT using the cluster map.
+ *
+ * Free clusters are searched for in the map starting at the cluster where the
+ * previous search ended. The allocated clusters are chained in ascending
+ * order so that they form contiguous runs wherever the free space allows.
+ *
+ * Must be called with fat_alloc_lock held.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Device service ID of the file system.
+ * @param instance	Instance data of the file system.
+ * @param nclsts	Number of clusters to allocate.
+ * @param mcl		Output parameter where the first cluster in the chain
+ *			will be returned.
+ * @param lcl		Output parameter where the last cluster in the chain
+ *			will be returned.
+ *
+ * @return		EOK on success, an error code otherwise.
+ */
+static errno_t fat_alloc_clusters_map(fat_bs_t *bs, service_id_t service_id,
+    fat_instance_t *instance, unsigned nclsts, fat_cluster_t *mcl,
+    fat_cluster_t *lcl)
+{
+	fat_cluster_t nclst = CC(bs) + 2;
+	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_cluster_t *clsts;
+	fat_cluster_t clst;
+	fat_cluster_t left = nclst;
+	unsigned found = 0;
+	unsigned fatno;
+	unsigned c;
+	errno_t rc = EOK;
+
+	if (nclsts == 0 || instance->free_cnt < nclsts)
+		return ENOSPC;
+
+	clsts = (fat_cluster_t *) malloc(nclsts * sizeof(fat_cluster_t));
+	if (!clsts)
+		return ENOMEM;
+
+	clst = instance->next_free;
+	if (clst < FAT_CLST_FIRST || clst >= nclst)
+		clst = FAT_CLST_FIRST;
+
+	while (found < nclsts) {
+		if (left == 0) {
+			/* The free cluster count does not match the map. */
+			rc = EIO;
+			goto error;
+		}
+
+		if (clst >= nclst)
+			clst = FAT_CLST_FIRST;
+
+		/* Skip whole words of used clusters. */
+		if (clst % 32 == 0 && left >= 32 &&
+		    instance->clst_map[clst / 32] == UINT32_MAX) {
+			clst += 32;
+			left -= 32;
+			continue;
+		}
+
+		if (!fat_clst_map_used(instance, clst)) {
+			fat_clst_map_set(instance, clst, true);
+			clsts[found++] = clst;
+		}
+		clst++;
+		left--;
+	}
+
+	for (fatno = FAT1; fatno < FATCNT(bs); fatno++) {
+		for (c = 0; c < nclsts; c++) {
+			rc = fat_set_cluster(bs, service_id, fatno, clsts[c],
+			    c + 1 < nclsts ? clsts[c + 1] : clst_last1);
+			if (rc != EOK)
+				goto error;
+		}
+	}
+
+	instance->free_cnt -= nclsts;
+	instance->next_free = clsts[nclsts - 1] + 1;
+	*mcl = clsts[0];
+	*lcl = clsts[nclsts - 1];
+	free(clsts);
+	return EOK;
+
+error:
+	for (c = 0; c < found; c++) {
+		for (fatno = FAT1; fatno < FATCNT(bs); fatno++) {
+			(void) fat_set_cluster(bs, service_id, fatno, clsts[c],
+			    FAT_CLST_RES0);
+		}
+		fat_clst_map_set(instance, clsts[c], false);
+	}
+	free(clsts);
+	return rc;
+}
+
 /** Allocate clusters in all copies of FAT.
  *
  * This function will attempt to allocate the requested number of clusters in
@@ -680,8 +966,21 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 	fat_cluster_t clst;
 	fat_cluster_t value = 0;
 	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_instance_t *instance;
+	void *data;
 	errno_t rc = EOK;
 
+	if (fs_instance_get(service_id, &data) == EOK) {
+		instance = (fat_instance_t *) data;
+		if (instance->clst_map != NULL) {
+			fibril_mutex_lock(&fat_alloc_lock);
+			rc = fat_alloc_clusters_map(bs, service_id, instance,
+			    nclsts, mcl, lcl);
+			fibril_mutex_unlock(&fat_alloc_lock);
+			return rc;
+		}
+	}
+
 	lifo = (fat_cluster_t *) malloc(nclsts * sizeof(fat_cluster_t));
 	if (!lifo)
 		return ENOMEM;
@@ -748,8 +1047,14 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 	unsigned fatno;
 	fat_cluster_t nextc = 0;
 	fat_cluster_t clst_bad = FAT_CLST_BAD(bs);
+	fat_instance_t *instance = NULL;
+	void *data;
 	errno_t rc;
 
+	if (fs_instance_get(service_id, &data) == EOK &&
+	    ((fat_instance_t *) data)->clst_map != NULL)
+		instance = (fat_instance_t *) data;
+
 	/* Mark all clusters in the chain as free in all copies of FAT. */
 	while (firstc < FAT_CLST_LAST1(bs)) {
 		assert(firstc >= FAT_CLST_FIRST && firstc < clst_bad);
@@ -765,6 +1070,13 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 				return rc;
 		}
 
+		if (instance != NULL) {
+			fibril_mutex_lock(&fat_alloc_lock);
+			fat_clst_map_set(instance, firstc, false);
+			instance->free_cnt++;
+			fibril_mutex_unlock(&fat_alloc_lock);
+		}
+
 		firstc = nextc;
 	}
 
@@ -837,8 +1149,8 @@ errno_t fat_chop_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t lcl)
 	 * Invalidate cached cluster numbers.
 	 */
 	nodep->lastc_cached_valid = false;
-	if (nodep->currc_cached_value != lcl)
-		nodep->currc_cached_valid = false;
+	nodep->runs_cnt = 0;
+	nodep->runs_victim = 0;
 
 	if (lcl == FAT_CLST_RES0) {
 		/* The node will have zero size and no clusters allocated. */
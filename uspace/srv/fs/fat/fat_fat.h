@@ -102,6 +102,7 @@
 struct block;
 struct fat_node;
 struct fat_bs;
+struct fat_instance;
 
 typedef uint32_t fat_cluster_t;
 
@@ -112,6 +113,8 @@ extern errno_t fat_cluster_walk(struct fat_bs *, service_id_t, fat_cluster_t,
 
 extern errno_t fat_block_get(block_t **, struct fat_bs *, struct fat_node *,
     aoff64_t, int);
+extern errno_t fat_node_cluster_get(struct fat_bs *, struct fat_node *,
+    uint32_t, fat_cluster_t *);
 extern errno_t _fat_block_get(block_t **, struct fat_bs *, service_id_t,
     fat_cluster_t, fat_cluster_t *, aoff64_t, int);
 
@@ -132,6 +135,9 @@ extern errno_t fat_fill_gap(struct fat_bs *, struct fat_node *, fat_cluster_t,
     aoff64_t);
 extern errno_t fat_zero_cluster(struct fat_bs *, service_id_t, fat_cluster_t);
 extern errno_t fat_sanity_check(struct fat_bs *, service_id_t);
+extern errno_t fat_clst_map_init(struct fat_bs *, service_id_t,
+    struct fat_instance *);
+extern void fat_clst_map_fini(struct fat_instance *);
 
 #endif
 
@@ -108,9 +108,8 @@ static void fat_node_initialize(fat_node_t *node)
 	node->dirty = false;
 	node->lastc_cached_valid = false;
 	node->lastc_cached_value = 0;
-	node->currc_cached_valid = false;
-	node->currc_cached_bn = 0;
-	node->currc_cached_value = 0;
+	node->runs_cnt = 0;
+	node->runs_victim = 0;
 }
 
 static errno_t fat_node_sync(fat_node_t *node)
@@ -905,7 +904,8 @@ libfs_ops_t fat_libfs_ops = {
 	.service_get = fat_service_get,
 	.size_block = fat_size_block,
 	.total_block_count = fat_total_block_count,
-	.free_block_count = fat_free_block_count
+	.free_block_count = fat_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 static errno_t fat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1074,6 +1074,32 @@ static errno_t fat_fsprobe(service_id_t service_id, vfs_fs_probe_info_t *info)
 	return EOK;
 }
 
+/** Parse the write-back tuning mount option.
+ *
+ * The option has the form wb=<dirty_bg>:<dirty_max>:<interval>, see
+ * block_cache_set_writeback(). The flusher interval is in milliseconds.
+ *
+ * @return EOK on success, EINVAL if the option is malformed.
+ */
+static errno_t fat_parse_wb(const char *opt, unsigned *dirty_bg,
+    unsigned *dirty_max, usec_t *interval)
+{
+	const char *p = opt + str_length("wb=");
+	uint32_t bg, max, msec;
+
+	if (str_uint32_t(p, &p, 10, false, &bg) != EOK || *p++ != ':')
+		return EINVAL;
+	if (str_uint32_t(p, &p, 10, false, &max) != EOK || *p++ != ':')
+		return EINVAL;
+	if (str_uint32_t(p, &p, 10, true, &msec) != EOK)
+		return EINVAL;
+
+	*dirty_bg = bg;
+	*dirty_max = max;
+	*interval = MSEC2USEC(msec);
+	return EOK;
+}
+
 static errno_t
 fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
     aoff64_t *size)
@@ -1082,6 +1108,10 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	fat_instance_t *instance;
 	fat_idx_t *ridxp;
 	fs_node_t *rfn;
+	bool wb_tune = false;
+	unsigned dirty_bg = 0;
+	unsigned dirty_max = 0;
+	usec_t interval = 0;
 	errno_t rc;
 
 	instance = malloc(sizeof(fat_instance_t));
@@ -1097,6 +1127,15 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 			cmode = CACHE_MODE_WT;
 		else if (str_cmp(opt, "nolfn") == 0)
 			instance->lfn_enabled = false;
+		else if (str_lcmp(opt, "wb=", str_length("wb=")) == 0) {
+			rc = fat_parse_wb(opt, &dirty_bg, &dirty_max,
+			    &interval);
+			if (rc != EOK) {
+				free(instance);
+				return rc;
+			}
+			wb_tune = true;
+		}
 	}
 
 	rc = fat_fs_open(service_id, cmode, &rfn, &ridxp);
@@ -1105,12 +1144,32 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 		return rc;
 	}
 
+	/* Tune write-back of the block cache if asked to. */
+	if (wb_tune && cmode == CACHE_MODE_WB) {
+		rc = block_cache_set_writeback(service_id, dirty_bg,
+		    dirty_max, interval);
+		if (rc != EOK) {
+			fat_fs_close(service_id, rfn);
+			free(instance);
+			return rc;
+		}
+	}
+
+	/* Build the map of used clusters for the allocator. */
+	rc = fat_clst_map_init(block_bb_get(service_id), service_id, instance);
+	if (rc != EOK) {
+		fat_fs_close(service_id, rfn);
+		free(instance);
+		return rc;
+	}
+
 	fibril_mutex_lock(&ridxp->lock);
 
 	rc = fs_instance_create(service_id, instance);
 	if (rc != EOK) {
 		fibril_mutex_unlock(&ridxp->lock);
 		fat_fs_close(service_id, rfn);
+		fat_clst_map_fini(instance);
 		free(instance);
 		return rc;
 	}
@@ -1125,11 +1184,16 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 
 static errno_t fat_update_fat32_fsinfo(service_id_t service_id)
 {
+	fat_instance_t *instance = NULL;
 	fat_bs_t *bs;
 	fat32_fsinfo_t *info;
 	block_t *b;
+	void *data;
 	errno_t rc;
 
+	if (fs_instance_get(service_id, &data) == EOK)
+		instance = (fat_instance_t *) data;
+
 	bs = block_bb_get(service_id);
 	assert(FAT_IS_FAT32(bs));
 
@@ -1147,8 +1211,14 @@ static errno_t fat_update_fat32_fsinfo(service_id_t service_id)
 		return EINVAL;
 	}
 
-	/* For now, invalidate the counter. */
-	info->free_clusters = host2uint16_t_le(-1);
+	if (instance != NULL && instance->clst_map != NULL) {
+		info->free_clusters = host2uint32_t_le(instance->free_cnt);
+		info->last_allocated_cluster =
+		    host2uint32_t_le(instance->next_free - 1);
+	} else {
+		/* Invalidate the counter. */
+		info->free_clusters = host2uint32_t_le(-1);
+	}
 
 	b->dirty = true;
 	return block_put(b);
@@ -1200,6 +1270,7 @@ static errno_t fat_unmounted(service_id_t service_id)
 	void *data;
 	if (fs_instance_get(service_id, &data) == EOK) {
 		fs_instance_destroy(service_id);
+		fat_clst_map_fini((fat_instance_t *) data);
 		free(data);
 	}
 
@@ -1495,8 +1566,8 @@ fat_truncate(service_id_t service_id, fs_index_t index, aoff64_t size)
 				goto out;
 		} else {
 			fat_cluster_t lastc;
-			rc = fat_cluster_walk(bs, service_id, nodep->firstc,
-			    &lastc, NULL, (size - 1) / BPC(bs));
+			rc = fat_node_cluster_get(bs, nodep,
+			    (size - 1) / BPC(bs), &lastc);
 			if (rc != EOK)
 				goto out;
 			rc = fat_chop_clusters(bs, nodep, lastc);
@@ -89,7 +89,8 @@ libfs_ops_t mfs_libfs_ops = {
 	.lnkcnt_get = mfs_lnkcnt_get,
 	.size_block = mfs_size_block,
 	.total_block_count = mfs_total_block_count,
-	.free_block_count = mfs_free_block_count
+	.free_block_count = mfs_free_block_count,
+	.cache_stats = block_cache_statfs
 };
 
 /* Hash table interface for open nodes hash table */
@@ -37,6 +37,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <adt/hash_table.h>
+#include <adt/odict.h>
+#include <offset.h>
 
 #define TMPFS_NODE(node)	((node) ? (tmpfs_node_t *)(node)->data : NULL)
 #define FS_NODE(node)		((node) ? (node)->bp : NULL)
@@ -47,9 +49,22 @@ typedef enum {
 	TMPFS_DIRECTORY
 } tmpfs_dentry_type_t;
 
+/** Size of a chunk of file contents. */
+#define TMPFS_CHUNK_SIZE	4096
+
 /* forward declaration */
 struct tmpfs_node;
 
+/** Chunk of file contents.
+ *
+ * Chunks which were never written are not allocated, they read as zeros.
+ */
+typedef struct tmpfs_chunk {
+	odlink_t link;		/**< Linkage for the node's chunk dictionary. */
+	aoff64_t index;		/**< Position in the file in chunks. */
+	uint8_t data[TMPFS_CHUNK_SIZE];
+} tmpfs_chunk_t;
+
 typedef struct tmpfs_dentry {
 	link_t link;		/**< Linkage for the list of siblings. */
 	struct tmpfs_node *node;/**< Back pointer to TMPFS node. */
@@ -63,8 +78,8 @@ typedef struct tmpfs_node {
 	ht_link_t nh_link;		/**< Nodes hash table link. */
 	tmpfs_dentry_type_t type;
 	unsigned lnkcnt;	/**< Link count. */
-	size_t size;		/**< File size if type is TMPFS_FILE. */
-	void *data;		/**< File content's if type is TMPFS_FILE. */
+	aoff64_t size;		/**< File size if type is TMPFS_FILE. */
+	odict_t chunks;		/**< File content's if type is TMPFS_FILE. */
 	list_t cs_list;		/**< Child's siblings list. */
 } tmpfs_node_t;
 
@@ -49,6 +49,7 @@
 #include <stddef.h>
 #include <adt/hash_table.h>
 #include <adt/hash.h>
+#include <adt/odict.h>
 #include <as.h>
 #include <libfs.h>
 
@@ -137,6 +138,78 @@ libfs_ops_t tmpfs_libfs_ops = {
 /** Hash table of all TMPFS nodes. */
 hash_table_t nodes;
 
+/*
+ * Implementation of the file contents.
+ */
+
+/** Contents of a chunk which was never written. */
+static const uint8_t tmpfs_zero_chunk[TMPFS_CHUNK_SIZE];
+
+static void *chunks_getkey(odlink_t *odlink)
+{
+	tmpfs_chunk_t *chunk = odict_get_instance(odlink, tmpfs_chunk_t, link);
+	return &chunk->index;
+}
+
+static int chunks_cmp(void *a, void *b)
+{
+	aoff64_t ia = *(aoff64_t *) a;
+	aoff64_t ib = *(aoff64_t *) b;
+
+	if (ia < ib)
+		return -1;
+	if (ia > ib)
+		return 1;
+	return 0;
+}
+
+static tmpfs_chunk_t *tmpfs_chunk_find(tmpfs_node_t *nodep, aoff64_t index)
+{
+	odlink_t *odlink = odict_find_eq(&nodep->chunks, &index, NULL);
+	if (!odlink)
+		return NULL;
+	return odict_get_instance(odlink, tmpfs_chunk_t, link);
+}
+
+/** Get a chunk of file contents, allocating it if necessary.
+ *
+ * @param nodep		TMPFS file node.
+ * @param index		Position of the chunk in the file in chunks.
+ *
+ * @return		Chunk or NULL if out of memory.
+ */
+static tmpfs_chunk_t *tmpfs_chunk_get(tmpfs_node_t *nodep, aoff64_t index)
+{
+	tmpfs_chunk_t *chunk = tmpfs_chunk_find(nodep, index);
+	if (chunk)
+		return chunk;
+
+	chunk = calloc(1, sizeof(tmpfs_chunk_t));
+	if (!chunk)
+		return NULL;
+
+	odlink_initialize(&chunk->link);
+	chunk->index = index;
+	odict_insert(&chunk->link, &nodep->chunks, NULL);
+	return chunk;
+}
+
+/** Free the chunks of file contents starting at a chunk index. */
+static void tmpfs_chunks_free(tmpfs_node_t *nodep, aoff64_t index)
+{
+	odlink_t *odlink = odict_find_geq(&nodep->chunks, &index, NULL);
+
+	while (odlink) {
+		odlink_t *next = odict_next(odlink, &nodep->chunks);
+		tmpfs_chunk_t *chunk = odict_get_instance(odlink,
+		    tmpfs_chunk_t, link);
+
+		odict_remove(odlink);
+		free(chunk);
+		odlink = next;
+	}
+}
+
 /*
  * Implementation of hash table interface for the nodes hash table.
  */
@@ -179,9 +252,9 @@ static void nodes_remove_callback(ht_link_t *item)
 		free(dentryp);
 	}
 
-	if (nodep->data) {
+	if (!odict_empty(&nodep->chunks)) {
 		assert(nodep->type == TMPFS_FILE);
-		free(nodep->data);
+		tmpfs_chunks_free(nodep, 0);
 	}
 	free(nodep->bp);
 	free(nodep);
@@ -204,7 +277,7 @@ static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 	nodep->type = TMPFS_NONE;
 	nodep->lnkcnt = 0;
 	nodep->size = 0;
-	nodep->data = NULL;
+	odict_initialize(&nodep->chunks, chunks_getkey, chunks_cmp);
 	list_initialize(&nodep->cs_list);
 }
 
@@ -491,9 +564,20 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	size_t bytes;
 	if (nodep->type == TMPFS_FILE) {
-		bytes = min(nodep->size - pos, size);
-		(void) async_data_read_finalize(&call, nodep->data + pos,
-		    bytes);
+		bytes = (pos < nodep->size) ? min(nodep->size - pos, size) : 0;
+
+		/*
+		 * Read at most up to the end of the chunk, so that the data
+		 * can be transferred right from it. Unallocated chunks read
+		 * as zeros.
+		 */
+		size_t off = pos % TMPFS_CHUNK_SIZE;
+		bytes = min(bytes, TMPFS_CHUNK_SIZE - off);
+
+		tmpfs_chunk_t *chunk = tmpfs_chunk_find(nodep,
+		    pos / TMPFS_CHUNK_SIZE);
+		(void) async_data_read_finalize(&call,
+		    chunk ? chunk->data + off : tmpfs_zero_chunk, bytes);
 	} else {
 		tmpfs_dentry_t *dentryp;
 		link_t *lnk;
@@ -552,34 +636,33 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		return EINVAL;
 	}
 
-	/*
-	 * Check whether the file needs to grow.
-	 */
-	if (pos + size <= nodep->size) {
-		/* The file size is not changing. */
-		(void) async_data_write_finalize(&call, nodep->data + pos,
-		    size);
-		goto out;
+	/* The end of the written range must be representable. */
+	if (pos + size < pos) {
+		async_answer_0(&call, EOVERFLOW);
+		return EOVERFLOW;
 	}
-	size_t delta = (pos + size) - nodep->size;
+
 	/*
-	 * At this point, we are deliberately extremely straightforward and
-	 * simply realloc the contents of the file on every write that grows the
-	 * file. In the end, the situation might not be as bad as it may look:
-	 * our heap allocator can save us and just grow the block whenever
-	 * possible.
+	 * Write at most up to the end of the chunk, so that the data can be
+	 * transferred right into it. Chunks which are skipped when writing
+	 * beyond the end of the file remain unallocated.
 	 */
-	void *newdata = realloc(nodep->data, nodep->size + delta);
-	if (!newdata) {
+	size_t off = pos % TMPFS_CHUNK_SIZE;
+	size = min(size, TMPFS_CHUNK_SIZE - off);
+
+	tmpfs_chunk_t *chunk = tmpfs_chunk_get(nodep, pos / TMPFS_CHUNK_SIZE);
+	if (!chunk) {
 		async_answer_0(&call, ENOMEM);
 		size = 0;
 		goto out;
 	}
-	/* Clear any newly allocated memory in order to emulate gaps. */
-	memset(newdata + nodep->size, 0, delta);
-	nodep->size += delta;
-	nodep->data = newdata;
-	(void) async_data_write_finalize(&call, nodep->data + pos, size);
+
+	errno_t rc = async_data_write_finalize(&call, chunk->data + off, size);
+	if (rc != EOK)
+		size = 0;
+
+	if (pos + size > nodep->size)
+		nodep->size = pos + size;
 
 out:
 	*wbytes = size;
@@ -606,20 +689,24 @@ static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
 	if (size == nodep->size)
 		return EOK;
 
-	if (size > SIZE_MAX)
-		return ENOMEM;
-
-	void *newdata = realloc(nodep->data, size);
-	if (!newdata && size)
-		return ENOMEM;
-
-	if (size > nodep->size) {
-		size_t delta = size - nodep->size;
-		memset(newdata + nodep->size, 0, delta);
+	if (size < nodep->size) {
+		/*
+		 * Free the chunks beyond the new end of the file and clear
+		 * the rest of the last chunk so that the file reads as zeros
+		 * there should it grow again.
+		 */
+		aoff64_t index = size / TMPFS_CHUNK_SIZE;
+		size_t off = size % TMPFS_CHUNK_SIZE;
+		if (off != 0) {
+			tmpfs_chunk_t *chunk = tmpfs_chunk_find(nodep, index);
+			if (chunk)
+				memset(chunk->data + off, 0, TMPFS_CHUNK_SIZE - off);
+			index++;
+		}
+		tmpfs_chunks_free(nodep, index);
 	}
 
 	nodep->size = size;
-	nodep->data = newdata;
 	return EOK;
 }
 
@@ -34,8 +34,11 @@
  * @brief
  */
 
-#include <adt/list.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/twheel.h>
 #include <errno.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
@@ -44,42 +47,137 @@
 #include "atrans.h"
 #include "ethip.h"
 
-/** Address translation list (of ethip_atrans_t) */
-static FIBRIL_MUTEX_INITIALIZE(atrans_list_lock);
-static LIST_INITIALIZE(atrans_list);
+/** Translation lifetime in seconds */
+#define ATRANS_TTL 300
+/** Expiration timer tick in microseconds */
+#define ATRANS_TICK_USEC (1000 * 1000)
+/** Number of timer wheel slots (more than ATRANS_TTL ticks) */
+#define ATRANS_WHEEL_SLOTS 512
+
+/** Address translation table (of ethip_atrans_t) */
+static FIBRIL_MUTEX_INITIALIZE(atrans_lock);
+static hash_table_t atrans_table;
 static FIBRIL_CONDVAR_INITIALIZE(atrans_cv);
+/** Expiration timers of translations */
+static twheel_t atrans_wheel;
+
+static size_t atrans_key_hash(const void *key)
+{
+	const addr32_t *ip_addr = key;
+	return hash_mix32(*ip_addr);
+}
+
+static size_t atrans_hash(const ht_link_t *item)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    atrans_ht);
+	return atrans_key_hash(&atrans->ip_addr);
+}
+
+static bool atrans_key_equal(const void *key, const ht_link_t *item)
+{
+	const addr32_t *ip_addr = key;
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    atrans_ht);
+	return atrans->ip_addr == *ip_addr;
+}
+
+static bool atrans_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	ethip_atrans_t *atrans1 = hash_table_get_inst(item1, ethip_atrans_t,
+	    atrans_ht);
+	return atrans_key_equal(&atrans1->ip_addr, item2);
+}
+
+static hash_table_ops_t atrans_ops = {
+	.hash = atrans_hash,
+	.key_hash = atrans_key_hash,
+	.key_equal = atrans_key_equal,
+	.equal = atrans_equal,
+	.remove_callback = NULL
+};
 
 static ethip_atrans_t *atrans_find(addr32_t ip_addr)
 {
-	list_foreach(atrans_list, atrans_list, ethip_atrans_t, atrans) {
-		if (atrans->ip_addr == ip_addr)
-			return atrans;
+	ht_link_t *link = hash_table_find(&atrans_table, &ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, ethip_atrans_t, atrans_ht);
+}
+
+static void atrans_expire(twheel_timer_t *timer, void *arg)
+{
+	ethip_atrans_t *atrans = list_get_instance(timer, ethip_atrans_t,
+	    expire);
+
+	hash_table_remove_item(&atrans_table, &atrans->atrans_ht);
+	free(atrans);
+}
+
+static errno_t atrans_timer_fibril(void *arg)
+{
+	while (true) {
+		fibril_usleep(ATRANS_TICK_USEC);
+
+		fibril_mutex_lock(&atrans_lock);
+		twheel_tick(&atrans_wheel, atrans_expire, NULL);
+		fibril_mutex_unlock(&atrans_lock);
 	}
 
-	return NULL;
+	return EOK;
 }
 
-errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
+/** Initialize address translation table.
+ *
+ * @return EOK on success or an error code
+ */
+errno_t atrans_init(void)
 {
-	ethip_atrans_t *atrans;
-	ethip_atrans_t *prev;
+	fid_t fid;
+	errno_t rc;
 
-	atrans = calloc(1, sizeof(ethip_atrans_t));
-	if (atrans == NULL)
+	if (!hash_table_create(&atrans_table, 0, 0, &atrans_ops))
 		return ENOMEM;
 
-	atrans->ip_addr = ip_addr;
-	atrans->mac_addr = *mac_addr;
+	rc = twheel_init(&atrans_wheel, ATRANS_WHEEL_SLOTS);
+	if (rc != EOK) {
+		hash_table_destroy(&atrans_table);
+		return rc;
+	}
 
-	fibril_mutex_lock(&atrans_list_lock);
-	prev = atrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->atrans_list);
-		free(prev);
+	fid = fibril_create(atrans_timer_fibril, NULL);
+	if (fid == 0) {
+		twheel_fini(&atrans_wheel);
+		hash_table_destroy(&atrans_table);
+		return ENOMEM;
 	}
 
-	list_append(&atrans->atrans_list, &atrans_list);
-	fibril_mutex_unlock(&atrans_list_lock);
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
+{
+	ethip_atrans_t *atrans;
+
+	fibril_mutex_lock(&atrans_lock);
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL) {
+		atrans = calloc(1, sizeof(ethip_atrans_t));
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_lock);
+			return ENOMEM;
+		}
+
+		atrans->ip_addr = ip_addr;
+		twheel_timer_initialize(&atrans->expire);
+		hash_table_insert(&atrans_table, &atrans->atrans_ht);
+	}
+
+	atrans->mac_addr = *mac_addr;
+	twheel_set(&atrans_wheel, &atrans->expire, ATRANS_TTL);
+	fibril_mutex_unlock(&atrans_lock);
 	fibril_condvar_broadcast(&atrans_cv);
 
 	return EOK;
@@ -89,15 +187,16 @@ errno_t atrans_remove(addr32_t ip_addr)
 {
 	ethip_atrans_t *atrans;
 
-	fibril_mutex_lock(&atrans_list_lock);
+	fibril_mutex_lock(&atrans_lock);
 	atrans = atrans_find(ip_addr);
 	if (atrans == NULL) {
-		fibril_mutex_unlock(&atrans_list_lock);
+		fibril_mutex_unlock(&atrans_lock);
 		return ENOENT;
 	}
 
-	list_remove(&atrans->atrans_list);
-	fibril_mutex_unlock(&atrans_list_lock);
+	twheel_clear(&atrans_wheel, &atrans->expire);
+	hash_table_remove_item(&atrans_table, &atrans->atrans_ht);
+	fibril_mutex_unlock(&atrans_lock);
 	free(atrans);
 
 	return EOK;
@@ -117,9 +216,9 @@ errno_t atrans_lookup(addr32_t ip_addr, eth_addr_t *mac_addr)
 {
 	errno_t rc;
 
-	fibril_mutex_lock(&atrans_list_lock);
+	fibril_mutex_lock(&atrans_lock);
 	rc = atrans_lookup_locked(ip_addr, mac_addr);
-	fibril_mutex_unlock(&atrans_list_lock);
+	fibril_mutex_unlock(&atrans_lock);
 
 	return rc;
 }
@@ -128,9 +227,9 @@ static void atrans_lookup_timeout_handler(void *arg)
 {
 	bool *timedout = (bool *)arg;
 
-	fibril_mutex_lock(&atrans_list_lock);
+	fibril_mutex_lock(&atrans_lock);
 	*timedout = true;
-	fibril_mutex_unlock(&atrans_list_lock);
+	fibril_mutex_unlock(&atrans_lock);
 	fibril_condvar_broadcast(&atrans_cv);
 }
 
@@ -148,14 +247,14 @@ errno_t atrans_lookup_timeout(addr32_t ip_addr, usec_t timeout,
 	timedout = false;
 	fibril_timer_set(t, timeout, atrans_lookup_timeout_handler, &timedout);
 
-	fibril_mutex_lock(&atrans_list_lock);
+	fibril_mutex_lock(&atrans_lock);
 
 	while ((rc = atrans_lookup_locked(ip_addr, mac_addr)) == ENOENT &&
 	    !timedout) {
-		fibril_condvar_wait(&atrans_cv, &atrans_list_lock);
+		fibril_condvar_wait(&atrans_cv, &atrans_lock);
 	}
 
-	fibril_mutex_unlock(&atrans_list_lock);
+	fibril_mutex_unlock(&atrans_lock);
 	(void) fibril_timer_clear(t);
 	fibril_timer_destroy(t);
 
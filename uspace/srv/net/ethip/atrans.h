@@ -42,6 +42,7 @@
 #include <inet/iplink_srv.h>
 #include "ethip.h"
 
+extern errno_t atrans_init(void);
 extern errno_t atrans_add(addr32_t, eth_addr_t *);
 extern errno_t atrans_remove(addr32_t);
 extern errno_t atrans_lookup(addr32_t, eth_addr_t *);
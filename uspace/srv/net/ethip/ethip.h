@@ -37,12 +37,17 @@
 #ifndef ETHIP_H_
 #define ETHIP_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
+#include <adt/twheel.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 #include <loc.h>
+#include <pktring.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -56,6 +61,16 @@ typedef struct ethip_nic {
 	service_id_t svc_id;
 	char *svc_name;
 	async_sess_t *sess;
+	/** Receive ring shared with the NIC driver or @c NULL */
+	pktring_t *rx_ring;
+	/** Protects transmit queue */
+	fibril_mutex_t tx_lock;
+	/** Signalled when a transmit batch has been sent */
+	fibril_condvar_t tx_cv;
+	/** Frames waiting to be sent (of the type ethip_tx_req_t) */
+	list_t tx_queue;
+	/** A fibril is currently sending a batch */
+	bool tx_busy;
 
 	iplink_srv_t iplink;
 	service_id_t iplink_sid;
@@ -111,7 +126,10 @@ typedef struct {
 
 /** Address translation table element */
 typedef struct {
-	link_t atrans_list;
+	/** Link to address translation table */
+	ht_link_t atrans_ht;
+	/** Expiration timer */
+	twheel_timer_t expire;
 	addr32_t ip_addr;
 	eth_addr_t mac_addr;
 } ethip_atrans_t;
@@ -51,6 +51,25 @@
 #include "ethip_nic.h"
 #include "pdu.h"
 
+/** Number of slots in the receive ring shared with the NIC driver */
+#define ETHIP_RX_RING_SLOTS 256
+/** Receive ring slot size (enough for a maximum-size Ethernet frame) */
+#define ETHIP_RX_RING_SLOT_SIZE 2048
+
+/** Frame waiting in the transmit queue */
+typedef struct {
+	/** Link to ethip_nic_t.tx_queue */
+	link_t link;
+	/** Frame data */
+	void *data;
+	/** Frame size */
+	size_t size;
+	/** The frame has been passed to the NIC */
+	bool done;
+	/** Result of sending the frame */
+	errno_t rc;
+} ethip_tx_req_t;
+
 static errno_t ethip_nic_open(service_id_t sid);
 static void ethip_nic_cb_conn(ipc_call_t *icall, void *arg);
 
@@ -115,6 +134,9 @@ static ethip_nic_t *ethip_nic_new(void)
 
 	link_initialize(&nic->link);
 	list_initialize(&nic->addr_list);
+	fibril_mutex_initialize(&nic->tx_lock);
+	fibril_condvar_initialize(&nic->tx_cv);
+	list_initialize(&nic->tx_queue);
 
 	return nic;
 }
@@ -136,6 +158,9 @@ static ethip_link_addr_t *ethip_nic_addr_new(inet_addr_t *addr)
 
 static void ethip_nic_delete(ethip_nic_t *nic)
 {
+	if (nic->rx_ring != NULL)
+		pktring_destroy(nic->rx_ring);
+
 	if (nic->svc_name != NULL)
 		free(nic->svc_name);
 
@@ -147,6 +172,43 @@ static void ethip_link_addr_delete(ethip_link_addr_t *laddr)
 	free(laddr);
 }
 
+/** Set up receive ring shared with the NIC driver.
+ *
+ * If the driver does not support receive rings, frames keep being
+ * delivered using NIC_EV_RECEIVED.
+ *
+ * @param nic NIC
+ */
+static void ethip_nic_rx_ring_setup(ethip_nic_t *nic)
+{
+	pktring_t *ring;
+	errno_t rc;
+
+	rc = pktring_create(ETHIP_RX_RING_SLOTS, ETHIP_RX_RING_SLOT_SIZE,
+	    &ring);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_WARN, "Failed creating receive ring "
+		    "for '%s'.", nic->svc_name);
+		return;
+	}
+
+	/*
+	 * The driver may notify us as soon as it has the ring and it only
+	 * does so when the ring becomes non-empty. Publish the ring first
+	 * so that no notification is dropped.
+	 */
+	nic->rx_ring = ring;
+
+	rc = nic_rx_ring_set(nic->sess, ring);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "NIC '%s' does not use receive "
+		    "ring: %s.", nic->svc_name, str_error_name(rc));
+		nic->rx_ring = NULL;
+		pktring_destroy(ring);
+		return;
+	}
+}
+
 static errno_t ethip_nic_open(service_id_t sid)
 {
 	bool in_list = false;
@@ -178,6 +240,8 @@ static errno_t ethip_nic_open(service_id_t sid)
 		goto error;
 	}
 
+	ethip_nic_rx_ring_setup(nic);
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Opened NIC '%s'", nic->svc_name);
 	list_append(&nic->link, &ethip_nic_list);
 	in_list = true;
@@ -283,6 +347,62 @@ static void ethip_nic_received(ethip_nic_t *nic, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+/** Process frames waiting in the receive ring.
+ *
+ * The driver only notifies us when the ring goes from empty to non-empty,
+ * so we must drain it completely.
+ */
+static void ethip_nic_rx_ring(ethip_nic_t *nic, ipc_call_t *call)
+{
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	async_answer_0(call, EOK);
+
+	if (nic->rx_ring == NULL)
+		return;
+
+	while ((rc = pktring_peek(nic->rx_ring, &data, &size)) != ENOENT) {
+		if (rc == EOK)
+			(void) ethip_received(&nic->iplink, data, size);
+		else
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "Dropping malformed "
+			    "receive ring entry.");
+
+		pktring_consume(nic->rx_ring);
+	}
+}
+
+static void ethip_nic_received_frames(ethip_nic_t *nic, ipc_call_t *call)
+{
+	size_t count = ipc_get_arg1(call);
+	size_t *sizes;
+	uint8_t *data;
+	uint8_t *frame;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_received_frames() nic=%p "
+	    "count=%zu", nic, count);
+
+	rc = nic_frames_accept(count, (void **) &data, &sizes);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_frames_accept() failed");
+		async_answer_0(call, rc);
+		return;
+	}
+
+	frame = data;
+	for (size_t i = 0; i < count; i++) {
+		(void) ethip_received(&nic->iplink, frame, sizes[i]);
+		frame += sizes[i];
+	}
+
+	free(sizes);
+	free(data);
+	async_answer_0(call, EOK);
+}
+
 static void ethip_nic_device_state(ethip_nic_t *nic, ipc_call_t *call)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_device_state()");
@@ -311,6 +431,12 @@ static void ethip_nic_cb_conn(ipc_call_t *icall, void *arg)
 		case NIC_EV_RECEIVED:
 			ethip_nic_received(nic, &call);
 			break;
+		case NIC_EV_RX_RING:
+			ethip_nic_rx_ring(nic, &call);
+			break;
+		case NIC_EV_RECEIVED_FRAMES:
+			ethip_nic_received_frames(nic, &call);
+			break;
 		case NIC_EV_DEVICE_STATE:
 			ethip_nic_device_state(nic, &call);
 			break;
@@ -350,13 +476,119 @@ ethip_nic_t *ethip_nic_find_by_iplink_sid(service_id_t iplink_sid)
 	return NULL;
 }
 
+/** Send a batch of frames taken from the transmit queue.
+ *
+ * @param nic   NIC
+ * @param batch List of ethip_tx_req_t
+ * @param count Number of frames in @a batch
+ * @return EOK on success or an error code
+ */
+static errno_t ethip_nic_send_batch(ethip_nic_t *nic, list_t *batch,
+    size_t count)
+{
+	size_t sizes[NIC_FRAMES_MAX];
+	size_t total;
+	uint8_t *data;
+	uint8_t *dp;
+	size_t i;
+	errno_t rc;
+
+	if (count == 1) {
+		ethip_tx_req_t *req = list_get_instance(list_first(batch),
+		    ethip_tx_req_t, link);
+		return nic_send_frame(nic->sess, req->data, req->size);
+	}
+
+	total = 0;
+	i = 0;
+	list_foreach(*batch, link, ethip_tx_req_t, req) {
+		sizes[i++] = req->size;
+		total += req->size;
+	}
+
+	data = malloc(total);
+	if (data == NULL)
+		return ENOMEM;
+
+	dp = data;
+	list_foreach(*batch, link, ethip_tx_req_t, req) {
+		memcpy(dp, req->data, req->size);
+		dp += req->size;
+	}
+
+	rc = nic_send_frames(nic->sess, data, sizes, count);
+	free(data);
+	return rc;
+}
+
+/** Send frame to NIC.
+ *
+ * Frames sent concurrently by several fibrils are coalesced. The frame
+ * is queued and if no other fibril is currently talking to the NIC,
+ * the caller sends all queued frames (up to NIC_FRAMES_MAX) in a single
+ * IPC transaction. Otherwise it waits until its frame is sent by
+ * another fibril.
+ *
+ * @param nic NIC
+ * @param data Frame data
+ * @param size Frame size
+ * @return EOK on success or an error code
+ */
 errno_t ethip_nic_send(ethip_nic_t *nic, void *data, size_t size)
 {
+	ethip_tx_req_t req;
 	errno_t rc;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_send(size=%zu)", size);
-	rc = nic_send_frame(nic->sess, data, size);
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_send_frame -> %s", str_error_name(rc));
-	return rc;
+
+	link_initialize(&req.link);
+	req.data = data;
+	req.size = size;
+	req.done = false;
+
+	fibril_mutex_lock(&nic->tx_lock);
+	list_append(&req.link, &nic->tx_queue);
+
+	while (!req.done) {
+		if (nic->tx_busy) {
+			fibril_condvar_wait(&nic->tx_cv, &nic->tx_lock);
+			continue;
+		}
+
+		/* Take over sending and move queued frames to a batch */
+		list_t batch;
+		size_t count = 0;
+
+		list_initialize(&batch);
+		while (!list_empty(&nic->tx_queue) && count < NIC_FRAMES_MAX) {
+			link_t *link = list_first(&nic->tx_queue);
+			list_remove(link);
+			list_append(link, &batch);
+			count++;
+		}
+
+		nic->tx_busy = true;
+		fibril_mutex_unlock(&nic->tx_lock);
+
+		rc = ethip_nic_send_batch(nic, &batch, count);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_send_frames(%zu) -> %s",
+		    count, str_error_name(rc));
+
+		fibril_mutex_lock(&nic->tx_lock);
+		while (!list_empty(&batch)) {
+			ethip_tx_req_t *breq = list_get_instance(
+			    list_first(&batch), ethip_tx_req_t, link);
+			list_remove(&breq->link);
+			breq->rc = rc;
+			breq->done = true;
+		}
+
+		nic->tx_busy = false;
+		fibril_condvar_broadcast(&nic->tx_cv);
+	}
+
+	fibril_mutex_unlock(&nic->tx_lock);
+	return req.rc;
 }
 
 /** Setup accepted multicast addresses
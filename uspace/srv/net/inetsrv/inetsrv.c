@@ -43,6 +43,8 @@
 #include <ipc/inet.h>
 #include <ipc/services.h>
 #include <loc.h>
+#include <mem.h>
+#include <pktring.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -57,6 +59,7 @@
 #include "inetcfg.h"
 #include "inetping.h"
 #include "inet_link.h"
+#include "ntrans.h"
 #include "reass.h"
 #include "sroute.h"
 
@@ -87,8 +90,12 @@ static errno_t inet_init(void)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_init()");
 
+	errno_t rc = ntrans_init();
+	if (rc != EOK)
+		return rc;
+
 	port_id_t port;
-	errno_t rc = async_create_port(INTERFACE_INET,
+	rc = async_create_port(INTERFACE_INET,
 	    inet_default_conn, NULL, &port);
 	if (rc != EOK)
 		return rc;
@@ -363,9 +370,33 @@ static void inet_set_proto_srv(inet_client_t *client, ipc_call_t *call)
 	async_answer_0(call, EOK);
 }
 
+static void inet_rx_ring_set_srv(inet_client_t *client, ipc_call_t *call)
+{
+	pktring_t *ring;
+	pktring_t *old_ring;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_rx_ring_set_srv()");
+
+	errno_t rc = pktring_share_accept(&ring);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	fibril_mutex_lock(&client->rx_lock);
+	old_ring = client->rx_ring;
+	client->rx_ring = ring;
+	fibril_mutex_unlock(&client->rx_lock);
+
+	pktring_destroy(old_ring);
+	async_answer_0(call, EOK);
+}
+
 static void inet_client_init(inet_client_t *client)
 {
 	client->sess = NULL;
+	fibril_mutex_initialize(&client->rx_lock);
+	client->rx_ring = NULL;
 
 	fibril_mutex_lock(&client_list_lock);
 	list_append(&client->client_list, &client_list);
@@ -400,6 +431,11 @@ static void inet_default_conn(ipc_call_t *icall, void *arg)
 
 		if (!method) {
 			/* The other side has hung up */
+			fibril_mutex_lock(&client.rx_lock);
+			pktring_destroy(client.rx_ring);
+			client.rx_ring = NULL;
+			fibril_mutex_unlock(&client.rx_lock);
+
 			async_answer_0(&call, EOK);
 			return;
 		}
@@ -417,6 +453,9 @@ static void inet_default_conn(ipc_call_t *icall, void *arg)
 		case INET_SET_PROTO:
 			inet_set_proto_srv(&client, &call);
 			break;
+		case INET_RX_RING_SET:
+			inet_rx_ring_set_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -440,19 +479,81 @@ static inet_client_t *inet_client_find(uint8_t proto)
 	return NULL;
 }
 
-errno_t inet_ev_recv(inet_client_t *client, inet_dgram_t *dgram)
+/** Store datagram into the receive ring of a client.
+ *
+ * @param client Client
+ * @param dgram  Datagram
+ * @param notify Place to store @c true if the client must be notified
+ * @return EOK on success, ENOSPC if the ring is full, ELIMIT if there
+ *         is no ring or the datagram does not fit into a slot
+ */
+static errno_t inet_rx_ring_put(inet_client_t *client, inet_dgram_t *dgram,
+    bool *notify)
 {
-	async_exch_t *exch = async_exchange_begin(client->sess);
+	inet_ring_hdr_t hdr;
+	void *buf;
+	errno_t rc = ELIMIT;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.src = dgram->src;
+	hdr.dest = dgram->dest;
+	hdr.iplink = dgram->iplink;
+	hdr.tos = dgram->tos;
+
+	fibril_mutex_lock(&client->rx_lock);
+	if (client->rx_ring != NULL) {
+		rc = pktring_alloc(client->rx_ring, sizeof(hdr) + dgram->size,
+		    &buf);
+		if (rc == EOK) {
+			memcpy(buf, &hdr, sizeof(hdr));
+			memcpy((uint8_t *) buf + sizeof(hdr), dgram->data,
+			    dgram->size);
+			*notify = pktring_commit(client->rx_ring,
+			    sizeof(hdr) + dgram->size);
+		}
+	}
+	fibril_mutex_unlock(&client->rx_lock);
 
-	ipc_call_t answer;
+	return rc;
+}
 
+/** Deliver datagram to a client.
+ *
+ * If the client has set up a receive ring, the datagram is stored into it
+ * and the client is notified only if the ring was empty. If the ring is
+ * full, the datagram is dropped. Datagrams that do not fit into a ring
+ * slot and all datagrams for clients without a ring are sent via IPC.
+ */
+errno_t inet_ev_recv(inet_client_t *client, inet_dgram_t *dgram)
+{
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_ev_recv: iplink=%zu",
 	    dgram->iplink);
 
+	bool notify = false;
+	errno_t rc = inet_rx_ring_put(client, dgram, &notify);
+	if (rc == EOK) {
+		if (notify) {
+			async_exch_t *exch = async_exchange_begin(client->sess);
+			async_msg_0(exch, INET_EV_RX_RING);
+			async_exchange_end(exch);
+		}
+
+		return EOK;
+	}
+
+	if (rc == ENOSPC) {
+		/* Client is not keeping up */
+		return rc;
+	}
+
+	async_exch_t *exch = async_exchange_begin(client->sess);
+
+	ipc_call_t answer;
+
 	aid_t req = async_send_2(exch, INET_EV_RECV, dgram->tos,
 	    dgram->iplink, &answer);
 
-	errno_t rc = async_data_write_start(exch, &dgram->src, sizeof(inet_addr_t));
+	rc = async_data_write_start(exch, &dgram->src, sizeof(inet_addr_t));
 	if (rc != EOK) {
 		async_exchange_end(exch);
 		async_forget(req);
@@ -38,6 +38,8 @@
 #define INETSRV_H_
 
 #include <adt/list.h>
+#include <fibril_synch.h>
+#include <pktring.h>
 #include <stdbool.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
@@ -53,6 +55,10 @@ typedef struct {
 	async_sess_t *sess;
 	uint8_t protocol;
 	link_t client_list;
+	/** Protects rx_ring */
+	fibril_mutex_t rx_lock;
+	/** Receive ring shared by the client or @c NULL */
+	pktring_t *rx_ring;
 } inet_client_t;
 
 /** Inetping Client */
@@ -124,6 +130,8 @@ typedef struct {
 /** Static route configuration */
 typedef struct {
 	link_t sroute_list;
+	/** Link to list of routes with the same prefix in route trie */
+	link_t trie_link;
 	sysarg_t id;
 	/** Destination network */
 	inet_naddr_t dest;
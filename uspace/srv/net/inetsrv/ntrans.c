@@ -35,18 +35,74 @@
  * @brief
  */
 
-#include <adt/list.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/twheel.h>
 #include <errno.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <mem.h>
 #include <stdlib.h>
 #include "ntrans.h"
 
-/** Address translation list (of inet_ntrans_t) */
-static FIBRIL_MUTEX_INITIALIZE(ntrans_list_lock);
-static LIST_INITIALIZE(ntrans_list);
+/** Translation lifetime in seconds */
+#define NTRANS_TTL 300
+/** Expiration timer tick in microseconds */
+#define NTRANS_TICK_USEC (1000 * 1000)
+/** Number of timer wheel slots (more than NTRANS_TTL ticks) */
+#define NTRANS_WHEEL_SLOTS 512
+
+/** Address translation table (of inet_ntrans_t) */
+static FIBRIL_MUTEX_INITIALIZE(ntrans_lock);
+static hash_table_t ntrans_table;
 static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
+/** Expiration timers of translations */
+static twheel_t ntrans_wheel;
+
+static size_t ntrans_key_hash(const void *key)
+{
+	const uint8_t *ip_addr = key;
+	size_t hash = 0;
+	uint32_t word;
+
+	for (size_t i = 0; i < sizeof(addr128_t); i += sizeof(word)) {
+		memcpy(&word, ip_addr + i, sizeof(word));
+		hash = hash_combine(hash, word);
+	}
+
+	return hash_mix(hash);
+}
+
+static size_t ntrans_hash(const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    ntrans_ht);
+	return ntrans_key_hash(ntrans->ip_addr);
+}
+
+static bool ntrans_key_equal(const void *key, const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    ntrans_ht);
+	return addr128_compare(ntrans->ip_addr, key);
+}
+
+static bool ntrans_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	inet_ntrans_t *ntrans1 = hash_table_get_inst(item1, inet_ntrans_t,
+	    ntrans_ht);
+	return ntrans_key_equal(ntrans1->ip_addr, item2);
+}
+
+static hash_table_ops_t ntrans_ops = {
+	.hash = ntrans_hash,
+	.key_hash = ntrans_key_hash,
+	.key_equal = ntrans_key_equal,
+	.equal = ntrans_equal,
+	.remove_callback = NULL
+};
 
 /** Look for address in translation table
  *
@@ -57,15 +113,72 @@ static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
  */
 static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 {
-	list_foreach(ntrans_list, ntrans_list, inet_ntrans_t, ntrans) {
-		if (addr128_compare(ntrans->ip_addr, ip_addr))
-			return ntrans;
+	ht_link_t *link = hash_table_find(&ntrans_table, ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, inet_ntrans_t, ntrans_ht);
+}
+
+/** Drop expired entry from translation table
+ *
+ * Called from ntrans_timer_fibril() with ntrans_lock held.
+ */
+static void ntrans_expire(twheel_timer_t *timer, void *arg)
+{
+	inet_ntrans_t *ntrans = list_get_instance(timer, inet_ntrans_t,
+	    expire);
+
+	hash_table_remove_item(&ntrans_table, &ntrans->ntrans_ht);
+	free(ntrans);
+}
+
+static errno_t ntrans_timer_fibril(void *arg)
+{
+	while (true) {
+		fibril_usleep(NTRANS_TICK_USEC);
+
+		fibril_mutex_lock(&ntrans_lock);
+		twheel_tick(&ntrans_wheel, ntrans_expire, NULL);
+		fibril_mutex_unlock(&ntrans_lock);
 	}
 
-	return NULL;
+	return EOK;
+}
+
+/** Initialize translation table
+ *
+ * @return EOK on success or an error code
+ */
+errno_t ntrans_init(void)
+{
+	fid_t fid;
+	errno_t rc;
+
+	if (!hash_table_create(&ntrans_table, 0, 0, &ntrans_ops))
+		return ENOMEM;
+
+	rc = twheel_init(&ntrans_wheel, NTRANS_WHEEL_SLOTS);
+	if (rc != EOK) {
+		hash_table_destroy(&ntrans_table);
+		return rc;
+	}
+
+	fid = fibril_create(ntrans_timer_fibril, NULL);
+	if (fid == 0) {
+		twheel_fini(&ntrans_wheel);
+		hash_table_destroy(&ntrans_table);
+		return ENOMEM;
+	}
+
+	fibril_add_ready(fid);
+	return EOK;
 }
 
 /** Add entry to translation table
+ *
+ * An existing entry for the same address is updated and its lifetime
+ * is renewed.
  *
  * @param ip_addr  IPv6 address of the new entry
  * @param mac_addr MAC address of the new entry
@@ -77,24 +190,24 @@ static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 errno_t ntrans_add(addr128_t ip_addr, eth_addr_t *mac_addr)
 {
 	inet_ntrans_t *ntrans;
-	inet_ntrans_t *prev;
 
-	ntrans = calloc(1, sizeof(inet_ntrans_t));
-	if (ntrans == NULL)
-		return ENOMEM;
-
-	addr128(ip_addr, ntrans->ip_addr);
-	ntrans->mac_addr = *mac_addr;
+	fibril_mutex_lock(&ntrans_lock);
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL) {
+		ntrans = calloc(1, sizeof(inet_ntrans_t));
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_lock);
+			return ENOMEM;
+		}
 
-	fibril_mutex_lock(&ntrans_list_lock);
-	prev = ntrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->ntrans_list);
-		free(prev);
+		addr128(ip_addr, ntrans->ip_addr);
+		twheel_timer_initialize(&ntrans->expire);
+		hash_table_insert(&ntrans_table, &ntrans->ntrans_ht);
 	}
 
-	list_append(&ntrans->ntrans_list, &ntrans_list);
-	fibril_mutex_unlock(&ntrans_list_lock);
+	ntrans->mac_addr = *mac_addr;
+	twheel_set(&ntrans_wheel, &ntrans->expire, NTRANS_TTL);
+	fibril_mutex_unlock(&ntrans_lock);
 	fibril_condvar_broadcast(&ntrans_cv);
 
 	return EOK;
@@ -112,15 +225,16 @@ errno_t ntrans_remove(addr128_t ip_addr)
 {
 	inet_ntrans_t *ntrans;
 
-	fibril_mutex_lock(&ntrans_list_lock);
+	fibril_mutex_lock(&ntrans_lock);
 	ntrans = ntrans_find(ip_addr);
 	if (ntrans == NULL) {
-		fibril_mutex_unlock(&ntrans_list_lock);
+		fibril_mutex_unlock(&ntrans_lock);
 		return ENOENT;
 	}
 
-	list_remove(&ntrans->ntrans_list);
-	fibril_mutex_unlock(&ntrans_list_lock);
+	twheel_clear(&ntrans_wheel, &ntrans->expire);
+	hash_table_remove_item(&ntrans_table, &ntrans->ntrans_ht);
+	fibril_mutex_unlock(&ntrans_lock);
 	free(ntrans);
 
 	return EOK;
@@ -137,15 +251,15 @@ errno_t ntrans_remove(addr128_t ip_addr)
  */
 errno_t ntrans_lookup(addr128_t ip_addr, eth_addr_t *mac_addr)
 {
-	fibril_mutex_lock(&ntrans_list_lock);
+	fibril_mutex_lock(&ntrans_lock);
 	inet_ntrans_t *ntrans = ntrans_find(ip_addr);
 	if (ntrans == NULL) {
-		fibril_mutex_unlock(&ntrans_list_lock);
+		fibril_mutex_unlock(&ntrans_lock);
 		return ENOENT;
 	}
 
-	fibril_mutex_unlock(&ntrans_list_lock);
 	*mac_addr = ntrans->mac_addr;
+	fibril_mutex_unlock(&ntrans_lock);
 	return EOK;
 }
 
@@ -159,10 +273,10 @@ errno_t ntrans_lookup(addr128_t ip_addr, eth_addr_t *mac_addr)
  */
 errno_t ntrans_wait_timeout(usec_t timeout)
 {
-	fibril_mutex_lock(&ntrans_list_lock);
-	errno_t rc = fibril_condvar_wait_timeout(&ntrans_cv, &ntrans_list_lock,
+	fibril_mutex_lock(&ntrans_lock);
+	errno_t rc = fibril_condvar_wait_timeout(&ntrans_cv, &ntrans_lock,
 	    timeout);
-	fibril_mutex_unlock(&ntrans_list_lock);
+	fibril_mutex_unlock(&ntrans_lock);
 
 	return rc;
 }
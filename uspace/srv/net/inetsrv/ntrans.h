@@ -38,17 +38,23 @@
 #ifndef NTRANS_H_
 #define NTRANS_H_
 
+#include <adt/hash_table.h>
+#include <adt/twheel.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 
 /** Address translation table element */
 typedef struct {
-	link_t ntrans_list;
+	/** Link to address translation table */
+	ht_link_t ntrans_ht;
+	/** Expiration timer */
+	twheel_timer_t expire;
 	addr128_t ip_addr;
 	eth_addr_t mac_addr;
 } inet_ntrans_t;
 
+extern errno_t ntrans_init(void);
 extern errno_t ntrans_add(addr128_t, eth_addr_t *);
 extern errno_t ntrans_remove(addr128_t);
 extern errno_t ntrans_lookup(addr128_t, eth_addr_t *);
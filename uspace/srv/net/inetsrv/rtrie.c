@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup inet
+ * @{
+ */
+/**
+ * @file
+ * @brief Route prefix trie
+ *
+ * Longest prefix match lookup in a path-compressed binary trie. Each node
+ * stores a prefix and children extend that prefix by at least one bit.
+ * Nodes without items only join two subtrees. A lookup visits at most one
+ * node per distinct prefix length on the path to the address.
+ */
+
+#include <adt/list.h>
+#include <errno.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "rtrie.h"
+
+struct rtrie_node {
+	/** Children (next bit after prefix is 0 or 1) */
+	rtrie_node_t *child[2];
+	/** Prefix (bits beyond @c plen are zero) */
+	uint8_t key[RTRIE_KEY_SIZE];
+	/** Prefix length in bits */
+	uint8_t plen;
+	/** Items with this prefix */
+	list_t items;
+};
+
+/** Get bit @a n of key (bit 0 being the most significant one). */
+static unsigned rtrie_bit(const uint8_t *key, unsigned n)
+{
+	return (key[n / 8] >> (7 - n % 8)) & 1;
+}
+
+/** Get length of common prefix of two keys, at most @a max bits. */
+static unsigned rtrie_common(const uint8_t *a, const uint8_t *b,
+    unsigned max)
+{
+	unsigned i = 0;
+
+	/* Skip whole equal bytes first */
+	while (i + 8 <= max && a[i / 8] == b[i / 8])
+		i += 8;
+
+	while (i < max && rtrie_bit(a, i) == rtrie_bit(b, i))
+		i++;
+
+	return i;
+}
+
+static rtrie_node_t *rtrie_node_new(const uint8_t *key, uint8_t plen)
+{
+	rtrie_node_t *node = calloc(1, sizeof(rtrie_node_t));
+	if (node == NULL)
+		return NULL;
+
+	memcpy(node->key, key, (plen + 7) / 8);
+	if (plen % 8 != 0)
+		node->key[plen / 8] &= 0xff << (8 - plen % 8);
+
+	node->plen = plen;
+	list_initialize(&node->items);
+	return node;
+}
+
+/** Initialize trie.
+ *
+ * @param trie Trie
+ * @param key_bits Key length in bits (at most 8 * RTRIE_KEY_SIZE)
+ */
+void rtrie_init(rtrie_t *trie, uint8_t key_bits)
+{
+	trie->root = NULL;
+	trie->key_bits = key_bits;
+}
+
+/** Insert item with prefix into trie.
+ *
+ * Several items can be inserted with the same prefix.
+ *
+ * @param trie Trie
+ * @param key Prefix
+ * @param plen Prefix length in bits
+ * @param item Item link
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t rtrie_insert(rtrie_t *trie, const uint8_t *key, uint8_t plen,
+    link_t *item)
+{
+	rtrie_node_t **np = &trie->root;
+	rtrie_node_t *node;
+	rtrie_node_t *leaf;
+	rtrie_node_t *glue;
+	unsigned c;
+
+	while (*np != NULL) {
+		node = *np;
+		c = rtrie_common(key, node->key, min(plen, node->plen));
+
+		if (c < node->plen) {
+			/* Prefix diverges from (or is shorter than) the node */
+			leaf = rtrie_node_new(key, plen);
+			if (leaf == NULL)
+				return ENOMEM;
+
+			list_append(item, &leaf->items);
+
+			if (c == plen) {
+				/* New prefix is an ancestor of the node */
+				leaf->child[rtrie_bit(node->key, plen)] = node;
+				*np = leaf;
+				return EOK;
+			}
+
+			glue = rtrie_node_new(key, c);
+			if (glue == NULL) {
+				free(leaf);
+				return ENOMEM;
+			}
+
+			glue->child[rtrie_bit(key, c)] = leaf;
+			glue->child[rtrie_bit(node->key, c)] = node;
+			*np = glue;
+			return EOK;
+		}
+
+		if (plen == node->plen) {
+			list_append(item, &node->items);
+			return EOK;
+		}
+
+		np = &node->child[rtrie_bit(key, node->plen)];
+	}
+
+	leaf = rtrie_node_new(key, plen);
+	if (leaf == NULL)
+		return ENOMEM;
+
+	list_append(item, &leaf->items);
+	*np = leaf;
+	return EOK;
+}
+
+/** Remove item from trie.
+ *
+ * @param trie Trie
+ * @param key Prefix the item was inserted with
+ * @param plen Prefix length the item was inserted with
+ * @param item Item link
+ */
+void rtrie_remove(rtrie_t *trie, const uint8_t *key, uint8_t plen,
+    link_t *item)
+{
+	rtrie_node_t **pnp = NULL;
+	rtrie_node_t **np = &trie->root;
+	rtrie_node_t *node;
+	rtrie_node_t *parent;
+	rtrie_node_t *child;
+
+	/* Find the node with the prefix */
+	while (*np != NULL && (*np)->plen < plen) {
+		pnp = np;
+		np = &(*np)->child[rtrie_bit(key, (*np)->plen)];
+	}
+
+	node = *np;
+	if (node == NULL || node->plen != plen ||
+	    rtrie_common(key, node->key, plen) != plen)
+		return;
+
+	list_remove(item);
+	if (!list_empty(&node->items))
+		return;
+
+	/* Remove the node unless it still joins two subtrees */
+	if (node->child[0] != NULL && node->child[1] != NULL)
+		return;
+
+	*np = node->child[0] != NULL ? node->child[0] : node->child[1];
+	free(node);
+
+	/* The parent may now be a needless join node */
+	if (pnp == NULL)
+		return;
+
+	parent = *pnp;
+	if (!list_empty(&parent->items))
+		return;
+
+	if (parent->child[0] != NULL && parent->child[1] != NULL)
+		return;
+
+	child = parent->child[0] != NULL ? parent->child[0] : parent->child[1];
+	*pnp = child;
+	free(parent);
+}
+
+/** Find item with longest prefix matching an address.
+ *
+ * @param trie Trie
+ * @param key Address
+ * @return Link of first item with the longest matching prefix or
+ *         @c NULL if there is none
+ */
+link_t *rtrie_lookup(rtrie_t *trie, const uint8_t *key)
+{
+	rtrie_node_t *node = trie->root;
+	rtrie_node_t *best = NULL;
+
+	while (node != NULL) {
+		if (rtrie_common(key, node->key, node->plen) != node->plen)
+			break;
+
+		if (!list_empty(&node->items))
+			best = node;
+
+		if (node->plen >= trie->key_bits)
+			break;
+
+		node = node->child[rtrie_bit(key, node->plen)];
+	}
+
+	if (best == NULL)
+		return NULL;
+
+	return list_first(&best->items);
+}
+
+/** @}
+ */
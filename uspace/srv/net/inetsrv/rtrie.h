@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup inet
+ * @{
+ */
+/**
+ * @file
+ * @brief Route prefix trie
+ */
+
+#ifndef INET_RTRIE_H_
+#define INET_RTRIE_H_
+
+#include <adt/list.h>
+#include <errno.h>
+#include <stdint.h>
+
+/** Maximum key length in bytes (IPv6 address) */
+#define RTRIE_KEY_SIZE 16
+
+typedef struct rtrie_node rtrie_node_t;
+
+/** Path-compressed binary trie of address prefixes
+ *
+ * Each prefix stored in the trie has a list of items (e.g. routes)
+ * associated with it. Keys are addresses in network byte order.
+ */
+typedef struct {
+	/** Root node or @c NULL if empty */
+	rtrie_node_t *root;
+	/** Key length in bits (32 for IPv4, 128 for IPv6) */
+	uint8_t key_bits;
+} rtrie_t;
+
+extern void rtrie_init(rtrie_t *, uint8_t);
+extern errno_t rtrie_insert(rtrie_t *, const uint8_t *, uint8_t, link_t *);
+extern void rtrie_remove(rtrie_t *, const uint8_t *, uint8_t, link_t *);
+extern link_t *rtrie_lookup(rtrie_t *, const uint8_t *);
+
+#endif
+
+/** @}
+ */
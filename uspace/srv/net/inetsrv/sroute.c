@@ -39,8 +39,10 @@
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <ipc/loc.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <str.h>
+#include "rtrie.h"
 #include "sroute.h"
 #include "inetsrv.h"
 #include "inet_link.h"
@@ -49,6 +51,36 @@ static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
 static sysarg_t sroute_id = 0;
 
+/** Route tries for longest prefix match (of inet_sroute_t) */
+static rtrie_t sroute_trie4 = { .root = NULL, .key_bits = 32 };
+static rtrie_t sroute_trie6 = { .root = NULL, .key_bits = 128 };
+
+/** Get route trie and trie key for an address.
+ *
+ * @param ver IP version
+ * @param v4 IPv4 address
+ * @param v6 IPv6 address
+ * @param key Place to store the key (RTRIE_KEY_SIZE bytes)
+ * @return Route trie or @c NULL if the version is not supported
+ */
+static rtrie_t *inet_sroute_trie(ip_ver_t ver, addr32_t v4, addr128_t v6,
+    uint8_t *key)
+{
+	switch (ver) {
+	case ip_v4:
+		key[0] = v4 >> 24;
+		key[1] = (v4 >> 16) & 0xff;
+		key[2] = (v4 >> 8) & 0xff;
+		key[3] = v4 & 0xff;
+		return &sroute_trie4;
+	case ip_v6:
+		memcpy(key, v6, sizeof(addr128_t));
+		return &sroute_trie6;
+	default:
+		return NULL;
+	}
+}
+
 inet_sroute_t *inet_sroute_new(void)
 {
 	inet_sroute_t *sroute = calloc(1, sizeof(inet_sroute_t));
@@ -74,16 +106,47 @@ void inet_sroute_delete(inet_sroute_t *sroute)
 	free(sroute);
 }
 
-void inet_sroute_add(inet_sroute_t *sroute)
+errno_t inet_sroute_add(inet_sroute_t *sroute)
 {
+	uint8_t key[RTRIE_KEY_SIZE];
+	addr32_t v4 = 0;
+	addr128_t v6;
+	uint8_t bits;
+	rtrie_t *trie;
+	errno_t rc;
+
+	trie = inet_sroute_trie(inet_naddr_get(&sroute->dest, &v4, &v6, &bits),
+	    v4, v6, key);
+	if (trie == NULL)
+		return EINVAL;
+
 	fibril_mutex_lock(&sroute_list_lock);
+	rc = rtrie_insert(trie, key, bits, &sroute->trie_link);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&sroute_list_lock);
+		return rc;
+	}
+
 	list_append(&sroute->sroute_list, &sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
+
+	return EOK;
 }
 
 void inet_sroute_remove(inet_sroute_t *sroute)
 {
+	uint8_t key[RTRIE_KEY_SIZE];
+	addr32_t v4 = 0;
+	addr128_t v6;
+	uint8_t bits;
+	rtrie_t *trie;
+
+	trie = inet_sroute_trie(inet_naddr_get(&sroute->dest, &v4, &v6, &bits),
+	    v4, v6, key);
+
 	fibril_mutex_lock(&sroute_list_lock);
+	if (trie != NULL)
+		rtrie_remove(trie, key, bits, &sroute->trie_link);
 	list_remove(&sroute->sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
 }
@@ -94,37 +157,27 @@ void inet_sroute_remove(inet_sroute_t *sroute)
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
+	uint8_t key[RTRIE_KEY_SIZE];
+	addr32_t v4 = 0;
+	addr128_t v6;
+	rtrie_t *trie;
+	link_t *link;
 	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
-
-	fibril_mutex_lock(&sroute_list_lock);
-
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
-
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
 
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
-
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
+	trie = inet_sroute_trie(inet_addr_get(addr, &v4, &v6), v4, v6, key);
+	if (trie == NULL)
+		return NULL;
 
-			best = sroute;
-			best_bits = dest_bits;
-		}
-	}
+	fibril_mutex_lock(&sroute_list_lock);
 
-	if (best == NULL)
+	link = rtrie_lookup(trie, key);
+	if (link != NULL) {
+		best = list_get_instance(link, inet_sroute_t, trie_link);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found %p",
+		    best);
+	} else {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
+	}
 
 	fibril_mutex_unlock(&sroute_list_lock);
 
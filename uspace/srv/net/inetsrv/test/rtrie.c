@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/list.h>
+#include <errno.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+#include "../rtrie.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(rtrie);
+
+/** Test route */
+typedef struct {
+	link_t link;
+	int id;
+} test_route_t;
+
+/** Look up address and return ID of the matching route or -1 if none. */
+static int test_lookup(rtrie_t *trie, const uint8_t *addr)
+{
+	link_t *link = rtrie_lookup(trie, addr);
+	if (link == NULL)
+		return -1;
+
+	return list_get_instance(link, test_route_t, link)->id;
+}
+
+/** Lookup in an empty trie finds nothing */
+PCUT_TEST(empty)
+{
+	rtrie_t trie;
+	uint8_t addr[] = { 10, 0, 0, 1 };
+
+	rtrie_init(&trie, 32);
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, addr));
+}
+
+/** Inserted prefix is found and no longer found after removal */
+PCUT_TEST(insert_remove)
+{
+	rtrie_t trie;
+	test_route_t r = { .id = 1 };
+	uint8_t net[] = { 10, 0, 0, 0 };
+	uint8_t in[] = { 10, 1, 2, 3 };
+	uint8_t out[] = { 11, 0, 0, 1 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, net, 8, &r.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, test_lookup(&trie, in));
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, out));
+
+	rtrie_remove(&trie, net, 8, &r.link);
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, in));
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** The longest of several overlapping prefixes wins */
+PCUT_TEST(overlapping)
+{
+	rtrie_t trie;
+	test_route_t r8 = { .id = 8 };
+	test_route_t r16 = { .id = 16 };
+	test_route_t r24 = { .id = 24 };
+	uint8_t net8[] = { 10, 0, 0, 0 };
+	uint8_t net16[] = { 10, 1, 0, 0 };
+	uint8_t net24[] = { 10, 1, 2, 0 };
+	uint8_t a8[] = { 10, 2, 0, 1 };
+	uint8_t a16[] = { 10, 1, 3, 1 };
+	uint8_t a24[] = { 10, 1, 2, 1 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	/* Insert the most specific prefix first to create ancestors later */
+	rc = rtrie_insert(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net8, 8, &r8.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net16, 16, &r16.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(8, test_lookup(&trie, a8));
+	PCUT_ASSERT_INT_EQUALS(16, test_lookup(&trie, a16));
+	PCUT_ASSERT_INT_EQUALS(24, test_lookup(&trie, a24));
+
+	rtrie_remove(&trie, net16, 16, &r16.link);
+	rtrie_remove(&trie, net8, 8, &r8.link);
+	rtrie_remove(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** Diverging prefixes are joined by a node which is removed with them */
+PCUT_TEST(siblings)
+{
+	rtrie_t trie;
+	test_route_t ra = { .id = 1 };
+	test_route_t rb = { .id = 2 };
+	uint8_t neta[] = { 192, 168, 0, 0 };
+	uint8_t netb[] = { 192, 168, 1, 0 };
+	uint8_t aa[] = { 192, 168, 0, 7 };
+	uint8_t ab[] = { 192, 168, 1, 7 };
+	uint8_t ac[] = { 192, 168, 2, 7 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, neta, 24, &ra.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, netb, 24, &rb.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, test_lookup(&trie, aa));
+	PCUT_ASSERT_INT_EQUALS(2, test_lookup(&trie, ab));
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, ac));
+
+	rtrie_remove(&trie, neta, 24, &ra.link);
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, aa));
+	PCUT_ASSERT_INT_EQUALS(2, test_lookup(&trie, ab));
+
+	rtrie_remove(&trie, netb, 24, &rb.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** Default route (/0) matches every address */
+PCUT_TEST(default_route)
+{
+	rtrie_t trie;
+	test_route_t rdef = { .id = 0 };
+	test_route_t r24 = { .id = 24 };
+	uint8_t any[] = { 0, 0, 0, 0 };
+	uint8_t net24[] = { 10, 1, 2, 0 };
+	uint8_t a24[] = { 10, 1, 2, 1 };
+	uint8_t alow[] = { 0, 0, 0, 1 };
+	uint8_t ahigh[] = { 255, 255, 255, 255 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, any, 0, &rdef.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(0, test_lookup(&trie, alow));
+	PCUT_ASSERT_INT_EQUALS(0, test_lookup(&trie, ahigh));
+	PCUT_ASSERT_INT_EQUALS(24, test_lookup(&trie, a24));
+
+	rtrie_remove(&trie, any, 0, &rdef.link);
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, alow));
+	PCUT_ASSERT_INT_EQUALS(24, test_lookup(&trie, a24));
+
+	rtrie_remove(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** Host route (/32) matches only its own address */
+PCUT_TEST(host_route)
+{
+	rtrie_t trie;
+	test_route_t r24 = { .id = 24 };
+	test_route_t r32 = { .id = 32 };
+	uint8_t net24[] = { 10, 1, 2, 0 };
+	uint8_t host[] = { 10, 1, 2, 3 };
+	uint8_t next[] = { 10, 1, 2, 2 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, host, 32, &r32.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(32, test_lookup(&trie, host));
+	PCUT_ASSERT_INT_EQUALS(-1, test_lookup(&trie, next));
+
+	rc = rtrie_insert(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(32, test_lookup(&trie, host));
+	PCUT_ASSERT_INT_EQUALS(24, test_lookup(&trie, next));
+
+	rtrie_remove(&trie, host, 32, &r32.link);
+	rtrie_remove(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** Lookup falls back to the shorter prefix once the longer one is removed */
+PCUT_TEST(remove_more_specific)
+{
+	rtrie_t trie;
+	test_route_t r8 = { .id = 8 };
+	test_route_t r24 = { .id = 24 };
+	test_route_t r25 = { .id = 25 };
+	uint8_t net8[] = { 10, 0, 0, 0 };
+	uint8_t net24[] = { 10, 1, 2, 0 };
+	uint8_t net25[] = { 10, 1, 2, 128 };
+	uint8_t a24[] = { 10, 1, 2, 1 };
+	uint8_t a25[] = { 10, 1, 2, 129 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, net8, 8, &r8.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net25, 25, &r25.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(24, test_lookup(&trie, a24));
+	PCUT_ASSERT_INT_EQUALS(25, test_lookup(&trie, a25));
+
+	/* The /25 node takes the place of the removed /24 node */
+	rtrie_remove(&trie, net24, 24, &r24.link);
+	PCUT_ASSERT_INT_EQUALS(8, test_lookup(&trie, a24));
+	PCUT_ASSERT_INT_EQUALS(25, test_lookup(&trie, a25));
+
+	rtrie_remove(&trie, net25, 25, &r25.link);
+	PCUT_ASSERT_INT_EQUALS(8, test_lookup(&trie, a25));
+
+	rtrie_remove(&trie, net8, 8, &r8.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** Several routes with the same prefix */
+PCUT_TEST(same_prefix)
+{
+	rtrie_t trie;
+	test_route_t r1 = { .id = 1 };
+	test_route_t r2 = { .id = 2 };
+	uint8_t net[] = { 10, 0, 0, 0 };
+	uint8_t addr[] = { 10, 0, 0, 1 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, net, 8, &r1.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net, 8, &r2.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(1, test_lookup(&trie, addr));
+
+	rtrie_remove(&trie, net, 8, &r1.link);
+	PCUT_ASSERT_INT_EQUALS(2, test_lookup(&trie, addr));
+
+	rtrie_remove(&trie, net, 8, &r2.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** Removing a prefix which is not in the trie does nothing */
+PCUT_TEST(remove_missing)
+{
+	rtrie_t trie;
+	test_route_t r = { .id = 1 };
+	test_route_t other = { .id = 2 };
+	uint8_t net[] = { 10, 0, 0, 0 };
+	uint8_t net16[] = { 10, 1, 0, 0 };
+	uint8_t addr[] = { 10, 1, 0, 1 };
+	errno_t rc;
+
+	rtrie_init(&trie, 32);
+
+	rc = rtrie_insert(&trie, net, 8, &r.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	link_initialize(&other.link);
+	rtrie_remove(&trie, net16, 16, &other.link);
+	PCUT_ASSERT_INT_EQUALS(1, test_lookup(&trie, addr));
+
+	rtrie_remove(&trie, net, 8, &r.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+/** IPv6 prefixes including /0 and /128 */
+PCUT_TEST(ipv6)
+{
+	rtrie_t trie;
+	test_route_t rdef = { .id = 0 };
+	test_route_t r64 = { .id = 64 };
+	test_route_t r128 = { .id = 128 };
+	uint8_t any[16] = { 0 };
+	uint8_t net64[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 1 };
+	uint8_t host[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 1,
+		0, 0, 0, 0, 0, 0, 0, 0x42 };
+	uint8_t next[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 1,
+		0, 0, 0, 0, 0, 0, 0, 0x43 };
+	uint8_t other[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 2,
+		0, 0, 0, 0, 0, 0, 0, 0x42 };
+	errno_t rc;
+
+	rtrie_init(&trie, 128);
+
+	rc = rtrie_insert(&trie, host, 128, &r128.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, net64, 64, &r64.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, any, 0, &rdef.link);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(128, test_lookup(&trie, host));
+	PCUT_ASSERT_INT_EQUALS(64, test_lookup(&trie, next));
+	PCUT_ASSERT_INT_EQUALS(0, test_lookup(&trie, other));
+
+	rtrie_remove(&trie, host, 128, &r128.link);
+	PCUT_ASSERT_INT_EQUALS(64, test_lookup(&trie, host));
+
+	rtrie_remove(&trie, net64, 64, &r64.link);
+	PCUT_ASSERT_INT_EQUALS(0, test_lookup(&trie, host));
+
+	rtrie_remove(&trie, any, 0, &rdef.link);
+	PCUT_ASSERT_NULL(trie.root);
+}
+
+PCUT_EXPORT(rtrie);
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup tcp
+ * @{
+ */
+
+/**
+ * @file TCP congestion control
+ *
+ * Window management common to all algorithms follows RFC 5681 (slow start,
+ * loss window after a retransmission timeout) and RFC 6582 (NewReno fast
+ * recovery). If the peer supports SACK, the window is not inflated during
+ * recovery. The transmission queue then estimates the amount of data in
+ * flight from the SACK scoreboard instead (RFC 6675).
+ *
+ * Only window growth in congestion avoidance and the reaction to loss are
+ * specific to the algorithm. NewReno (RFC 5681) and CUBIC (RFC 8312) are
+ * provided.
+ */
+
+#include <io/log.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "cc.h"
+#include "seq_no.h"
+#include "tcp_type.h"
+
+/** Upper bound on the congestion window */
+#define TCP_CWND_MAX	(1024 * 1024 * 1024)
+
+/** CUBIC multiplicative decrease factor (beta_cubic = 0.7) */
+#define CUBIC_BETA_NUM	7
+#define CUBIC_BETA_DEN	10
+
+/** Limit on |t - K| in the cubic function in milliseconds (avoid overflow) */
+#define CUBIC_DT_MAX	100000
+
+static void tcp_newreno_init(tcp_conn_t *);
+static void tcp_newreno_cong_avoid(tcp_conn_t *, uint32_t);
+static uint32_t tcp_newreno_ssthresh(tcp_conn_t *);
+static void tcp_cubic_init(tcp_conn_t *);
+static void tcp_cubic_cong_avoid(tcp_conn_t *, uint32_t);
+static uint32_t tcp_cubic_ssthresh(tcp_conn_t *);
+
+tcp_cc_ops_t tcp_cc_newreno = {
+	.name = "newreno",
+	.init = tcp_newreno_init,
+	.cong_avoid = tcp_newreno_cong_avoid,
+	.ssthresh = tcp_newreno_ssthresh
+};
+
+tcp_cc_ops_t tcp_cc_cubic = {
+	.name = "cubic",
+	.init = tcp_cubic_init,
+	.cong_avoid = tcp_cubic_cong_avoid,
+	.ssthresh = tcp_cubic_ssthresh
+};
+
+/** Congestion control algorithm used for new connections */
+tcp_cc_ops_t *tcp_cc_algo = &tcp_cc_newreno;
+
+/** Amount of data sent, but not yet acknowledged (FlightSize). */
+static uint32_t tcp_cc_flight_size(tcp_conn_t *conn)
+{
+	return conn->snd_nxt - conn->snd_una;
+}
+
+/** Initialize congestion control state.
+ *
+ * Called when the connection is created and again when the maximum segment
+ * size has been negotiated.
+ *
+ * @param conn	Connection
+ */
+void tcp_cc_init(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+	uint32_t mss = conn->snd_mss;
+
+	cc->ops = tcp_cc_algo;
+
+	/* Initial window (RFC 5681, 3.1) */
+	if (mss > 2190)
+		cc->cwnd = 2 * mss;
+	else if (mss > 1095)
+		cc->cwnd = 3 * mss;
+	else
+		cc->cwnd = 4 * mss;
+
+	cc->ssthresh = UINT32_MAX;
+	cc->bytes_acked = 0;
+	cc->dupacks = 0;
+	cc->recovery = false;
+	cc->recover = conn->iss;
+
+	cc->ops->init(conn);
+}
+
+/** New data has been acknowledged.
+ *
+ * @param conn	Connection
+ * @param acked	Number of newly acknowledged sequence numbers
+ */
+void tcp_cc_ack(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+	uint32_t mss = conn->snd_mss;
+
+	cc->dupacks = 0;
+
+	if (cc->recovery) {
+		if (seq_no_acked(conn, cc->recover)) {
+			/* Full acknowledgement, leave fast recovery */
+			cc->recovery = false;
+			cc->cwnd = min(cc->ssthresh,
+			    max(tcp_cc_flight_size(conn), mss) + mss);
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: recovered, "
+			    "cwnd=%" PRIu32, conn->name, cc->cwnd);
+		} else if (!conn->sack_ok) {
+			/* Partial acknowledgement, deflate the window */
+			cc->cwnd -= min(acked, cc->cwnd);
+			if (acked >= mss)
+				cc->cwnd += mss;
+			cc->cwnd = max(cc->cwnd, mss);
+		}
+
+		return;
+	}
+
+	if (cc->cwnd < cc->ssthresh) {
+		/* Slow start */
+		cc->cwnd += min(acked, mss);
+	} else {
+		cc->ops->cong_avoid(conn, acked);
+	}
+
+	cc->cwnd = min(cc->cwnd, TCP_CWND_MAX);
+}
+
+/** Duplicate acknowledgement has been received.
+ *
+ * @param conn	Connection
+ * @return	@c true if fast recovery has just been entered and the first
+ *		unacknowledged segment should be retransmitted
+ */
+bool tcp_cc_dupack(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+	uint32_t mss = conn->snd_mss;
+
+	++cc->dupacks;
+
+	if (cc->recovery) {
+		/* Another segment has left the network, inflate the window */
+		if (!conn->sack_ok)
+			cc->cwnd = min(cc->cwnd + mss, TCP_CWND_MAX);
+		return false;
+	}
+
+	if (cc->dupacks != TCP_DUPACK_THRESH)
+		return false;
+
+	/* Do not react more than once to losses from the same window */
+	if (!seq_no_acked(conn, cc->recover))
+		return false;
+
+	cc->ssthresh = cc->ops->ssthresh(conn);
+	cc->cwnd = cc->ssthresh;
+	if (!conn->sack_ok)
+		cc->cwnd += TCP_DUPACK_THRESH * mss;
+	cc->recover = conn->snd_nxt;
+	cc->recovery = true;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: fast retransmit, cwnd=%" PRIu32
+	    ", ssthresh=%" PRIu32, conn->name, cc->cwnd, cc->ssthresh);
+	return true;
+}
+
+/** Retransmission timer has expired.
+ *
+ * @param conn	Connection
+ */
+void tcp_cc_timeout(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	/*
+	 * If a retransmission timed out again, the window is already down
+	 * to one segment and the flight size no longer reflects the
+	 * capacity of the path. Keep the threshold.
+	 */
+	if (cc->cwnd > conn->snd_mss)
+		cc->ssthresh = cc->ops->ssthresh(conn);
+
+	/* Loss window (RFC 5681, 3.1) */
+	cc->cwnd = conn->snd_mss;
+	cc->bytes_acked = 0;
+	cc->dupacks = 0;
+	cc->recovery = false;
+	cc->recover = conn->snd_nxt;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: retransmission timeout, "
+	    "ssthresh=%" PRIu32, conn->name, cc->ssthresh);
+}
+
+static void tcp_newreno_init(tcp_conn_t *conn)
+{
+}
+
+/** Grow window by one segment per window of acknowledged data. */
+static void tcp_newreno_cong_avoid(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	cc->bytes_acked += acked;
+	if (cc->bytes_acked >= cc->cwnd) {
+		cc->bytes_acked -= cc->cwnd;
+		cc->cwnd += conn->snd_mss;
+	}
+}
+
+/** Halve the flight size (RFC 5681, equation 4). */
+static uint32_t tcp_newreno_ssthresh(tcp_conn_t *conn)
+{
+	return max(tcp_cc_flight_size(conn) / 2, 2 * (uint32_t) conn->snd_mss);
+}
+
+/** Get current time for CUBIC window computation. */
+static usec_t tcp_cubic_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+/** Integer cube root. */
+static uint64_t tcp_cubic_cbrt(uint64_t a)
+{
+	uint64_t lo, hi, mid;
+
+	lo = 0;
+	hi = 1 << 21;
+
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (mid * mid * mid <= a)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return lo;
+}
+
+static void tcp_cubic_init(tcp_conn_t *conn)
+{
+	memset(&conn->cc.alg.cubic, 0, sizeof(tcp_cubic_t));
+}
+
+/** Grow window along the cubic function (RFC 8312, 4.1 - 4.3). */
+static void tcp_cubic_cong_avoid(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+	tcp_cubic_t *cubic = &cc->alg.cubic;
+	uint32_t mss = conn->snd_mss;
+	usec_t now;
+	uint64_t segs;
+	int64_t dt;
+	int64_t target;
+	uint64_t inc;
+
+	now = tcp_cubic_now();
+
+	if (cubic->epoch == 0) {
+		/* Start a new congestion avoidance epoch */
+		cubic->epoch = now;
+		cubic->w_est = cc->cwnd;
+		cc->bytes_acked = 0;
+
+		if (cc->cwnd < cubic->w_max) {
+			/* K = cbrt((W_max - cwnd) / C), C = 0.4, in ms */
+			segs = (cubic->w_max - cc->cwnd) / mss;
+			cubic->k = MSEC2USEC(tcp_cubic_cbrt(segs * 2500000000ULL));
+			cubic->origin = cubic->w_max;
+		} else {
+			cubic->k = 0;
+			cubic->origin = cc->cwnd;
+		}
+	}
+
+	/* Target is W_cubic(t + RTT) = C * (t + RTT - K)^3 + origin */
+	dt = (now - cubic->epoch + conn->retransmit.srtt - cubic->k) / 1000;
+	dt = max(min(dt, CUBIC_DT_MAX), -CUBIC_DT_MAX);
+	target = (int64_t) cubic->origin +
+	    4 * dt * dt * dt * mss / 10000000000LL;
+
+	/* Do not grow faster than 1.5 times per RTT */
+	target = min(target, (int64_t) cc->cwnd * 3 / 2);
+
+	if (target > (int64_t) cc->cwnd) {
+		cc->bytes_acked += acked;
+		inc = (uint64_t) (target - cc->cwnd) * cc->bytes_acked /
+		    cc->cwnd;
+		if (inc > 0) {
+			cc->cwnd += inc;
+			cc->bytes_acked = 0;
+		}
+	}
+
+	/*
+	 * Do not be slower than Reno would be (RFC 8312, 4.2),
+	 * alpha = 3 * (1 - beta) / (1 + beta) = 9 / 17
+	 */
+	cubic->w_est += (uint64_t) 9 * mss * acked / (17 * (uint64_t) cc->cwnd);
+	if (cubic->w_est > cc->cwnd)
+		cc->cwnd = cubic->w_est;
+}
+
+/** Remember window at loss and reduce it by beta (RFC 8312, 4.5, 4.6). */
+static uint32_t tcp_cubic_ssthresh(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+	tcp_cubic_t *cubic = &cc->alg.cubic;
+
+	cubic->epoch = 0;
+
+	if (cc->cwnd < cubic->w_last_max) {
+		/* Fast convergence, release bandwidth to new flows */
+		cubic->w_last_max = cc->cwnd;
+		cubic->w_max = (uint64_t) cc->cwnd *
+		    (CUBIC_BETA_DEN + CUBIC_BETA_NUM) / (2 * CUBIC_BETA_DEN);
+	} else {
+		cubic->w_last_max = cc->cwnd;
+		cubic->w_max = cc->cwnd;
+	}
+
+	return max((uint64_t) cc->cwnd * CUBIC_BETA_NUM / CUBIC_BETA_DEN,
+	    2 * (uint64_t) conn->snd_mss);
+}
+
+/**
+ * @}
+ */
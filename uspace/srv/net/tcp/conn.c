@@ -42,19 +42,22 @@
 #include <nettl/amap.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
 #include "iqueue.h"
+#include "ncsim.h"
 #include "pdu.h"
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
+#include "std.h"
 #include "tcp_type.h"
 #include "tqueue.h"
 #include "ucall.h"
 
-#define RCV_BUF_SIZE 4096/*2*/
-#define SND_BUF_SIZE 4096
+#define RCV_BUF_SIZE 65535
+#define SND_BUF_SIZE 65536
 
 #define MAX_SEGMENT_LIFETIME	(15*1000*1000) //(2*60*1000*1000)
 #define TIME_WAIT_TIMEOUT	(2*MAX_SEGMENT_LIFETIME)
@@ -152,6 +155,10 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	/* Set up receive window. */
 	conn->rcv_wnd = conn->rcv_buf_size;
 
+	/* Until the peer tells us otherwise, assume the default MSS */
+	conn->snd_mss = TCP_MSS_DEFAULT;
+	conn->sack_ok = false;
+
 	/* Initialize incoming segment queue */
 	tcp_iqueue_init(&conn->incoming, conn);
 
@@ -163,6 +170,9 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 
 	tqueue_inited = true;
 
+	/* Initialize congestion control */
+	tcp_cc_init(conn);
+
 	/* Connection state change signalling */
 	fibril_condvar_initialize(&conn->cstate_cv);
 
@@ -511,6 +521,29 @@ bool tcp_conn_got_syn(tcp_conn_t *conn)
 	assert(false);
 }
 
+/** Process options carried by an incoming SYN segment.
+ *
+ * Determine the send MSS and whether SACK can be used, then
+ * (re)initialize congestion control accordingly.
+ *
+ * @param conn		Connection
+ * @param seg		SYN segment
+ */
+static void tcp_conn_syn_opts(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	if (seg->mss != 0)
+		conn->snd_mss = min(seg->mss, TCP_MSS_LOCAL);
+	else
+		conn->snd_mss = TCP_MSS_DEFAULT;
+
+	conn->sack_ok = seg->sack_perm;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: SND.MSS=%u, SACK %s", conn->name,
+	    (unsigned)conn->snd_mss, conn->sack_ok ? "on" : "off");
+
+	tcp_cc_init(conn);
+}
+
 /** Segment arrived in Listen state.
  *
  * @param conn		Connection
@@ -551,6 +584,8 @@ static void tcp_conn_sa_listen(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->snd_nxt = conn->iss;
 	conn->snd_una = conn->iss;
 
+	tcp_conn_syn_opts(conn, seg);
+
 	/*
 	 * Surprisingly the spec does not deal with initial window setting.
 	 * Set SND.WND = SEG.WND and set SND.WL1 so that next segment
@@ -615,6 +650,8 @@ static void tcp_conn_sa_syn_sent(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->rcv_nxt = seg->seq + 1;
 	conn->irs = seg->seq;
 
+	tcp_conn_syn_opts(conn, seg);
+
 	if ((seg->ctrl & CTL_ACK) != 0) {
 		conn->snd_una = seg->ack;
 
@@ -673,6 +710,9 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 		return;
 	}
 
+	/* A segment beyond RCV.NXT leaves a hole in the sequence space */
+	bool out_of_order = !seq_no_segment_ready(conn, seg);
+
 	/* Queue for processing */
 	tcp_iqueue_insert_seg(&conn->incoming, seg);
 
@@ -684,6 +724,16 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 	 */
 	while (tcp_iqueue_get_ready_seg(&conn->incoming, &pseg) == EOK)
 		tcp_conn_seg_process(conn, pseg);
+
+	/*
+	 * An out-of-order segment is not processed and thus not
+	 * acknowledged yet. Acknowledge immediately so that the peer
+	 * sees duplicate ACKs (with SACK information) and can recover
+	 * quickly (RFC 5681, 4.2). Segments processed above have been
+	 * acknowledged already.
+	 */
+	if (out_of_order && conn->cstate != st_closed)
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
 }
 
 /** Process segment RST field.
@@ -811,6 +861,8 @@ static cproc_t tcp_conn_seg_proc_ack_sr(tcp_conn_t *conn, tcp_segment_t *seg)
  */
 static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 {
+	bool dup_ack = false;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_seg_proc_ack_est(%p, %p)", conn, seg);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "SEG.ACK=%u, SND.UNA=%u, SND.NXT=%u",
@@ -828,6 +880,15 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 			return cp_done;
 		} else {
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "Ignoring duplicate ACK.");
+
+			/*
+			 * Duplicate ACK as defined by RFC 5681, 2: acknowledges
+			 * SND.UNA, carries no data, does not change the window
+			 * and we have outstanding data.
+			 */
+			dup_ack = seg->ack == conn->snd_una && seg->len == 0 &&
+			    seg->wnd == conn->snd_wnd &&
+			    conn->snd_nxt != conn->snd_una;
 		}
 	} else {
 		/* Update SND.UNA */
@@ -844,6 +905,12 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 		    conn->snd_wnd, conn->snd_wl1, conn->snd_wl2);
 	}
 
+	if (conn->sack_ok && seg->sack_cnt > 0)
+		tcp_tqueue_sack_received(conn, seg);
+
+	if (dup_ack)
+		tcp_tqueue_dup_ack(conn);
+
 	/*
 	 * Prune acked segments from retransmission queue and
 	 * possibly transmit more data.
@@ -1409,11 +1476,20 @@ static void tcp_transmit_segment(inet_ep2_t *epp, tcp_segment_t *seg)
 
 	tcp_segment_dump(seg);
 
+	if (tcp_conn_lb == tcp_lb_ncsim) {
+		/* Loop back segment through network condition simulator */
+		dseg = tcp_segment_dup(seg);
+		if (dseg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_WARN, "Not enough memory. Segment dropped.");
+			return;
+		}
+
+		tcp_ncsim_bounce_seg(epp, dseg);
+		return;
+	}
+
 	if (tcp_conn_lb == tcp_lb_segment) {
 		/* Loop back segment */
-#if 0
-		tcp_ncsim_bounce_seg(sp, seg);
-#endif
 
 		/* Reverse the identification */
 		tcp_ep2_flipped(epp, &rident);
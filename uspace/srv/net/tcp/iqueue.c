@@ -39,6 +39,8 @@
 #include <adt/list.h>
 #include <errno.h>
 #include <io/log.h>
+#include <mem.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include "iqueue.h"
 #include "segment.h"
@@ -75,6 +77,7 @@ void tcp_iqueue_insert_seg(tcp_iqueue_t *iqueue, tcp_segment_t *seg)
 	}
 
 	iqe->seg = seg;
+	iqueue->recent = seg->seq;
 
 	/* Sort by sequence number */
 
@@ -186,6 +189,90 @@ errno_t tcp_iqueue_get_ready_seg(tcp_iqueue_t *iqueue, tcp_segment_t **seg)
 	return EOK;
 }
 
+/** Add SACK block to be reported.
+ *
+ * @param iqueue	Incoming queue
+ * @param blk		Block
+ * @param sack		Array of blocks, entry zero is reserved
+ * @param cnt		Number of blocks in @a sack, including entry zero
+ * @param max		Size of @a sack
+ * @return		@c true if @a blk contains the most recent segment
+ */
+static bool tcp_iqueue_sack_add(tcp_iqueue_t *iqueue, tcp_sack_block_t *blk,
+    tcp_sack_block_t *sack, unsigned *cnt, unsigned max)
+{
+	if (iqueue->recent - blk->start < blk->end - blk->start) {
+		sack[0] = *blk;
+		return true;
+	}
+
+	if (*cnt < max)
+		sack[(*cnt)++] = *blk;
+	return false;
+}
+
+/** Compute SACK blocks describing out-of-order data in incoming queue.
+ *
+ * Contiguous and overlapping segments are merged into one block. The block
+ * containing the most recently received segment is reported first
+ * (RFC 2018, section 4), the others follow in sequence order.
+ *
+ * @param iqueue	Incoming queue
+ * @param sack		Array to fill in
+ * @param max		Maximum number of blocks
+ * @return		Number of blocks
+ */
+unsigned tcp_iqueue_sack(tcp_iqueue_t *iqueue, tcp_sack_block_t *sack,
+    unsigned max)
+{
+	tcp_conn_t *conn = iqueue->conn;
+	tcp_sack_block_t blk;
+	bool have_blk;
+	bool have_recent;
+	unsigned cnt;
+	uint32_t off;
+
+	if (max == 0)
+		return 0;
+
+	have_blk = false;
+	have_recent = false;
+	cnt = 1;
+
+	list_foreach(iqueue->list, link, tcp_iqueue_entry_t, iqe) {
+		/* Only segments beyond RCV.NXT are out of order */
+		off = iqe->seg->seq - conn->rcv_nxt;
+		if (off == 0 || off >= (UINT32_C(1) << 31) || iqe->seg->len == 0)
+			continue;
+
+		if (have_blk && off <= blk.end - conn->rcv_nxt) {
+			/* Contiguous or overlapping, extend block */
+			if (off + iqe->seg->len > blk.end - conn->rcv_nxt)
+				blk.end = iqe->seg->seq + iqe->seg->len;
+			continue;
+		}
+
+		if (have_blk && tcp_iqueue_sack_add(iqueue, &blk, sack, &cnt,
+		    max))
+			have_recent = true;
+
+		blk.start = iqe->seg->seq;
+		blk.end = iqe->seg->seq + iqe->seg->len;
+		have_blk = true;
+	}
+
+	if (have_blk && tcp_iqueue_sack_add(iqueue, &blk, sack, &cnt, max))
+		have_recent = true;
+
+	if (have_recent)
+		return cnt;
+
+	/* Entry zero is unused */
+	if (cnt > 1)
+		memmove(&sack[0], &sack[1], (cnt - 1) * sizeof(tcp_sack_block_t));
+	return cnt - 1;
+}
+
 /**
  * @}
  */
@@ -43,8 +43,11 @@
 #include <errno.h>
 #include <inet/endpoint.h>
 #include <io/log.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <fibril.h>
+#include <fibril_synch.h>
+#include <time.h>
 #include "conn.h"
 #include "ncsim.h"
 #include "rqueue.h"
@@ -54,6 +57,9 @@
 static list_t sim_queue;
 static fibril_mutex_t sim_queue_lock;
 static fibril_condvar_t sim_queue_cv;
+static tcp_ncsim_cfg_t sim_cfg;
+static bool fibril_active;
+static bool fibril_stop;
 
 /** Initialize segment receive queue. */
 void tcp_ncsim_init(void)
@@ -61,61 +67,110 @@ void tcp_ncsim_init(void)
 	list_initialize(&sim_queue);
 	fibril_mutex_initialize(&sim_queue_lock);
 	fibril_condvar_initialize(&sim_queue_cv);
+	sim_cfg.loss = 0;
+	sim_cfg.delay = 0;
+	sim_cfg.jitter = 0;
+	fibril_active = false;
+	fibril_stop = false;
+}
+
+/** Finalize network condition simulator.
+ *
+ * Stop the simulator fibril and discard segments that are still in flight.
+ */
+void tcp_ncsim_fini(void)
+{
+	tcp_squeue_entry_t *sqe;
+	link_t *link;
+
+	fibril_mutex_lock(&sim_queue_lock);
+	fibril_stop = true;
+	fibril_condvar_broadcast(&sim_queue_cv);
+
+	while (fibril_active)
+		fibril_condvar_wait(&sim_queue_cv, &sim_queue_lock);
+
+	while ((link = list_first(&sim_queue)) != NULL) {
+		sqe = list_get_instance(link, tcp_squeue_entry_t, link);
+		list_remove(link);
+		tcp_segment_delete(sqe->seg);
+		free(sqe);
+	}
+
+	fibril_mutex_unlock(&sim_queue_lock);
+}
+
+/** Set simulated network conditions.
+ *
+ * @param cfg	Configuration
+ */
+void tcp_ncsim_set_cfg(tcp_ncsim_cfg_t *cfg)
+{
+	fibril_mutex_lock(&sim_queue_lock);
+	sim_cfg = *cfg;
+	fibril_mutex_unlock(&sim_queue_lock);
+}
+
+/** Get current time in microseconds. */
+static usec_t tcp_ncsim_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
 }
 
 /** Bounce segment through simulator into receive queue.
  *
  * @param epp	Endpoint pair, oriented for transmission
- * @param seg	Segment
+ * @param seg	Segment (ownership transferred to simulator)
  */
 void tcp_ncsim_bounce_seg(inet_ep2_t *epp, tcp_segment_t *seg)
 {
 	tcp_squeue_entry_t *sqe;
 	tcp_squeue_entry_t *old_qe;
-	inet_ep2_t rident;
 	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_ncsim_bounce_seg()");
-	tcp_ep2_flipped(epp, &rident);
-	tcp_rqueue_insert_seg(&rident, seg);
-	return;
 
-	if (0 /* rand() % 4 == 3 */) {
+	fibril_mutex_lock(&sim_queue_lock);
+
+	if (sim_cfg.loss > 0 && (unsigned) rand() % 1000 < sim_cfg.loss) {
 		/* Drop segment */
-		log_msg(LOG_DEFAULT, LVL_ERROR, "NCSim dropping segment");
+		fibril_mutex_unlock(&sim_queue_lock);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "NCSim dropping segment");
 		tcp_segment_delete(seg);
 		return;
 	}
 
 	sqe = calloc(1, sizeof(tcp_squeue_entry_t));
 	if (sqe == NULL) {
+		fibril_mutex_unlock(&sim_queue_lock);
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed allocating SQE.");
+		tcp_segment_delete(seg);
 		return;
 	}
 
-	sqe->delay = rand() % (1000 * 1000);
+	sqe->due = tcp_ncsim_now() + sim_cfg.delay;
+	if (sim_cfg.jitter > 0)
+		sqe->due += rand() % sim_cfg.jitter;
 	sqe->epp = *epp;
 	sqe->seg = seg;
 
-	fibril_mutex_lock(&sim_queue_lock);
-
-	link = list_first(&sim_queue);
-	while (link != NULL && sqe->delay > 0) {
+	/* Keep the queue sorted by delivery time */
+	link = list_last(&sim_queue);
+	while (link != NULL) {
 		old_qe = list_get_instance(link, tcp_squeue_entry_t, link);
-		if (sqe->delay < old_qe->delay)
+		if (old_qe->due <= sqe->due)
 			break;
 
-		sqe->delay -= old_qe->delay;
-
-		link = link->next;
-		if (link == &sim_queue.head)
-			link = NULL;
+		link = list_prev(link, &sim_queue);
 	}
 
 	if (link != NULL)
 		list_insert_after(&sqe->link, link);
 	else
-		list_append(&sqe->link, &sim_queue);
+		list_prepend(&sqe->link, &sim_queue);
 
 	fibril_condvar_broadcast(&sim_queue_cv);
 	fibril_mutex_unlock(&sim_queue_lock);
@@ -127,35 +182,50 @@ static errno_t tcp_ncsim_fibril(void *arg)
 	link_t *link;
 	tcp_squeue_entry_t *sqe;
 	inet_ep2_t rident;
-	errno_t rc;
+	usec_t now;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_ncsim_fibril()");
 
-	while (true) {
-		fibril_mutex_lock(&sim_queue_lock);
+	fibril_mutex_lock(&sim_queue_lock);
 
-		while (list_empty(&sim_queue))
+	while (true) {
+		while (list_empty(&sim_queue) && !fibril_stop)
 			fibril_condvar_wait(&sim_queue_cv, &sim_queue_lock);
 
-		do {
-			link = list_first(&sim_queue);
-			sqe = list_get_instance(link, tcp_squeue_entry_t, link);
+		if (fibril_stop)
+			break;
 
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "NCSim - Sleep");
-			rc = fibril_condvar_wait_timeout(&sim_queue_cv,
-			    &sim_queue_lock, sqe->delay);
-		} while (rc != ETIMEOUT);
+		link = list_first(&sim_queue);
+		sqe = list_get_instance(link, tcp_squeue_entry_t, link);
+
+		now = tcp_ncsim_now();
+		if (sqe->due > now) {
+			/*
+			 * Sleep until the segment is due. An earlier segment
+			 * may be queued in the meantime, so re-examine
+			 * the queue after waking up.
+			 */
+			(void) fibril_condvar_wait_timeout(&sim_queue_cv,
+			    &sim_queue_lock, sqe->due - now);
+			continue;
+		}
 
 		list_remove(link);
 		fibril_mutex_unlock(&sim_queue_lock);
 
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "NCSim - End Sleep");
 		tcp_ep2_flipped(&sqe->epp, &rident);
 		tcp_rqueue_insert_seg(&rident, sqe->seg);
 		free(sqe);
+
+		fibril_mutex_lock(&sim_queue_lock);
 	}
 
-	/* Not reached */
+	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_ncsim_fibril() exiting");
+
+	fibril_active = false;
+	fibril_condvar_broadcast(&sim_queue_cv);
+	fibril_mutex_unlock(&sim_queue_lock);
+
 	return 0;
 }
 
@@ -173,6 +243,7 @@ void tcp_ncsim_fibril_start(void)
 	}
 
 	fibril_add_ready(fid);
+	fibril_active = true;
 }
 
 /**
@@ -34,10 +34,12 @@
  * @file TCP header encoding and decoding
  */
 
+#include <adt/checksum.h>
 #include <bitops.h>
 #include <byteorder.h>
 #include <errno.h>
 #include <inet/endpoint.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 #include "pdu.h"
@@ -48,41 +50,8 @@
 
 #define TCP_CHECKSUM_INIT 0xffff
 
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t tcp_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-static uint16_t tcp_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
+/** Maximum size of TCP options */
+#define TCP_OPTS_MAX 40
 
 static void tcp_header_decode_flags(uint16_t doff_flags, tcp_control_t *rctl)
 {
@@ -125,7 +94,8 @@ static void tcp_header_encode_flags(tcp_control_t ctl, uint16_t doff_flags0,
 	*rdoff_flags = doff_flags;
 }
 
-static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *hdr)
+static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg,
+    tcp_header_t *hdr, size_t hdr_size)
 {
 	uint16_t doff_flags;
 	uint16_t doff;
@@ -135,7 +105,7 @@ static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *
 	hdr->seq = host2uint32_t_be(seg->seq);
 	hdr->ack = host2uint32_t_be(seg->ack);
 
-	doff = (sizeof(tcp_header_t) / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
+	doff = (hdr_size / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
 	tcp_header_encode_flags(seg->ctrl, doff, &doff_flags);
 
 	hdr->doff_flags = host2uint16_t_be(doff_flags);
@@ -190,18 +160,156 @@ static void tcp_header_decode(tcp_header_t *hdr, tcp_segment_t *seg)
 	seg->up = uint16_t_be2host(hdr->urg_ptr);
 }
 
+static uint32_t tcp_opt_get32(uint8_t *opt)
+{
+	return ((uint32_t)opt[0] << 24) | ((uint32_t)opt[1] << 16) |
+	    ((uint32_t)opt[2] << 8) | opt[3];
+}
+
+static void tcp_opt_set32(uint8_t *opt, uint32_t val)
+{
+	opt[0] = val >> 24;
+	opt[1] = (val >> 16) & 0xff;
+	opt[2] = (val >> 8) & 0xff;
+	opt[3] = val & 0xff;
+}
+
+/** Decode TCP options.
+ *
+ * Unknown options are skipped. Decoding stops at a malformed option.
+ *
+ * @param opt	Options
+ * @param size	Size of options in bytes
+ * @param seg	Segment to store decoded options to
+ */
+static void tcp_header_decode_opts(uint8_t *opt, size_t size,
+    tcp_segment_t *seg)
+{
+	size_t i;
+	uint8_t len;
+	unsigned n, b;
+
+	i = 0;
+	while (i < size) {
+		if (opt[i] == OPT_END_LIST)
+			break;
+
+		if (opt[i] == OPT_NOP) {
+			++i;
+			continue;
+		}
+
+		if (i + 1 >= size)
+			break;
+
+		len = opt[i + 1];
+		if (len < 2 || i + len > size)
+			break;
+
+		switch (opt[i]) {
+		case OPT_MAX_SEG_SIZE:
+			if (len != OPT_MAX_SEG_SIZE_LEN)
+				break;
+			seg->mss = ((uint16_t)opt[i + 2] << 8) | opt[i + 3];
+			break;
+		case OPT_SACK_PERMITTED:
+			if (len != OPT_SACK_PERMITTED_LEN)
+				break;
+			seg->sack_perm = true;
+			break;
+		case OPT_SACK:
+			if ((len - OPT_SACK_LEN) % OPT_SACK_BLOCK_LEN != 0)
+				break;
+			n = min((len - OPT_SACK_LEN) / OPT_SACK_BLOCK_LEN,
+			    TCP_SACK_BLOCKS);
+			for (b = 0; b < n; b++) {
+				seg->sack[b].start = tcp_opt_get32(opt + i +
+				    OPT_SACK_LEN + b * OPT_SACK_BLOCK_LEN);
+				seg->sack[b].end = tcp_opt_get32(opt + i +
+				    OPT_SACK_LEN + b * OPT_SACK_BLOCK_LEN + 4);
+			}
+			seg->sack_cnt = n;
+			break;
+		default:
+			break;
+		}
+
+		i += len;
+	}
+}
+
+/** Encode TCP options.
+ *
+ * SACK blocks that do not fit into the option space are left out.
+ *
+ * @param seg	Segment
+ * @param opt	Buffer to store options to or @c NULL to only compute size
+ * @return	Size of encoded options in bytes (multiple of four)
+ */
+static size_t tcp_header_encode_opts(tcp_segment_t *seg, uint8_t *opt)
+{
+	size_t size;
+	unsigned n, b;
+
+	size = 0;
+
+	if (seg->mss != 0) {
+		if (opt != NULL) {
+			opt[size] = OPT_MAX_SEG_SIZE;
+			opt[size + 1] = OPT_MAX_SEG_SIZE_LEN;
+			opt[size + 2] = seg->mss >> 8;
+			opt[size + 3] = seg->mss & 0xff;
+		}
+		size += OPT_MAX_SEG_SIZE_LEN;
+	}
+
+	if (seg->sack_perm) {
+		if (opt != NULL) {
+			opt[size] = OPT_NOP;
+			opt[size + 1] = OPT_NOP;
+			opt[size + 2] = OPT_SACK_PERMITTED;
+			opt[size + 3] = OPT_SACK_PERMITTED_LEN;
+		}
+		size += 2 + OPT_SACK_PERMITTED_LEN;
+	}
+
+	n = min(seg->sack_cnt, (TCP_OPTS_MAX - size - 2 - OPT_SACK_LEN) /
+	    OPT_SACK_BLOCK_LEN);
+	if (n > 0) {
+		if (opt != NULL) {
+			opt[size] = OPT_NOP;
+			opt[size + 1] = OPT_NOP;
+			opt[size + 2] = OPT_SACK;
+			opt[size + 3] = OPT_SACK_LEN + n * OPT_SACK_BLOCK_LEN;
+			for (b = 0; b < n; b++) {
+				tcp_opt_set32(opt + size + 4 +
+				    b * OPT_SACK_BLOCK_LEN, seg->sack[b].start);
+				tcp_opt_set32(opt + size + 4 +
+				    b * OPT_SACK_BLOCK_LEN + 4, seg->sack[b].end);
+			}
+		}
+		size += 2 + OPT_SACK_LEN + n * OPT_SACK_BLOCK_LEN;
+	}
+
+	return size;
+}
+
 static errno_t tcp_header_encode(inet_ep2_t *epp, tcp_segment_t *seg,
     void **header, size_t *size)
 {
 	tcp_header_t *hdr;
+	size_t hdr_size;
 
-	hdr = calloc(1, sizeof(tcp_header_t));
+	hdr_size = sizeof(tcp_header_t) + tcp_header_encode_opts(seg, NULL);
+
+	hdr = calloc(1, hdr_size);
 	if (hdr == NULL)
 		return ENOMEM;
 
-	tcp_header_setup(epp, seg, hdr);
+	tcp_header_setup(epp, seg, hdr, hdr_size);
+	(void) tcp_header_encode_opts(seg, (uint8_t *)(hdr + 1));
 	*header = hdr;
-	*size = sizeof(tcp_header_t);
+	*size = hdr_size;
 
 	return EOK;
 }
@@ -260,7 +368,13 @@ void tcp_pdu_delete(tcp_pdu_t *pdu)
 	free(pdu);
 }
 
-static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
+/** Compute PDU checksum while copying segment text into the PDU.
+ *
+ * @param pdu  PDU with header filled in and text buffer allocated
+ * @param text Segment text to copy to @a pdu->text
+ * @return Checksum
+ */
+static uint16_t tcp_pdu_checksum_copy(tcp_pdu_t *pdu, const void *text)
 {
 	uint16_t cs_phdr;
 	uint16_t cs_headers;
@@ -270,19 +384,21 @@ static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
 	ip_ver_t ver = tcp_phdr_setup(pdu, &phdr, &phdr6);
 	switch (ver) {
 	case ip_v4:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr,
+		cs_phdr = compute_inet_checksum(TCP_CHECKSUM_INIT, &phdr,
 		    sizeof(tcp_phdr_t));
 		break;
 	case ip_v6:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr6,
+		cs_phdr = compute_inet_checksum(TCP_CHECKSUM_INIT, &phdr6,
 		    sizeof(tcp_phdr6_t));
 		break;
 	default:
 		assert(false);
 	}
 
-	cs_headers = tcp_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
-	return tcp_checksum_calc(cs_headers, pdu->text, pdu->text_size);
+	cs_headers = compute_inet_checksum(cs_phdr, pdu->header,
+	    pdu->header_size);
+	return compute_inet_checksum_copy(cs_headers, pdu->text, text,
+	    pdu->text_size);
 }
 
 static void tcp_pdu_set_checksum(tcp_pdu_t *pdu, uint16_t checksum)
@@ -306,6 +422,12 @@ errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 	tcp_header_decode(pdu->header, nseg);
 	nseg->len += seq_no_control_len(nseg->ctrl);
 
+	if (pdu->header_size > sizeof(tcp_header_t)) {
+		tcp_header_decode_opts((uint8_t *)pdu->header +
+		    sizeof(tcp_header_t), pdu->header_size -
+		    sizeof(tcp_header_t), nseg);
+	}
+
 	hdr = (tcp_header_t *)pdu->header;
 
 	epp->local.port = uint16_t_be2host(hdr->dest_port);
@@ -338,7 +460,7 @@ errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
 	}
 
 	text_size = tcp_segment_text_size(seg);
-	npdu->text = calloc(1, text_size);
+	npdu->text = malloc(text_size);
 	if (npdu->text == NULL) {
 		free(npdu->header);
 		free(npdu);
@@ -346,10 +468,9 @@ errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
 	}
 
 	npdu->text_size = text_size;
-	memcpy(npdu->text, seg->data, text_size);
 
-	/* Checksum calculation */
-	checksum = tcp_pdu_checksum_calc(npdu);
+	/* Copy text and calculate checksum in one pass */
+	checksum = tcp_pdu_checksum_copy(npdu, seg->data);
 	tcp_pdu_set_checksum(npdu, checksum);
 
 	*pdu = npdu;
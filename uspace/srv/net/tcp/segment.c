@@ -74,6 +74,10 @@ tcp_segment_t *tcp_segment_dup(tcp_segment_t *seg)
 	scopy->len = seg->len;
 	scopy->wnd = seg->wnd;
 	scopy->up = seg->up;
+	scopy->mss = seg->mss;
+	scopy->sack_perm = seg->sack_perm;
+	scopy->sack_cnt = seg->sack_cnt;
+	memcpy(scopy->sack, seg->sack, sizeof(scopy->sack));
 
 	tsize = tcp_segment_text_size(seg);
 	scopy->data = calloc(tsize, 1);
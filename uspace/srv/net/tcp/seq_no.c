@@ -157,6 +157,23 @@ bool seq_no_syn_acked(tcp_conn_t *conn)
 	return seq_no_lt_le(conn->iss, conn->snd_una, conn->snd_nxt);
 }
 
+/** Determine whether all sequence numbers before @a sn are acked.
+ *
+ * Like seq_no_ack_duplicate(), this is decided based on the difference
+ * of @a sn and SND.UNA.
+ *
+ * @param conn Connection
+ * @param sn   Sequence number
+ * @return @c true if SN <= SND.UNA, @c false otherwise
+ */
+bool seq_no_acked(tcp_conn_t *conn, uint32_t sn)
+{
+	uint32_t diff;
+
+	diff = conn->snd_una - sn;
+	return (diff & (UINT32_C(1) << 31)) == 0;
+}
+
 /** Determine whether segment overlaps the receive window.
  *
  * @param conn Connection
@@ -44,6 +44,7 @@ extern bool seq_no_in_rcv_wnd(tcp_conn_t *, uint32_t);
 extern bool seq_no_new_wnd_update(tcp_conn_t *, tcp_segment_t *);
 extern bool seq_no_segment_acked(tcp_conn_t *, tcp_segment_t *, uint32_t);
 extern bool seq_no_syn_acked(tcp_conn_t *);
+extern bool seq_no_acked(tcp_conn_t *, uint32_t);
 extern bool seq_no_segment_ready(tcp_conn_t *, tcp_segment_t *);
 extern bool seq_no_segment_acceptable(tcp_conn_t *, tcp_segment_t *);
 extern void seq_no_seg_trim_calc(tcp_conn_t *, tcp_segment_t *, uint32_t *,
@@ -42,6 +42,11 @@
 
 #define IP_PROTO_TCP  6
 
+/** Maximum segment size assumed when the peer does not send one (RFC 1122) */
+#define TCP_MSS_DEFAULT  536
+/** Maximum segment size we advertise and use at most */
+#define TCP_MSS_LOCAL    1460
+
 /** TCP Header (fixed part) */
 typedef struct {
 	/** Source port */
@@ -109,7 +114,23 @@ enum opt_kind {
 	/** No-operation */
 	OPT_NOP			= 1,
 	/** Maximum segment size */
-	OPT_MAX_SEG_SIZE	= 2
+	OPT_MAX_SEG_SIZE	= 2,
+	/** SACK permitted (RFC 2018) */
+	OPT_SACK_PERMITTED	= 4,
+	/** SACK (RFC 2018) */
+	OPT_SACK		= 5
+};
+
+/** Option lengths */
+enum opt_len {
+	/** Maximum segment size */
+	OPT_MAX_SEG_SIZE_LEN	= 4,
+	/** SACK permitted */
+	OPT_SACK_PERMITTED_LEN	= 2,
+	/** SACK, without the blocks */
+	OPT_SACK_LEN		= 2,
+	/** One SACK block */
+	OPT_SACK_BLOCK_LEN	= 8
 };
 
 #endif
@@ -43,6 +43,7 @@
 #include <refcount.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 #include <inet/addr.h>
 #include <inet/endpoint.h>
 
@@ -120,10 +121,23 @@ typedef enum {
 	CTL_ACK		= 0x8
 } tcp_control_t;
 
+/** Maximum number of SACK blocks in one segment */
+#define TCP_SACK_BLOCKS 4
+
+/** SACK block */
+typedef struct {
+	/** Left edge (first sequence number of the block) */
+	uint32_t start;
+	/** Right edge (sequence number following the block) */
+	uint32_t end;
+} tcp_sack_block_t;
+
 /** Connection incoming segments queue */
 typedef struct {
 	struct tcp_conn *conn;
 	list_t list;
+	/** Sequence number of the most recently inserted segment */
+	uint32_t recent;
 } tcp_iqueue_t;
 
 /** Active or passive connection */
@@ -169,6 +183,15 @@ typedef struct {
 	/** Segment urgent pointer */
 	uint32_t up;
 
+	/** Maximum segment size option, zero if not present */
+	uint16_t mss;
+	/** SACK-permitted option present */
+	bool sack_perm;
+	/** Number of SACK blocks */
+	unsigned sack_cnt;
+	/** SACK blocks */
+	tcp_sack_block_t sack[TCP_SACK_BLOCKS];
+
 	/** Segment data, may be moved when trimming segment */
 	void *data;
 	/** Segment data, original pointer used to free data */
@@ -188,10 +211,21 @@ typedef struct {
 	void (*seg_received)(inet_ep2_t *, tcp_segment_t *);
 } tcp_rqueue_cb_t;
 
+/** NCSim configuration */
+typedef struct {
+	/** Probability of dropping a segment in per mille */
+	unsigned loss;
+	/** One-way delay */
+	usec_t delay;
+	/** Maximum random delay added to @c delay */
+	usec_t jitter;
+} tcp_ncsim_cfg_t;
+
 /** NCSim queue entry */
 typedef struct {
 	link_t link;
-	usec_t delay;
+	/** Time of delivery */
+	usec_t due;
 	inet_ep2_t epp;
 	tcp_segment_t *seg;
 } tcp_squeue_entry_t;
@@ -207,6 +241,12 @@ typedef struct {
 	link_t link;
 	tcp_conn_t *conn;
 	tcp_segment_t *seg;
+	/** Segment has been selectively acknowledged */
+	bool sacked;
+	/** Segment is presumed lost */
+	bool lost;
+	/** Segment has been retransmitted since it was marked lost */
+	bool rexmit;
 } tcp_tqueue_entry_t;
 
 /** Retransmission queue callbacks */
@@ -223,10 +263,73 @@ typedef struct {
 	/** Retransmission timer */
 	fibril_timer_t *timer;
 
+	/** Smoothed round-trip time (SRTT), zero until first measured */
+	usec_t srtt;
+	/** Round-trip time variation (RTTVAR) */
+	usec_t rttvar;
+	/** Retransmission timeout (RTO) */
+	usec_t rto;
+	/** Round-trip time measurement is in progress */
+	bool rtt_timing;
+	/** Acknowledgement number that completes the measurement */
+	uint32_t rtt_seq;
+	/** Time when the measured segment was sent */
+	usec_t rtt_start;
+
 	/** Callbacks */
 	tcp_tqueue_cb_t *cb;
 } tcp_tqueue_t;
 
+/** Congestion control algorithm */
+typedef struct {
+	/** Algorithm name */
+	const char *name;
+	/** Initialize algorithm state */
+	void (*init)(tcp_conn_t *);
+	/** Grow window in congestion avoidance when new data is acked */
+	void (*cong_avoid)(tcp_conn_t *, uint32_t);
+	/** Loss detected, return new slow start threshold */
+	uint32_t (*ssthresh)(tcp_conn_t *);
+} tcp_cc_ops_t;
+
+/** CUBIC congestion control state */
+typedef struct {
+	/** Window before the last reduction (W_max) */
+	uint32_t w_max;
+	/** W_max before the last reduction, for fast convergence */
+	uint32_t w_last_max;
+	/** Start of the current congestion avoidance epoch, zero if none */
+	usec_t epoch;
+	/** Window the cubic function approaches in the current epoch */
+	uint32_t origin;
+	/** Time to reach @c origin from the start of the epoch (K) */
+	usec_t k;
+	/** Reno-friendly window estimate (W_est) */
+	uint32_t w_est;
+} tcp_cubic_t;
+
+/** Congestion control state */
+typedef struct {
+	/** Algorithm */
+	tcp_cc_ops_t *ops;
+	/** Congestion window (cwnd) in bytes */
+	uint32_t cwnd;
+	/** Slow start threshold (ssthresh) in bytes */
+	uint32_t ssthresh;
+	/** Bytes acked in congestion avoidance not yet accounted for */
+	uint32_t bytes_acked;
+	/** Number of consecutive duplicate ACKs */
+	unsigned dupacks;
+	/** Connection is in fast recovery */
+	bool recovery;
+	/** SND.NXT when loss recovery was last started (recover) */
+	uint32_t recover;
+	/** Algorithm-specific state */
+	union {
+		tcp_cubic_t cubic;
+	} alg;
+} tcp_cc_t;
+
 /** Connection */
 struct tcp_conn {
 	char *name;
@@ -268,6 +371,13 @@ struct tcp_conn {
 	/** Retransmission queue */
 	tcp_tqueue_t retransmit;
 
+	/** Maximum segment size for sending (SMSS) */
+	uint16_t snd_mss;
+	/** Peer permitted selective acknowledgements */
+	bool sack_ok;
+	/** Congestion control */
+	tcp_cc_t cc;
+
 	/** Time-Wait timeout timer */
 	fibril_timer_t *tw_timer;
 
@@ -386,7 +496,9 @@ typedef enum {
 	/** Segment loopback */
 	tcp_lb_segment,
 	/** PDU loopback */
-	tcp_lb_pdu
+	tcp_lb_pdu,
+	/** Segment loopback through network condition simulator */
+	tcp_lb_ncsim
 } tcp_lb_t;
 
 #endif
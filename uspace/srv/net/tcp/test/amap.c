@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <inet/endpoint.h>
+#include <io/log.h>
+#include <nettl/amap.h>
+#include <pcut/pcut.h>
+#include <perf.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(amap);
+
+/** Number of associations in the lookup benchmark */
+#define AMAP_BENCH_ASSOCS 10000
+
+PCUT_TEST_BEFORE
+{
+	errno_t rc;
+
+	/* We will be calling functions that perform logging */
+	rc = log_init("test-tcp");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+/** Set up endpoint pair of a connection accepted by a server. */
+static void test_epp_init(inet_ep2_t *epp, unsigned i)
+{
+	inet_ep2_init(epp);
+	inet_addr(&epp->local.addr, 10, 0, 0, 1);
+	epp->local.port = 80;
+	inet_addr(&epp->remote.addr, 10, 1 + i / 65536, (i / 256) % 256,
+	    i % 256);
+	epp->remote.port = inet_port_dyn_lo + i % 1000;
+}
+
+/** Look up connections among many associations.
+ *
+ * Reports the average cost of a lookup as seen by tcp_conn_find_ref().
+ */
+PCUT_TEST(find_match_many)
+{
+	amap_t *map;
+	inet_ep2_t *epp;
+	inet_ep2_t aepp;
+	stopwatch_t sw;
+	void *arg;
+	unsigned i;
+	errno_t rc;
+
+	epp = calloc(AMAP_BENCH_ASSOCS, sizeof(inet_ep2_t));
+	PCUT_ASSERT_NOT_NULL(epp);
+
+	rc = amap_create(&map);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (i = 0; i < AMAP_BENCH_ASSOCS; i++) {
+		test_epp_init(&epp[i], i);
+		rc = amap_insert(map, &epp[i], &epp[i], af_allow_system, &aepp);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	}
+
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+
+	for (i = 0; i < AMAP_BENCH_ASSOCS; i++) {
+		rc = amap_find_match(map, &epp[i], &arg);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_EQUALS(&epp[i], arg);
+	}
+
+	stopwatch_stop(&sw);
+
+	printf("amap_find_match: %u associations, %lld ns per lookup\n",
+	    AMAP_BENCH_ASSOCS,
+	    (long long) stopwatch_get_nanos(&sw) / AMAP_BENCH_ASSOCS);
+
+	for (i = 0; i < AMAP_BENCH_ASSOCS; i++)
+		amap_remove(map, &epp[i]);
+
+	amap_destroy(map);
+	free(epp);
+}
+
+/** Allocate all dynamic ports of a local address. */
+PCUT_TEST(alloc_dyn_all)
+{
+	amap_t *map;
+	inet_ep2_t epp;
+	inet_ep2_t aepp;
+	unsigned i;
+	errno_t rc;
+
+	rc = amap_create(&map);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 10, 0, 0, 1);
+
+	for (i = inet_port_dyn_lo; i <= inet_port_dyn_hi; i++) {
+		rc = amap_insert(map, &epp, NULL, 0, &aepp);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(i, aepp.local.port);
+	}
+
+	/* The dynamic range is exhausted */
+	rc = amap_insert(map, &epp, NULL, 0, &aepp);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	/* A freed port is reused */
+	epp.local.port = inet_port_dyn_lo + 100;
+	amap_remove(map, &epp);
+	epp.local.port = inet_port_any;
+
+	rc = amap_insert(map, &epp, NULL, 0, &aepp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(inet_port_dyn_lo + 100, aepp.local.port);
+
+	for (i = inet_port_dyn_lo; i <= inet_port_dyn_hi; i++) {
+		epp.local.port = i;
+		amap_remove(map, &epp);
+	}
+
+	amap_destroy(map);
+}
+
+PCUT_EXPORT(amap);
@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <inet/endpoint.h>
+#include <io/log.h>
+#include <macros.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <perf.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../cc.h"
+#include "../conn.h"
+#include "../ncsim.h"
+#include "../rqueue.h"
+#include "../std.h"
+#include "../ucall.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(cc);
+
+enum {
+	/** Amount of data to transfer in throughput tests */
+	xfer_size = 256 * 1024,
+	/** Receive buffer size used in throughput tests */
+	xfer_rbuf_size = 4096
+};
+
+/** Throughput test state */
+typedef struct {
+	tcp_conn_t *conn;
+	uint8_t *data;
+	size_t size;
+	tcp_error_t send_rc;
+	bool send_done;
+	bool data_avail;
+} test_xfer_t;
+
+static void test_cstate_change(tcp_conn_t *, void *, tcp_cstate_t);
+static void test_recv_data(tcp_conn_t *, void *);
+static void test_xfer(tcp_cc_ops_t *, const char *);
+
+static tcp_rqueue_cb_t test_rqueue_cb = {
+	.seg_received = tcp_as_segment_arrived
+};
+
+static tcp_cb_t test_conn_cb = {
+	.cstate_change = test_cstate_change,
+	.recv_data = test_recv_data
+};
+
+static test_xfer_t xfer;
+
+static FIBRIL_MUTEX_INITIALIZE(test_lock);
+static FIBRIL_CONDVAR_INITIALIZE(test_cv);
+
+PCUT_TEST_BEFORE
+{
+	errno_t rc;
+
+	/* We will be calling functions that perform logging */
+	rc = log_init("test-tcp");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = tcp_conns_init();
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	tcp_rqueue_init(&test_rqueue_cb);
+	tcp_rqueue_fibril_start();
+
+	tcp_ncsim_init();
+	tcp_ncsim_fibril_start();
+
+	/* Enable internal loopback through the network condition simulator */
+	tcp_conn_lb = tcp_lb_ncsim;
+}
+
+PCUT_TEST_AFTER
+{
+	tcp_ncsim_fini();
+	tcp_rqueue_fini();
+	tcp_conns_fini();
+	tcp_cc_algo = &tcp_cc_newreno;
+}
+
+/** Create connection with a known amount of outstanding data. */
+static tcp_conn_t *test_conn_create(tcp_cc_ops_t *ops, uint32_t flight)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+
+	tcp_cc_algo = ops;
+
+	/* XXX congestion control state can only be created via tcp_conn_new */
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->iss = 1;
+	conn->snd_una = 1001;
+	conn->snd_nxt = conn->snd_una + flight;
+	tcp_cc_init(conn);
+
+	return conn;
+}
+
+static void test_conn_destroy(tcp_conn_t *conn)
+{
+	tcp_conn_lock(conn);
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+	tcp_conn_delete(conn);
+}
+
+/** Test that the initial window follows RFC 5681 and slow start grows it */
+PCUT_TEST(slow_start)
+{
+	tcp_conn_t *conn;
+	uint32_t mss;
+
+	conn = test_conn_create(&tcp_cc_newreno, 0);
+	mss = conn->snd_mss;
+
+	PCUT_ASSERT_INT_EQUALS(TCP_MSS_DEFAULT, mss);
+	PCUT_ASSERT_INT_EQUALS(4 * mss, conn->cc.cwnd);
+
+	/* One segment acknowledged, window grows by one segment */
+	tcp_cc_ack(conn, mss);
+	PCUT_ASSERT_INT_EQUALS(5 * mss, conn->cc.cwnd);
+
+	/* Growth per ACK is limited to one segment */
+	tcp_cc_ack(conn, 3 * mss);
+	PCUT_ASSERT_INT_EQUALS(6 * mss, conn->cc.cwnd);
+
+	test_conn_destroy(conn);
+}
+
+/** Test NewReno congestion avoidance */
+PCUT_TEST(newreno_cong_avoid)
+{
+	tcp_conn_t *conn;
+	uint32_t mss;
+	int i;
+
+	conn = test_conn_create(&tcp_cc_newreno, 0);
+	mss = conn->snd_mss;
+
+	conn->cc.cwnd = 4 * mss;
+	conn->cc.ssthresh = 4 * mss;
+
+	/* Three quarters of the window acknowledged - no growth yet */
+	for (i = 0; i < 3; i++)
+		tcp_cc_ack(conn, mss);
+	PCUT_ASSERT_INT_EQUALS(4 * mss, conn->cc.cwnd);
+
+	/* Full window acknowledged - grow by one segment */
+	tcp_cc_ack(conn, mss);
+	PCUT_ASSERT_INT_EQUALS(5 * mss, conn->cc.cwnd);
+
+	test_conn_destroy(conn);
+}
+
+/** Test NewReno fast retransmit and fast recovery */
+PCUT_TEST(newreno_fast_recovery)
+{
+	tcp_conn_t *conn;
+	uint32_t mss;
+	uint32_t cwnd;
+
+	conn = test_conn_create(&tcp_cc_newreno, 8 * TCP_MSS_DEFAULT);
+	mss = conn->snd_mss;
+	conn->cc.cwnd = 8 * mss;
+
+	/* Third duplicate ACK triggers fast retransmit */
+	PCUT_ASSERT_FALSE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_FALSE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_TRUE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_TRUE(conn->cc.recovery);
+	PCUT_ASSERT_INT_EQUALS(4 * mss, conn->cc.ssthresh);
+	PCUT_ASSERT_INT_EQUALS(7 * mss, conn->cc.cwnd);
+
+	/* Further duplicate ACKs inflate the window */
+	PCUT_ASSERT_FALSE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_INT_EQUALS(8 * mss, conn->cc.cwnd);
+
+	/* Partial ACK keeps us in recovery */
+	cwnd = conn->cc.cwnd;
+	conn->snd_una += mss;
+	tcp_cc_ack(conn, mss);
+	PCUT_ASSERT_TRUE(conn->cc.recovery);
+	PCUT_ASSERT_INT_EQUALS(cwnd, conn->cc.cwnd);
+
+	/* Full ACK ends recovery with a deflated window */
+	conn->snd_una = conn->snd_nxt;
+	tcp_cc_ack(conn, 7 * mss);
+	PCUT_ASSERT_FALSE(conn->cc.recovery);
+	PCUT_ASSERT_TRUE(conn->cc.cwnd <= conn->cc.ssthresh);
+
+	test_conn_destroy(conn);
+}
+
+/** Test retransmission timeout */
+PCUT_TEST(timeout)
+{
+	tcp_conn_t *conn;
+	uint32_t mss;
+
+	conn = test_conn_create(&tcp_cc_newreno, 8 * TCP_MSS_DEFAULT);
+	mss = conn->snd_mss;
+	conn->cc.cwnd = 8 * mss;
+
+	tcp_cc_timeout(conn);
+	PCUT_ASSERT_INT_EQUALS(mss, conn->cc.cwnd);
+	PCUT_ASSERT_INT_EQUALS(4 * mss, conn->cc.ssthresh);
+
+	/* Repeated timeout does not collapse the threshold */
+	tcp_cc_timeout(conn);
+	PCUT_ASSERT_INT_EQUALS(mss, conn->cc.cwnd);
+	PCUT_ASSERT_INT_EQUALS(4 * mss, conn->cc.ssthresh);
+
+	/* Losses from the same window do not trigger fast retransmit */
+	PCUT_ASSERT_FALSE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_FALSE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_FALSE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_FALSE(conn->cc.recovery);
+
+	test_conn_destroy(conn);
+}
+
+/** Test CUBIC multiplicative decrease and fast convergence */
+PCUT_TEST(cubic_decrease)
+{
+	tcp_conn_t *conn;
+	uint32_t mss;
+	uint32_t cwnd;
+
+	conn = test_conn_create(&tcp_cc_cubic, 100 * TCP_MSS_DEFAULT);
+	mss = conn->snd_mss;
+	conn->cc.cwnd = 100 * mss;
+
+	/* Window is reduced to beta_cubic = 0.7 times its size at loss */
+	(void) tcp_cc_dupack(conn);
+	(void) tcp_cc_dupack(conn);
+	PCUT_ASSERT_TRUE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_INT_EQUALS(70 * mss, conn->cc.ssthresh);
+	PCUT_ASSERT_INT_EQUALS(100 * mss, conn->cc.alg.cubic.w_max);
+
+	/* Leave recovery */
+	conn->snd_una = conn->snd_nxt;
+	tcp_cc_ack(conn, 100 * mss);
+	PCUT_ASSERT_FALSE(conn->cc.recovery);
+
+	/* Second loss at a smaller window releases bandwidth */
+	conn->snd_nxt = conn->snd_una + 70 * mss;
+	conn->cc.cwnd = 70 * mss;
+	cwnd = conn->cc.cwnd;
+	(void) tcp_cc_dupack(conn);
+	(void) tcp_cc_dupack(conn);
+	PCUT_ASSERT_TRUE(tcp_cc_dupack(conn));
+	PCUT_ASSERT_INT_EQUALS(cwnd, conn->cc.alg.cubic.w_last_max);
+	PCUT_ASSERT_INT_EQUALS((uint64_t) cwnd * 17 / 20,
+	    conn->cc.alg.cubic.w_max);
+	PCUT_ASSERT_INT_EQUALS((uint64_t) cwnd * 7 / 10, conn->cc.ssthresh);
+
+	test_conn_destroy(conn);
+}
+
+/** Test CUBIC window growth in congestion avoidance */
+PCUT_TEST(cubic_growth)
+{
+	tcp_conn_t *conn;
+	uint32_t mss;
+	uint32_t cwnd;
+	int i;
+
+	conn = test_conn_create(&tcp_cc_cubic, 0);
+	mss = conn->snd_mss;
+
+	conn->cc.cwnd = 20 * mss;
+	conn->cc.ssthresh = 20 * mss;
+	conn->cc.alg.cubic.w_max = 30 * mss;
+	conn->retransmit.srtt = MSEC2USEC(100);
+
+	/* Acknowledge one full window */
+	cwnd = conn->cc.cwnd;
+	for (i = 0; i < 20; i++)
+		tcp_cc_ack(conn, mss);
+
+	/* Window grows, but by no more than half of its size */
+	PCUT_ASSERT_TRUE(conn->cc.cwnd > cwnd);
+	PCUT_ASSERT_TRUE(conn->cc.cwnd <= cwnd * 3 / 2);
+
+	test_conn_destroy(conn);
+}
+
+/** Test bulk transfer over simulated lossy link using NewReno */
+PCUT_TEST(xfer_newreno, PCUT_TEST_SET_TIMEOUT(120))
+{
+	test_xfer(&tcp_cc_newreno, "newreno");
+}
+
+/** Test bulk transfer over simulated lossy link using CUBIC */
+PCUT_TEST(xfer_cubic, PCUT_TEST_SET_TIMEOUT(120))
+{
+	test_xfer(&tcp_cc_cubic, "cubic");
+}
+
+static void test_cstate_change(tcp_conn_t *conn, void *arg,
+    tcp_cstate_t old_state)
+{
+	fibril_mutex_lock(&test_lock);
+	fibril_condvar_broadcast(&test_cv);
+	fibril_mutex_unlock(&test_lock);
+}
+
+static void test_recv_data(tcp_conn_t *conn, void *arg)
+{
+	test_xfer_t *x = (test_xfer_t *)arg;
+
+	fibril_mutex_lock(&test_lock);
+	x->data_avail = true;
+	fibril_condvar_broadcast(&test_cv);
+	fibril_mutex_unlock(&test_lock);
+}
+
+/** Sender fibril for throughput tests */
+static errno_t test_xfer_sender(void *arg)
+{
+	test_xfer_t *x = (test_xfer_t *)arg;
+	tcp_error_t trc;
+
+	trc = tcp_uc_send(x->conn, x->data, x->size, 0);
+
+	fibril_mutex_lock(&test_lock);
+	x->send_rc = trc;
+	x->send_done = true;
+	fibril_condvar_broadcast(&test_cv);
+	fibril_mutex_unlock(&test_lock);
+
+	return 0;
+}
+
+/** Transfer data over a lossy link and report throughput.
+ *
+ * @param ops	Congestion control algorithm
+ * @param name	Name of the algorithm for reporting
+ */
+static void test_xfer(tcp_cc_ops_t *ops, const char *name)
+{
+	tcp_conn_t *cconn, *sconn;
+	inet_ep2_t cepp, sepp;
+	tcp_conn_status_t cstatus;
+	tcp_ncsim_cfg_t cfg;
+	tcp_error_t trc;
+	stopwatch_t sw;
+	uint8_t *rbuf;
+	size_t rcvd, total;
+	xflags_t xflags;
+	nsec_t nsec;
+	fid_t fid;
+	size_t i;
+
+	tcp_cc_algo = ops;
+
+	/* 1 % loss, 20 ms round-trip time */
+	cfg.loss = 10;
+	cfg.delay = MSEC2USEC(10);
+	cfg.jitter = 0;
+	tcp_ncsim_set_cfg(&cfg);
+
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.size = xfer_size;
+	xfer.data = malloc(xfer.size);
+	PCUT_ASSERT_NOT_NULL(xfer.data);
+	for (i = 0; i < xfer.size; i++)
+		xfer.data[i] = (uint8_t) (i * 7 + i / 256);
+
+	rbuf = malloc(xfer_rbuf_size);
+	PCUT_ASSERT_NOT_NULL(rbuf);
+
+	/* Client EPP */
+	inet_ep2_init(&cepp);
+	inet_addr(&cepp.local.addr, 127, 0, 0, 1);
+	inet_addr(&cepp.remote.addr, 127, 0, 0, 1);
+	cepp.remote.port = inet_port_user_lo;
+
+	/* Server EPP */
+	inet_ep2_init(&sepp);
+	inet_addr(&sepp.local.addr, 127, 0, 0, 1);
+	sepp.local.port = inet_port_user_lo;
+
+	sconn = NULL;
+	trc = tcp_uc_open(&sepp, ap_passive, tcp_open_nonblock, &sconn);
+	PCUT_ASSERT_INT_EQUALS(TCP_EOK, trc);
+	PCUT_ASSERT_NOT_NULL(sconn);
+	tcp_uc_set_cb(sconn, &test_conn_cb, &xfer);
+
+	cconn = NULL;
+	trc = tcp_uc_open(&cepp, ap_active, 0, &cconn);
+	PCUT_ASSERT_INT_EQUALS(TCP_EOK, trc);
+	PCUT_ASSERT_NOT_NULL(cconn);
+
+	/* Wait for server side */
+	fibril_mutex_lock(&test_lock);
+	tcp_uc_status(sconn, &cstatus);
+	while (cstatus.cstate != st_established) {
+		fibril_condvar_wait(&test_cv, &test_lock);
+		tcp_uc_status(sconn, &cstatus);
+	}
+	fibril_mutex_unlock(&test_lock);
+
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+
+	xfer.conn = cconn;
+	fid = fibril_create(test_xfer_sender, &xfer);
+	PCUT_ASSERT_TRUE(fid != 0);
+	fibril_add_ready(fid);
+
+	total = 0;
+	while (total < xfer.size) {
+		trc = tcp_uc_receive(sconn, rbuf, xfer_rbuf_size, &rcvd,
+		    &xflags);
+		if (trc == TCP_EAGAIN) {
+			fibril_mutex_lock(&test_lock);
+			while (!xfer.data_avail)
+				fibril_condvar_wait(&test_cv, &test_lock);
+			xfer.data_avail = false;
+			fibril_mutex_unlock(&test_lock);
+			continue;
+		}
+
+		PCUT_ASSERT_INT_EQUALS(TCP_EOK, trc);
+		PCUT_ASSERT_TRUE(total + rcvd <= xfer.size);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(rbuf, xfer.data + total,
+		    rcvd));
+		total += rcvd;
+	}
+
+	stopwatch_stop(&sw);
+
+	fibril_mutex_lock(&test_lock);
+	while (!xfer.send_done)
+		fibril_condvar_wait(&test_cv, &test_lock);
+	fibril_mutex_unlock(&test_lock);
+
+	PCUT_ASSERT_INT_EQUALS(TCP_EOK, xfer.send_rc);
+
+	nsec = stopwatch_get_nanos(&sw);
+	printf("tcp %s: %zu bytes in %lld ms, %lld KiB/s\n", name, total,
+	    (long long) NSEC2MSEC(nsec),
+	    (long long) (total * 1000000000LL / 1024 / max(nsec, 1)));
+
+	tcp_uc_abort(cconn);
+	tcp_uc_delete(cconn);
+	tcp_uc_abort(sconn);
+	tcp_uc_delete(sconn);
+
+	free(rbuf);
+	free(xfer.data);
+}
+
+PCUT_EXPORT(cc);
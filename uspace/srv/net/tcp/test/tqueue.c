@@ -32,6 +32,7 @@
 
 #include "../conn.h"
 #include "../segment.h"
+#include "../std.h"
 #include "../tqueue.h"
 
 PCUT_INIT;
@@ -203,6 +204,54 @@ PCUT_TEST(new_data_small_win)
 	tcp_segment_delete(trans_seg[0]);
 }
 
+/** Test that data is split into segments of at most SND.MSS bytes */
+PCUT_TEST(new_data_segmented)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+	int i;
+
+	/* XXX tqueue can only be created via tcp_conn_new */
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->cstate = st_established;
+	conn->snd_una = 10;
+	conn->snd_nxt = 10;
+	conn->snd_wnd = 4096;
+	conn->snd_buf_used = 2000;
+	conn->snd_buf_fin = false;
+	for (i = 0; i < 2000; i++)
+		conn->snd_buf[i] = (uint8_t) i;
+
+	/* Redirect segment transmission */
+	conn->retransmit.cb = &tqueue_test_cb;
+	seg_cnt = 0;
+
+	tcp_conn_lock(conn);
+	tcp_tqueue_new_data(conn);
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+
+	PCUT_ASSERT_EQUALS(2010, conn->snd_nxt);
+	PCUT_ASSERT_EQUALS(0, conn->snd_buf_used);
+
+	tcp_conn_delete(conn);
+	PCUT_ASSERT_EQUALS(4, seg_cnt);
+	PCUT_ASSERT_EQUALS(10, trans_seg[0]->seq);
+	PCUT_ASSERT_EQUALS(TCP_MSS_DEFAULT, trans_seg[0]->len);
+	PCUT_ASSERT_EQUALS(10 + TCP_MSS_DEFAULT, trans_seg[1]->seq);
+	PCUT_ASSERT_EQUALS(TCP_MSS_DEFAULT, trans_seg[1]->len);
+	PCUT_ASSERT_EQUALS(10 + 2 * TCP_MSS_DEFAULT, trans_seg[2]->seq);
+	PCUT_ASSERT_EQUALS(TCP_MSS_DEFAULT, trans_seg[2]->len);
+	PCUT_ASSERT_EQUALS(10 + 3 * TCP_MSS_DEFAULT, trans_seg[3]->seq);
+	PCUT_ASSERT_EQUALS(2000 - 3 * TCP_MSS_DEFAULT, trans_seg[3]->len);
+
+	for (i = 0; i < seg_cnt; i++)
+		tcp_segment_delete(trans_seg[i]);
+}
+
 /** Test flushing tqueue due to receiving an ACK */
 PCUT_TEST(ack_received)
 {
@@ -42,9 +42,12 @@
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
+#include "iqueue.h"
 #include "ncsim.h"
 #include "rqueue.h"
 #include "segment.h"
@@ -52,7 +55,14 @@
 #include "tqueue.h"
 #include "tcp_type.h"
 
-#define RETRANSMIT_TIMEOUT	(2*1000*1000)
+/** Initial retransmission timeout (RFC 6298, 2.1) */
+#define RTO_INITIAL	(1000 * 1000)
+/** Minimum retransmission timeout (RFC 6298, 2.4) */
+#define RTO_MIN		(1000 * 1000)
+/** Maximum retransmission timeout (RFC 6298, 2.5) */
+#define RTO_MAX		(60 * 1000 * 1000)
+/** Clock granularity (G) */
+#define RTT_CLOCK_G	1000
 
 static void retransmit_timeout_func(void *);
 static void tcp_tqueue_timer_set(tcp_conn_t *);
@@ -61,6 +71,16 @@ static void tcp_tqueue_seg(tcp_conn_t *, tcp_segment_t *);
 static void tcp_conn_transmit_segment(tcp_conn_t *, tcp_segment_t *);
 static void tcp_prepare_transmit_segment(tcp_conn_t *, tcp_segment_t *);
 static void tcp_tqueue_send_immed(tcp_conn_t *, tcp_segment_t *);
+static void tcp_tqueue_rexmit_lost(tcp_conn_t *);
+
+/** Get current time for round-trip time measurement. */
+static usec_t tcp_tqueue_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
 
 errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
     tcp_tqueue_cb_t *cb)
@@ -73,6 +93,11 @@ errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
 
 	list_initialize(&tqueue->list);
 
+	tqueue->srtt = 0;
+	tqueue->rttvar = 0;
+	tqueue->rto = RTO_INITIAL;
+	tqueue->rtt_timing = false;
+
 	return EOK;
 }
 
@@ -110,6 +135,17 @@ void tcp_tqueue_ctrl_seg(tcp_conn_t *conn, tcp_control_t ctrl)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_tqueue_ctrl_seg(%p, %u)", conn, ctrl);
 
 	seg = tcp_segment_make_ctrl(ctrl);
+	if (seg == NULL) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
+		return;
+	}
+
+	if ((ctrl & CTL_SYN) != 0) {
+		/* Only offer SACK in SYN-ACK if the peer offered it */
+		seg->mss = TCP_MSS_LOCAL;
+		seg->sack_perm = (ctrl & CTL_ACK) == 0 || conn->sack_ok;
+	}
+
 	tcp_tqueue_seg(conn, seg);
 	tcp_segment_delete(seg);
 }
@@ -149,8 +185,16 @@ static void tcp_tqueue_seg(tcp_conn_t *conn, tcp_segment_t *seg)
 
 		list_append(&tqe->link, &conn->retransmit.list);
 
-		/* Set retransmission timer */
-		tcp_tqueue_timer_set(conn);
+		/* Time this segment unless another one is being timed */
+		if (!conn->retransmit.rtt_timing) {
+			conn->retransmit.rtt_timing = true;
+			conn->retransmit.rtt_seq = rt_seg->seq + rt_seg->len;
+			conn->retransmit.rtt_start = tcp_tqueue_now();
+		}
+
+		/* Set retransmission timer unless it is running (RFC 6298, 5.1) */
+		if (conn->retransmit.timer->state != fts_active)
+			tcp_tqueue_timer_set(conn);
 	}
 
 	tcp_prepare_transmit_segment(conn, seg);
@@ -172,16 +216,45 @@ static void tcp_prepare_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 	tcp_conn_transmit_segment(conn, seg);
 }
 
+/** Compute amount of data in flight (pipe).
+ *
+ * Segments that were selectively acknowledged or that are presumed lost
+ * and were not retransmitted yet have left the network (RFC 6675).
+ *
+ * @param conn	Connection
+ * @return	Number of sequence numbers in flight
+ */
+static uint32_t tcp_tqueue_pipe(tcp_conn_t *conn)
+{
+	uint32_t pipe = 0;
+
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		if (tqe->sacked)
+			continue;
+		if (tqe->lost && !tqe->rexmit)
+			continue;
+		pipe += tqe->seg->len;
+	}
+
+	return pipe;
+}
+
 /** Transmit data from the send buffer.
+ *
+ * Segments presumed lost are retransmitted first. Then new data is sent
+ * in segments of at most SMSS bytes, as long as both the send window and
+ * the congestion window allow it.
  *
  * @param conn	Connection
  */
 void tcp_tqueue_new_data(tcp_conn_t *conn)
 {
+	uint32_t wnd_used;
 	size_t avail_wnd;
-	size_t xfer_seqlen;
-	size_t snd_buf_seqlen;
+	size_t buf_left;
 	size_t data_size;
+	size_t offs;
+	uint32_t pipe;
 	tcp_control_t ctrl;
 	bool send_fin;
 
@@ -189,52 +262,197 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_new_data()", conn->name);
 
-	/* Number of free sequence numbers in send window */
-	avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
-	snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
+	tcp_tqueue_rexmit_lost(conn);
 
-	xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, SND.WND = %" PRIu32 ", "
-	    "xfer_seqlen = %zu", conn->name, snd_buf_seqlen, conn->snd_wnd,
-	    xfer_seqlen);
+	pipe = tcp_tqueue_pipe(conn);
+	offs = 0;
 
-	if (xfer_seqlen == 0)
-		return;
+	while (pipe < conn->cc.cwnd) {
+		/* Number of free sequence numbers in send window */
+		wnd_used = conn->snd_nxt - conn->snd_una;
+		avail_wnd = wnd_used < conn->snd_wnd ?
+		    conn->snd_wnd - wnd_used : 0;
+		buf_left = conn->snd_buf_used - offs;
 
-	/* XXX Do not always send immediately */
+		data_size = min(min(buf_left, avail_wnd), conn->snd_mss);
+		send_fin = conn->snd_buf_fin && data_size == buf_left &&
+		    avail_wnd > data_size;
 
-	send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen;
-	data_size = xfer_seqlen - (send_fin ? 1 : 0);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: buf_left = %zu, SND.WND = %"
+		    PRIu32 ", cwnd = %" PRIu32 ", pipe = %" PRIu32 ", "
+		    "data_size = %zu", conn->name, buf_left, conn->snd_wnd,
+		    conn->cc.cwnd, pipe, data_size);
 
-	if (send_fin) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.", conn->name);
-		/* We are sending out FIN */
-		ctrl = CTL_FIN;
-	} else {
-		ctrl = 0;
+		if (data_size == 0 && !send_fin)
+			break;
+
+		/* XXX Do not always send immediately */
+
+		if (send_fin) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.", conn->name);
+			/* We are sending out FIN */
+			ctrl = CTL_FIN;
+		} else {
+			ctrl = 0;
+		}
+
+		seg = tcp_segment_make_data(ctrl, conn->snd_buf + offs,
+		    data_size);
+		if (seg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+			break;
+		}
+
+		offs += data_size;
+
+		if (send_fin) {
+			conn->snd_buf_fin = false;
+			tcp_conn_fin_sent(conn);
+		}
+
+		pipe += seg->len;
+		tcp_tqueue_seg(conn, seg);
+		tcp_segment_delete(seg);
 	}
 
-	seg = tcp_segment_make_data(ctrl, conn->snd_buf, data_size);
-	if (seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+	if (offs == 0)
 		return;
-	}
 
 	/* Remove data from send buffer */
-	memmove(conn->snd_buf, conn->snd_buf + data_size,
-	    conn->snd_buf_used - data_size);
-	conn->snd_buf_used -= data_size;
-
-	if (send_fin)
-		conn->snd_buf_fin = false;
+	memmove(conn->snd_buf, conn->snd_buf + offs,
+	    conn->snd_buf_used - offs);
+	conn->snd_buf_used -= offs;
 
 	fibril_condvar_broadcast(&conn->snd_buf_cv);
+}
 
-	if (send_fin)
-		tcp_conn_fin_sent(conn);
+/** Retransmit segment from the retransmission queue.
+ *
+ * @param conn	Connection
+ * @param tqe	Retransmission queue entry
+ */
+static void tcp_tqueue_rexmit(tcp_conn_t *conn, tcp_tqueue_entry_t *tqe)
+{
+	tcp_segment_t *rt_seg;
 
-	tcp_tqueue_seg(conn, seg);
-	tcp_segment_delete(seg);
+	rt_seg = tcp_segment_dup(tqe->seg);
+	if (rt_seg == NULL) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
+		/* XXX Handle properly */
+		return;
+	}
+
+	/* Queued copy was made before tcp_prepare_transmit_segment() */
+	if (tcp_conn_got_syn(conn) && (rt_seg->ctrl & CTL_RST) == 0)
+		rt_seg->ctrl |= CTL_ACK;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment, "
+	    "SEG.SEQ=%" PRIu32, conn->name, rt_seg->seq);
+
+	tqe->rexmit = true;
+
+	/* Karn's algorithm: do not time across a retransmission */
+	conn->retransmit.rtt_timing = false;
+
+	tcp_conn_transmit_segment(conn, rt_seg);
+	tcp_segment_delete(rt_seg);
+}
+
+/** Retransmit segments presumed lost as far as congestion window allows.
+ *
+ * @param conn	Connection
+ */
+static void tcp_tqueue_rexmit_lost(tcp_conn_t *conn)
+{
+	uint32_t pipe;
+
+	pipe = tcp_tqueue_pipe(conn);
+
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		if (pipe >= conn->cc.cwnd)
+			break;
+
+		if (!tqe->lost || tqe->rexmit || tqe->sacked)
+			continue;
+
+		tcp_tqueue_rexmit(conn, tqe);
+		pipe += tqe->seg->len;
+	}
+}
+
+/** Retransmit the first unacknowledged segment now.
+ *
+ * Used for fast retransmit and on partial acknowledgements during fast
+ * recovery. The retransmission is not limited by the congestion window.
+ *
+ * @param conn	Connection
+ */
+static void tcp_tqueue_rexmit_first(tcp_conn_t *conn)
+{
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		if (tqe->sacked)
+			continue;
+
+		tqe->lost = true;
+		if (!tqe->rexmit)
+			tcp_tqueue_rexmit(conn, tqe);
+		break;
+	}
+}
+
+/** Mark segments lost based on the SACK scoreboard.
+ *
+ * A segment is presumed lost if at least TCP_DUPACK_THRESH segments
+ * worth of data above it has been selectively acknowledged (RFC 6675).
+ *
+ * @param conn	Connection
+ */
+static void tcp_tqueue_sack_mark_lost(tcp_conn_t *conn)
+{
+	uint32_t sacked = 0;
+
+	list_foreach_rev(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		if (tqe->sacked) {
+			sacked += tqe->seg->len;
+			continue;
+		}
+
+		if (sacked >= TCP_DUPACK_THRESH * (uint32_t) conn->snd_mss &&
+		    !tqe->lost) {
+			tqe->lost = true;
+			tqe->rexmit = false;
+		}
+	}
+}
+
+/** Update round-trip time estimate with a new measurement.
+ *
+ * @param tqueue	Retransmission queue
+ * @param rtt		Measured round-trip time
+ */
+static void tcp_tqueue_rtt_sample(tcp_tqueue_t *tqueue, usec_t rtt)
+{
+	usec_t delta;
+
+	rtt = max(rtt, 1);
+
+	if (tqueue->srtt == 0) {
+		/* First measurement (RFC 6298, 2.2) */
+		tqueue->srtt = rtt;
+		tqueue->rttvar = rtt / 2;
+	} else {
+		/* Subsequent measurement (RFC 6298, 2.3) */
+		delta = tqueue->srtt > rtt ? tqueue->srtt - rtt :
+		    rtt - tqueue->srtt;
+		tqueue->rttvar = (3 * tqueue->rttvar + delta) / 4;
+		tqueue->srtt = (7 * tqueue->srtt + rtt) / 8;
+	}
+
+	tqueue->rto = tqueue->srtt + max(RTT_CLOCK_G, 4 * tqueue->rttvar);
+	tqueue->rto = min(max(tqueue->rto, RTO_MIN), RTO_MAX);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG2, "RTT=%lld SRTT=%lld RTTVAR=%lld "
+	    "RTO=%lld", rtt, tqueue->srtt, tqueue->rttvar, tqueue->rto);
 }
 
 /** Remove ACKed segments from retransmission queue and possibly transmit
@@ -245,10 +463,12 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 void tcp_tqueue_ack_received(tcp_conn_t *conn)
 {
 	link_t *cur, *next;
+	uint32_t acked;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_ack_received(%p)", conn->name,
 	    conn);
 
+	acked = 0;
 	cur = conn->retransmit.list.head.next;
 
 	while (cur != &conn->retransmit.list.head) {
@@ -270,16 +490,32 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 				conn->fin_is_acked = true;
 			}
 
+			acked += tqe->seg->len;
 			tcp_segment_delete(tqe->seg);
 			free(tqe);
-
-			/* Reset retransmission timer */
-			tcp_tqueue_timer_set(conn);
 		}
 
 		cur = next;
 	}
 
+	if (acked > 0) {
+		if (conn->retransmit.rtt_timing &&
+		    seq_no_acked(conn, conn->retransmit.rtt_seq)) {
+			conn->retransmit.rtt_timing = false;
+			tcp_tqueue_rtt_sample(&conn->retransmit,
+			    tcp_tqueue_now() - conn->retransmit.rtt_start);
+		}
+
+		tcp_cc_ack(conn, acked);
+
+		/* Partial acknowledgement, the next hole is lost as well */
+		if (conn->cc.recovery)
+			tcp_tqueue_rexmit_first(conn);
+
+		/* Reset retransmission timer */
+		tcp_tqueue_timer_set(conn);
+	}
+
 	/* Clear retransmission timer if the queue is empty. */
 	if (list_empty(&conn->retransmit.list))
 		tcp_tqueue_timer_clear(conn);
@@ -288,6 +524,63 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 	tcp_tqueue_new_data(conn);
 }
 
+/** Process duplicate acknowledgement.
+ *
+ * Should be called before tcp_tqueue_ack_received(), which transmits
+ * whatever the congestion window allows.
+ *
+ * @param conn	Connection
+ */
+void tcp_tqueue_dup_ack(tcp_conn_t *conn)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_dup_ack()", conn->name);
+
+	if (tcp_cc_dupack(conn))
+		tcp_tqueue_rexmit_first(conn);
+
+	if (conn->cc.recovery && conn->sack_ok)
+		tcp_tqueue_sack_mark_lost(conn);
+}
+
+/** Process SACK blocks of an incoming segment.
+ *
+ * Mark segments covered by the SACK blocks as selectively acknowledged.
+ * Blocks outside of SND.UNA..SND.NXT are ignored.
+ *
+ * @param conn	Connection
+ * @param seg	Incoming segment
+ */
+void tcp_tqueue_sack_received(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	uint32_t start, end, nxt;
+	uint32_t sstart, send;
+	unsigned i;
+
+	/* Work with offsets relative to SND.UNA */
+	nxt = conn->snd_nxt - conn->snd_una;
+
+	for (i = 0; i < seg->sack_cnt; i++) {
+		start = seg->sack[i].start - conn->snd_una;
+		end = seg->sack[i].end - conn->snd_una;
+
+		if (start >= end || end > nxt)
+			continue;
+
+		list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t,
+		    tqe) {
+			sstart = tqe->seg->seq - conn->snd_una;
+			send = sstart + tqe->seg->len;
+			/* Already acknowledged, not yet removed from queue */
+			if (sstart >= nxt)
+				continue;
+			if (sstart >= end)
+				break;
+			if (sstart >= start && send <= end)
+				tqe->sacked = true;
+		}
+	}
+}
+
 static void tcp_conn_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_conn_transmit_segment(%p, %p)",
@@ -295,10 +588,16 @@ static void tcp_conn_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 
 	seg->wnd = conn->rcv_wnd;
 
-	if ((seg->ctrl & CTL_ACK) != 0)
+	if ((seg->ctrl & CTL_ACK) != 0) {
 		seg->ack = conn->rcv_nxt;
-	else
+		/* Tell the peer about out-of-order data we hold */
+		if (conn->sack_ok) {
+			seg->sack_cnt = tcp_iqueue_sack(&conn->incoming,
+			    seg->sack, TCP_SACK_BLOCKS);
+		}
+	} else {
 		seg->ack = 0;
+	}
 
 	tcp_tqueue_send_immed(conn, seg);
 }
@@ -320,9 +619,6 @@ void tcp_tqueue_send_immed(tcp_conn_t *conn, tcp_segment_t *seg)
 static void retransmit_timeout_func(void *arg)
 {
 	tcp_conn_t *conn = (tcp_conn_t *) arg;
-	tcp_tqueue_entry_t *tqe;
-	tcp_segment_t *rt_seg;
-	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmit_timeout_func(%p)", conn->name, conn);
 
@@ -335,30 +631,32 @@ static void retransmit_timeout_func(void *arg)
 		return;
 	}
 
-	link = list_first(&conn->retransmit.list);
-	if (link == NULL) {
+	if (list_empty(&conn->retransmit.list)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "Nothing to retransmit");
 		tcp_conn_unlock(conn);
 		tcp_conn_delref(conn);
 		return;
 	}
 
-	tqe = list_get_instance(link, tcp_tqueue_entry_t, link);
+	tcp_cc_timeout(conn);
 
-	rt_seg = tcp_segment_dup(tqe->seg);
-	if (rt_seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
-		tcp_conn_unlock(conn);
-		tcp_conn_delref(conn);
-		/* XXX Handle properly */
-		return;
+	/*
+	 * All outstanding segments are presumed lost. SACK information must
+	 * not be relied upon after a timeout (RFC 2018, section 8).
+	 */
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		tqe->sacked = false;
+		tqe->lost = true;
+		tqe->rexmit = false;
 	}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment", conn->name);
-	tcp_conn_transmit_segment(tqe->conn, rt_seg);
+	/* Back off the timer (RFC 6298, 5.5) */
+	conn->retransmit.rto = min(conn->retransmit.rto * 2, RTO_MAX);
+
+	tcp_tqueue_rexmit_lost(conn);
 
 	/* Reset retransmission timer */
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	fibril_timer_set_locked(conn->retransmit.timer, conn->retransmit.rto,
 	    retransmit_timeout_func, (void *) conn);
 
 	tcp_conn_unlock(conn);
@@ -377,7 +675,7 @@ static void tcp_tqueue_timer_set(tcp_conn_t *conn)
 	tcp_tqueue_timer_clear(conn);
 
 	tcp_conn_addref(conn);
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	fibril_timer_set_locked(conn->retransmit.timer, conn->retransmit.rto,
 	    retransmit_timeout_func, (void *) conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_set() end", conn->name);
@@ -34,6 +34,7 @@
  * @file UDP PDU encoding and decoding
  */
 
+#include <adt/checksum.h>
 #include <bitops.h>
 #include <byteorder.h>
 #include <errno.h>
@@ -47,42 +48,6 @@
 
 #define UDP_CHECKSUM_INIT 0xffff
 
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t udp_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-static uint16_t udp_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = udp_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = udp_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
-
 static ip_ver_t udp_phdr_setup(udp_pdu_t *pdu, udp_phdr_t *phdr,
     udp_phdr6_t *phdr6)
 {
@@ -129,27 +94,38 @@ void udp_pdu_delete(udp_pdu_t *pdu)
 	free(pdu);
 }
 
-static uint16_t udp_pdu_checksum_calc(udp_pdu_t *pdu)
+/** Compute PDU checksum while copying message data into the PDU.
+ *
+ * @param pdu  PDU with header filled in and data buffer allocated
+ * @param data Message data to copy after the UDP header
+ * @return Checksum
+ */
+static uint16_t udp_pdu_checksum_copy(udp_pdu_t *pdu, const void *data)
 {
 	uint16_t cs_phdr;
+	uint16_t cs_header;
 	udp_phdr_t phdr;
 	udp_phdr6_t phdr6;
 
 	ip_ver_t ver = udp_phdr_setup(pdu, &phdr, &phdr6);
 	switch (ver) {
 	case ip_v4:
-		cs_phdr = udp_checksum_calc(UDP_CHECKSUM_INIT, (void *) &phdr,
+		cs_phdr = compute_inet_checksum(UDP_CHECKSUM_INIT, &phdr,
 		    sizeof(udp_phdr_t));
 		break;
 	case ip_v6:
-		cs_phdr = udp_checksum_calc(UDP_CHECKSUM_INIT, (void *) &phdr6,
+		cs_phdr = compute_inet_checksum(UDP_CHECKSUM_INIT, &phdr6,
 		    sizeof(udp_phdr6_t));
 		break;
 	default:
 		assert(false);
 	}
 
-	return udp_checksum_calc(cs_phdr, pdu->data, pdu->data_size);
+	cs_header = compute_inet_checksum(cs_phdr, pdu->data,
+	    sizeof(udp_header_t));
+	return compute_inet_checksum_copy(cs_header,
+	    (uint8_t *)pdu->data + sizeof(udp_header_t), data,
+	    pdu->data_size - sizeof(udp_header_t));
 }
 
 static void udp_pdu_set_checksum(udp_pdu_t *pdu, uint16_t checksum)
@@ -223,7 +199,7 @@ errno_t udp_pdu_encode(inet_ep2_t *epp, udp_msg_t *msg, udp_pdu_t **pdu)
 	npdu->dest = epp->remote.addr;
 
 	npdu->data_size = sizeof(udp_header_t) + msg->data_size;
-	npdu->data = calloc(1, npdu->data_size);
+	npdu->data = malloc(npdu->data_size);
 	if (npdu->data == NULL) {
 		udp_pdu_delete(npdu);
 		return ENOMEM;
@@ -235,11 +211,8 @@ errno_t udp_pdu_encode(inet_ep2_t *epp, udp_msg_t *msg, udp_pdu_t **pdu)
 	hdr->length = host2uint16_t_be(npdu->data_size);
 	hdr->checksum = 0;
 
-	memcpy((uint8_t *)npdu->data + sizeof(udp_header_t), msg->data,
-	    msg->data_size);
-
-	/* Checksum calculation */
-	checksum = udp_pdu_checksum_calc(npdu);
+	/* Copy data and calculate checksum in one pass */
+	checksum = udp_pdu_checksum_copy(npdu, msg->data);
 	udp_pdu_set_checksum(npdu, checksum);
 
 	*pdu = npdu;
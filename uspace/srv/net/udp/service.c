@@ -34,6 +34,7 @@
  * @file HelenOS service implementation
  */
 
+#include <abi/ipc/methods.h>
 #include <async.h>
 #include <errno.h>
 #include <inet/endpoint.h>
@@ -42,6 +43,7 @@
 #include <ipc/udp.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 
 #include "assoc.h"
@@ -414,6 +416,80 @@ static void udp_assoc_send_msg_srv(udp_client_t *client, ipc_call_t *icall)
 	free(data);
 }
 
+/** Send message via association, with the message passed along.
+ *
+ * Handle client request to send message carried in an IPC_M_DATA_XFER
+ * call. The request data consists of the destination endpoint followed
+ * by the message data.
+ *
+ * @param client UDP client
+ * @param icall  Async request data
+ * @param size   Size of request data
+ *
+ */
+static void udp_assoc_send_msg_xfer_srv(udp_client_t *client,
+    ipc_call_t *icall, size_t size)
+{
+	inet_ep_t dest;
+	sysarg_t assoc_id;
+	void *buf;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "udp_assoc_send_msg_xfer_srv()");
+
+	if (size < sizeof(inet_ep_t)) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	buf = malloc(size);
+	if (buf == NULL) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	rc = async_xfer_fetch(icall, buf, size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		free(buf);
+		return;
+	}
+
+	memcpy(&dest, buf, sizeof(inet_ep_t));
+	assoc_id = ipc_get_arg4(icall);
+
+	rc = udp_assoc_send_msg_impl(client, assoc_id, &dest,
+	    (uint8_t *) buf + sizeof(inet_ep_t), size - sizeof(inet_ep_t));
+	async_answer_0(icall, rc);
+	free(buf);
+}
+
+/** Handle request carrying its data.
+ *
+ * @param client UDP client
+ * @param icall  Async request data
+ *
+ */
+static void udp_xfer_srv(udp_client_t *client, ipc_call_t *icall)
+{
+	sysarg_t method;
+	size_t size;
+
+	if (!async_xfer_receive(icall, &method, &size, NULL)) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	switch (method) {
+	case UDP_ASSOC_SEND_MSG:
+		udp_assoc_send_msg_xfer_srv(client, icall, size);
+		break;
+	default:
+		async_answer_0(icall, ENOTSUP);
+		break;
+	}
+}
+
 /** Get next received message.
  *
  * @param client UDP Client
@@ -617,6 +693,9 @@ static void udp_client_conn(ipc_call_t *icall, void *arg)
 		case UDP_RMSG_DISCARD:
 			udp_rmsg_discard_srv(&client, &call);
 			break;
+		case IPC_M_DATA_XFER:
+			udp_xfer_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -37,22 +37,31 @@
  * backed by the ELF backend.
  */
 
+#include <abi/ipc/interfaces.h>
+#include <abi/ipc/methods.h>
 #include <as.h>
 #include <async.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <str_error.h>
 #include <io/log.h>
 #include <ipc/ipc_test.h>
 #include <ipc/services.h>
 #include <loc.h>
 #include <mem.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <task.h>
 
 #define NAME  "ipc-test"
 
 static service_id_t svc_id;
 
+/** Session to this service used for forwarding requests. */
+static async_sess_t *fwd_sess;
+static FIBRIL_MUTEX_INITIALIZE(fwd_sess_lock);
+
 /** Object in read-only memory area that will be shared.
  *
  * If the server is run as an initial task, the area should be backed
@@ -181,8 +190,110 @@ static void ipc_test_share_in_rw_srv(ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+static void ipc_test_xfer_reply_srv(ipc_call_t *icall, size_t size)
+{
+	size_t reply_size;
+	uint8_t *data;
+	uint8_t *reply;
+	errno_t rc;
+
+	reply_size = ipc_get_arg4(icall);
+	if (size == 0 || reply_size > DATA_XFER_LIMIT) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	data = malloc(size);
+	reply = malloc(reply_size);
+	if (data == NULL || reply == NULL) {
+		free(data);
+		free(reply);
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	rc = async_xfer_fetch(icall, data, size);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "async_xfer_fetch failed");
+		free(data);
+		free(reply);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	for (size_t i = 0; i < reply_size; i++)
+		reply[i] = data[i % size];
+
+	/* The kernel refuses the reply if it does not fit the sender. */
+	rc = async_xfer_finalize(icall, reply, reply_size, 0, 0);
+	if (rc != EOK)
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "async_xfer_finalize: %s",
+		    str_error(rc));
+
+	free(data);
+	free(reply);
+}
+
+static void ipc_test_xfer_forward_srv(ipc_call_t *icall)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	fibril_mutex_lock(&fwd_sess_lock);
+	if (fwd_sess == NULL)
+		fwd_sess = loc_service_connect(svc_id, INTERFACE_IPC_TEST, 0);
+	fibril_mutex_unlock(&fwd_sess_lock);
+
+	if (fwd_sess == NULL) {
+		async_answer_0(icall, EIO);
+		log_msg(LOG_DEFAULT, LVL_ERROR, "loc_service_connect failed");
+		return;
+	}
+
+	/* The call is immutable, the method is ignored. */
+	exch = async_exchange_begin(fwd_sess);
+	rc = async_forward_0(icall, exch, 0, IPC_FF_NONE);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		log_msg(LOG_DEFAULT, LVL_ERROR, "async_forward_0 failed");
+}
+
+static void ipc_test_xfer_srv(ipc_call_t *icall, bool forwarded)
+{
+	sysarg_t method;
+	size_t size;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ipc_test_xfer_srv");
+	if (!async_xfer_receive(icall, &method, &size, NULL)) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	switch (method) {
+	case IPC_TEST_XFER:
+		ipc_test_xfer_reply_srv(icall, size);
+		break;
+	case IPC_TEST_XFER_FORWARD:
+		if (forwarded)
+			ipc_test_xfer_reply_srv(icall, size);
+		else
+			ipc_test_xfer_forward_srv(icall);
+		break;
+	default:
+		async_answer_0(icall, ENOTSUP);
+		break;
+	}
+}
+
 static void ipc_test_connection(ipc_call_t *icall, void *arg)
 {
+	/*
+	 * Requests forwarded by this service arrive over a connection
+	 * made by this service.
+	 */
+	bool forwarded = icall->task_id == task_get_id();
+
 	/* Accept connection */
 	async_accept_0(icall);
 
@@ -211,6 +322,9 @@ static void ipc_test_connection(ipc_call_t *icall, void *arg)
 		case IPC_TEST_SHARE_IN_RW:
 			ipc_test_share_in_rw_srv(&call);
 			break;
+		case IPC_M_DATA_XFER:
+			ipc_test_xfer_srv(&call, forwarded);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -66,10 +66,21 @@ static void vfs_pager(ipc_call_t *icall, void *arg)
 			break;
 		}
 
+		errno_t rc;
+		int id = -1;
+
 		switch (ipc_get_imethod(&call)) {
 		case IPC_M_PAGE_IN:
 			vfs_page_in(&call);
 			break;
+		case VFS_PAGER_MAP:
+			rc = vfs_file_map(ipc_get_arg1(&call), &id);
+			async_answer_1(&call, rc, id);
+			break;
+		case VFS_PAGER_UNMAP:
+			rc = vfs_file_unmap(ipc_get_arg1(&call));
+			async_answer_0(&call, rc);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -99,6 +110,14 @@ int main(int argc, char **argv)
 		return ENOMEM;
 	}
 
+	/*
+	 * Initialize the pager's page cache.
+	 */
+	if (!vfs_pager_init()) {
+		printf("%s: Failed to initialize page cache\n", NAME);
+		return ENOMEM;
+	}
+
 	/*
 	 * Allocate and initialize the Path Lookup Buffer.
 	 */
@@ -41,6 +41,7 @@
 #include <stdint.h>
 #include <loc.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <ipc/vfs.h>
 #include <task.h>
 #include <vfs/vfs.h>
@@ -53,6 +54,9 @@
 /** Maximum number of open files per client. */
 #define VFS_MAX_OPEN_FILES  128
 
+/** Maximum number of files a client can map through the pager. */
+#define VFS_MAX_MAPPED_FILES  64
+
 /**
  * A structure like this will be allocated for each registered file system.
  */
@@ -123,6 +127,21 @@ typedef struct _vfs_node {
 	 */
 	fibril_rwlock_t contents_rwlock;
 
+	/**
+	 * Pages of the node's contents cached by the pager (of the type
+	 * vfs_page_t). Protected by the page cache mutex.
+	 */
+	list_t pages;
+	/** Incremented whenever the cached pages are invalidated. */
+	unsigned pages_gen;
+
+	/**
+	 * Number of clients which map the node through the pager. The
+	 * contents cannot be modified while the node is mapped. Protected
+	 * by contents_rwlock.
+	 */
+	unsigned mapped;
+
 	struct _vfs_node *mount;
 } vfs_node_t;
 
@@ -131,13 +150,16 @@ typedef struct _vfs_node {
  * than one task, there will be a separate structure allocated for each task.
  */
 typedef struct {
-	/** Serializes access to this open file. */
-	fibril_mutex_t _lock;
+	/**
+	 * Held exclusively by operations which modify the open file and
+	 * for sharing by operations which only use it, e.g. reads and writes.
+	 */
+	fibril_rwlock_t _lock;
 
 	vfs_node_t *node;
 
 	/** Number of file handles referencing this file. */
-	unsigned refcnt;
+	atomic_uint refcnt;
 
 	int permissions;
 	bool open_read;
@@ -199,6 +221,11 @@ extern errno_t vfs_wait_handle_internal(bool, int *);
 
 extern vfs_file_t *vfs_file_get(int);
 extern void vfs_file_put(vfs_file_t *);
+extern vfs_file_t *vfs_file_get_shared(int);
+extern void vfs_file_put_shared(vfs_file_t *);
+extern errno_t vfs_file_map(int, int *);
+extern errno_t vfs_file_unmap(int);
+extern vfs_file_t *vfs_file_get_mapped(int);
 extern errno_t vfs_fd_assign(vfs_file_t *, int);
 extern errno_t vfs_fd_alloc(vfs_file_t **file, bool desc, int *);
 extern errno_t vfs_fd_free(int);
@@ -227,14 +254,17 @@ extern errno_t vfs_op_write(int fd, aoff64_t, size_t *out_bytes);
 
 extern void vfs_register(ipc_call_t *);
 
+extern bool vfs_pager_init(void);
 extern void vfs_page_in(ipc_call_t *);
+extern void vfs_page_cache_evict(vfs_node_t *);
 
 typedef struct {
 	void *buffer;
 	size_t size;
 } rdwr_io_chunk_t;
 
-extern errno_t vfs_rdwr_internal(int, aoff64_t, bool, rdwr_io_chunk_t *);
+extern errno_t vfs_rdwr_internal(vfs_file_t *, aoff64_t, bool,
+    rdwr_io_chunk_t *);
 
 extern void vfs_connection(ipc_call_t *, void *);
 
@@ -50,11 +50,27 @@
 #define VFS_DATA	((vfs_client_data_t *) async_get_client_data())
 #define FILES		(VFS_DATA->files)
 
+/** File mapped by a client through the pager */
 typedef struct {
+	vfs_file_t *file;
+	/** Number of times the client has mapped the file. */
+	unsigned refcnt;
+} vfs_mapped_file_t;
+
+typedef struct {
+	/** Protects the list of passed handles. */
 	fibril_mutex_t lock;
 	fibril_condvar_t cv;
 	list_t passed_handles;
+	/**
+	 * Protects the table of open files. Looking up a file descriptor
+	 * only needs the lock for reading, so that the fibrils of a client
+	 * can access distinct open files in parallel.
+	 */
+	fibril_rwlock_t files_lock;
 	vfs_file_t **files;
+	/** Files mapped through the pager. Protected by files_lock. */
+	vfs_mapped_file_t *mapped;
 } vfs_client_data_t;
 
 typedef struct {
@@ -64,21 +80,17 @@ typedef struct {
 } vfs_boxed_handle_t;
 
 static errno_t _vfs_fd_free(vfs_client_data_t *, int);
+static errno_t vfs_file_delref(vfs_file_t *);
 
-/** Initialize the table of open files. */
-static bool vfs_files_init(vfs_client_data_t *vfs_data)
+/** Stop keeping a file mapped through the pager. */
+static void vfs_file_unmapped(vfs_file_t *file)
 {
-	fibril_mutex_lock(&vfs_data->lock);
-	if (!vfs_data->files) {
-		vfs_data->files = malloc(VFS_MAX_OPEN_FILES * sizeof(vfs_file_t *));
-		if (!vfs_data->files) {
-			fibril_mutex_unlock(&vfs_data->lock);
-			return false;
-		}
-		memset(vfs_data->files, 0, VFS_MAX_OPEN_FILES * sizeof(vfs_file_t *));
-	}
-	fibril_mutex_unlock(&vfs_data->lock);
-	return true;
+	fibril_rwlock_write_lock(&file->node->contents_rwlock);
+	assert(file->node->mapped > 0);
+	file->node->mapped--;
+	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
+
+	(void) vfs_file_delref(file);
 }
 
 /** Cleanup the table of open files. */
@@ -86,9 +98,6 @@ static void vfs_files_done(vfs_client_data_t *vfs_data)
 {
 	int i;
 
-	if (!vfs_data->files)
-		return;
-
 	for (i = 0; i < VFS_MAX_OPEN_FILES; i++) {
 		if (vfs_data->files[i])
 			(void) _vfs_fd_free(vfs_data, i);
@@ -96,6 +105,17 @@ static void vfs_files_done(vfs_client_data_t *vfs_data)
 
 	free(vfs_data->files);
 
+	/*
+	 * The kernel does not tell us when a mapping goes away, so the
+	 * files stay mapped until the client terminates.
+	 */
+	for (i = 0; i < VFS_MAX_MAPPED_FILES; i++) {
+		if (vfs_data->mapped[i].file != NULL)
+			vfs_file_unmapped(vfs_data->mapped[i].file);
+	}
+
+	free(vfs_data->mapped);
+
 	while (!list_empty(&vfs_data->passed_handles)) {
 		link_t *lnk;
 		vfs_boxed_handle_t *bh;
@@ -113,13 +133,32 @@ void *vfs_client_data_create(void)
 	vfs_client_data_t *vfs_data;
 
 	vfs_data = malloc(sizeof(vfs_client_data_t));
-	if (vfs_data) {
-		fibril_mutex_initialize(&vfs_data->lock);
-		fibril_condvar_initialize(&vfs_data->cv);
-		list_initialize(&vfs_data->passed_handles);
-		vfs_data->files = NULL;
+	if (!vfs_data)
+		return NULL;
+
+	/*
+	 * The table of open files is allocated up front so that looking up
+	 * a file descriptor never needs to take the table lock exclusively.
+	 */
+	vfs_data->files = calloc(VFS_MAX_OPEN_FILES, sizeof(vfs_file_t *));
+	if (!vfs_data->files) {
+		free(vfs_data);
+		return NULL;
+	}
+
+	vfs_data->mapped = calloc(VFS_MAX_MAPPED_FILES,
+	    sizeof(vfs_mapped_file_t));
+	if (!vfs_data->mapped) {
+		free(vfs_data->files);
+		free(vfs_data);
+		return NULL;
 	}
 
+	fibril_mutex_initialize(&vfs_data->lock);
+	fibril_condvar_initialize(&vfs_data->cv);
+	list_initialize(&vfs_data->passed_handles);
+	fibril_rwlock_initialize(&vfs_data->files_lock);
+
 	return vfs_data;
 }
 
@@ -134,7 +173,7 @@ void vfs_client_data_destroy(void *data)
 /** Close the file in the endpoint FS server. */
 static errno_t vfs_file_close_remote(vfs_file_t *file)
 {
-	assert(!file->refcnt);
+	assert(!atomic_load(&file->refcnt));
 
 	async_exch_t *exch = vfs_exchange_grab(file->node->fs_handle);
 
@@ -151,15 +190,16 @@ static errno_t vfs_file_close_remote(vfs_file_t *file)
 }
 
 /** Increment reference count of VFS file structure.
+ *
+ * The caller must already hold a reference to the file or hold the lock
+ * of a table of open files which references the file.
  *
  * @param file		File structure that will have reference count
  *			incremented.
  */
-static void vfs_file_addref(vfs_client_data_t *vfs_data, vfs_file_t *file)
+static void vfs_file_addref(vfs_file_t *file)
 {
-	assert(fibril_mutex_is_locked(&vfs_data->lock));
-
-	file->refcnt++;
+	atomic_fetch_add(&file->refcnt, 1);
 }
 
 /** Decrement reference count of VFS file structure.
@@ -167,13 +207,11 @@ static void vfs_file_addref(vfs_client_data_t *vfs_data, vfs_file_t *file)
  * @param file		File structure that will have reference count
  *			decremented.
  */
-static errno_t vfs_file_delref(vfs_client_data_t *vfs_data, vfs_file_t *file)
+static errno_t vfs_file_delref(vfs_file_t *file)
 {
 	errno_t rc = EOK;
 
-	assert(fibril_mutex_is_locked(&vfs_data->lock));
-
-	if (file->refcnt-- == 1) {
+	if (atomic_fetch_sub(&file->refcnt, 1) == 1) {
 		/*
 		 * Lost the last reference to a file, need to close it in the
 		 * endpoint FS and drop our reference to the underlying VFS node.
@@ -193,34 +231,31 @@ static errno_t vfs_file_delref(vfs_client_data_t *vfs_data, vfs_file_t *file)
 
 static errno_t _vfs_fd_alloc(vfs_client_data_t *vfs_data, vfs_file_t **file, bool desc, int *out_fd)
 {
-	if (!vfs_files_init(vfs_data))
-		return ENOMEM;
-
 	unsigned int i;
 	if (desc)
 		i = VFS_MAX_OPEN_FILES - 1;
 	else
 		i = 0;
 
-	fibril_mutex_lock(&vfs_data->lock);
+	fibril_rwlock_write_lock(&vfs_data->files_lock);
 	while (true) {
 		if (!vfs_data->files[i]) {
 			vfs_data->files[i] = (vfs_file_t *) malloc(sizeof(vfs_file_t));
 			if (!vfs_data->files[i]) {
-				fibril_mutex_unlock(&vfs_data->lock);
+				fibril_rwlock_write_unlock(&vfs_data->files_lock);
 				return ENOMEM;
 			}
 
 			memset(vfs_data->files[i], 0, sizeof(vfs_file_t));
 
-			fibril_mutex_initialize(&vfs_data->files[i]->_lock);
-			fibril_mutex_lock(&vfs_data->files[i]->_lock);
-			vfs_file_addref(vfs_data, vfs_data->files[i]);
+			fibril_rwlock_initialize(&vfs_data->files[i]->_lock);
+			fibril_rwlock_write_lock(&vfs_data->files[i]->_lock);
+			atomic_init(&vfs_data->files[i]->refcnt, 1);
 
 			*file = vfs_data->files[i];
-			vfs_file_addref(vfs_data, *file);
+			vfs_file_addref(*file);
 
-			fibril_mutex_unlock(&vfs_data->lock);
+			fibril_rwlock_write_unlock(&vfs_data->files_lock);
 			*out_fd = (int) i;
 			return EOK;
 		}
@@ -237,7 +272,7 @@ static errno_t _vfs_fd_alloc(vfs_client_data_t *vfs_data, vfs_file_t **file, boo
 			i++;
 		}
 	}
-	fibril_mutex_unlock(&vfs_data->lock);
+	fibril_rwlock_write_unlock(&vfs_data->files_lock);
 
 	return EMFILE;
 }
@@ -257,29 +292,32 @@ errno_t vfs_fd_alloc(vfs_file_t **file, bool desc, int *out_fd)
 	return _vfs_fd_alloc(VFS_DATA, file, desc, out_fd);
 }
 
-static errno_t _vfs_fd_free_locked(vfs_client_data_t *vfs_data, int fd)
+/** Remove a file from the table of open files.
+ *
+ * Should be called only with the table locked for writing. The table's
+ * reference to the file is handed over to the caller.
+ */
+static vfs_file_t *_vfs_fd_remove_locked(vfs_client_data_t *vfs_data, int fd)
 {
-	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES) || !vfs_data->files[fd]) {
-		return EBADF;
-	}
+	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES))
+		return NULL;
 
-	errno_t rc = vfs_file_delref(vfs_data, vfs_data->files[fd]);
+	vfs_file_t *file = vfs_data->files[fd];
 	vfs_data->files[fd] = NULL;
-	return rc;
+	return file;
 }
 
 static errno_t _vfs_fd_free(vfs_client_data_t *vfs_data, int fd)
 {
-	errno_t rc;
-
-	if (!vfs_files_init(vfs_data))
-		return ENOMEM;
+	fibril_rwlock_write_lock(&vfs_data->files_lock);
+	vfs_file_t *file = _vfs_fd_remove_locked(vfs_data, fd);
+	fibril_rwlock_write_unlock(&vfs_data->files_lock);
 
-	fibril_mutex_lock(&vfs_data->lock);
-	rc = _vfs_fd_free_locked(vfs_data, fd);
-	fibril_mutex_unlock(&vfs_data->lock);
+	if (!file)
+		return EBADF;
 
-	return rc;
+	/* Closing the file may need IPC, do not hold the table lock. */
+	return vfs_file_delref(file);
 }
 
 /** Release file descriptor.
@@ -305,63 +343,67 @@ errno_t vfs_fd_free(int fd)
  */
 errno_t vfs_fd_assign(vfs_file_t *file, int fd)
 {
-	if (!vfs_files_init(VFS_DATA))
-		return ENOMEM;
-
-	fibril_mutex_lock(&VFS_DATA->lock);
-	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES)) {
-		fibril_mutex_unlock(&VFS_DATA->lock);
+	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES))
 		return EBADF;
-	}
+
+	fibril_rwlock_write_lock(&VFS_DATA->files_lock);
 
 	/* Make sure fd is closed. */
-	(void) _vfs_fd_free_locked(VFS_DATA, fd);
-	assert(FILES[fd] == NULL);
+	vfs_file_t *old = _vfs_fd_remove_locked(VFS_DATA, fd);
 
 	FILES[fd] = file;
-	vfs_file_addref(VFS_DATA, FILES[fd]);
-	fibril_mutex_unlock(&VFS_DATA->lock);
+	vfs_file_addref(FILES[fd]);
+	fibril_rwlock_write_unlock(&VFS_DATA->files_lock);
+
+	if (old)
+		(void) vfs_file_delref(old);
 
 	return EOK;
 }
 
-static void _vfs_file_put(vfs_client_data_t *vfs_data, vfs_file_t *file)
+static void _vfs_file_put(vfs_client_data_t *vfs_data, vfs_file_t *file,
+    bool shared)
 {
-	fibril_mutex_unlock(&file->_lock);
+	if (shared)
+		fibril_rwlock_read_unlock(&file->_lock);
+	else
+		fibril_rwlock_write_unlock(&file->_lock);
 
-	fibril_mutex_lock(&vfs_data->lock);
-	vfs_file_delref(vfs_data, file);
-	fibril_mutex_unlock(&vfs_data->lock);
+	vfs_file_delref(file);
 }
 
-static vfs_file_t *_vfs_file_get(vfs_client_data_t *vfs_data, int fd)
+static vfs_file_t *_vfs_file_get(vfs_client_data_t *vfs_data, int fd,
+    bool shared)
 {
-	if (!vfs_files_init(vfs_data))
+	if ((fd < 0) || (fd >= VFS_MAX_OPEN_FILES))
 		return NULL;
 
-	fibril_mutex_lock(&vfs_data->lock);
-	if ((fd >= 0) && (fd < VFS_MAX_OPEN_FILES)) {
-		vfs_file_t *file = vfs_data->files[fd];
-		if (file != NULL) {
-			vfs_file_addref(vfs_data, file);
-			fibril_mutex_unlock(&vfs_data->lock);
-
-			fibril_mutex_lock(&file->_lock);
-			if (file->node == NULL) {
-				_vfs_file_put(vfs_data, file);
-				return NULL;
-			}
-			assert(file != NULL);
-			assert(file->node != NULL);
-			return file;
-		}
+	fibril_rwlock_read_lock(&vfs_data->files_lock);
+	vfs_file_t *file = vfs_data->files[fd];
+	if (file == NULL) {
+		fibril_rwlock_read_unlock(&vfs_data->files_lock);
+		return NULL;
 	}
-	fibril_mutex_unlock(&vfs_data->lock);
+	vfs_file_addref(file);
+	fibril_rwlock_read_unlock(&vfs_data->files_lock);
+
+	if (shared)
+		fibril_rwlock_read_lock(&file->_lock);
+	else
+		fibril_rwlock_write_lock(&file->_lock);
 
-	return NULL;
+	if (file->node == NULL) {
+		_vfs_file_put(vfs_data, file, shared);
+		return NULL;
+	}
+	assert(file != NULL);
+	assert(file->node != NULL);
+	return file;
 }
 
 /** Find VFS file structure for a given file descriptor.
+ *
+ * The file is locked exclusively until it is put.
  *
  * @param fd		File descriptor.
  *
@@ -369,7 +411,21 @@ static vfs_file_t *_vfs_file_get(vfs_client_data_t *vfs_data, int fd)
  */
 vfs_file_t *vfs_file_get(int fd)
 {
-	return _vfs_file_get(VFS_DATA, fd);
+	return _vfs_file_get(VFS_DATA, fd, false);
+}
+
+/** Find VFS file structure for a given file descriptor for sharing.
+ *
+ * The file is locked for sharing until it is put, i.e. other fibrils
+ * can use the file at the same time as long as they do not modify it.
+ *
+ * @param fd		File descriptor.
+ *
+ * @return		VFS file structure corresponding to fd.
+ */
+vfs_file_t *vfs_file_get_shared(int fd)
+{
+	return _vfs_file_get(VFS_DATA, fd, true);
 }
 
 /** Stop using a file structure.
@@ -378,7 +434,152 @@ vfs_file_t *vfs_file_get(int fd)
  */
 void vfs_file_put(vfs_file_t *file)
 {
-	_vfs_file_put(VFS_DATA, file);
+	_vfs_file_put(VFS_DATA, file, false);
+}
+
+/** Stop using a file structure obtained by vfs_file_get_shared().
+ *
+ * @param file		VFS file structure.
+ */
+void vfs_file_put_shared(vfs_file_t *file)
+{
+	_vfs_file_put(VFS_DATA, file, true);
+}
+
+/** Map an open file through the pager.
+ *
+ * The pager reads the mapped file for the client until the client unmaps
+ * it or terminates, so that the client does not need to keep a file
+ * descriptor open. While a node is mapped, its contents cannot be
+ * modified. Otherwise, pages faulted in later by the client could be
+ * inconsistent with the pages it has already got. If the client has
+ * mapped the node already, the existing mapping is used.
+ *
+ * @param fd		File descriptor of the file to map.
+ * @param[out] out_id	Mapping ID to pass to the pager.
+ *
+ * @return		EOK on success, EBADF if fd is an invalid file
+ *			descriptor, EINVAL if the file is not a regular file
+ *			open for reading or ELIMIT if the client has mapped
+ *			too many files.
+ */
+errno_t vfs_file_map(int fd, int *out_id)
+{
+	vfs_client_data_t *vfs_data = VFS_DATA;
+	vfs_file_t *file;
+	int id = -1;
+
+	file = _vfs_file_get(vfs_data, fd, true);
+	if (!file)
+		return EBADF;
+
+	if (!file->open_read || file->node->type != VFS_NODE_FILE) {
+		_vfs_file_put(vfs_data, file, true);
+		return EINVAL;
+	}
+
+	/* Waits for writes in progress to finish */
+	fibril_rwlock_write_lock(&file->node->contents_rwlock);
+	file->node->mapped++;
+	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
+
+	fibril_rwlock_write_lock(&vfs_data->files_lock);
+
+	for (int i = 0; i < VFS_MAX_MAPPED_FILES; i++) {
+		vfs_mapped_file_t *mf = &vfs_data->mapped[i];
+
+		if (mf->file != NULL && mf->file->node == file->node) {
+			mf->refcnt++;
+			fibril_rwlock_write_unlock(&vfs_data->files_lock);
+			fibril_rwlock_read_unlock(&file->_lock);
+			vfs_file_unmapped(file);
+			*out_id = i;
+			return EOK;
+		}
+
+		if (mf->file == NULL && id < 0)
+			id = i;
+	}
+
+	if (id < 0) {
+		fibril_rwlock_write_unlock(&vfs_data->files_lock);
+		fibril_rwlock_read_unlock(&file->_lock);
+		vfs_file_unmapped(file);
+		return ELIMIT;
+	}
+
+	/* The mapping takes over our reference to the file. */
+	vfs_data->mapped[id].file = file;
+	vfs_data->mapped[id].refcnt = 1;
+
+	fibril_rwlock_write_unlock(&vfs_data->files_lock);
+	fibril_rwlock_read_unlock(&file->_lock);
+
+	*out_id = id;
+	return EOK;
+}
+
+/** Unmap a file mapped through the pager.
+ *
+ * @param id		Mapping ID returned by vfs_file_map().
+ *
+ * @return		EOK on success or EBADF if id is an invalid
+ *			mapping ID.
+ */
+errno_t vfs_file_unmap(int id)
+{
+	vfs_client_data_t *vfs_data = VFS_DATA;
+	vfs_file_t *file = NULL;
+
+	if ((id < 0) || (id >= VFS_MAX_MAPPED_FILES))
+		return EBADF;
+
+	fibril_rwlock_write_lock(&vfs_data->files_lock);
+
+	vfs_mapped_file_t *mf = &vfs_data->mapped[id];
+	if (mf->file == NULL) {
+		fibril_rwlock_write_unlock(&vfs_data->files_lock);
+		return EBADF;
+	}
+
+	if (--mf->refcnt == 0) {
+		file = mf->file;
+		mf->file = NULL;
+	}
+
+	fibril_rwlock_write_unlock(&vfs_data->files_lock);
+
+	if (file != NULL)
+		vfs_file_unmapped(file);
+
+	return EOK;
+}
+
+/** Find a file mapped through the pager for sharing.
+ *
+ * @param id		Mapping ID returned by vfs_file_map().
+ *
+ * @return		VFS file structure, to be put by
+ *			vfs_file_put_shared(), or NULL.
+ */
+vfs_file_t *vfs_file_get_mapped(int id)
+{
+	vfs_client_data_t *vfs_data = VFS_DATA;
+
+	if ((id < 0) || (id >= VFS_MAX_MAPPED_FILES))
+		return NULL;
+
+	fibril_rwlock_read_lock(&vfs_data->files_lock);
+	vfs_file_t *file = vfs_data->mapped[id].file;
+	if (file == NULL) {
+		fibril_rwlock_read_unlock(&vfs_data->files_lock);
+		return NULL;
+	}
+	vfs_file_addref(file);
+	fibril_rwlock_read_unlock(&vfs_data->files_lock);
+
+	fibril_rwlock_read_lock(&file->_lock);
+	return file;
 }
 
 void vfs_op_pass_handle(task_id_t donor_id, task_id_t acceptor_id, int donor_fd)
@@ -402,7 +603,7 @@ void vfs_op_pass_handle(task_id_t donor_id, task_id_t acceptor_id, int donor_fd)
 	if (!donor_data)
 		goto out;
 
-	donor_file = _vfs_file_get(donor_data, donor_fd);
+	donor_file = _vfs_file_get(donor_data, donor_fd, true);
 	if (!donor_file)
 		goto out;
 
@@ -424,7 +625,7 @@ out:
 	if (acceptor_data)
 		async_put_client_data_by_id(acceptor_id);
 	if (donor_file)
-		_vfs_file_put(donor_data, donor_file);
+		_vfs_file_put(donor_data, donor_file, true);
 }
 
 errno_t vfs_wait_handle_internal(bool high_fd, int *out_fd)
@@ -407,39 +407,25 @@ static errno_t rdwr_ipc_internal(async_exch_t *exch, vfs_file_t *file, aoff64_t
 	return (errno_t) rc;
 }
 
-static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
-    void *ipc_cb_data)
+/** Read or write an open file locked for sharing. */
+static errno_t vfs_rdwr_file(vfs_file_t *file, aoff64_t pos, bool read,
+    rdwr_ipc_cb_t ipc_cb, void *ipc_cb_data)
 {
-	/*
-	 * The following code strongly depends on the fact that the files data
-	 * structure can be only accessed by a single fibril and all file
-	 * operations are serialized (i.e. the reads and writes cannot
-	 * interleave and a file cannot be closed while it is being read).
-	 *
-	 * Additional synchronization needs to be added once the table of
-	 * open files supports parallel access!
-	 */
-
-	/* Lookup the file structure corresponding to the file descriptor. */
-	vfs_file_t *file = vfs_file_get(fd);
-	if (!file)
-		return EBADF;
-
-	if ((read && !file->open_read) || (!read && !file->open_write)) {
-		vfs_file_put(file);
+	if ((read && !file->open_read) || (!read && !file->open_write))
 		return EINVAL;
-	}
 
 	vfs_info_t *fs_info = fs_handle_to_info(file->node->fs_handle);
 	assert(fs_info);
 
 	bool rlock = read ||
-	    (fs_info->concurrent_read_write && fs_info->write_retains_size);
+	    (fs_info->concurrent_read_write && fs_info->write_retains_size &&
+	    !file->append);
 
 	/*
 	 * Lock the file's node so that no other client can read/write to it at
 	 * the same time unless the FS supports concurrent reads/writes and its
-	 * write implementation does not modify the file size.
+	 * write implementation does not modify the file size. Appending writes
+	 * always lock the node exclusively as they depend on its size.
 	 */
 	if (rlock)
 		fibril_rwlock_read_lock(&file->node->contents_rwlock);
@@ -460,13 +446,21 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 				fibril_rwlock_write_unlock(
 				    &file->node->contents_rwlock);
 			}
-			vfs_file_put(file);
 			return EINVAL;
 		}
 
 		fibril_rwlock_read_lock(&namespace_rwlock);
 	}
 
+	/* The contents of a node mapped by the pager must not change */
+	if (!read && file->node->mapped > 0) {
+		if (rlock)
+			fibril_rwlock_read_unlock(&file->node->contents_rwlock);
+		else
+			fibril_rwlock_write_unlock(&file->node->contents_rwlock);
+		return ETXTBSY;
+	}
+
 	async_exch_t *fs_exch = vfs_exchange_grab(file->node->fs_handle);
 
 	if (!read && file->append)
@@ -495,14 +489,40 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 		fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	}
 
-	vfs_file_put(file);
+	/* Pages cached by the pager no longer reflect the contents */
+	if (!read)
+		vfs_page_cache_evict(file->node);
+
+	return rc;
+}
+
+static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
+    void *ipc_cb_data)
+{
+	/*
+	 * Reading and writing does not modify the open file, so the file is
+	 * only locked for sharing and the fibrils of a client can do I/O on
+	 * the same open file in parallel. The position is passed by the
+	 * client with every request, so there is no file position to protect.
+	 * The node's contents lock taken in vfs_rdwr_file() orders the I/O
+	 * against changes of the file size.
+	 */
+
+	/* Lookup the file structure corresponding to the file descriptor. */
+	vfs_file_t *file = vfs_file_get_shared(fd);
+	if (!file)
+		return EBADF;
+
+	errno_t rc = vfs_rdwr_file(file, pos, read, ipc_cb, ipc_cb_data);
+	vfs_file_put_shared(file);
 
 	return rc;
 }
 
-errno_t vfs_rdwr_internal(int fd, aoff64_t pos, bool read, rdwr_io_chunk_t *chunk)
+errno_t vfs_rdwr_internal(vfs_file_t *file, aoff64_t pos, bool read,
+    rdwr_io_chunk_t *chunk)
 {
-	return vfs_rdwr(fd, pos, read, rdwr_ipc_internal, chunk);
+	return vfs_rdwr_file(file, pos, read, rdwr_ipc_internal, chunk);
 }
 
 errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
@@ -624,19 +644,27 @@ errno_t vfs_op_resize(int fd, int64_t size)
 
 	fibril_rwlock_write_lock(&file->node->contents_rwlock);
 
+	/* The contents of a node mapped by the pager must not change */
+	if (file->node->mapped > 0) {
+		fibril_rwlock_write_unlock(&file->node->contents_rwlock);
+		vfs_file_put(file);
+		return ETXTBSY;
+	}
+
 	errno_t rc = vfs_truncate_internal(file->node->fs_handle,
 	    file->node->service_id, file->node->index, size);
 	if (rc == EOK)
 		file->node->size = size;
 
 	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
+	vfs_page_cache_evict(file->node);
 	vfs_file_put(file);
 	return rc;
 }
 
 errno_t vfs_op_stat(int fd)
 {
-	vfs_file_t *file = vfs_file_get(fd);
+	vfs_file_t *file = vfs_file_get_shared(fd);
 	if (!file)
 		return EBADF;
 
@@ -647,13 +675,13 @@ errno_t vfs_op_stat(int fd)
 	    node->service_id, node->index, true);
 	vfs_exchange_release(exch);
 
-	vfs_file_put(file);
+	vfs_file_put_shared(file);
 	return rc;
 }
 
 errno_t vfs_op_statfs(int fd)
 {
-	vfs_file_t *file = vfs_file_get(fd);
+	vfs_file_t *file = vfs_file_get_shared(fd);
 	if (!file)
 		return EBADF;
 
@@ -664,13 +692,13 @@ errno_t vfs_op_statfs(int fd)
 	    node->service_id, node->index, false);
 	vfs_exchange_release(exch);
 
-	vfs_file_put(file);
+	vfs_file_put_shared(file);
 	return rc;
 }
 
 errno_t vfs_op_sync(int fd)
 {
-	vfs_file_t *file = vfs_file_get(fd);
+	vfs_file_t *file = vfs_file_get_shared(fd);
 	if (!file)
 		return EBADF;
 
@@ -686,7 +714,7 @@ errno_t vfs_op_sync(int fd)
 	errno_t rc;
 	async_wait_for(msg, &rc);
 
-	vfs_file_put(file);
+	vfs_file_put_shared(file);
 	return rc;
 
 }
@@ -40,24 +40,271 @@
 #include <fibril_synch.h>
 #include <errno.h>
 #include <as.h>
+#include <assert.h>
+#include <smc.h>
+#include <stdlib.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 
-void vfs_page_in(ipc_call_t *req)
-{
-	aoff64_t offset = ipc_get_arg1(req);
-	size_t page_size = ipc_get_arg2(req);
-	int fd = ipc_get_arg3(req);
+/** Number of pages in one area of the page cache */
+#define PAGE_CHUNK_PAGES  16
+
+/** Maximum number of areas held by the page cache */
+#define PAGE_CACHE_CHUNKS  64
+
+/** Area holding several pages of the page cache
+ *
+ * Slots of a chunk are filled in order and never reused, as clients may
+ * keep the frame of an evicted page mapped. The whole area is destroyed
+ * once none of its pages is cached any longer or when the chunk is
+ * evicted, the frames then live on only in the clients that map them.
+ */
+typedef struct {
+	/** Link to page_chunk_lru */
+	link_t lru_link;
+	/** Cached pages in this chunk (of the type vfs_page_t) */
+	list_t pages;
+	/** Area holding PAGE_CHUNK_PAGES pages */
+	void *area;
+	/** Number of slots handed out */
+	size_t used;
+	/** Number of slots which are cached or being read */
+	size_t live;
+	/** Number of slots being read */
+	size_t pending;
+} vfs_page_chunk_t;
+
+/** Page of a file cached by the pager
+ *
+ * The same page is handed out to all clients that map the file through
+ * the pager. Read-only mappings, such as the text of shared libraries,
+ * are thus backed by the same physical memory in all tasks. The kernel
+ * gives writable mappings a private copy of the page.
+ */
+typedef struct {
+	/** Link to page_cache */
+	ht_link_t ht_link;
+	/** Link to vfs_node_t.pages */
+	link_t node_link;
+	/** Link to vfs_page_chunk_t.pages */
+	link_t chunk_link;
+	/** Node whose contents are cached */
+	vfs_node_t *node;
+	/** Offset of the page within the node */
+	aoff64_t offset;
+	/** Chunk holding the data */
+	vfs_page_chunk_t *chunk;
+	/** Slot of the chunk holding the data */
 	void *page;
-	errno_t rc;
+} vfs_page_t;
 
-	page = as_area_create(AS_AREA_ANY, page_size,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
-	    AS_AREA_UNPAGED);
+/** Page cache lookup key */
+typedef struct {
+	vfs_node_t *node;
+	aoff64_t offset;
+} vfs_page_key_t;
 
-	if (page == AS_MAP_FAILED) {
-		async_answer_0(req, ENOMEM);
-		return;
+/** Mutex protecting the page cache and the page lists of all nodes. */
+static FIBRIL_MUTEX_INITIALIZE(page_cache_mutex);
+
+/** Pages cached by the pager (of the type vfs_page_t). */
+static hash_table_t page_cache;
+
+/** Chunks of the page cache, least recently used first. */
+static LIST_INITIALIZE(page_chunk_lru);
+
+/** Number of chunks in page_chunk_lru. */
+static size_t page_chunk_count;
+
+/** Chunk whose free slots are being handed out. */
+static vfs_page_chunk_t *page_chunk_fill;
+
+static size_t page_key_hash(const void *key)
+{
+	const vfs_page_key_t *k = key;
+
+	return hash_combine((size_t) k->node,
+	    hash_mix((size_t) (k->offset / PAGE_SIZE)));
+}
+
+static size_t page_hash(const ht_link_t *item)
+{
+	vfs_page_t *vpage = hash_table_get_inst(item, vfs_page_t, ht_link);
+	vfs_page_key_t key = {
+		.node = vpage->node,
+		.offset = vpage->offset
+	};
+
+	return page_key_hash(&key);
+}
+
+static bool page_key_equal(const void *key, const ht_link_t *item)
+{
+	const vfs_page_key_t *k = key;
+	vfs_page_t *vpage = hash_table_get_inst(item, vfs_page_t, ht_link);
+
+	return vpage->node == k->node && vpage->offset == k->offset;
+}
+
+static hash_table_ops_t page_cache_ops = {
+	.hash = page_hash,
+	.key_hash = page_key_hash,
+	.key_equal = page_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+bool vfs_pager_init(void)
+{
+	return hash_table_create(&page_cache, 0, 0, &page_cache_ops);
+}
+
+/** Find a cached page.
+ *
+ * @param node   VFS node
+ * @param offset Page-aligned offset within the node
+ * @return Cached page or @c NULL. The page cache mutex must be held.
+ */
+static vfs_page_t *page_cache_find(vfs_node_t *node, aoff64_t offset)
+{
+	vfs_page_key_t key = {
+		.node = node,
+		.offset = offset
+	};
+
+	assert(fibril_mutex_is_locked(&page_cache_mutex));
+
+	ht_link_t *link = hash_table_find(&page_cache, &key);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, vfs_page_t, ht_link);
+}
+
+/** Drop a page from the page cache.
+ *
+ * The slot of the page stays in use until its chunk is destroyed.
+ * The page cache mutex must be held.
+ */
+static void page_cache_remove(vfs_page_t *vpage)
+{
+	assert(fibril_mutex_is_locked(&page_cache_mutex));
+
+	list_remove(&vpage->node_link);
+	list_remove(&vpage->chunk_link);
+	hash_table_remove_item(&page_cache, &vpage->ht_link);
+	free(vpage);
+}
+
+/** Destroy a chunk and drop all its pages from the page cache.
+ *
+ * The page cache mutex must be held.
+ */
+static void page_chunk_destroy(vfs_page_chunk_t *chunk)
+{
+	assert(fibril_mutex_is_locked(&page_cache_mutex));
+	assert(chunk->pending == 0);
+
+	while (!list_empty(&chunk->pages)) {
+		page_cache_remove(list_get_instance(list_first(&chunk->pages),
+		    vfs_page_t, chunk_link));
+	}
+
+	if (chunk == page_chunk_fill)
+		page_chunk_fill = NULL;
+
+	list_remove(&chunk->lru_link);
+	page_chunk_count--;
+	as_area_destroy(chunk->area);
+	free(chunk);
+}
+
+/** Release a slot of a chunk.
+ *
+ * Destroy the chunk if none of its slots is in use and no more slots
+ * can be handed out from it. The page cache mutex must be held.
+ */
+static void page_chunk_put(vfs_page_chunk_t *chunk)
+{
+	assert(fibril_mutex_is_locked(&page_cache_mutex));
+	assert(chunk->live > 0);
+
+	chunk->live--;
+	if (chunk->live == 0 && chunk->used == PAGE_CHUNK_PAGES)
+		page_chunk_destroy(chunk);
+}
+
+/** Get a free slot for a page.
+ *
+ * Create a new chunk if the current one is full, evicting the least
+ * recently used chunk that is not being read into if the page cache
+ * is at its limit. The page cache mutex must be held.
+ *
+ * @param rchunk Place to store the chunk holding the slot
+ * @return Slot or @c NULL if none is available
+ */
+static void *page_chunk_get(vfs_page_chunk_t **rchunk)
+{
+	vfs_page_chunk_t *chunk = page_chunk_fill;
+
+	assert(fibril_mutex_is_locked(&page_cache_mutex));
+
+	if (chunk == NULL || chunk->used == PAGE_CHUNK_PAGES) {
+		page_chunk_fill = NULL;
+
+		if (page_chunk_count >= PAGE_CACHE_CHUNKS) {
+			vfs_page_chunk_t *victim = NULL;
+
+			list_foreach(page_chunk_lru, lru_link,
+			    vfs_page_chunk_t, c) {
+				if (c->pending == 0) {
+					victim = c;
+					break;
+				}
+			}
+
+			if (victim == NULL)
+				return NULL;
+
+			page_chunk_destroy(victim);
+		}
+
+		chunk = malloc(sizeof(vfs_page_chunk_t));
+		if (chunk == NULL)
+			return NULL;
+
+		chunk->area = as_area_create(AS_AREA_ANY,
+		    PAGE_CHUNK_PAGES * PAGE_SIZE,
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+		    AS_AREA_UNPAGED);
+		if (chunk->area == AS_MAP_FAILED) {
+			free(chunk);
+			return NULL;
+		}
+
+		list_initialize(&chunk->pages);
+		chunk->used = 0;
+		chunk->live = 0;
+		chunk->pending = 0;
+		list_append(&chunk->lru_link, &page_chunk_lru);
+		page_chunk_count++;
+		page_chunk_fill = chunk;
 	}
 
+	void *page = chunk->area + chunk->used * PAGE_SIZE;
+	chunk->used++;
+	chunk->live++;
+
+	*rchunk = chunk;
+	return page;
+}
+
+/** Read a page of a file into a buffer. */
+static errno_t page_read(vfs_file_t *file, aoff64_t offset, void *page,
+    size_t page_size)
+{
+	errno_t rc;
+
 	rdwr_io_chunk_t chunk = {
 		.buffer = page,
 		.size = page_size
@@ -66,7 +313,7 @@ void vfs_page_in(ipc_call_t *req)
 	size_t total = 0;
 	aoff64_t pos = offset;
 	do {
-		rc = vfs_rdwr_internal(fd, pos, true, &chunk);
+		rc = vfs_rdwr_internal(file, pos, true, &chunk);
 		if (rc != EOK)
 			break;
 		if (chunk.size == 0)
@@ -77,17 +324,172 @@ void vfs_page_in(ipc_call_t *req)
 		chunk.size = page_size - total;
 	} while (total < page_size);
 
-	async_answer_1(req, rc, (sysarg_t) page);
+	if (rc != EOK)
+		return rc;
+
+	/* The page may end up mapped executable */
+	return smc_coherence(page, page_size);
+}
+
+/** Answer a page-in request with a private copy of the page. */
+static void page_in_private(ipc_call_t *req, vfs_file_t *file,
+    aoff64_t offset, size_t page_size)
+{
+	void *page;
+	errno_t rc;
+
+	page = as_area_create(AS_AREA_ANY, page_size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_UNPAGED);
+
+	if (page == AS_MAP_FAILED) {
+		async_answer_0(req, ENOMEM);
+		return;
+	}
+
+	rc = page_read(file, offset, page, page_size);
+	if (rc != EOK)
+		async_answer_0(req, rc);
+	else
+		async_answer_1(req, EOK, (sysarg_t) page);
 
-	/*
-	 * FIXME:
-	 * This is just for now until we implement proper page cache
-	 * management.  Not keeping the pages around in a cache results in
-	 * inherently non-coherent private mappings.
-	 */
 	as_area_destroy(page);
 }
 
+/** Handle a page-in request from the kernel.
+ *
+ * ARG1 is the offset of the faulting page within the area, ARG2 the page
+ * size, ARG3 the ID under which the client has mapped the file and ARG4
+ * the offset in the file at which the area starts.
+ *
+ * The page is answered while holding the page cache mutex. The kernel
+ * takes its reference to the frame while processing the answer, so the
+ * page cannot be evicted in the meantime.
+ */
+void vfs_page_in(ipc_call_t *req)
+{
+	aoff64_t offset = ipc_get_arg1(req) + ipc_get_arg4(req);
+	size_t page_size = ipc_get_arg2(req);
+	int id = ipc_get_arg3(req);
+	vfs_page_chunk_t *chunk;
+	vfs_page_t *vpage;
+	vfs_file_t *file;
+	vfs_node_t *node;
+	unsigned gen;
+	void *page;
+	errno_t rc;
+
+	file = vfs_file_get_mapped(id);
+	if (file == NULL) {
+		async_answer_0(req, EBADF);
+		return;
+	}
+
+	node = file->node;
+
+	/* Only whole, aligned pages can be shared */
+	if (page_size != PAGE_SIZE || (offset % PAGE_SIZE) != 0) {
+		page_in_private(req, file, offset, page_size);
+		vfs_file_put_shared(file);
+		return;
+	}
+
+	fibril_mutex_lock(&page_cache_mutex);
+
+	vpage = page_cache_find(node, offset);
+	if (vpage != NULL) {
+		list_remove(&vpage->chunk->lru_link);
+		list_append(&vpage->chunk->lru_link, &page_chunk_lru);
+		async_answer_1(req, EOK, (sysarg_t) vpage->page);
+		fibril_mutex_unlock(&page_cache_mutex);
+		vfs_file_put_shared(file);
+		return;
+	}
+
+	gen = node->pages_gen;
+	page = page_chunk_get(&chunk);
+	if (page != NULL)
+		chunk->pending++;
+
+	fibril_mutex_unlock(&page_cache_mutex);
+
+	if (page == NULL) {
+		/* The page cache is exhausted */
+		page_in_private(req, file, offset, page_size);
+		vfs_file_put_shared(file);
+		return;
+	}
+
+	rc = page_read(file, offset, page, page_size);
+	vpage = (rc == EOK) ? malloc(sizeof(vfs_page_t)) : NULL;
+
+	fibril_mutex_lock(&page_cache_mutex);
+
+	chunk->pending--;
+
+	vfs_page_t *cached = page_cache_find(node, offset);
+	if (vpage == NULL || cached != NULL || node->pages_gen != gen) {
+		/*
+		 * The page could not be read, another fibril has cached
+		 * the page in the meantime or the node was written to while
+		 * we were reading it.
+		 */
+		if (rc != EOK)
+			async_answer_0(req, rc);
+		else if (cached != NULL)
+			async_answer_1(req, EOK, (sysarg_t) cached->page);
+		else
+			async_answer_1(req, EOK, (sysarg_t) page);
+
+		page_chunk_put(chunk);
+		fibril_mutex_unlock(&page_cache_mutex);
+		free(vpage);
+		vfs_file_put_shared(file);
+		return;
+	}
+
+	vpage->node = node;
+	vpage->offset = offset;
+	vpage->chunk = chunk;
+	vpage->page = page;
+	list_append(&vpage->node_link, &node->pages);
+	list_append(&vpage->chunk_link, &chunk->pages);
+	hash_table_insert(&page_cache, &vpage->ht_link);
+
+	async_answer_1(req, EOK, (sysarg_t) page);
+	fibril_mutex_unlock(&page_cache_mutex);
+
+	vfs_file_put_shared(file);
+}
+
+/** Drop all pages of a node from the page cache.
+ *
+ * Called when the node's contents change or the node goes away. Clients
+ * that already have the pages mapped keep the old contents, later page-ins
+ * read the node again.
+ *
+ * @param node VFS node
+ */
+void vfs_page_cache_evict(vfs_node_t *node)
+{
+	vfs_page_chunk_t *chunk;
+	vfs_page_t *vpage;
+
+	fibril_mutex_lock(&page_cache_mutex);
+
+	node->pages_gen++;
+
+	while (!list_empty(&node->pages)) {
+		vpage = list_get_instance(list_first(&node->pages),
+		    vfs_page_t, node_link);
+		chunk = vpage->chunk;
+		page_cache_remove(vpage);
+		page_chunk_put(chunk);
+	}
+
+	fibril_mutex_unlock(&page_cache_mutex);
+}
+
 /**
  * @}
  */